@@ -0,0 +1,80 @@
+/*
+@file allocator_bench.cpp
+@brief Benchmarks the allocators from `include/allocators` on a request-handling workload:
+each "request" builds `state.range(0)` short-lived `StackAssistedVector<int64_t, 8>`s of 1 to 16
+elements (most of which spill to the heap), after which any arena is reset.
+
+The allocators compared are `std::allocator`, `ArenaAllocator` (over an arena that is reset after
+every request), `ThreadLocalArenaAllocator`, `PoolAllocator` (over a pool whose blocks fit the
+largest buffer), and `std::pmr::polymorphic_allocator` over a `MemoryResourceAdapter` of an arena.
+*/
+
+#include "vector_variations/stack_assisted_vector.h"
+#include "allocators/monotonic_arena.h"
+#include "allocators/pool_allocator.h"
+#include "allocators/memory_resource_adapter.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+namespace {
+
+/* Each "setup" owns the resources behind one allocator, and provides `allocator()` and
+`end_request()`, which is called after every request */
+struct StdAllocatorSetup {
+    std::allocator<int64_t> allocator() { return {}; }
+    void end_request() {}
+};
+
+struct ArenaSetup {
+    MonotonicArena arena;
+    ArenaAllocator<int64_t> allocator() { return arena; }
+    void end_request() { arena.reset(); }
+};
+
+struct ThreadLocalArenaSetup {
+    ThreadLocalArenaAllocator<int64_t> allocator() { return {}; }
+    void end_request() { MonotonicArena::thread_local_arena().reset(); }
+};
+
+struct PoolSetup {
+    FixedSizePool pool{16 * sizeof(int64_t)};
+    PoolAllocator<int64_t> allocator() { return pool; }
+    void end_request() {}
+};
+
+struct PmrArenaSetup {
+    MonotonicArena arena;
+    MemoryResourceAdapter<MonotonicArena> resource{arena};
+    std::pmr::polymorphic_allocator<int64_t> allocator() { return &resource; }
+    void end_request() { arena.reset(); }
+};
+
+template <typename Setup>
+void BM_Request(benchmark::State &state) {
+    auto vectors_per_request = state.range(0);
+    Setup setup;
+    using Allocator = decltype(setup.allocator());
+
+    for (auto _ : state) {
+        for (int64_t i = 0; i < vectors_per_request; ++i) {
+            StackAssistedVector<int64_t, 8, Allocator> sav(setup.allocator());
+            auto n = i % 16 + 1;
+            for (int64_t j = 0; j < n; ++j) {
+                sav.push_back(j);
+            }
+            benchmark::DoNotOptimize(sav.data());
+        }
+        setup.end_request();
+    }
+    state.SetItemsProcessed(state.iterations() * vectors_per_request);
+}
+
+}  /* namespace */
+
+BENCHMARK(BM_Request<StdAllocatorSetup>)->Arg(1000);
+BENCHMARK(BM_Request<ArenaSetup>)->Arg(1000);
+BENCHMARK(BM_Request<ThreadLocalArenaSetup>)->Arg(1000);
+BENCHMARK(BM_Request<PoolSetup>)->Arg(1000);
+BENCHMARK(BM_Request<PmrArenaSetup>)->Arg(1000);
@@ -0,0 +1,115 @@
+/*
+@file bounds_check_bench.cpp
+@brief Benchmarks the overhead of each `BoundsCheckLevel` of `BoundsCheckedVector` against a plain
+`std::vector`.
+
+Four workloads are measured:
+- `BM_SequentialSum` sums every element through `operator[]` (which bounds checks may prevent from
+  being vectorized);
+- `BM_RandomGather` sums elements at precomputed random indices through `operator[]`;
+- `BM_PushBack` fills a vector with `push_back` (which records size changes in the
+  `BoundsCheckHistory` for `Sampled` and `Full` checking); and
+- `BM_PushPop` repeatedly pushes and pops an element without ever reallocating, which isolates the
+  cost of tracking size changes.
+*/
+
+#include "vector_variations/bounds_checked_vector.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+template <BoundsCheckLevel Level>
+using CheckedVector = BoundsCheckedVector<int64_t, std::allocator<int64_t>, Level>;
+
+/* Returns a vector of the `n` elements `0, 1, ..., n - 1` */
+template <typename V>
+V make_iota(int64_t n) {
+    V v;
+    v.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        v.push_back(i);
+    }
+    return v;
+}
+
+template <typename V>
+void BM_SequentialSum(benchmark::State &state) {
+    auto n = state.range(0);
+    auto v = make_iota<V>(n);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            sum += v[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename V>
+void BM_RandomGather(benchmark::State &state) {
+    auto n = state.range(0);
+    auto v = make_iota<V>(n);
+
+    std::mt19937_64 rng(12345);
+    std::uniform_int_distribution<size_t> distribution(0, n - 1);
+    std::vector<size_t> indices(4096);
+    for (auto &index : indices) {
+        index = distribution(rng);
+    }
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto index : indices) {
+            sum += v[index];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+template <typename V>
+void BM_PushBack(benchmark::State &state) {
+    auto n = state.range(0);
+    for (auto _ : state) {
+        V v;
+        for (int64_t i = 0; i < n; ++i) {
+            v.push_back(i);
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename V>
+void BM_PushPop(benchmark::State &state) {
+    V v;
+    v.reserve(16);
+    for (auto _ : state) {
+        for (int64_t i = 0; i < 16; ++i) {
+            v.push_back(i);
+        }
+        for (int64_t i = 0; i < 16; ++i) {
+            v.pop_back();
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 32);
+}
+
+}  /* namespace */
+
+#define BOUNDS_CHECK_BENCHMARKS(...) \
+    BENCHMARK(BM_SequentialSum<__VA_ARGS__>)->Arg(1 << 10)->Arg(1 << 16); \
+    BENCHMARK(BM_RandomGather<__VA_ARGS__>)->Arg(1 << 10)->Arg(1 << 20); \
+    BENCHMARK(BM_PushBack<__VA_ARGS__>)->Arg(1 << 10)->Arg(1 << 16); \
+    BENCHMARK(BM_PushPop<__VA_ARGS__>)
+
+BOUNDS_CHECK_BENCHMARKS(std::vector<int64_t>);
+BOUNDS_CHECK_BENCHMARKS(CheckedVector<BoundsCheckLevel::Off>);
+BOUNDS_CHECK_BENCHMARKS(CheckedVector<BoundsCheckLevel::BranchOnly>);
+BOUNDS_CHECK_BENCHMARKS(CheckedVector<BoundsCheckLevel::Sampled>);
+BOUNDS_CHECK_BENCHMARKS(CheckedVector<BoundsCheckLevel::Full>);
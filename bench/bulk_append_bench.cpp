@@ -0,0 +1,195 @@
+/*
+@file bulk_append_bench.cpp
+@brief Benchmarks appending a batch of `state.range(0)` decoded records to a vector (as our parsers
+do), comparing:
+- `push_back` of every record, which checks the capacity on every call;
+- `append_range` of the decoded batch, which checks the capacity once and then copies the batch
+  with a single `std::memcpy`;
+- `append_n_uninitialized` (or `resize_for_overwrite`), followed by decoding the records straight
+  into the vector.
+The vector is cleared (but keeps its capacity) between batches, so that the appends themselves,
+rather than reallocations, are measured.
+
+It also benchmarks growing a byte buffer and "reading" `state.range(0)` bytes into it (with a
+`std::memcpy` from a source that is already in cache), where `resize` zeroes the buffer first, while
+`resize_and_overwrite` and `DefaultInitAllocator` leave it untouched until the read.
+*/
+
+#include "allocators/default_init_allocator.h"
+#include "vector_variations/fixed_capacity_vector.h"
+#include "vector_variations/stack_assisted_vector.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/* A fixed-size record, as decoded from a batch of input */
+struct Record {
+    uint32_t id;
+    uint32_t flags;
+    uint64_t value;
+};
+
+/* "Decodes" the `i`th record of a batch */
+Record decode(uint32_t i) {
+    return {i, i & 7, uint64_t{i} * 2654435761u};
+}
+
+std::vector<Record> decode_batch(int64_t n) {
+    std::vector<Record> batch;
+    for (int64_t i = 0; i < n; ++i) {
+        batch.push_back(decode(static_cast<uint32_t>(i)));
+    }
+    return batch;
+}
+
+template <typename Vector>
+Vector make_vector_with_capacity(int64_t n) {
+    Vector v;
+    if constexpr (requires { v.reserve(size_t{}); }) {
+        v.reserve(n);
+    }
+    return v;
+}
+
+/* Each iteration appends the records of a decoded batch one by one */
+template <typename Vector>
+void BM_PushBackEach(benchmark::State &state) {
+    auto batch = decode_batch(state.range(0));
+    auto v = make_vector_with_capacity<Vector>(state.range(0));
+    for (auto _ : state) {
+        v.clear();
+        for (const auto &record : batch) {
+            v.push_back(record);
+        }
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration appends a decoded batch at once */
+template <typename Vector>
+void BM_AppendRange(benchmark::State &state) {
+    auto batch = decode_batch(state.range(0));
+    auto v = make_vector_with_capacity<Vector>(state.range(0));
+    for (auto _ : state) {
+        v.clear();
+        if constexpr (requires { v.append_range(batch); }) {
+            v.append_range(batch);
+        } else {
+            v.insert(v.end(), batch.begin(), batch.end());
+        }
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration decodes a batch with `push_back` (the baseline for `BM_DecodeInPlace`) */
+template <typename Vector>
+void BM_DecodePushBack(benchmark::State &state) {
+    auto v = make_vector_with_capacity<Vector>(state.range(0));
+    for (auto _ : state) {
+        v.clear();
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            v.push_back(decode(static_cast<uint32_t>(i)));
+        }
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration makes room for a batch without initializing it, then decodes it in place. With
+`std::vector`, `resize` zeroes the records first. */
+template <typename Vector>
+void BM_DecodeInPlace(benchmark::State &state) {
+    auto v = make_vector_with_capacity<Vector>(state.range(0));
+    for (auto _ : state) {
+        v.clear();
+        Record *records;
+        if constexpr (requires { v.append_n_uninitialized(size_t{}); }) {
+            records = v.append_n_uninitialized(state.range(0));
+        } else {
+            v.resize(state.range(0));
+            records = v.data();
+        }
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            records[i] = decode(static_cast<uint32_t>(i));
+        }
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Stands in for `read(fd, data, count)` from a file or a socket */
+size_t read_into(const std::vector<char> &source, char *data, size_t count) {
+    std::memcpy(data, source.data(), count);
+    return count;
+}
+
+/* Each iteration grows an empty buffer with `resize`, then reads into it */
+template <typename Buffer>
+void BM_ResizeThenRead(benchmark::State &state) {
+    std::vector<char> source(state.range(0), 'x');
+    for (auto _ : state) {
+        Buffer buffer;
+        buffer.resize(state.range(0));
+        buffer.resize(read_into(source, buffer.data(), buffer.size()));
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration grows an empty buffer with `resize_and_overwrite`, reading into it */
+template <typename Buffer>
+void BM_ResizeAndOverwrite(benchmark::State &state) {
+    std::vector<char> source(state.range(0), 'x');
+    for (auto _ : state) {
+        Buffer buffer;
+        buffer.resize_and_overwrite(state.range(0), [&](char *data, size_t count) {
+            return read_into(source, data, count);
+        });
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+using StdBuffer = std::vector<char>;
+using DefaultInitStdBuffer = std::vector<char, DefaultInitAllocator<char>>;
+using SAVBuffer = StackAssistedVector<char, 256>;
+using DefaultInitSAVBuffer = StackAssistedVector<char, 256, DefaultInitAllocator<char>>;
+
+using StdVector = std::vector<Record>;
+using SAV = StackAssistedVector<Record, 16>;
+using FCV = FixedCapacityVector<Record, 4096>;
+
+}  /* namespace */
+
+#define BULK_APPEND_BENCHMARK(benchmark_, vector) \
+    BENCHMARK(benchmark_<vector>)->Arg(64)->Arg(4096)
+
+BULK_APPEND_BENCHMARK(BM_PushBackEach, StdVector);
+BULK_APPEND_BENCHMARK(BM_PushBackEach, SAV);
+BULK_APPEND_BENCHMARK(BM_PushBackEach, FCV);
+BULK_APPEND_BENCHMARK(BM_AppendRange, StdVector);
+BULK_APPEND_BENCHMARK(BM_AppendRange, SAV);
+BULK_APPEND_BENCHMARK(BM_AppendRange, FCV);
+BULK_APPEND_BENCHMARK(BM_DecodePushBack, StdVector);
+BULK_APPEND_BENCHMARK(BM_DecodePushBack, SAV);
+BULK_APPEND_BENCHMARK(BM_DecodePushBack, FCV);
+BULK_APPEND_BENCHMARK(BM_DecodeInPlace, StdVector);
+BULK_APPEND_BENCHMARK(BM_DecodeInPlace, SAV);
+BULK_APPEND_BENCHMARK(BM_DecodeInPlace, FCV);
+
+BENCHMARK(BM_ResizeThenRead<StdBuffer>)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_ResizeThenRead<DefaultInitStdBuffer>)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_ResizeThenRead<SAVBuffer>)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_ResizeThenRead<DefaultInitSAVBuffer>)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_ResizeAndOverwrite<SAVBuffer>)->Arg(4096)->Arg(1 << 20);
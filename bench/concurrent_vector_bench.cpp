@@ -0,0 +1,90 @@
+/*
+@file concurrent_vector_bench.cpp
+@brief Benchmarks how appending to one shared `ConcurrentSegmentedVector` scales from 1 to 64
+threads, against a `std::vector` protected by a `std::mutex` (which is what collecting results
+from worker threads typically looks like). Every thread appends either one element at a time (with
+`push_back`) or in batches of 16 (with `grow_by`, against one `insert` under the lock). Each thread
+appends a fixed number of elements, so that the shared vector does not grow without bound.
+*/
+
+#include "vector_variations/concurrent_segmented_vector.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/* A `std::vector` protected by a mutex, with the same appending interface as
+`ConcurrentSegmentedVector` */
+template <typename T>
+struct MutexVector {
+    std::mutex mutex;
+    std::vector<T> elements;
+
+    size_t push_back(const T &value) {
+        std::lock_guard lock(mutex);
+        elements.push_back(value);
+        return elements.size() - 1;
+    }
+
+    size_t grow_by(size_t n, const T &value) {
+        std::lock_guard lock(mutex);
+        elements.insert(elements.end(), n, value);
+        return elements.size() - n;
+    }
+};
+
+/* The vector shared by all threads of a benchmark, created by the first thread before the timed
+loop (which all threads start together) and destroyed by it afterwards */
+template <typename Vector>
+std::unique_ptr<Vector> shared_vector;
+
+constexpr int64_t appends_per_thread = 1 << 16;
+
+/* Each iteration appends one integer */
+template <typename Vector>
+void BM_ConcurrentPushBack(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        shared_vector<Vector> = std::make_unique<Vector>();
+    }
+    uint64_t value = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shared_vector<Vector>->push_back(value));
+    }
+    if (state.thread_index() == 0) {
+        shared_vector<Vector>.reset();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/* Each iteration appends a batch of 16 integers */
+template <typename Vector>
+void BM_ConcurrentGrowBy(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        shared_vector<Vector> = std::make_unique<Vector>();
+    }
+    uint64_t value = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shared_vector<Vector>->grow_by(16, value));
+    }
+    if (state.thread_index() == 0) {
+        shared_vector<Vector>.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+}
+
+using ConcurrentVector = ConcurrentSegmentedVector<uint64_t>;
+using LockedVector = MutexVector<uint64_t>;
+
+}  /* namespace */
+
+BENCHMARK(BM_ConcurrentPushBack<ConcurrentVector>)
+    ->ThreadRange(1, 64)->Iterations(appends_per_thread)->UseRealTime();
+BENCHMARK(BM_ConcurrentPushBack<LockedVector>)
+    ->ThreadRange(1, 64)->Iterations(appends_per_thread)->UseRealTime();
+BENCHMARK(BM_ConcurrentGrowBy<ConcurrentVector>)
+    ->ThreadRange(1, 64)->Iterations(appends_per_thread / 16)->UseRealTime();
+BENCHMARK(BM_ConcurrentGrowBy<LockedVector>)
+    ->ThreadRange(1, 64)->Iterations(appends_per_thread / 16)->UseRealTime();
@@ -0,0 +1,314 @@
+/*
+@file container_comparison_bench.cpp
+@brief Benchmarks the three vector variations (`StackAssistedVector`, `FixedCapacityVector`, and
+`BoundsCheckedVector`) against `std::vector`, and, when they are available, against
+`boost::container::small_vector` and `absl::InlinedVector`.
+
+Every container is measured on the same set of operations (`push_back`, `emplace_back`,
+insertion and erasure at the front, middle, and back, iteration, copy construction, move
+construction, and destruction), for every combination of
+- an element type: trivial elements of 8 and 64 bytes, and a non-trivial element that owns a heap
+  allocation (like `NonDefaultConstructibleClass` in `main.cpp`) of 16 and 64 bytes; and
+- a stack capacity `N` of 8 and 64 (ignored by `std::vector` and `BoundsCheckedVector`).
+Each benchmark runs with `N` elements (which fit in the stack storage) and with `4 * N` elements
+(which do not); `FixedCapacityVector` is given a capacity of `4 * N` so that it can hold both.
+
+Benchmark names have the form `<operation>/<container>/<element>/N=<N>/<element count>`, so for
+instance `--benchmark_filter='^insert_erase_front/[^/]+/Trivial64/N=8/'` compares all containers on
+one operation.
+*/
+
+#include "vector_variations/stack_assisted_vector.h"
+#include "vector_variations/fixed_capacity_vector.h"
+#include "vector_variations/bounds_checked_vector.h"
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(CPP_CONTAINERS_HAVE_BOOST)
+#include <boost/container/small_vector.hpp>
+#endif
+#if defined(CPP_CONTAINERS_HAVE_ABSL)
+#include <absl/container/inlined_vector.h>
+#endif
+
+namespace {
+
+/* `TrivialElement<Bytes>` is a trivially-copyable element of exactly `Bytes` bytes */
+template <size_t Bytes>
+struct TrivialElement {
+    static_assert(Bytes % 8 == 0 && Bytes >= 8);
+    static std::string name() { return "Trivial" + std::to_string(Bytes); }
+
+    std::array<int64_t, Bytes / 8> words;
+
+    TrivialElement(int64_t i) : words{} { words[0] = i; }
+    int64_t value() const { return words[0]; }
+};
+
+/* `NonTrivialElement<Bytes>` is an element of exactly `Bytes` bytes which, like
+`NonDefaultConstructibleClass` in `main.cpp`, is not default-constructible and owns a heap
+allocation; copying it allocates, and destroying it deallocates. */
+template <size_t Bytes>
+struct NonTrivialElement {
+    static_assert(Bytes % 8 == 0 && Bytes >= 8);
+    static std::string name() { return "NonTrivial" + std::to_string(Bytes); }
+
+    int64_t *field;
+    std::array<int64_t, Bytes / 8 - 1> padding;
+
+    NonTrivialElement(int64_t i) : field{new int64_t(i)}, padding{} {}
+    NonTrivialElement(const NonTrivialElement &other)
+    : field{new int64_t(*other.field)}, padding{other.padding} {}
+    NonTrivialElement(NonTrivialElement &&other) noexcept
+    : field{std::exchange(other.field, nullptr)}, padding{other.padding} {}
+    NonTrivialElement& operator= (const NonTrivialElement &other) {
+        *this = NonTrivialElement(other);
+        return *this;
+    }
+    NonTrivialElement& operator= (NonTrivialElement &&other) noexcept {
+        std::swap(field, other.field);
+        padding = other.padding;
+        return *this;
+    }
+    ~NonTrivialElement() { delete field; }
+
+    int64_t value() const { return *field; }
+};
+
+/* Each "container family" maps an element type `T` and a stack capacity `N` to a container type,
+along with a name for the benchmark output. */
+struct StackAssistedVectorFamily {
+    static constexpr auto name = "StackAssistedVector";
+    template <typename T, size_t N> using type = StackAssistedVector<T, N>;
+};
+
+struct FixedCapacityVectorFamily {
+    static constexpr auto name = "FixedCapacityVector";
+    template <typename T, size_t N> using type = FixedCapacityVector<T, 4 * N>;
+};
+
+struct BoundsCheckedVectorFamily {
+    static constexpr auto name = "BoundsCheckedVector";
+    template <typename T, size_t> using type = BoundsCheckedVector<T>;
+};
+
+struct StdVectorFamily {
+    static constexpr auto name = "std::vector";
+    template <typename T, size_t> using type = std::vector<T>;
+};
+
+#if defined(CPP_CONTAINERS_HAVE_BOOST)
+struct BoostSmallVectorFamily {
+    static constexpr auto name = "boost::small_vector";
+    template <typename T, size_t N> using type = boost::container::small_vector<T, N>;
+};
+#endif
+
+#if defined(CPP_CONTAINERS_HAVE_ABSL)
+struct AbslInlinedVectorFamily {
+    static constexpr auto name = "absl::InlinedVector";
+    template <typename T, size_t N> using type = absl::InlinedVector<T, N>;
+};
+#endif
+
+/* Appends the element constructed from `i` to `c` with `emplace_back`. `BoundsCheckedVector`'s
+`emplace_back` cannot deduce its arguments (as they precede the defaulted source location), so it
+falls back to `push_back` of a temporary. */
+template <typename C>
+void emplace_back_into(C &c, int64_t i) {
+    if constexpr (requires { c.emplace_back(i); }) {
+        c.emplace_back(i);
+    } else {
+        c.push_back(typename C::value_type(i));
+    }
+}
+
+/* Returns a container holding the `n` elements constructed from `0, 1, ..., n - 1` */
+template <typename C>
+C make_filled(int64_t n) {
+    C c;
+    for (int64_t i = 0; i < n; ++i) {
+        c.push_back(typename C::value_type(i));
+    }
+    return c;
+}
+
+/* Builds a container by calling `push_back` `state.range(0)` times, then destroys it */
+template <typename C>
+void BM_PushBack(benchmark::State &state) {
+    auto n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (int64_t i = 0; i < n; ++i) {
+            c.push_back(typename C::value_type(i));
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* Builds a container by calling `emplace_back` `state.range(0)` times, then destroys it */
+template <typename C>
+void BM_EmplaceBack(benchmark::State &state) {
+    auto n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (int64_t i = 0; i < n; ++i) {
+            emplace_back_into(c, i);
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+enum class Position { Front, Middle, Back };
+
+/* Repeatedly inserts an element at `Where` in a container of `state.range(0) - 1` elements, then
+erases it again. The container holds exactly `state.range(0)` elements after each insertion, so
+that inserting never outgrows a `FixedCapacityVector`. */
+template <typename C, Position Where>
+void BM_InsertErase(benchmark::State &state) {
+    auto c = make_filled<C>(state.range(0) - 1);
+    auto offset = [&c] {
+        switch (Where) {
+            case Position::Front: return size_t{0};
+            case Position::Middle: return c.size() / 2;
+            default: return c.size();
+        }
+    }();
+
+    for (auto _ : state) {
+        c.insert(c.begin() + offset, typename C::value_type(-1));
+        c.erase(c.begin() + offset);
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+/* Sums the values of the elements of a container of `state.range(0)` elements */
+template <typename C>
+void BM_Iterate(benchmark::State &state) {
+    auto c = make_filled<C>(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto &element : c) {
+            sum += element.value();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Copy-constructs (and then destroys) a container of `state.range(0)` elements */
+template <typename C>
+void BM_CopyConstruct(benchmark::State &state) {
+    auto c = make_filled<C>(state.range(0));
+    for (auto _ : state) {
+        C copy(c);
+        benchmark::DoNotOptimize(copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Move-constructs a container of `state.range(0)` elements back and forth between two objects */
+template <typename C>
+void BM_MoveConstruct(benchmark::State &state) {
+    auto storage = std::allocator<C>().allocate(2);
+    std::construct_at(storage, make_filled<C>(state.range(0)));
+    for (auto _ : state) {
+        std::construct_at(storage + 1, std::move(storage[0]));
+        std::destroy_at(storage);
+        std::construct_at(storage, std::move(storage[1]));
+        std::destroy_at(storage + 1);
+        benchmark::DoNotOptimize(storage[0].data());
+    }
+    std::destroy_at(storage);
+    std::allocator<C>().deallocate(storage, 2);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+/* Destroys containers of `state.range(0)` elements. The containers are built in batches with the
+timer paused, as pausing the timer for every single container would dominate the measurement. */
+template <typename C>
+void BM_Destroy(benchmark::State &state) {
+    constexpr size_t batch_size = 32;
+    auto prototype = make_filled<C>(state.range(0));
+    auto batch = std::allocator<C>().allocate(batch_size);
+    size_t remaining = 0;
+
+    for (auto _ : state) {
+        if (remaining == 0) {
+            state.PauseTiming();
+            for (size_t i = 0; i < batch_size; ++i) {
+                std::construct_at(batch + i, prototype);
+            }
+            remaining = batch_size;
+            state.ResumeTiming();
+        }
+        std::destroy_at(batch + --remaining);
+        benchmark::ClobberMemory();
+    }
+
+    std::destroy(batch, batch + remaining);
+    std::allocator<C>().deallocate(batch, batch_size);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Registers every benchmark for the container `Family::type<T, N>` */
+template <typename Family, typename T, size_t N>
+void register_container_benchmarks() {
+    using C = typename Family::template type<T, N>;
+    auto suffix = std::string("/") + Family::name + "/" + T::name() + "/N=" + std::to_string(N);
+    auto register_one = [&suffix](const std::string &operation, auto function) {
+        benchmark::RegisterBenchmark((operation + suffix).c_str(), function)
+            ->Arg(static_cast<int64_t>(N))
+            ->Arg(static_cast<int64_t>(4 * N));
+    };
+
+    register_one("push_back", BM_PushBack<C>);
+    register_one("emplace_back", BM_EmplaceBack<C>);
+    register_one("insert_erase_front", BM_InsertErase<C, Position::Front>);
+    register_one("insert_erase_middle", BM_InsertErase<C, Position::Middle>);
+    register_one("insert_erase_back", BM_InsertErase<C, Position::Back>);
+    register_one("iterate", BM_Iterate<C>);
+    register_one("copy_construct", BM_CopyConstruct<C>);
+    register_one("move_construct", BM_MoveConstruct<C>);
+    register_one("destroy", BM_Destroy<C>);
+}
+
+/* Registers every benchmark for every container, for the element type `T` and stack capacity `N` */
+template <typename T, size_t N>
+void register_all_containers() {
+    register_container_benchmarks<StackAssistedVectorFamily, T, N>();
+    register_container_benchmarks<FixedCapacityVectorFamily, T, N>();
+    register_container_benchmarks<BoundsCheckedVectorFamily, T, N>();
+    register_container_benchmarks<StdVectorFamily, T, N>();
+#if defined(CPP_CONTAINERS_HAVE_BOOST)
+    register_container_benchmarks<BoostSmallVectorFamily, T, N>();
+#endif
+#if defined(CPP_CONTAINERS_HAVE_ABSL)
+    register_container_benchmarks<AbslInlinedVectorFamily, T, N>();
+#endif
+}
+
+template <size_t N>
+void register_all_elements() {
+    register_all_containers<TrivialElement<8>, N>();
+    register_all_containers<TrivialElement<64>, N>();
+    register_all_containers<NonTrivialElement<16>, N>();
+    register_all_containers<NonTrivialElement<64>, N>();
+}
+
+}  /* namespace */
+
+/* Register everything before `benchmark_main` runs */
+static const bool container_comparison_benchmarks_registered = [] {
+    register_all_elements<8>();
+    register_all_elements<64>();
+    return true;
+}();
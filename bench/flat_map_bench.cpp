@@ -0,0 +1,134 @@
+/*
+@file flat_map_bench.cpp
+@brief Benchmarks `SmallFlatMap<K, V, 16>` against `std::map`, `std::unordered_map`, and (if Boost
+is found) `boost::container::flat_map`, on maps of `state.range(0)` entries:
+- looking up keys which are all present, for integer keys (which `SmallFlatMap` scans with SIMD
+  instructions while it is small) and for string keys;
+- building a map by inserting the entries one by one, in random order;
+- building a map from a range of entries in random order, which `SmallFlatMap` sorts in one go.
+Building includes destroying the map, so it also measures the node allocations of `std::map` and
+`std::unordered_map`.
+*/
+
+#include "maps/small_flat_map.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if defined(CPP_CONTAINERS_HAVE_BOOST)
+#include <boost/container/flat_map.hpp>
+#endif
+
+namespace {
+
+/* Returns `n` distinct keys, in random order */
+template <typename K>
+std::vector<K> make_keys(int64_t n) {
+    std::mt19937 rng(42);
+    std::vector<K> keys;
+    for (int64_t i = 0; i < n; ++i) {
+        /* Spread the keys out, so that they are not simply the first `n` integers */
+        auto key = static_cast<uint32_t>(i * 2654435761u);
+        if constexpr (std::is_same_v<K, std::string>) {
+            keys.push_back("key_" + std::to_string(key));
+        } else {
+            keys.push_back(key);
+        }
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+template <typename K>
+std::vector<std::pair<K, uint32_t>> make_entries(int64_t n) {
+    std::vector<std::pair<K, uint32_t>> entries;
+    for (auto &key : make_keys<K>(n)) {
+        entries.emplace_back(key, static_cast<uint32_t>(entries.size()));
+    }
+    return entries;
+}
+
+/* Each iteration looks up one key; the keys are probed in a different random order than that in
+which they were inserted */
+template <typename Map>
+void BM_Find(benchmark::State &state) {
+    using K = typename Map::key_type;
+    auto entries = make_entries<K>(state.range(0));
+    Map map(entries.begin(), entries.end());
+    auto probes = make_keys<K>(state.range(0));
+    std::reverse(probes.begin(), probes.end());
+    size_t i = 0;
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        sum += map.find(probes[i])->second;
+        i = (i + 1 == probes.size() ? 0 : i + 1);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+/* Each iteration builds a map by inserting `state.range(0)` entries one by one */
+template <typename Map>
+void BM_InsertOneByOne(benchmark::State &state) {
+    auto entries = make_entries<typename Map::key_type>(state.range(0));
+    for (auto _ : state) {
+        Map map;
+        for (const auto &entry : entries) {
+            map.insert(entry);
+        }
+        benchmark::DoNotOptimize(map);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration builds a map from a range of `state.range(0)` entries */
+template <typename Map>
+void BM_ConstructFromRange(benchmark::State &state) {
+    auto entries = make_entries<typename Map::key_type>(state.range(0));
+    for (auto _ : state) {
+        Map map(entries.begin(), entries.end());
+        benchmark::DoNotOptimize(map);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename K>
+using StdMap = std::map<K, uint32_t>;
+template <typename K>
+using StdUnorderedMap = std::unordered_map<K, uint32_t>;
+template <typename K>
+using FlatMap = SmallFlatMap<K, uint32_t, 16>;
+#if defined(CPP_CONTAINERS_HAVE_BOOST)
+template <typename K>
+using BoostFlatMap = boost::container::flat_map<K, uint32_t>;
+#endif
+
+}  /* namespace */
+
+#define FLAT_MAP_BENCHMARK(benchmark_, map) \
+    BENCHMARK(benchmark_<map>)->Arg(1)->Arg(8)->Arg(16)->Arg(64)->Arg(256)->Arg(1000)
+
+FLAT_MAP_BENCHMARK(BM_Find, StdMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_Find, StdUnorderedMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_Find, FlatMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_Find, StdMap<std::string>);
+FLAT_MAP_BENCHMARK(BM_Find, StdUnorderedMap<std::string>);
+FLAT_MAP_BENCHMARK(BM_Find, FlatMap<std::string>);
+FLAT_MAP_BENCHMARK(BM_InsertOneByOne, StdMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_InsertOneByOne, StdUnorderedMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_InsertOneByOne, FlatMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_ConstructFromRange, StdMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_ConstructFromRange, StdUnorderedMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_ConstructFromRange, FlatMap<uint32_t>);
+
+#if defined(CPP_CONTAINERS_HAVE_BOOST)
+FLAT_MAP_BENCHMARK(BM_Find, BoostFlatMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_Find, BoostFlatMap<std::string>);
+FLAT_MAP_BENCHMARK(BM_InsertOneByOne, BoostFlatMap<uint32_t>);
+FLAT_MAP_BENCHMARK(BM_ConstructFromRange, BoostFlatMap<uint32_t>);
+#endif
@@ -0,0 +1,123 @@
+/*
+@file growth_policy_bench.cpp
+@brief Benchmarks the growth policies from `growth_policies.h` when filling a
+`StackAssistedVector` with `push_back`.
+
+For every policy, two benchmarks are run:
+- `BM_PushBack` measures push throughput, and reports the number of reallocations along with the
+  peak number of live heap bytes (including the old buffer that is alive during each reallocation).
+- `BM_PeakRss` fills one vector inside a forked child process and reports that child's peak
+  resident set size, as measured by `wait4`. A fresh process is needed because the peak RSS of
+  the benchmark process itself only ever increases from one benchmark to the next.
+*/
+
+#include "vector_variations/stack_assisted_vector.h"
+#include "vector_variations/growth_policies.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* `PeakTrackingAllocator<T>` is a `std::allocator<T>` that also counts allocations, and tracks the
+current and peak number of bytes allocated through any `PeakTrackingAllocator`. */
+template <typename T>
+struct PeakTrackingAllocator : std::allocator<T> {
+    static inline size_t allocations = 0;
+    static inline size_t live_bytes = 0;
+    static inline size_t peak_live_bytes = 0;
+
+    template <typename U>
+    struct rebind { using other = PeakTrackingAllocator<U>; };
+
+    PeakTrackingAllocator() = default;
+    template <typename U>
+    PeakTrackingAllocator(const PeakTrackingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++allocations;
+        live_bytes += n * sizeof(T);
+        peak_live_bytes = std::max(peak_live_bytes, live_bytes);
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        live_bytes -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+
+    static void reset() {
+        allocations = live_bytes = peak_live_bytes = 0;
+    }
+};
+
+template <typename GrowthPolicy>
+using BenchVector = StackAssistedVector<int64_t, 16, PeakTrackingAllocator<int64_t>, GrowthPolicy>;
+
+/* Repeatedly fills a vector with `state.range(0)` elements using `push_back` */
+template <typename GrowthPolicy>
+void BM_PushBack(benchmark::State &state) {
+    auto n = state.range(0);
+    PeakTrackingAllocator<int64_t>::reset();
+    for (auto _ : state) {
+        BenchVector<GrowthPolicy> sav;
+        for (int64_t i = 0; i < n; ++i) {
+            sav.push_back(i);
+        }
+        benchmark::DoNotOptimize(sav.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["reallocations"] = benchmark::Counter(
+        static_cast<double>(PeakTrackingAllocator<int64_t>::allocations),
+        benchmark::Counter::kAvgIterations
+    );
+    state.counters["peak_heap_bytes"] = static_cast<double>(PeakTrackingAllocator<int64_t>::peak_live_bytes);
+}
+
+/* Returns the peak resident set size (in KiB) of a forked child process that runs `work()` */
+template <typename F>
+long child_peak_rss_kib(F work) {
+    auto pid = fork();
+    if (pid == 0) {
+        work();
+        _exit(0);
+    }
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    return usage.ru_maxrss;
+}
+
+/* Reports the peak RSS of filling one vector with `state.range(0)` elements, minus the peak RSS
+of a child process that does nothing (i.e. the RSS inherited from the benchmark process). */
+template <typename GrowthPolicy>
+void BM_PeakRss(benchmark::State &state) {
+    auto n = state.range(0);
+    long rss_kib = 0, baseline_kib = 0;
+    for (auto _ : state) {
+        baseline_kib = child_peak_rss_kib([] {});
+        rss_kib = child_peak_rss_kib([n] {
+            BenchVector<GrowthPolicy> sav;
+            for (int64_t i = 0; i < n; ++i) {
+                sav.push_back(i);
+            }
+            benchmark::DoNotOptimize(sav.data());
+        });
+    }
+    state.counters["peak_rss_kib"] = static_cast<double>(std::max(0L, rss_kib - baseline_kib));
+}
+
+#define GROWTH_POLICY_BENCHMARKS(...) \
+    BENCHMARK(BM_PushBack<__VA_ARGS__>)->RangeMultiplier(32)->Range(64, 1 << 20); \
+    BENCHMARK(BM_PeakRss<__VA_ARGS__>)->Arg(1 << 22)->Iterations(1)->Unit(benchmark::kMillisecond)
+
+GROWTH_POLICY_BENCHMARKS(OneAndAHalfGrowth);
+GROWTH_POLICY_BENCHMARKS(DoublingGrowth);
+GROWTH_POLICY_BENCHMARKS(GoldenRatioGrowth);
+GROWTH_POLICY_BENCHMARKS(AllocatorBucketGrowth<JemallocSizeClasses>);
+GROWTH_POLICY_BENCHMARKS(AllocatorBucketGrowth<GlibcSizeClasses>);
+GROWTH_POLICY_BENCHMARKS(LinearChunkGrowth<1 << 16>);
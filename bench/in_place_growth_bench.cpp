@@ -0,0 +1,51 @@
+/*
+@file in_place_growth_bench.cpp
+@brief Benchmarks growing a large `StackAssistedVector` of fixed-size records with
+`std::allocator` (where every reallocation moves all elements to a new buffer) against
+`MallocAllocator` (where the buffer is grown in place with `realloc`/`mremap` whenever possible).
+*/
+
+#include "vector_variations/stack_assisted_vector.h"
+#include "allocators/malloc_allocator.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+/* A 32-byte fixed-size record, as produced by an ingest pipeline */
+struct IngestRecord {
+    int64_t key;
+    int64_t timestamp;
+    double value;
+    int64_t flags;
+};
+
+/* Fills a vector with `state.range(0)` records, and also reports the slowest single `push_back`
+(which is always one that triggers a reallocation). */
+template <typename Allocator>
+void BM_GrowLargeVector(benchmark::State &state) {
+    auto n = state.range(0);
+    double slowest_push_us = 0;
+    for (auto _ : state) {
+        StackAssistedVector<IngestRecord, 16, Allocator> sav;
+        for (int64_t i = 0; i < n; ++i) {
+            if (sav.size() == sav.capacity()) {
+                /* Only time the pushes that grow the vector */
+                auto start = std::chrono::steady_clock::now();
+                sav.push_back({i, i, 1.0, 0});
+                std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                slowest_push_us = std::max(slowest_push_us, elapsed.count());
+            } else {
+                sav.push_back({i, i, 1.0, 0});
+            }
+        }
+        benchmark::DoNotOptimize(sav.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["slowest_push_us"] = slowest_push_us;
+}
+
+BENCHMARK(BM_GrowLargeVector<std::allocator<IngestRecord>>)
+    ->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GrowLargeVector<MallocAllocator<IngestRecord>>)
+    ->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->Unit(benchmark::kMillisecond);
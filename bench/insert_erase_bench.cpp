@@ -0,0 +1,118 @@
+/*
+@file insert_erase_bench.cpp
+@brief Benchmarks inserting an element at the front (or in the middle) of a vector holding
+`state.range(0)` elements, and then erasing it again, comparing `std::vector`,
+`StackAssistedVector` and `FixedCapacityVector`. Each iteration shifts the tail right by one and
+then back left by one, so these measure the shifting engine (see `insert_erase.h`): a single
+`std::memmove` each way for trivially relocatable elements such as `int`, and an
+`std::uninitialized_move`/`std::move_backward` pass for elements such as `std::string`.
+
+It also benchmarks inserting an element at the front of a vector whose capacity is exhausted, so
+that the insertion must grow the capacity: `StackAssistedVector` moves every element once, straight
+to its final place in the new buffer.
+*/
+
+#include "vector_variations/fixed_capacity_vector.h"
+#include "vector_variations/stack_assisted_vector.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename T>
+T make_element(int64_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        /* Long enough to not fit in the small string buffer, so that moves are pointer swaps */
+        return std::string(32, static_cast<char>('a' + i % 26));
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+template <typename Vector>
+Vector make_vector(int64_t n) {
+    Vector v;
+    for (int64_t i = 0; i < n; ++i) {
+        v.push_back(make_element<typename Vector::value_type>(i));
+    }
+    return v;
+}
+
+/* Each iteration inserts an element before `begin() + state.range(0) * Numerator / 4`, and then
+erases it */
+template <typename Vector, int64_t Numerator>
+void BM_InsertErase(benchmark::State &state) {
+    using T = typename Vector::value_type;
+    auto v = make_vector<Vector>(state.range(0));
+    auto offset = state.range(0) * Numerator / 4;
+    auto element = make_element<T>(-1);
+    for (auto _ : state) {
+        v.insert(v.begin() + offset, element);
+        v.erase(v.begin() + offset);
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Vector>
+void BM_FrontInsertErase(benchmark::State &state) {
+    BM_InsertErase<Vector, 0>(state);
+}
+
+template <typename Vector>
+void BM_MiddleInsertErase(benchmark::State &state) {
+    BM_InsertErase<Vector, 2>(state);
+}
+
+/* Each iteration fills a vector to its capacity of `state.range(0)` short strings (which, for a
+`StackAssistedVector`, is its stack capacity), and then inserts a string at the front. The strings
+fit in the small string buffer, so that constructing them is cheap, but moving them is not
+`std::memcpy` (`std::string` is not trivially relocatable). */
+template <typename Vector>
+void BM_InsertWhenFull(benchmark::State &state) {
+    for (auto _ : state) {
+        Vector v;
+        if constexpr (requires { v.reserve(size_t{}); }) {
+            v.reserve(state.range(0));
+        }
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            v.emplace_back(size_t{8}, static_cast<char>('a' + i % 26));
+        }
+        v.insert(v.begin(), std::string(8, 'z'));
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using StdIntVector = std::vector<int>;
+using SAVInt = StackAssistedVector<int, 16>;
+using FCVInt = FixedCapacityVector<int, 1024>;
+using StdStringVector = std::vector<std::string>;
+using SAVString = StackAssistedVector<std::string, 16>;
+using FCVString = FixedCapacityVector<std::string, 1024>;
+
+}  /* namespace */
+
+#define INSERT_ERASE_BENCHMARK(benchmark_, vector) \
+    BENCHMARK(benchmark_<vector>)->Arg(16)->Arg(1000)
+
+INSERT_ERASE_BENCHMARK(BM_FrontInsertErase, StdIntVector);
+INSERT_ERASE_BENCHMARK(BM_FrontInsertErase, SAVInt);
+INSERT_ERASE_BENCHMARK(BM_FrontInsertErase, FCVInt);
+INSERT_ERASE_BENCHMARK(BM_MiddleInsertErase, StdIntVector);
+INSERT_ERASE_BENCHMARK(BM_MiddleInsertErase, SAVInt);
+INSERT_ERASE_BENCHMARK(BM_MiddleInsertErase, FCVInt);
+INSERT_ERASE_BENCHMARK(BM_FrontInsertErase, StdStringVector);
+INSERT_ERASE_BENCHMARK(BM_FrontInsertErase, SAVString);
+INSERT_ERASE_BENCHMARK(BM_FrontInsertErase, FCVString);
+INSERT_ERASE_BENCHMARK(BM_MiddleInsertErase, StdStringVector);
+INSERT_ERASE_BENCHMARK(BM_MiddleInsertErase, SAVString);
+INSERT_ERASE_BENCHMARK(BM_MiddleInsertErase, FCVString);
+
+BENCHMARK(BM_InsertWhenFull<std::vector<std::string>>)->Arg(16)->Arg(256);
+BENCHMARK(BM_InsertWhenFull<StackAssistedVector<std::string, 16>>)->Arg(16);
+BENCHMARK(BM_InsertWhenFull<StackAssistedVector<std::string, 256>>)->Arg(256);
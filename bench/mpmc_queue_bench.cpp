@@ -0,0 +1,130 @@
+/*
+@file mpmc_queue_bench.cpp
+@brief Benchmarks how `FixedCapacityMPMCQueue` scales from one thread to one thread per core,
+against a `std::deque` protected by a `std::mutex` (with condition variables to block on), which
+is what a typical thread pool uses as its task queue. Every thread alternately submits work to the
+shared queue and takes work from it, either one element at a time (with the blocking `push` and
+`pop`) or in batches of 16 (with `try_push_n` and `try_pop_n`).
+*/
+
+#include "queues/mpmc_queue.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/* A bounded queue protected by a mutex, with the same interface as `FixedCapacityMPMCQueue` */
+template <typename T, size_t Capacity>
+struct MutexQueue {
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<T> elements;
+
+    void push(const T &element) {
+        {
+            std::unique_lock lock(mutex);
+            not_full.wait(lock, [this] { return elements.size() < Capacity; });
+            elements.push_back(element);
+        }
+        not_empty.notify_one();
+    }
+
+    T pop() {
+        T result;
+        {
+            std::unique_lock lock(mutex);
+            not_empty.wait(lock, [this] { return !elements.empty(); });
+            result = elements.front();
+            elements.pop_front();
+        }
+        not_full.notify_one();
+        return result;
+    }
+
+    size_t try_push_n(const T *source, size_t n) {
+        {
+            std::lock_guard lock(mutex);
+            n = std::min(n, Capacity - elements.size());
+            elements.insert(elements.end(), source, source + n);
+        }
+        not_empty.notify_all();
+        return n;
+    }
+
+    size_t try_pop_n(T *dest, size_t n) {
+        {
+            std::lock_guard lock(mutex);
+            n = std::min(n, elements.size());
+            std::copy_n(elements.begin(), n, dest);
+            elements.erase(elements.begin(), elements.begin() + n);
+        }
+        not_full.notify_all();
+        return n;
+    }
+};
+
+/* The queue shared by all threads of a benchmark. Every thread pops as many elements as it
+pushes, so the queue is empty between benchmarks. */
+template <typename Queue>
+Queue& shared_queue() {
+    static Queue queue;
+    return queue;
+}
+
+/* Each iteration pushes one integer and pops one */
+template <typename Queue>
+void BM_SharedQueue(benchmark::State &state) {
+    auto &queue = shared_queue<Queue>();
+    uint64_t value = state.thread_index();
+    for (auto _ : state) {
+        queue.push(value);
+        value = queue.pop();
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/* Each iteration pushes a batch of 16 integers and pops 16, yielding whenever no progress is
+made (so that oversubscribed threads do not spin against each other) */
+template <typename Queue>
+void BM_SharedQueueBatch(benchmark::State &state) {
+    auto &queue = shared_queue<Queue>();
+    uint64_t batch[16];
+    std::fill_n(batch, 16, state.thread_index());
+    for (auto _ : state) {
+        for (size_t pushed = 0; pushed < 16;) {
+            auto n = queue.try_push_n(batch + pushed, 16 - pushed);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            pushed += n;
+        }
+        for (size_t popped = 0; popped < 16;) {
+            auto n = queue.try_pop_n(batch + popped, 16 - popped);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            popped += n;
+        }
+        benchmark::DoNotOptimize(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+}
+
+const int max_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+using MPMCQueue = FixedCapacityMPMCQueue<uint64_t, 1024>;
+using LockedDeque = MutexQueue<uint64_t, 1024>;
+
+}  /* namespace */
+
+BENCHMARK(BM_SharedQueue<MPMCQueue>)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK(BM_SharedQueue<LockedDeque>)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK(BM_SharedQueueBatch<MPMCQueue>)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK(BM_SharedQueueBatch<LockedDeque>)->ThreadRange(1, max_threads)->UseRealTime();
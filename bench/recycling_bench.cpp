@@ -0,0 +1,128 @@
+/*
+@file recycling_bench.cpp
+@brief Benchmarks loops which reuse vectors across iterations (as a server does across requests),
+comparing `std::vector`, `StackAssistedVector` and `FixedCapacityVector` holding `state.range(0)`
+elements:
+- copying a prototype into a fresh vector every iteration, versus copy-assigning it into a
+  long-lived scratch vector, which reuses the scratch vector's capacity;
+- double buffering, where each iteration fills the back buffer and then swaps it with the front
+  buffer (which, for vectors on the heap, exchanges the buffers in O(1)); and
+- sorting a batch of vectors by their first element, which moves and swaps whole vectors.
+*/
+
+#include "vector_variations/fixed_capacity_vector.h"
+#include "vector_variations/stack_assisted_vector.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Vector>
+Vector make_vector(int64_t n, int64_t seed = 0) {
+    using T = typename Vector::value_type;
+    Vector v;
+    for (int64_t i = 0; i < n; ++i) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            v.push_back(std::string(24, static_cast<char>('a' + (seed + i) % 26)));
+        } else {
+            v.push_back(static_cast<T>(seed + i));
+        }
+    }
+    return v;
+}
+
+/* Each iteration copies the prototype into a new vector */
+template <typename Vector>
+void BM_CopyIntoFresh(benchmark::State &state) {
+    auto prototype = make_vector<Vector>(state.range(0));
+    for (auto _ : state) {
+        Vector copy(prototype);
+        benchmark::DoNotOptimize(copy.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration copy-assigns the prototype into the same scratch vector */
+template <typename Vector>
+void BM_CopyAssignRecycled(benchmark::State &state) {
+    auto prototype = make_vector<Vector>(state.range(0));
+    Vector scratch;
+    for (auto _ : state) {
+        scratch = prototype;
+        benchmark::DoNotOptimize(scratch.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration fills the back buffer (after clearing it, which keeps its capacity), and then
+swaps it with the front buffer */
+template <typename Vector>
+void BM_DoubleBufferSwap(benchmark::State &state) {
+    using T = typename Vector::value_type;
+    Vector front = make_vector<Vector>(state.range(0));
+    Vector back = make_vector<Vector>(state.range(0));
+    for (auto _ : state) {
+        back.clear();
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            back.push_back(static_cast<T>(i));
+        }
+        front.swap(back);
+        benchmark::DoNotOptimize(front.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration sorts a batch of 256 vectors (each holding `state.range(0)` elements) by their
+first element */
+template <typename Vector>
+void BM_SortVectors(benchmark::State &state) {
+    std::vector<Vector> prototype;
+    std::mt19937 rng(42);
+    for (int i = 0; i < 256; ++i) {
+        prototype.push_back(make_vector<Vector>(state.range(0), rng() % 1000));
+    }
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto batch = prototype;
+        state.ResumeTiming();
+        std::ranges::sort(batch, {}, [](const Vector &v) { return v.front(); });
+        benchmark::DoNotOptimize(batch.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+using StdVector = std::vector<int>;
+using SAV = StackAssistedVector<int, 16>;
+using FCV = FixedCapacityVector<int, 256>;
+using StdStringVector = std::vector<std::string>;
+using SAVString = StackAssistedVector<std::string, 16>;
+
+}  /* namespace */
+
+#define RECYCLING_BENCHMARK(benchmark_, vector) \
+    BENCHMARK(benchmark_<vector>)->Arg(8)->Arg(256)
+
+RECYCLING_BENCHMARK(BM_CopyIntoFresh, StdVector);
+RECYCLING_BENCHMARK(BM_CopyIntoFresh, SAV);
+RECYCLING_BENCHMARK(BM_CopyIntoFresh, FCV);
+RECYCLING_BENCHMARK(BM_CopyAssignRecycled, StdVector);
+RECYCLING_BENCHMARK(BM_CopyAssignRecycled, SAV);
+RECYCLING_BENCHMARK(BM_CopyAssignRecycled, FCV);
+RECYCLING_BENCHMARK(BM_CopyIntoFresh, StdStringVector);
+RECYCLING_BENCHMARK(BM_CopyIntoFresh, SAVString);
+RECYCLING_BENCHMARK(BM_CopyAssignRecycled, StdStringVector);
+RECYCLING_BENCHMARK(BM_CopyAssignRecycled, SAVString);
+RECYCLING_BENCHMARK(BM_DoubleBufferSwap, StdVector);
+RECYCLING_BENCHMARK(BM_DoubleBufferSwap, SAV);
+RECYCLING_BENCHMARK(BM_DoubleBufferSwap, FCV);
+RECYCLING_BENCHMARK(BM_SortVectors, StdVector);
+RECYCLING_BENCHMARK(BM_SortVectors, SAV);
+RECYCLING_BENCHMARK(BM_SortVectors, FCV);
@@ -0,0 +1,97 @@
+/*
+@file relocation_bench.cpp
+@brief Benchmarks the trivial relocation fast paths of `StackAssistedVector` (spilling from the
+stack to the heap, reallocation, insertion, and erasure) against the per-element loops they
+replace.
+
+Every benchmark is run twice: once with an element type that is trivially relocatable, and once
+with an otherwise-identical element type that opts out via `is_trivially_relocatable`.
+*/
+
+#include "vector_variations/stack_assisted_vector.h"
+#include "vector_variations/relocation.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+
+/* `PodRecord` is a small trivially-copyable record, and hence trivially relocatable by default */
+struct PodRecord {
+    int64_t id;
+    int64_t timestamp;
+    double value;
+    int32_t flags;
+
+    PodRecord(int64_t i) : id{i}, timestamp{i}, value{0.5 * i}, flags{0} {}
+};
+
+/* `PodRecordNoRelocation` is identical to `PodRecord`, except that it opts out of
+`is_trivially_relocatable`, forcing the per-element move-and-destroy loops. */
+struct PodRecordNoRelocation : PodRecord {
+    using PodRecord::PodRecord;
+};
+
+template <>
+struct is_trivially_relocatable<PodRecordNoRelocation> : std::false_type {};
+
+/* `OwningRecord` holds a `std::unique_ptr`, so it is not trivially copyable; however, it is
+trivially relocatable, and so it opts in to `is_trivially_relocatable`. */
+struct OwningRecord {
+    std::unique_ptr<int64_t> payload;
+    int64_t id;
+
+    OwningRecord(int64_t i) : payload{std::make_unique<int64_t>(i)}, id{i} {}
+};
+
+template <>
+struct is_trivially_relocatable<OwningRecord> : std::true_type {};
+
+/* `OwningRecordNoRelocation` is identical to `OwningRecord`, but without the opt-in. */
+struct OwningRecordNoRelocation : OwningRecord {
+    using OwningRecord::OwningRecord;
+};
+
+template <>
+struct is_trivially_relocatable<OwningRecordNoRelocation> : std::false_type {};
+
+/* Repeatedly builds a `StackAssistedVector<T, 8>` of `state.range(0)` elements from scratch,
+which spills from the stack to the heap and then reallocates several more times. */
+template <typename T>
+void BM_SpillAndGrow(benchmark::State &state) {
+    auto n = state.range(0);
+    for (auto _ : state) {
+        StackAssistedVector<T, 8> sav;
+        for (int64_t i = 0; i < n; ++i) {
+            sav.emplace_back(i);
+        }
+        benchmark::DoNotOptimize(sav.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+/* Repeatedly inserts an element at the front of a `StackAssistedVector` of `state.range(0)`
+elements, then erases it again; each operation shifts the whole vector by one position. */
+template <typename T>
+void BM_InsertEraseFront(benchmark::State &state) {
+    auto n = state.range(0);
+    StackAssistedVector<T, 8> sav;
+    for (int64_t i = 0; i < n; ++i) {
+        sav.emplace_back(i);
+    }
+
+    for (auto _ : state) {
+        sav.insert(sav.begin(), T(-1));
+        sav.erase(sav.begin());
+        benchmark::DoNotOptimize(sav.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK(BM_SpillAndGrow<PodRecord>)->RangeMultiplier(8)->Range(16, 1 << 15);
+BENCHMARK(BM_SpillAndGrow<PodRecordNoRelocation>)->RangeMultiplier(8)->Range(16, 1 << 15);
+BENCHMARK(BM_SpillAndGrow<OwningRecord>)->RangeMultiplier(8)->Range(16, 1 << 15);
+BENCHMARK(BM_SpillAndGrow<OwningRecordNoRelocation>)->RangeMultiplier(8)->Range(16, 1 << 15);
+
+BENCHMARK(BM_InsertEraseFront<PodRecord>)->RangeMultiplier(8)->Range(16, 1 << 12);
+BENCHMARK(BM_InsertEraseFront<PodRecordNoRelocation>)->RangeMultiplier(8)->Range(16, 1 << 12);
+BENCHMARK(BM_InsertEraseFront<OwningRecord>)->RangeMultiplier(8)->Range(16, 1 << 12);
+BENCHMARK(BM_InsertEraseFront<OwningRecordNoRelocation>)->RangeMultiplier(8)->Range(16, 1 << 12);
@@ -0,0 +1,78 @@
+/*
+@file ring_buffer_bench.cpp
+@brief Benchmarks `FixedCapacityRingBuffer` as a bounded FIFO queue and as a sliding window,
+against `std::deque` and against `FixedCapacityVector` (which has to shift every element to pop
+from the front). The power-of-two capacity (64) wraps indices with a mask, and the other (63)
+with a comparison.
+*/
+
+#include "vector_variations/fixed_capacity_vector.h"
+#include "queues/fixed_capacity_ring_buffer.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <deque>
+
+namespace {
+
+/* Every iteration pushes one element at the back and, once the queue holds `Window` elements,
+pops one from the front */
+template <typename Queue, size_t Window>
+void BM_SlidingWindow(benchmark::State &state) {
+    Queue queue;
+    int64_t sum = 0;
+    int64_t next = 0;
+    for (auto _ : state) {
+        if (queue.size() == Window) {
+            sum -= queue.front();
+            if constexpr (requires { queue.pop_front(); }) {
+                queue.pop_front();
+            } else {
+                queue.erase(queue.begin());
+            }
+        }
+        queue.push_back(next);
+        sum += next++;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/* Every iteration pushes a batch of 48 samples and pops them again, either one at a time or with
+`push_n`/`pop_n` */
+template <size_t Capacity, bool Bulk>
+void BM_Batches(benchmark::State &state) {
+    FixedCapacityRingBuffer<int32_t, Capacity> queue;
+    int32_t input[48];
+    int32_t output[48];
+    for (int32_t i = 0; i < 48; ++i) {
+        input[i] = i;
+    }
+    for (auto _ : state) {
+        if constexpr (Bulk) {
+            queue.push_n(input, 48);
+            queue.pop_n(output, 48);
+        } else {
+            for (auto sample : input) {
+                queue.push_back(sample);
+            }
+            for (auto &sample : output) {
+                sample = queue.front();
+                queue.pop_front();
+            }
+        }
+        benchmark::DoNotOptimize(output);
+    }
+    state.SetItemsProcessed(state.iterations() * 48);
+}
+
+}  /* namespace */
+
+BENCHMARK(BM_SlidingWindow<std::deque<int64_t>, 63>);
+BENCHMARK(BM_SlidingWindow<FixedCapacityVector<int64_t, 64>, 63>);
+BENCHMARK(BM_SlidingWindow<FixedCapacityRingBuffer<int64_t, 63>, 63>);
+BENCHMARK(BM_SlidingWindow<FixedCapacityRingBuffer<int64_t, 64>, 63>);
+
+BENCHMARK(BM_Batches<63, false>);
+BENCHMARK(BM_Batches<63, true>);
+BENCHMARK(BM_Batches<64, false>);
+BENCHMARK(BM_Batches<64, true>);
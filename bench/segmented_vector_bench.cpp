@@ -0,0 +1,142 @@
+/*
+@file segmented_vector_bench.cpp
+@brief Benchmarks `SegmentedVector<int, 16>` (with geometric and with fixed-size segments) against
+`std::vector` and `StackAssistedVector<int, 16>`:
+- pushing `state.range(0)` elements one by one, both for throughput and for the latency of the
+  slowest single `push_back` (reported as the `max_push_ns` counter), which is where reallocating
+  vectors spike, as they move every element;
+- summing the elements by random indexing, by iterators, and segment by segment.
+*/
+
+#include "vector_variations/segmented_vector.h"
+#include "vector_variations/stack_assisted_vector.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+/* Each iteration pushes `state.range(0)` elements into an empty vector */
+template <typename Vector>
+void BM_PushBack(benchmark::State &state) {
+    for (auto _ : state) {
+        Vector v;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Like `BM_PushBack`, but times every `push_back`, and reports the slowest one. The median of
+the slowest pushes of all iterations is reported, so that a single preemption does not dominate. */
+template <typename Vector>
+void BM_PushBackMaxLatency(benchmark::State &state) {
+    using clock = std::chrono::steady_clock;
+    std::vector<clock::duration> slowest_per_iteration;
+    for (auto _ : state) {
+        Vector v;
+        clock::duration slowest{};
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            auto start = clock::now();
+            v.push_back(static_cast<int>(i));
+            slowest = std::max(slowest, clock::now() - start);
+        }
+        slowest_per_iteration.push_back(slowest);
+        benchmark::DoNotOptimize(v);
+    }
+    auto median = slowest_per_iteration.begin() + slowest_per_iteration.size() / 2;
+    std::nth_element(slowest_per_iteration.begin(), median, slowest_per_iteration.end());
+    state.counters["max_push_ns"] = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(*median).count()
+    );
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Vector>
+Vector make_vector(int64_t n) {
+    Vector v;
+    for (int64_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<int>(i));
+    }
+    return v;
+}
+
+/* Each iteration sums `state.range(0)` elements at random indices */
+template <typename Vector>
+void BM_RandomIndex(benchmark::State &state) {
+    auto v = make_vector<Vector>(state.range(0));
+    std::vector<uint32_t> indices(state.range(0));
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::shuffle(indices.begin(), indices.end(), std::mt19937(42));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto i : indices) {
+            sum += v[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration sums all elements with a range-based for loop */
+template <typename Vector>
+void BM_Iterate(benchmark::State &state) {
+    auto v = make_vector<Vector>(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto element : v) {
+            sum += element;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* Each iteration sums all elements segment by segment, which the compiler can vectorize */
+template <typename Vector>
+void BM_IterateSegments(benchmark::State &state) {
+    auto v = make_vector<Vector>(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        v.for_each_segment([&](std::span<const int> segment) {
+            for (auto element : segment) {
+                sum += element;
+            }
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using StdVector = std::vector<int>;
+using SAV = StackAssistedVector<int, 16>;
+using GeometricSV = SegmentedVector<int, 16>;
+using FixedSV = SegmentedVector<int, 1024, FixedSegments>;
+
+}  /* namespace */
+
+#define SEGMENTED_BENCHMARK(benchmark_, vector) \
+    BENCHMARK(benchmark_<vector>)->Arg(1000)->Arg(100000)->Arg(1000000)
+
+SEGMENTED_BENCHMARK(BM_PushBack, StdVector);
+SEGMENTED_BENCHMARK(BM_PushBack, SAV);
+SEGMENTED_BENCHMARK(BM_PushBack, GeometricSV);
+SEGMENTED_BENCHMARK(BM_PushBack, FixedSV);
+SEGMENTED_BENCHMARK(BM_PushBackMaxLatency, StdVector);
+SEGMENTED_BENCHMARK(BM_PushBackMaxLatency, SAV);
+SEGMENTED_BENCHMARK(BM_PushBackMaxLatency, GeometricSV);
+SEGMENTED_BENCHMARK(BM_PushBackMaxLatency, FixedSV);
+SEGMENTED_BENCHMARK(BM_RandomIndex, StdVector);
+SEGMENTED_BENCHMARK(BM_RandomIndex, GeometricSV);
+SEGMENTED_BENCHMARK(BM_RandomIndex, FixedSV);
+SEGMENTED_BENCHMARK(BM_Iterate, StdVector);
+SEGMENTED_BENCHMARK(BM_Iterate, GeometricSV);
+SEGMENTED_BENCHMARK(BM_Iterate, FixedSV);
+SEGMENTED_BENCHMARK(BM_IterateSegments, GeometricSV);
+SEGMENTED_BENCHMARK(BM_IterateSegments, FixedSV);
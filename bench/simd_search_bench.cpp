@@ -0,0 +1,112 @@
+/*
+@file simd_search_bench.cpp
+@brief Benchmarks the search functions of `FixedCapacityVector` (`find`, `count`, and
+`min_element`), which use the SIMD kernels from `simd_search.h`, against the equivalent standard
+algorithms on the same elements.
+
+Every benchmark fills a `FixedCapacityVector<T, 256>` with `state.range(0)` elements and searches
+for a value that is not present (so `find` scans every element), for 1-, 4-, and 8-byte integer
+elements and for `float`. Sizes that are not a multiple of the vector width exercise the tail
+handling.
+*/
+
+#include "vector_variations/fixed_capacity_vector.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+constexpr size_t capacity = 256;
+
+/* Returns a `FixedCapacityVector` of `n` elements in `[1, 100]`, none of which equal
+`absent_value<T>` */
+template <typename T>
+FixedCapacityVector<T, capacity> make_haystack(int64_t n) {
+    FixedCapacityVector<T, capacity> v;
+    for (int64_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<T>(i % 100 + 1));
+    }
+    return v;
+}
+
+template <typename T>
+constexpr T absent_value = static_cast<T>(0);
+
+template <typename T>
+void BM_FindStd(benchmark::State &state) {
+    auto v = make_haystack<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(std::find(v.begin(), v.end(), absent_value<T>));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+void BM_FindMember(benchmark::State &state) {
+    auto v = make_haystack<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.find(absent_value<T>));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+void BM_CountStd(benchmark::State &state) {
+    auto v = make_haystack<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(std::count(v.begin(), v.end(), static_cast<T>(1)));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+void BM_CountMember(benchmark::State &state) {
+    auto v = make_haystack<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.count(static_cast<T>(1)));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+void BM_MinElementStd(benchmark::State &state) {
+    auto v = make_haystack<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(std::min_element(v.begin(), v.end()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+void BM_MinElementMember(benchmark::State &state) {
+    auto v = make_haystack<T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.min_element());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  /* namespace */
+
+#define SIMD_SEARCH_BENCHMARKS(benchmark_name, T) \
+    BENCHMARK(benchmark_name<T>)->Arg(8)->Arg(31)->Arg(64)->Arg(250)
+
+#define SIMD_SEARCH_BENCHMARKS_FOR_TYPE(T) \
+    SIMD_SEARCH_BENCHMARKS(BM_FindStd, T); \
+    SIMD_SEARCH_BENCHMARKS(BM_FindMember, T); \
+    SIMD_SEARCH_BENCHMARKS(BM_CountStd, T); \
+    SIMD_SEARCH_BENCHMARKS(BM_CountMember, T); \
+    SIMD_SEARCH_BENCHMARKS(BM_MinElementStd, T); \
+    SIMD_SEARCH_BENCHMARKS(BM_MinElementMember, T)
+
+SIMD_SEARCH_BENCHMARKS_FOR_TYPE(int8_t);
+SIMD_SEARCH_BENCHMARKS_FOR_TYPE(int32_t);
+SIMD_SEARCH_BENCHMARKS_FOR_TYPE(int64_t);
+SIMD_SEARCH_BENCHMARKS_FOR_TYPE(float);
@@ -0,0 +1,155 @@
+/*
+@file small_string_bench.cpp
+@brief Benchmarks `SmallString<23>` (which is as large as `std::string`) against `std::string`, for
+keys of 8 to 40 characters, which straddle both the 15 characters `std::string` stores inline and
+the 23 `SmallString<23>` does:
+- constructing keys and building them up by appending pieces;
+- finding a character and a substring, and comparing keys which differ only near their end;
+- hashing keys, including with a cached hash (hashing the same keys repeatedly, as lookups do).
+*/
+
+#include "strings/small_string.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr size_t key_count = 1024;
+
+/* Returns `key_count` random keys of `length` lowercase letters, each ending with 'Z' */
+std::vector<std::string> make_keys(size_t length) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> keys(key_count);
+    for (auto &key : keys) {
+        for (size_t i = 0; i + 1 < length; ++i) {
+            key.push_back(static_cast<char>(letter(random)));
+        }
+        key.push_back('Z');
+    }
+    return keys;
+}
+
+template <typename String>
+std::vector<String> convert_keys(const std::vector<std::string> &keys) {
+    std::vector<String> result;
+    for (const auto &key : keys) {
+        result.emplace_back(std::string_view(key));
+    }
+    return result;
+}
+
+/* Each iteration constructs every key */
+template <typename String>
+void BM_Construct(benchmark::State &state) {
+    auto keys = make_keys(state.range(0));
+    for (auto _ : state) {
+        for (const auto &key : keys) {
+            String s(std::string_view{key});
+            benchmark::DoNotOptimize(s);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+}
+
+/* Each iteration builds every key by appending it in pieces of 4 characters */
+template <typename String>
+void BM_AppendPieces(benchmark::State &state) {
+    auto keys = make_keys(state.range(0));
+    for (auto _ : state) {
+        for (std::string_view key : keys) {
+            String s;
+            for (size_t i = 0; i < key.size(); i += 4) {
+                s += key.substr(i, 4);
+            }
+            benchmark::DoNotOptimize(s);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+}
+
+/* Each iteration finds the last character ('Z') of every key */
+template <typename String>
+void BM_FindChar(benchmark::State &state) {
+    auto keys = convert_keys<String>(make_keys(state.range(0)));
+    for (auto _ : state) {
+        for (const auto &key : keys) {
+            benchmark::DoNotOptimize(key.find('Z'));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+}
+
+/* Each iteration finds the last 3 characters of every key */
+template <typename String>
+void BM_FindSubstring(benchmark::State &state) {
+    auto keys = convert_keys<String>(make_keys(state.range(0)));
+    std::vector<std::string> needles;
+    for (const auto &key : keys) {
+        needles.emplace_back(std::string_view(key).substr(key.size() - 3));
+    }
+    for (auto _ : state) {
+        for (size_t i = 0; i < key_count; ++i) {
+            benchmark::DoNotOptimize(keys[i].find(std::string_view(needles[i])));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+}
+
+/* Each iteration compares every key with a copy whose last character differs */
+template <typename String>
+void BM_Compare(benchmark::State &state) {
+    auto keys = convert_keys<String>(make_keys(state.range(0)));
+    std::vector<std::string> others;
+    for (const auto &key : keys) {
+        others.emplace_back(std::string_view(key));
+        others.back().back() = 'Y';
+    }
+    for (auto _ : state) {
+        for (size_t i = 0; i < key_count; ++i) {
+            benchmark::DoNotOptimize(keys[i].compare(std::string_view(others[i])));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+}
+
+/* Each iteration hashes every key */
+template <typename String>
+void BM_Hash(benchmark::State &state) {
+    auto keys = convert_keys<String>(make_keys(state.range(0)));
+    std::hash<String> hash;
+    for (auto _ : state) {
+        for (const auto &key : keys) {
+            benchmark::DoNotOptimize(hash(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+}
+
+using StdString = std::string;
+using SmallString23 = SmallString<23>;
+using CachedSmallString23 = SmallString<23, true>;
+
+}  /* namespace */
+
+#define SMALL_STRING_BENCHMARK(benchmark_, string) \
+    BENCHMARK(benchmark_<string>)->Arg(8)->Arg(20)->Arg(40)
+
+SMALL_STRING_BENCHMARK(BM_Construct, StdString);
+SMALL_STRING_BENCHMARK(BM_Construct, SmallString23);
+SMALL_STRING_BENCHMARK(BM_AppendPieces, StdString);
+SMALL_STRING_BENCHMARK(BM_AppendPieces, SmallString23);
+SMALL_STRING_BENCHMARK(BM_FindChar, StdString);
+SMALL_STRING_BENCHMARK(BM_FindChar, SmallString23);
+SMALL_STRING_BENCHMARK(BM_FindSubstring, StdString);
+SMALL_STRING_BENCHMARK(BM_FindSubstring, SmallString23);
+SMALL_STRING_BENCHMARK(BM_Compare, StdString);
+SMALL_STRING_BENCHMARK(BM_Compare, SmallString23);
+SMALL_STRING_BENCHMARK(BM_Hash, StdString);
+SMALL_STRING_BENCHMARK(BM_Hash, SmallString23);
+SMALL_STRING_BENCHMARK(BM_Hash, CachedSmallString23);
@@ -0,0 +1,110 @@
+/*
+@file soa_bench.cpp
+@brief Benchmarks column scans over `state.range(0)` records of 64 bytes: summing one field of
+every record, and updating one field from another. The records are stored either as structs (in a
+`std::vector` and in a `StackAssistedVector`), or as columns (in a `SoAVector` and in a
+`StackAssistedSoAVector`).
+*/
+
+#include "vector_variations/stack_assisted_vector.h"
+#include "vector_variations/soa_vector.h"
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+/* A record with two hot fields (`position` and `velocity`) among cold ones */
+struct Record {
+    float position;
+    float velocity;
+    int64_t id;
+    double cold[6];
+};
+static_assert(sizeof(Record) == 64);
+
+using RecordSoA = SoAVector<float, float, int64_t, std::array<double, 6>>;
+using RecordInlineSoA = StackAssistedSoAVector<64, float, float, int64_t, std::array<double, 6>>;
+
+template <typename Container>
+Container make_structs(int64_t n) {
+    Container records;
+    for (int64_t i = 0; i < n; ++i) {
+        records.push_back(Record{static_cast<float>(i), 1.0f, i, {}});
+    }
+    return records;
+}
+
+template <typename Container>
+Container make_columns(int64_t n) {
+    Container records;
+    for (int64_t i = 0; i < n; ++i) {
+        records.emplace_back(static_cast<float>(i), 1.0f, i, std::array<double, 6>{});
+    }
+    return records;
+}
+
+template <typename Container>
+void BM_SumField_Structs(benchmark::State &state) {
+    auto records = make_structs<Container>(state.range(0));
+    for (auto _ : state) {
+        float sum = 0;
+        for (const auto &record : records) {
+            sum += record.position;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_SumField_Columns(benchmark::State &state) {
+    auto records = make_columns<Container>(state.range(0));
+    for (auto _ : state) {
+        float sum = 0;
+        for (float position : records.template column<0>()) {
+            sum += position;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_Integrate_Structs(benchmark::State &state) {
+    auto records = make_structs<Container>(state.range(0));
+    for (auto _ : state) {
+        for (auto &record : records) {
+            record.position += record.velocity * 0.5f;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_Integrate_Columns(benchmark::State &state) {
+    auto records = make_columns<Container>(state.range(0));
+    for (auto _ : state) {
+        auto positions = records.template column<0>();
+        auto velocities = records.template column<1>();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            positions[i] += velocities[i] * 0.5f;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  /* namespace */
+
+BENCHMARK(BM_SumField_Structs<std::vector<Record>>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_SumField_Structs<StackAssistedVector<Record, 64>>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_SumField_Columns<RecordSoA>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_SumField_Columns<RecordInlineSoA>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+BENCHMARK(BM_Integrate_Structs<std::vector<Record>>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_Integrate_Structs<StackAssistedVector<Record, 64>>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_Integrate_Columns<RecordSoA>)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_Integrate_Columns<RecordInlineSoA>)->Arg(64)->Arg(4096)->Arg(1 << 20);
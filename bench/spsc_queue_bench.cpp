@@ -0,0 +1,180 @@
+/*
+@file spsc_queue_bench.cpp
+@brief Benchmarks `FixedCapacitySPSCQueue` between two threads pinned to different cores (on
+Linux), against a `std::deque` protected by a `std::mutex`:
+- throughput, where a producer thread streams integers to the benchmark thread, one at a time or in
+  batches of `state.range(0)`;
+- latency, where the benchmark thread sends an integer to an echo thread and waits for it to come
+  back over a second queue (so each iteration is one round trip).
+The cores are given by the environment variables `CPP_CONTAINERS_BENCH_CORE_A` and
+`CPP_CONTAINERS_BENCH_CORE_B` (0 and 1 by default). Both threads spin rather than block, so the
+benchmarks are skipped on machines with a single core.
+*/
+
+#include "queues/spsc_queue.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+/* Pins the calling thread to the core given by the environment variable `variable` (or to
+`default_core`), if possible */
+void pin_to_core(const char *variable, int default_core) {
+#if defined(__linux__)
+    auto value = std::getenv(variable);
+    int core = (value ? std::atoi(value) : default_core);
+    if (core < 0 || core >= static_cast<int>(std::thread::hardware_concurrency())) {
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+    (void)variable;
+    (void)default_core;
+#endif
+}
+
+/* Returns true (after marking `state` as skipped) if there are not enough cores to run two
+spinning threads */
+bool skip_without_two_cores(benchmark::State &state) {
+    if (std::thread::hardware_concurrency() < 2) {
+        state.SkipWithError("needs at least two cores");
+        return true;
+    }
+    return false;
+}
+
+/* A bounded queue protected by a mutex, with the same interface as `FixedCapacitySPSCQueue` */
+template <typename T, size_t Capacity>
+struct MutexQueue {
+    std::mutex mutex;
+    std::deque<T> elements;
+
+    bool try_push(const T &element) {
+        std::lock_guard lock(mutex);
+        if (elements.size() == Capacity) {
+            return false;
+        }
+        elements.push_back(element);
+        return true;
+    }
+
+    bool try_pop(T &out) {
+        std::lock_guard lock(mutex);
+        if (elements.empty()) {
+            return false;
+        }
+        out = elements.front();
+        elements.pop_front();
+        return true;
+    }
+
+    size_t try_push_n(const T *source, size_t n) {
+        std::lock_guard lock(mutex);
+        n = std::min(n, Capacity - elements.size());
+        elements.insert(elements.end(), source, source + n);
+        return n;
+    }
+
+    size_t try_pop_n(T *dest, size_t n) {
+        std::lock_guard lock(mutex);
+        n = std::min(n, elements.size());
+        std::copy_n(elements.begin(), n, dest);
+        elements.erase(elements.begin(), elements.begin() + n);
+        return n;
+    }
+};
+
+/* The producer pushes batches of `state.range(0)` integers (one at a time if it is 1) until it
+is told to stop; each benchmark iteration pops one batch */
+template <typename Queue>
+void BM_Throughput(benchmark::State &state) {
+    if (skip_without_two_cores(state)) {
+        return;
+    }
+    auto batch_size = static_cast<size_t>(state.range(0));
+    Queue queue;
+    std::atomic<bool> running{true};
+
+    pin_to_core("CPP_CONTAINERS_BENCH_CORE_A", 0);
+    std::thread producer([&] {
+        pin_to_core("CPP_CONTAINERS_BENCH_CORE_B", 1);
+        uint64_t batch[64];
+        for (uint64_t next = 0; running.load(std::memory_order_relaxed);) {
+            if (batch_size == 1) {
+                next += queue.try_push(next);
+            } else {
+                std::fill_n(batch, batch_size, next);
+                next += queue.try_push_n(batch, batch_size);
+            }
+        }
+    });
+
+    uint64_t batch[64];
+    for (auto _ : state) {
+        for (size_t popped = 0; popped < batch_size;) {
+            if (batch_size == 1) {
+                popped += queue.try_pop(batch[0]);
+            } else {
+                popped += queue.try_pop_n(batch + popped, batch_size - popped);
+            }
+        }
+        benchmark::DoNotOptimize(batch);
+    }
+
+    running = false;
+    producer.join();
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+/* Each iteration sends one integer to the echo thread and waits for it to return */
+template <typename Queue>
+void BM_RoundTrip(benchmark::State &state) {
+    if (skip_without_two_cores(state)) {
+        return;
+    }
+    Queue requests;
+    Queue responses;
+    std::atomic<bool> running{true};
+
+    pin_to_core("CPP_CONTAINERS_BENCH_CORE_A", 0);
+    std::thread echo([&] {
+        pin_to_core("CPP_CONTAINERS_BENCH_CORE_B", 1);
+        uint64_t value;
+        while (running.load(std::memory_order_relaxed)) {
+            if (requests.try_pop(value)) {
+                while (!responses.try_push(value)) {}
+            }
+        }
+    });
+
+    uint64_t value = 0;
+    for (auto _ : state) {
+        while (!requests.try_push(value)) {}
+        while (!responses.try_pop(value)) {}
+        ++value;
+    }
+
+    running = false;
+    echo.join();
+}
+
+}  /* namespace */
+
+using SPSCQueue = FixedCapacitySPSCQueue<uint64_t, 1024>;
+BENCHMARK(BM_Throughput<SPSCQueue>)->Arg(1)->Arg(32)->UseRealTime();
+BENCHMARK(BM_Throughput<MutexQueue<uint64_t, 1024>>)->Arg(1)->Arg(32)->UseRealTime();
+BENCHMARK(BM_RoundTrip<SPSCQueue>)->UseRealTime();
+BENCHMARK(BM_RoundTrip<MutexQueue<uint64_t, 1024>>)->UseRealTime();
@@ -0,0 +1,109 @@
+/*
+@file swiss_map_bench.cpp
+@brief Benchmarks `SmallSwissMap<K, uint32_t, 16>` against `std::unordered_map`, on maps of
+`state.range(0)` entries, under two mixes of operations:
+- lookup-heavy: every iteration looks up 8 keys (half of which are present) and then erases one
+  entry and inserts another, for integer and string keys;
+- insert-heavy: every iteration builds a map by inserting the entries one by one (without
+  reserving), then looks each of them up once, and destroys the map.
+*/
+
+#include "maps/small_swiss_map.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/* Returns `n` distinct keys, in random order */
+template <typename K>
+std::vector<K> make_keys(int64_t n, uint32_t seed = 42) {
+    std::mt19937 rng(seed);
+    std::vector<K> keys;
+    for (int64_t i = 0; i < n; ++i) {
+        /* Spread the keys out, so that they are not simply consecutive integers */
+        auto key = static_cast<uint32_t>((i + seed * n) * 2654435761u);
+        if constexpr (std::is_same_v<K, std::string>) {
+            keys.push_back("key_" + std::to_string(key));
+        } else {
+            keys.push_back(key);
+        }
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+/* Each iteration looks up 8 keys, alternating between present and absent ones, then erases the
+oldest entry and inserts a new one (so the map keeps `state.range(0)` entries, and the Swiss map
+accumulates and clears out deleted slots) */
+template <typename Map>
+void BM_LookupHeavy(benchmark::State &state) {
+    using K = typename Map::key_type;
+    auto n = static_cast<size_t>(state.range(0));
+    /* `n` keys start in the map; the other `n` are absent, and take turns being inserted */
+    auto present = make_keys<K>(n, 1);
+    auto absent = make_keys<K>(n, 2);
+    Map map;
+    for (size_t i = 0; i < n; ++i) {
+        map.try_emplace(present[i], static_cast<uint32_t>(i));
+    }
+    size_t probe = 0;
+    size_t replaced = 0;
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < 4; ++i) {
+            sum += map.find(present[probe])->second;
+            sum += map.count(absent[probe]);
+            probe = (probe + 1 == n ? 0 : probe + 1);
+        }
+        map.erase(present[replaced]);
+        map.try_emplace(absent[replaced], static_cast<uint32_t>(replaced));
+        std::swap(present[replaced], absent[replaced]);
+        replaced = (replaced + 1 == n ? 0 : replaced + 1);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * 10);
+}
+
+/* Each iteration builds a map of `state.range(0)` entries, then looks each of them up */
+template <typename Map>
+void BM_InsertHeavy(benchmark::State &state) {
+    using K = typename Map::key_type;
+    auto keys = make_keys<K>(state.range(0));
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        Map map;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            map.try_emplace(keys[i], static_cast<uint32_t>(i));
+        }
+        for (const auto &key : keys) {
+            sum += map.find(key)->second;
+        }
+        benchmark::DoNotOptimize(map);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+
+template <typename K>
+using StdUnorderedMap = std::unordered_map<K, uint32_t>;
+template <typename K>
+using SwissMap = SmallSwissMap<K, uint32_t, 16>;
+
+}  /* namespace */
+
+#define SWISS_MAP_BENCHMARK(benchmark_, map) \
+    BENCHMARK(benchmark_<map>)->Arg(8)->Arg(16)->Arg(256)->Arg(4096)->Arg(65536)
+
+SWISS_MAP_BENCHMARK(BM_LookupHeavy, StdUnorderedMap<uint32_t>);
+SWISS_MAP_BENCHMARK(BM_LookupHeavy, SwissMap<uint32_t>);
+SWISS_MAP_BENCHMARK(BM_LookupHeavy, StdUnorderedMap<std::string>);
+SWISS_MAP_BENCHMARK(BM_LookupHeavy, SwissMap<std::string>);
+SWISS_MAP_BENCHMARK(BM_InsertHeavy, StdUnorderedMap<uint32_t>);
+SWISS_MAP_BENCHMARK(BM_InsertHeavy, SwissMap<uint32_t>);
+SWISS_MAP_BENCHMARK(BM_InsertHeavy, StdUnorderedMap<std::string>);
+SWISS_MAP_BENCHMARK(BM_InsertHeavy, SwissMap<std::string>);
@@ -0,0 +1,50 @@
+/*
+@file allocator_hooks.h
+@brief Defines the optional allocator extensions that the containers in this repository detect
+and make use of, beyond what `std::allocator_traits` provides.
+
+This file includes the following concepts:
+- `allocator_has_reallocate<Allocator>`
+- `allocator_has_expand<Allocator>`
+*/
+
+#ifndef ALLOCATOR_HOOKS_H
+#define ALLOCATOR_HOOKS_H
+
+#include <cstddef>
+#include <concepts>
+#include <memory>
+
+/* `allocator_has_reallocate<Allocator>` is satisfied iff `Allocator` provides a member function
+
+    pointer reallocate(pointer p, size_t old_n, size_t new_n);
+
+with the semantics of `realloc`: given a buffer `p` of `old_n` objects previously obtained from
+this allocator, it returns a buffer of `new_n` objects whose first `min(old_n, new_n)` objects have
+the same bytes as those of `p` (possibly `p` itself, if the buffer could be resized in place), after
+which `p` must no longer be used. On failure, it returns `nullptr` and leaves `p` untouched.
+
+Because the bytes are carried over as-is, containers only use `reallocate` for element types that
+are trivially relocatable (see `relocation.h`). */
+template <typename Allocator>
+concept allocator_has_reallocate = requires (
+    Allocator &allocator, typename std::allocator_traits<Allocator>::pointer p, size_t n
+) {
+    { allocator.reallocate(p, n, n) } -> std::convertible_to<typename std::allocator_traits<Allocator>::pointer>;
+};
+
+/* `allocator_has_expand<Allocator>` is satisfied iff `Allocator` provides a member function
+
+    bool expand(pointer p, size_t old_n, size_t new_n);
+
+which attempts to grow the buffer `p` of `old_n` objects to `new_n` objects without moving it,
+returning `true` on success. On failure, it returns `false` and leaves `p` untouched. Unlike
+`reallocate`, the objects in `p` are never moved, so `expand` is usable for any element type. */
+template <typename Allocator>
+concept allocator_has_expand = requires (
+    Allocator &allocator, typename std::allocator_traits<Allocator>::pointer p, size_t n
+) {
+    { allocator.expand(p, n, n) } -> std::convertible_to<bool>;
+};
+
+#endif
@@ -0,0 +1,210 @@
+/*
+@file counting_allocator.h
+@brief Defines and implements `CountingAllocator<T, Upstream>`, an allocator wrapper which counts
+(and optionally traces) every allocation made through it.
+
+This file includes the following types:
+- `AllocationEvent`
+- `AllocationCounters`
+- `CountingAllocator<T, Upstream>`
+*/
+
+#ifndef COUNTING_ALLOCATOR_H
+#define COUNTING_ALLOCATOR_H
+
+#include "allocators/allocator_hooks.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/* `AllocationEvent` describes a single allocator call, as passed to `AllocationCounters::tracer` */
+struct AllocationEvent {
+    enum class Kind { Allocate, Deallocate, Reallocate, Expand };
+
+    Kind kind;
+    /* `old_pointer`/`old_bytes` = The buffer before the call (`nullptr`/0 for `Allocate`) */
+    const void *old_pointer;
+    size_t old_bytes;
+    /* `new_pointer`/`new_bytes` = The buffer after the call (`nullptr`/0 for `Deallocate`, and
+    for a failed `Reallocate` or `Expand`) */
+    const void *new_pointer;
+    size_t new_bytes;
+};
+
+/* `AllocationCounters` accumulates the allocator calls made through every `CountingAllocator` that
+refers to it. The counters are relaxed atomics, so one instance may be shared across threads.
+
+A successful `reallocate` or `expand` counts as a reallocation (rather than as an allocation and a
+deallocation), and moves the byte counters from the old size to the new size, so that
+`bytes_allocated - bytes_deallocated` is always the number of bytes currently allocated. */
+struct AllocationCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> reallocations{0};
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> bytes_deallocated{0};
+
+    /* If set, `tracer` is called for every allocator call (including failed reallocations), for
+    instance to log the call or to capture a stack trace. */
+    void (*tracer)(const AllocationEvent&) = nullptr;
+
+    /* Returns the number of bytes currently allocated */
+    uint64_t live_bytes() const { return bytes_allocated - bytes_deallocated; }
+
+    /* Sets every counter back to zero (but keeps `tracer`) */
+    void reset() {
+        allocations = 0;
+        deallocations = 0;
+        reallocations = 0;
+        bytes_allocated = 0;
+        bytes_deallocated = 0;
+    }
+
+    /* Returns the counters used by default-constructed `CountingAllocator`s */
+    static AllocationCounters& global() {
+        static AllocationCounters counters;
+        return counters;
+    }
+
+    /* Records `event`, and passes it on to `tracer` */
+    void record(const AllocationEvent &event) {
+        constexpr auto relaxed = std::memory_order_relaxed;
+        switch (event.kind) {
+            case AllocationEvent::Kind::Allocate:
+                allocations.fetch_add(1, relaxed);
+                bytes_allocated.fetch_add(event.new_bytes, relaxed);
+                break;
+            case AllocationEvent::Kind::Deallocate:
+                deallocations.fetch_add(1, relaxed);
+                bytes_deallocated.fetch_add(event.old_bytes, relaxed);
+                break;
+            case AllocationEvent::Kind::Reallocate:
+            case AllocationEvent::Kind::Expand:
+                if (event.new_pointer) {
+                    reallocations.fetch_add(1, relaxed);
+                    bytes_deallocated.fetch_add(event.old_bytes, relaxed);
+                    bytes_allocated.fetch_add(event.new_bytes, relaxed);
+                }
+                break;
+        }
+        if (tracer) {
+            tracer(event);
+        }
+    }
+};
+
+/* `CountingAllocator<T, Upstream>` forwards every call to the allocator `Upstream`, and records it
+in an `AllocationCounters` (by default, `AllocationCounters::global()`). It is meant for asserting
+allocation budgets in tests, e.g. that a `StackAssistedVector` does not allocate until its stack
+capacity is exceeded:
+
+    AllocationCounters counters;
+    StackAssistedVector<int, 8, CountingAllocator<int>> v(counters);
+    for (int i = 0; i < 8; ++i) { v.push_back(i); }
+    assert(counters.allocations == 0);
+
+The wrapper is transparent to the containers: it provides the `reallocate` and `expand` hooks (see
+`allocator_hooks.h`) iff `Upstream` does, and customizes element construction iff `Upstream` does,
+so that wrapping an allocator does not change which code paths a container takes. */
+template <typename T, typename Upstream = std::allocator<T>>
+struct CountingAllocator {
+    using UpstreamTraits = std::allocator_traits<Upstream>;
+
+    using value_type = T;
+    using pointer = typename UpstreamTraits::pointer;
+    using propagate_on_container_copy_assignment =
+        typename UpstreamTraits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment =
+        typename UpstreamTraits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename UpstreamTraits::propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        using other = CountingAllocator<U, typename UpstreamTraits::template rebind_alloc<U>>;
+    };
+
+    CountingAllocator() : counters{&AllocationCounters::global()} {}
+    CountingAllocator(AllocationCounters &counters_, const Upstream &upstream_ = {})
+    : upstream{upstream_}, counters{&counters_} {}
+    template <typename U, typename OtherUpstream>
+    CountingAllocator(const CountingAllocator<U, OtherUpstream> &other)
+    : upstream(other.upstream_allocator()), counters{&other.allocation_counters()} {}
+
+    pointer allocate(size_t n) {
+        auto p = UpstreamTraits::allocate(upstream, n);
+        counters->record({
+            AllocationEvent::Kind::Allocate, nullptr, 0, std::to_address(p), n * sizeof(T)
+        });
+        return p;
+    }
+
+    void deallocate(pointer p, size_t n) {
+        counters->record({
+            AllocationEvent::Kind::Deallocate, std::to_address(p), n * sizeof(T), nullptr, 0
+        });
+        UpstreamTraits::deallocate(upstream, p, n);
+    }
+
+    pointer reallocate(pointer p, size_t old_n, size_t new_n)
+    requires allocator_has_reallocate<Upstream> {
+        auto q = upstream.reallocate(p, old_n, new_n);
+        counters->record({
+            AllocationEvent::Kind::Reallocate, std::to_address(p), old_n * sizeof(T),
+            (q ? std::to_address(q) : nullptr), (q ? new_n * sizeof(T) : 0)
+        });
+        return q;
+    }
+
+    bool expand(pointer p, size_t old_n, size_t new_n)
+    requires allocator_has_expand<Upstream> {
+        bool expanded = upstream.expand(p, old_n, new_n);
+        counters->record({
+            AllocationEvent::Kind::Expand, std::to_address(p), old_n * sizeof(T),
+            (expanded ? std::to_address(p) : nullptr), (expanded ? new_n * sizeof(T) : 0)
+        });
+        return expanded;
+    }
+
+    template <typename U, typename... Args>
+    requires requires (Upstream &a, U *p, Args&&... args) {
+        a.construct(p, std::forward<Args>(args)...);
+    }
+    void construct(U *p, Args&&... args) {
+        upstream.construct(p, std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    requires requires (Upstream &a, U *p) { a.destroy(p); }
+    void destroy(U *p) {
+        upstream.destroy(p);
+    }
+
+    CountingAllocator select_on_container_copy_construction() const {
+        return CountingAllocator(
+            *counters, UpstreamTraits::select_on_container_copy_construction(upstream)
+        );
+    }
+
+    /* Returns the wrapped allocator */
+    const Upstream& upstream_allocator() const { return upstream; }
+
+    /* Returns the counters this allocator records to */
+    AllocationCounters& allocation_counters() const { return *counters; }
+
+    template <typename U, typename OtherUpstream>
+    friend bool operator== (
+        const CountingAllocator &a, const CountingAllocator<U, OtherUpstream> &b
+    ) {
+        return &a.allocation_counters() == &b.allocation_counters() &&
+            a.upstream_allocator() == b.upstream_allocator();
+    }
+
+private:
+    [[no_unique_address]] Upstream upstream;
+    AllocationCounters *counters;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*
+@file default_init_allocator.h
+@brief Defines and implements `DefaultInitAllocator<T, Upstream>`, an allocator wrapper which makes
+containers default-initialize (rather than value-initialize) the elements they create without an
+initial value.
+
+This file includes the following types:
+- `DefaultInitAllocator<T, Upstream>`
+*/
+
+#ifndef DEFAULT_INIT_ALLOCATOR_H
+#define DEFAULT_INIT_ALLOCATOR_H
+
+#include "allocators/allocator_hooks.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/* `DefaultInitAllocator<T, Upstream>` wraps the allocator `Upstream`, and changes one thing: when a
+container asks it to construct an element from no arguments (as `resize(n)` and the size
+constructor do), the element is default-initialized rather than value-initialized. For trivially
+default-constructible types (such as `int`, `char`, or a plain struct of them), this leaves the
+element uninitialized, so that growing a buffer which is about to be overwritten (for instance, by
+a `read` from a socket or a file) does not first fill it with zeros:
+
+    StackAssistedVector<char, 4096, DefaultInitAllocator<char>> buffer;
+    buffer.resize(n);  // Does not touch the memory
+    buffer.resize(read(fd, buffer.data(), n));
+
+Constructing elements from arguments (copies, moves, and so on) is left to `Upstream`, so the
+wrapper does not count as customizing element construction (see `relocation.h`) unless `Upstream`
+does; the containers' `std::memcpy`/`std::memmove` paths remain enabled. Like `CountingAllocator`,
+it provides the `reallocate` and `expand` hooks (see `allocator_hooks.h`) iff `Upstream` does. */
+template <typename T, typename Upstream = std::allocator<T>>
+struct DefaultInitAllocator {
+    using UpstreamTraits = std::allocator_traits<Upstream>;
+
+    using value_type = T;
+    using pointer = typename UpstreamTraits::pointer;
+    using propagate_on_container_copy_assignment =
+        typename UpstreamTraits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment =
+        typename UpstreamTraits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename UpstreamTraits::propagate_on_container_swap;
+    using is_always_equal = typename UpstreamTraits::is_always_equal;
+
+    template <typename U>
+    struct rebind {
+        using other = DefaultInitAllocator<U, typename UpstreamTraits::template rebind_alloc<U>>;
+    };
+
+    DefaultInitAllocator() = default;
+    DefaultInitAllocator(const Upstream &upstream_) : upstream{upstream_} {}
+    template <typename U, typename OtherUpstream>
+    DefaultInitAllocator(const DefaultInitAllocator<U, OtherUpstream> &other)
+    : upstream(other.upstream_allocator()) {}
+
+    pointer allocate(size_t n) { return UpstreamTraits::allocate(upstream, n); }
+    void deallocate(pointer p, size_t n) { UpstreamTraits::deallocate(upstream, p, n); }
+
+    pointer reallocate(pointer p, size_t old_n, size_t new_n)
+    requires allocator_has_reallocate<Upstream> {
+        return upstream.reallocate(p, old_n, new_n);
+    }
+
+    bool expand(pointer p, size_t old_n, size_t new_n)
+    requires allocator_has_expand<Upstream> {
+        return upstream.expand(p, old_n, new_n);
+    }
+
+    /* Default-initializes an element at `p` (unless `Upstream` customizes this itself) */
+    template <typename U>
+    void construct(U *p) {
+        if constexpr (requires (Upstream &a) { a.construct(p); }) {
+            upstream.construct(p);
+        } else {
+            ::new (static_cast<void*>(p)) U;
+        }
+    }
+
+    template <typename U, typename Arg, typename... Args>
+    requires requires (Upstream &a, U *p, Arg &&arg, Args&&... args) {
+        a.construct(p, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+    void construct(U *p, Arg &&arg, Args&&... args) {
+        upstream.construct(p, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    requires requires (Upstream &a, U *p) { a.destroy(p); }
+    void destroy(U *p) {
+        upstream.destroy(p);
+    }
+
+    DefaultInitAllocator select_on_container_copy_construction() const {
+        return DefaultInitAllocator(UpstreamTraits::select_on_container_copy_construction(upstream));
+    }
+
+    /* Returns the wrapped allocator */
+    const Upstream& upstream_allocator() const { return upstream; }
+
+    template <typename U, typename OtherUpstream>
+    friend bool operator== (
+        const DefaultInitAllocator &a, const DefaultInitAllocator<U, OtherUpstream> &b
+    ) {
+        return a.upstream_allocator() == b.upstream_allocator();
+    }
+
+private:
+    [[no_unique_address]] Upstream upstream;
+};
+
+#endif
@@ -0,0 +1,134 @@
+/*
+@file malloc_allocator.h
+@brief Defines and implements `MallocAllocator<T>`, a stateless allocator on top of
+`malloc`/`realloc`/`free` that can grow buffers in place.
+
+This file includes the following types:
+- `MallocAllocator<T>`
+*/
+
+#ifndef MALLOC_ALLOCATOR_H
+#define MALLOC_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <limits>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/* `MallocAllocator<T>` is a stateless allocator which obtains memory from `malloc` and releases it
+with `free`. Its purpose is to provide `reallocate` (see `allocator_hooks.h`), which lets containers
+such as `StackAssistedVector` grow a buffer of trivially relocatable elements without allocating a
+new buffer and moving every element across:
+- Buffers smaller than `mmap_threshold` bytes are resized with `realloc`, which extends the buffer
+in place whenever the memory after it is free, and otherwise copies it.
+- On Linux, buffers of at least `mmap_threshold` bytes are instead mapped directly with `mmap`, and
+are resized with `mremap`. This never copies any data; at worst, the kernel moves the pages of the
+buffer to a new virtual address. Mapping large buffers ourselves (rather than relying on glibc to
+do so) is necessary because glibc's mmap threshold is dynamic, and rises as large blocks are freed,
+after which large buffers would be served from the heap (where growing them copies every byte). */
+template <typename T>
+struct MallocAllocator {
+    static_assert(
+        alignof(T) <= alignof(std::max_align_t),
+        "MallocAllocator does not support over-aligned types"
+    );
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+#if defined(__linux__)
+    /* Buffers of at least this many bytes are mapped directly with `mmap` */
+    static constexpr size_t mmap_threshold = size_t{1} << 20;
+#endif
+
+    constexpr MallocAllocator() = default;
+    template <typename U>
+    constexpr MallocAllocator(const MallocAllocator<U>&) {}
+
+    /* Allocates an uninitialized buffer for `n` objects of type `T` */
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+
+        auto bytes = n * sizeof(T);
+        void *p = nullptr;
+#if defined(__linux__)
+        if (bytes >= mmap_threshold) {
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(p);
+        }
+#endif
+        /* `malloc(0)` may return `nullptr`, so always request at least one byte */
+        p = std::malloc(bytes == 0 ? 1 : bytes);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    /* Deallocates the buffer `p` of `n` objects, which must have come from `allocate(n)` or
+    `reallocate(..., n)` */
+    void deallocate(T *p, size_t n) {
+#if defined(__linux__)
+        if (n * sizeof(T) >= mmap_threshold) {
+            munmap(p, n * sizeof(T));
+            return;
+        }
+#endif
+        std::free(p);
+    }
+
+    /* Resizes the buffer `p` from `old_n` to `new_n` objects, carrying over its bytes (see
+    `allocator_has_reallocate` in `allocator_hooks.h`). Returns `nullptr` on failure, in which case
+    `p` is left untouched. */
+    T* reallocate(T *p, size_t old_n, size_t new_n) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return nullptr;
+        }
+
+        [[maybe_unused]] auto old_bytes = old_n * sizeof(T);
+        auto new_bytes = new_n * sizeof(T);
+#if defined(__linux__)
+        auto old_mapped = old_bytes >= mmap_threshold, new_mapped = new_bytes >= mmap_threshold;
+        if (old_mapped && new_mapped) {
+            /* Both buffers are mappings, so `mremap` can move the pages themselves if needed */
+            void *q = mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE);
+            return (q == MAP_FAILED ? nullptr : static_cast<T*>(q));
+        }
+        if (old_mapped != new_mapped) {
+            /* The buffer crosses `mmap_threshold`, so it has to be copied to a new buffer of the
+            other kind. This happens at most once in each direction. */
+            T *q = nullptr;
+            try {
+                q = allocate(new_n);
+            } catch (const std::bad_alloc&) {
+                return nullptr;
+            }
+            std::memcpy(
+                static_cast<void*>(q), static_cast<const void*>(p),
+                (old_bytes < new_bytes ? old_bytes : new_bytes)
+            );
+            deallocate(p, old_n);
+            return q;
+        }
+#endif
+        return static_cast<T*>(std::realloc(static_cast<void*>(p), new_bytes == 0 ? 1 : new_bytes));
+    }
+
+    friend constexpr bool operator== (const MallocAllocator&, const MallocAllocator&) {
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,48 @@
+/*
+@file memory_resource_adapter.h
+@brief Defines and implements `MemoryResourceAdapter<Resource>`, which exposes the memory resources
+in this directory (`MonotonicArena` and `FixedSizePool`) as a `std::pmr::memory_resource`.
+
+This file includes the following types:
+- `MemoryResourceAdapter<Resource>`
+*/
+
+#ifndef MEMORY_RESOURCE_ADAPTER_H
+#define MEMORY_RESOURCE_ADAPTER_H
+
+#include <cstddef>
+#include <memory_resource>
+
+/* `MemoryResourceAdapter<Resource>` forwards `allocate` and `deallocate` to a `Resource` (which must
+outlive it), so that code written against `std::pmr` can draw from the same arena or pool as the
+containers in this repository. A `std::pmr::polymorphic_allocator<T>` constructed from the adapter
+then works as the `Allocator` of any of those containers too, at the cost of a virtual call per
+allocation (and of the `expand` hook, which `std::pmr` has no equivalent of).
+
+Two adapters compare equal iff they adapt the same resource, as memory from one can then be
+deallocated through the other. */
+template <typename Resource>
+struct MemoryResourceAdapter : std::pmr::memory_resource {
+    explicit MemoryResourceAdapter(Resource &resource_) : resource{&resource_} {}
+
+    /* Returns the resource this adapter forwards to */
+    Resource& upstream() const { return *resource; }
+
+private:
+    Resource *resource;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return resource->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        resource->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        auto adapter = dynamic_cast<const MemoryResourceAdapter*>(&other);
+        return adapter && adapter->resource == resource;
+    }
+};
+
+#endif
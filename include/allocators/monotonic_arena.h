@@ -0,0 +1,306 @@
+/*
+@file monotonic_arena.h
+@brief Defines and implements `MonotonicArena`, a bump-pointer memory arena whose allocations are
+all released at once, along with the allocators that draw from it.
+
+This file includes the following types:
+- `MonotonicArena`
+- `ArenaAllocator<T>`
+- `ThreadLocalArenaAllocator<T>`
+*/
+
+#ifndef MONOTONIC_ARENA_H
+#define MONOTONIC_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/* `MonotonicArena` hands out memory by advancing a pointer (the "cursor") through large chunks, and
+never frees individual allocations. Instead, `reset()` reclaims everything at once, after which
+the same chunks are reused; so a program that builds many short-lived containers (for instance, a
+server building thousands of vectors per request) can reset an arena after each unit of work, and
+stop calling `malloc`/`free` entirely once the arena has grown large enough.
+
+Chunks are obtained with `malloc`, starting at `initial_chunk_size` bytes and doubling from there.
+An arena may also be given an initial buffer (for instance, a stack array), which it uses before
+allocating any chunks, and which it never frees.
+
+Two operations make the arena a good fit for growing vectors:
+- `deallocate(p, bytes)` rolls back the cursor if `p` is the most recent allocation, so a buffer
+  that is freed right after being replaced (as when a vector reallocates) is reused.
+- `expand(p, old_bytes, new_bytes)` grows the most recent allocation in place, as long as the
+  current chunk has room. `ArenaAllocator` exposes it as the `expand` hook from
+  `allocator_hooks.h`, so a `StackAssistedVector` that is the last to allocate from its arena grows
+  without moving its elements.
+
+Every object allocated from an arena must be destroyed before the arena is reset or destroyed. A
+`MonotonicArena` is not thread-safe; see `ThreadLocalArenaAllocator` for one arena per thread. */
+struct MonotonicArena {
+    static constexpr size_t default_initial_chunk_size = size_t{64} << 10;
+
+    /* Constructs an arena whose first chunk will be `initial_chunk_size` bytes. No memory is
+    allocated until the first allocation. */
+    explicit MonotonicArena(size_t initial_chunk_size = default_initial_chunk_size)
+    : next_chunk_size{initial_chunk_size < min_chunk_size ? min_chunk_size : initial_chunk_size} {}
+
+    /* Constructs an arena which allocates from the `size` bytes at `buffer` first. The buffer is
+    not owned by the arena, and must outlive it. */
+    MonotonicArena(
+        void *buffer, size_t size, size_t initial_chunk_size = default_initial_chunk_size
+    ) : MonotonicArena(initial_chunk_size) {
+        if (auto chunk = make_chunk(buffer, size, false)) {
+            first_chunk = current_chunk = chunk;
+            cursor = chunk->begin();
+            chunk_end = chunk->end();
+        }
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator= (const MonotonicArena&) = delete;
+
+    ~MonotonicArena() { release(); }
+
+    /* Returns a buffer of `bytes` bytes aligned to `alignment` (which must be a power of two). */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (auto p = try_allocate_from_current_chunk(bytes, alignment)) [[likely]] {
+            return p;
+        }
+        return allocate_from_next_chunk(bytes, alignment);
+    }
+
+    /* Gives back the buffer `p` of `bytes` bytes. This only reclaims memory if `p` is the most
+    recent allocation; otherwise, the memory is reclaimed by the next `reset()`. */
+    void deallocate(void *p, size_t bytes, [[maybe_unused]] size_t alignment = 0) {
+        if (static_cast<std::byte*>(p) + bytes == cursor) {
+            cursor = static_cast<std::byte*>(p);
+        }
+    }
+
+    /* Attempts to grow the buffer `p` from `old_bytes` to `new_bytes` bytes without moving it,
+    which succeeds iff `p` is the most recent allocation and the current chunk has enough room
+    left. Returns `true` on success; otherwise, `p` is left untouched. */
+    bool expand(void *p, size_t old_bytes, size_t new_bytes) {
+        auto begin = static_cast<std::byte*>(p);
+        if (begin + old_bytes != cursor || new_bytes > static_cast<size_t>(chunk_end - begin)) {
+            return false;
+        }
+        cursor = begin + new_bytes;
+        return true;
+    }
+
+    /* Reclaims every allocation at once, keeping every chunk for reuse. */
+    void reset() {
+        current_chunk = first_chunk;
+        cursor = (first_chunk ? first_chunk->begin() : nullptr);
+        chunk_end = (first_chunk ? first_chunk->end() : nullptr);
+    }
+
+    /* Reclaims every allocation at once, and frees every chunk (except the initial buffer, if any,
+    which is kept for reuse). */
+    void release() {
+        Chunk *kept = nullptr;
+        for (auto chunk = first_chunk; chunk;) {
+            auto next = chunk->next;
+            if (chunk->owned) {
+                std::free(chunk);
+            } else {
+                kept = chunk;
+                kept->next = nullptr;
+            }
+            chunk = next;
+        }
+        first_chunk = kept;
+        reset();
+    }
+
+    /* Returns the total number of bytes in the chunks (and the initial buffer) of this arena. */
+    size_t bytes_reserved() const {
+        size_t result = 0;
+        for (auto chunk = first_chunk; chunk; chunk = chunk->next) {
+            result += chunk->size;
+        }
+        return result;
+    }
+
+    /* Returns this thread's arena, which `ThreadLocalArenaAllocator` allocates from. It is
+    destroyed (freeing its chunks) when the thread exits. */
+    static MonotonicArena& thread_local_arena() {
+        thread_local MonotonicArena arena;
+        return arena;
+    }
+
+private:
+    /* Every chunk starts with a `Chunk` header, followed by its usable bytes (which are thus
+    suitably aligned for any fundamental type) */
+    struct alignas(std::max_align_t) Chunk {
+        Chunk *next;
+        size_t size;  /* The number of usable bytes after the header */
+        bool owned;   /* Whether the chunk was allocated by the arena (and must be freed by it) */
+
+        std::byte* begin() { return reinterpret_cast<std::byte*>(this + 1); }
+        std::byte* end() { return begin() + size; }
+    };
+
+    static constexpr size_t min_chunk_size = 256;
+
+    /* The chunks form a singly-linked list, which `reset()` rewinds to the start of */
+    Chunk *first_chunk = nullptr;
+    Chunk *current_chunk = nullptr;
+    /* `cursor` = The start of the free bytes of `current_chunk`, which end at `chunk_end` */
+    std::byte *cursor = nullptr;
+    std::byte *chunk_end = nullptr;
+    /* `next_chunk_size` = The number of usable bytes in the next chunk to be allocated */
+    size_t next_chunk_size;
+
+    /* Places a `Chunk` header at the start of the `size` bytes at `buffer`, or returns `nullptr`
+    if they do not fit one */
+    static Chunk* make_chunk(void *buffer, size_t size, bool owned) {
+        if (!std::align(alignof(Chunk), sizeof(Chunk), buffer, size)) {
+            return nullptr;
+        }
+        return ::new (buffer) Chunk{nullptr, size - sizeof(Chunk), owned};
+    }
+
+    void* try_allocate_from_current_chunk(size_t bytes, size_t alignment) {
+        auto address = reinterpret_cast<uintptr_t>(cursor);
+        auto aligned = (address + (alignment - 1)) & ~uintptr_t(alignment - 1);
+        auto available = static_cast<size_t>(reinterpret_cast<uintptr_t>(chunk_end) - address);
+        if (!cursor || aligned - address > available || bytes > available - (aligned - address)) {
+            return nullptr;
+        }
+        cursor = reinterpret_cast<std::byte*>(aligned) + bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    /* Moves on to the next chunk that can fit the allocation: either a chunk kept from before the
+    last `reset()`, or a newly-allocated chunk, which is inserted after the current one. */
+    [[gnu::noinline]] void* allocate_from_next_chunk(size_t bytes, size_t alignment) {
+        if (bytes > std::numeric_limits<size_t>::max() - alignment - sizeof(Chunk)) {
+            throw std::bad_alloc();
+        }
+        auto worst_case = bytes + alignment;
+
+        while (current_chunk && current_chunk->next) {
+            current_chunk = current_chunk->next;
+            cursor = current_chunk->begin();
+            chunk_end = current_chunk->end();
+            if (auto p = try_allocate_from_current_chunk(bytes, alignment)) {
+                return p;
+            }
+        }
+
+        while (next_chunk_size < worst_case) {
+            next_chunk_size = (next_chunk_size > std::numeric_limits<size_t>::max() / 2
+                ? worst_case : 2 * next_chunk_size);
+        }
+        auto buffer = std::malloc(sizeof(Chunk) + next_chunk_size);
+        if (!buffer) {
+            throw std::bad_alloc();
+        }
+        auto chunk = ::new (buffer) Chunk{nullptr, next_chunk_size, true};
+        next_chunk_size *= 2;
+
+        if (current_chunk) {
+            current_chunk->next = chunk;
+        } else {
+            first_chunk = chunk;
+        }
+        current_chunk = chunk;
+        cursor = chunk->begin();
+        chunk_end = chunk->end();
+        return try_allocate_from_current_chunk(bytes, alignment);
+    }
+};
+
+/* `ArenaAllocator<T>` allocates from a `MonotonicArena`, which must outlive every container using
+it. It provides the `expand` hook (see `allocator_hooks.h`), and its `deallocate` only reclaims
+memory if the buffer is the arena's most recent allocation (see `MonotonicArena`).
+
+Copies of an `ArenaAllocator` share the same arena, and compare equal iff they do. The allocator is
+propagated along with the buffer whenever a container is moved or swapped, and is kept when one is
+copied, so copies of a container allocate from the same arena as the original. */
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    constexpr ArenaAllocator(MonotonicArena &arena_) : arena{&arena_} {}
+    template <typename U>
+    constexpr ArenaAllocator(const ArenaAllocator<U> &other) : arena{&other.resource()} {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        arena->deallocate(p, n * sizeof(T));
+    }
+
+    bool expand(T *p, size_t old_n, size_t new_n) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return false;
+        }
+        return arena->expand(p, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    /* Returns the arena this allocator allocates from */
+    MonotonicArena& resource() const { return *arena; }
+
+    template <typename U>
+    friend constexpr bool operator== (const ArenaAllocator &a, const ArenaAllocator<U> &b) {
+        return &a.resource() == &b.resource();
+    }
+
+private:
+    MonotonicArena *arena;
+};
+
+/* `ThreadLocalArenaAllocator<T>` is a stateless allocator which allocates from the calling thread's
+arena (see `MonotonicArena::thread_local_arena()`). As it needs no arena to be passed around, it
+can simply be named as the `Allocator` of a container; each thread then resets its own arena with
+`MonotonicArena::thread_local_arena().reset()` once it is done with its containers.
+
+Containers using it must be destroyed before the arena of the thread that allocated their buffers
+is reset (or before that thread exits). Deallocating from another thread is harmless but reclaims
+nothing, as `deallocate` and `expand` only ever act on the calling thread's most recent
+allocation. */
+template <typename T>
+struct ThreadLocalArenaAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    constexpr ThreadLocalArenaAllocator() = default;
+    template <typename U>
+    constexpr ThreadLocalArenaAllocator(const ThreadLocalArenaAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return ArenaAllocator<T>(MonotonicArena::thread_local_arena()).allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        ArenaAllocator<T>(MonotonicArena::thread_local_arena()).deallocate(p, n);
+    }
+
+    bool expand(T *p, size_t old_n, size_t new_n) {
+        return ArenaAllocator<T>(MonotonicArena::thread_local_arena()).expand(p, old_n, new_n);
+    }
+
+    friend constexpr bool operator== (
+        const ThreadLocalArenaAllocator&, const ThreadLocalArenaAllocator&
+    ) {
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+@file pool_allocator.h
+@brief Defines and implements `FixedSizePool`, a slab allocator for blocks of one fixed size, along
+with the allocator that draws from it.
+
+This file includes the following types:
+- `FixedSizePool`
+- `PoolAllocator<T>`
+*/
+
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/* `FixedSizePool` serves allocations of up to `block_size` bytes from large slabs of
+`blocks_per_slab` blocks each, and recycles freed blocks through an intrusive free list. Allocating
+and deallocating a block are thus a couple of pointer operations each, and blocks never need to be
+returned to `malloc` one by one.
+
+Larger (or over-aligned) allocations are passed through to `::operator new`. This suits containers
+whose buffers are mostly of one size class; for instance, a pool whose `block_size` is the size of a
+`StackAssistedVector`'s first heap buffer serves every vector that spills to the heap once.
+
+Slabs are only freed when the pool is destroyed, which must happen after every block has been
+deallocated. A `FixedSizePool` is not thread-safe. */
+struct FixedSizePool {
+    static constexpr size_t default_blocks_per_slab = 64;
+
+    /* Constructs a pool of blocks of (at least) `block_size_` bytes, aligned to
+    `alignof(std::max_align_t)`. No memory is allocated until the first allocation. */
+    explicit FixedSizePool(size_t block_size_, size_t blocks_per_slab_ = default_blocks_per_slab)
+    : block_size_bytes{round_up_block_size(block_size_)},
+      blocks_per_slab{blocks_per_slab_ == 0 ? 1 : blocks_per_slab_} {}
+
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool& operator= (const FixedSizePool&) = delete;
+
+    ~FixedSizePool() {
+        while (slabs) {
+            std::free(std::exchange(slabs, slabs->next));
+        }
+    }
+
+    /* Returns a buffer of `bytes` bytes aligned to `alignment` (which must be a power of two). */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (!served_by_pool(bytes, alignment)) {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+        if (!free_list) [[unlikely]] {
+            allocate_slab();
+        }
+        return std::exchange(free_list, free_list->next);
+    }
+
+    /* Deallocates the buffer `p`, which must have come from `allocate(bytes, alignment)`. */
+    void deallocate(void *p, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (!served_by_pool(bytes, alignment)) {
+            ::operator delete(p, bytes, std::align_val_t(alignment));
+            return;
+        }
+        free_list = ::new (p) FreeBlock{free_list};
+    }
+
+    /* Returns the number of bytes in each block */
+    size_t block_size() const { return block_size_bytes; }
+
+private:
+    /* A block on the free list holds a pointer to the next free block */
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    /* Every slab starts with a `Slab` header, followed by its blocks */
+    struct alignas(std::max_align_t) Slab {
+        Slab *next;
+    };
+
+    size_t block_size_bytes;
+    size_t blocks_per_slab;
+    FreeBlock *free_list = nullptr;
+    Slab *slabs = nullptr;
+
+    /* Rounds `bytes` up to a multiple of `alignof(std::max_align_t)` that can hold a `FreeBlock` */
+    static size_t round_up_block_size(size_t bytes) {
+        constexpr auto alignment = alignof(std::max_align_t);
+        bytes = (bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : bytes);
+        return (bytes + (alignment - 1)) / alignment * alignment;
+    }
+
+    bool served_by_pool(size_t bytes, size_t alignment) const {
+        return bytes <= block_size_bytes && alignment <= alignof(std::max_align_t);
+    }
+
+    /* Allocates a new slab, and pushes all of its blocks onto the free list */
+    [[gnu::noinline]] void allocate_slab() {
+        auto max_blocks = (std::numeric_limits<size_t>::max() - sizeof(Slab)) / block_size_bytes;
+        if (blocks_per_slab > max_blocks) {
+            throw std::bad_alloc();
+        }
+        auto memory = std::malloc(sizeof(Slab) + blocks_per_slab * block_size_bytes);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        slabs = ::new (memory) Slab{slabs};
+
+        /* Push the blocks in reverse, so that they are handed out in address order */
+        auto blocks = reinterpret_cast<std::byte*>(slabs + 1);
+        for (size_t i = blocks_per_slab; i-- > 0;) {
+            free_list = ::new (blocks + i * block_size_bytes) FreeBlock{free_list};
+        }
+    }
+};
+
+/* `PoolAllocator<T>` allocates from a `FixedSizePool`, which must outlive every container using
+it. Copies of a `PoolAllocator` share the same pool, and compare equal iff they do; the allocator is
+propagated along with the buffer whenever a container is moved or swapped. */
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    constexpr PoolAllocator(FixedSizePool &pool_) : pool{&pool_} {}
+    template <typename U>
+    constexpr PoolAllocator(const PoolAllocator<U> &other) : pool{&other.resource()} {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(pool->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        pool->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    /* Returns the pool this allocator allocates from */
+    FixedSizePool& resource() const { return *pool; }
+
+    template <typename U>
+    friend constexpr bool operator== (const PoolAllocator &a, const PoolAllocator<U> &b) {
+        return &a.resource() == &b.resource();
+    }
+
+private:
+    FixedSizePool *pool;
+};
+
+#endif
@@ -0,0 +1,288 @@
+/*
+@file capacity_profile.h
+@brief Defines an opt-in profiling mode which records, for each `StackAssistedVector` type, a
+histogram of the peak sizes its objects reached, and recommends a stack capacity from it.
+
+This file includes the following types and functions:
+- `CapacityProfile`
+- `capacity_profile<Container>(inline_capacity, element_size)`
+- `PeakSizeTracker`
+- `write_capacity_profiles_json(out, percentile)` and `write_capacity_profiles_csv(out, percentile)`
+*/
+
+#ifndef CAPACITY_PROFILE_H
+#define CAPACITY_PROFILE_H
+
+#include "instrumentation/container_counters.h"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <source_location>
+#include <string_view>
+#include <type_traits>
+
+/* Profiling is off by default, in which case `PeakSizeTracker` is an empty type whose functions do
+nothing. Define `CPP_CONTAINERS_CAPACITY_PROFILING` to 1 (for the whole program, since it changes
+the layout of `StackAssistedVector`) to turn it on.
+
+When profiling is on, every `StackAssistedVector` tracks the largest size it reached, and records it
+in the `CapacityProfile` of its type when it is destroyed. At exit, all profiles are written to the
+file named by the environment variable `CPP_CONTAINERS_CAPACITY_PROFILE` (as CSV if the name ends in
+".csv", and as JSON otherwise), or as JSON to `std::cerr` if the variable is not set. Each profile
+includes the recommended stack capacity at the percentile `CPP_CONTAINERS_CAPACITY_PERCENTILE`
+(0.95 by default). */
+#if !defined(CPP_CONTAINERS_CAPACITY_PROFILING)
+#define CPP_CONTAINERS_CAPACITY_PROFILING 0
+#endif
+
+#if !defined(CPP_CONTAINERS_CAPACITY_PERCENTILE)
+#define CPP_CONTAINERS_CAPACITY_PERCENTILE 0.95
+#endif
+
+/* `CapacityProfile` holds the histogram of peak sizes of the objects of one container type, along
+with the number of times those objects spilled from their stack storage to the heap.
+
+Peak sizes below `exact_sizes` each have their own bucket; larger sizes are bucketed by powers of
+two, so a recommendation above `exact_sizes` is rounded up to the end of its bucket. */
+struct CapacityProfile {
+    static constexpr size_t exact_sizes = 256;
+    static constexpr size_t bucket_count =
+        exact_sizes + (64 - std::countr_zero(exact_sizes));
+
+    /* The name of the container type, its stack capacity, and the size of its elements */
+    std::string_view container_name;
+    size_t inline_capacity = 0;
+    size_t element_size = 0;
+
+    std::atomic<uint64_t> objects{0};
+    std::atomic<uint64_t> spills{0};
+    std::atomic<uint64_t> histogram[bucket_count] = {};
+
+    /* The next entry in the list of all profiles */
+    CapacityProfile *next = nullptr;
+
+    /* Records an object whose largest size was `peak_size` */
+    void record_peak_size(size_t peak_size) {
+        histogram[bucket_of(peak_size)].fetch_add(1, std::memory_order_relaxed);
+        objects.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /* Records that an object spilled from its stack storage to the heap */
+    void record_spill() {
+        spills.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /* Returns the smallest size `s` such that at least a fraction `percentile` of the recorded
+    objects had a peak size of at most `s` (rounded up to the end of its bucket), or 0 if no
+    objects were recorded. A stack capacity of `s` would have kept those objects off the heap. */
+    size_t peak_size_at(double percentile) const {
+        auto total = objects.load(std::memory_order_relaxed);
+        /* Round the number of objects to cover up, so that the fraction covered is never short
+        of `percentile` (allowing for the rounding error of the product, so that a target which is
+        an integer, such as 95% of 100 objects, does not round up to the next one) */
+        auto target = static_cast<uint64_t>(
+            std::ceil(percentile * static_cast<double>(total) - 1e-9)
+        );
+        target = (target == 0 ? 1 : target);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+            seen += histogram[bucket].load(std::memory_order_relaxed);
+            if (seen >= target && total > 0) {
+                return bucket_upper_bound(bucket);
+            }
+        }
+        return 0;
+    }
+
+    /* Returns the recommended stack capacity: the peak size at `percentile`, but at least 1 */
+    size_t recommended_capacity(double percentile = CPP_CONTAINERS_CAPACITY_PERCENTILE) const {
+        auto size = peak_size_at(percentile);
+        return (size == 0 ? 1 : size);
+    }
+
+    /* Returns the bucket of the histogram that `size` falls into */
+    static size_t bucket_of(size_t size) {
+        if (size < exact_sizes) {
+            return size;
+        }
+        return exact_sizes + (std::bit_width(size) - 1 - std::countr_zero(exact_sizes));
+    }
+
+    /* Returns the smallest and largest sizes of the bucket `bucket` */
+    static size_t bucket_lower_bound(size_t bucket) {
+        return (bucket < exact_sizes ? bucket : exact_sizes << (bucket - exact_sizes));
+    }
+    static size_t bucket_upper_bound(size_t bucket) {
+        if (bucket < exact_sizes) {
+            return bucket;
+        }
+        return bucket_lower_bound(bucket) + (bucket_lower_bound(bucket) - 1);
+    }
+};
+
+void write_capacity_profiles_json(std::ostream &out, double percentile);
+void write_capacity_profiles_csv(std::ostream &out, double percentile);
+
+namespace capacity_profile_detail {
+
+/* The head of the (lock-free, push-only) list of every profile created so far */
+inline std::atomic<CapacityProfile*> all_profiles{nullptr};
+
+/* Writes every profile to the destination described at the top of this file */
+inline void write_profiles_at_exit() {
+    double percentile = CPP_CONTAINERS_CAPACITY_PERCENTILE;
+    auto path = std::getenv("CPP_CONTAINERS_CAPACITY_PROFILE");
+    if (!path) {
+        write_capacity_profiles_json(std::cerr, percentile);
+        return;
+    }
+    std::ofstream file(path);
+    if (std::string_view(path).ends_with(".csv")) {
+        write_capacity_profiles_csv(file, percentile);
+    } else {
+        write_capacity_profiles_json(file, percentile);
+    }
+}
+
+/* Adds `profile` to `all_profiles`, and schedules the profiles to be written at exit if profiling
+is enabled (profiles filled in by hand, e.g. in tests, are not written) */
+inline void register_profile(CapacityProfile &profile, std::string_view function_name) {
+    if constexpr (CPP_CONTAINERS_CAPACITY_PROFILING) {
+        [[maybe_unused]] static const bool scheduled = (std::atexit(write_profiles_at_exit), true);
+    }
+    profile.container_name = container_counters_detail::container_name_from(function_name);
+    profile.next = all_profiles.load(std::memory_order_relaxed);
+    while (!all_profiles.compare_exchange_weak(profile.next, &profile)) {}
+}
+
+}  /* namespace capacity_profile_detail */
+
+/* Returns the profile of the container type `Container`, whose stack capacity is `inline_capacity`
+elements of `element_size` bytes each */
+template <typename Container>
+CapacityProfile& capacity_profile(size_t inline_capacity, size_t element_size) {
+    static CapacityProfile profile;
+    [[maybe_unused]] static const bool registered = (
+        profile.inline_capacity = inline_capacity,
+        profile.element_size = element_size,
+        capacity_profile_detail::register_profile(
+            profile, std::source_location::current().function_name()
+        ),
+        true
+    );
+    return profile;
+}
+
+/* Calls `f(profile)` for every profile */
+template <typename F>
+void for_each_capacity_profile(F &&f) {
+    auto profile = capacity_profile_detail::all_profiles.load(std::memory_order_acquire);
+    for (; profile; profile = profile->next) {
+        f(*profile);
+    }
+}
+
+/* Writes every profile to `out` as a JSON array, including the recommended capacity at
+`percentile`, and the non-empty buckets of the histogram as `[smallest size, largest size, count]`
+triples */
+inline void write_capacity_profiles_json(std::ostream &out, double percentile) {
+    out << "[";
+    bool first_profile = true;
+    for_each_capacity_profile([&](const CapacityProfile &p) {
+        out << (first_profile ? "\n" : ",\n");
+        first_profile = false;
+
+        out << "  {\"container\": \"" << p.container_name << "\", "
+            << "\"inline_capacity\": " << p.inline_capacity << ", "
+            << "\"element_size\": " << p.element_size << ", "
+            << "\"objects\": " << p.objects << ", \"spills\": " << p.spills << ", "
+            << "\"p50\": " << p.peak_size_at(0.5) << ", \"p90\": " << p.peak_size_at(0.9) << ", "
+            << "\"p99\": " << p.peak_size_at(0.99) << ", "
+            << "\"percentile\": " << percentile << ", "
+            << "\"recommended_capacity\": " << p.recommended_capacity(percentile) << ", "
+            << "\"histogram\": [";
+        bool first_bucket = true;
+        for (size_t bucket = 0; bucket < CapacityProfile::bucket_count; ++bucket) {
+            if (auto count = p.histogram[bucket].load(std::memory_order_relaxed)) {
+                out << (first_bucket ? "" : ", ") << "["
+                    << CapacityProfile::bucket_lower_bound(bucket) << ", "
+                    << CapacityProfile::bucket_upper_bound(bucket) << ", " << count << "]";
+                first_bucket = false;
+            }
+        }
+        out << "]}";
+    });
+    out << "\n]\n";
+}
+
+/* Writes every profile to `out` as CSV, with one line per non-empty bucket of each histogram */
+inline void write_capacity_profiles_csv(std::ostream &out, double percentile) {
+    out << "container,inline_capacity,element_size,objects,spills,recommended_capacity,"
+           "bucket_min,bucket_max,count\n";
+    for_each_capacity_profile([&](const CapacityProfile &p) {
+        for (size_t bucket = 0; bucket < CapacityProfile::bucket_count; ++bucket) {
+            if (auto count = p.histogram[bucket].load(std::memory_order_relaxed)) {
+                out << '"' << p.container_name << '"' << ',' << p.inline_capacity << ','
+                    << p.element_size << ',' << p.objects << ',' << p.spills << ','
+                    << p.recommended_capacity(percentile) << ','
+                    << CapacityProfile::bucket_lower_bound(bucket) << ','
+                    << CapacityProfile::bucket_upper_bound(bucket) << ',' << count << '\n';
+            }
+        }
+    });
+}
+
+namespace capacity_profile_detail {
+
+/* Tracks the largest size of one container object */
+struct ActivePeakSizeTracker {
+    size_t peak_size = 0;
+
+    /* Notes that the container currently has `size` elements. Containers only call this just
+    before their size decreases (and at destruction), so that growing is not slowed down. */
+    constexpr void note(size_t size) {
+        peak_size = (size > peak_size ? size : peak_size);
+    }
+
+    /* Records the container's peak size in its profile, given its final size */
+    template <typename Container>
+    constexpr void finish(size_t final_size, size_t inline_capacity, size_t element_size) {
+        note(final_size);
+        if (!std::is_constant_evaluated()) {
+            capacity_profile<Container>(inline_capacity, element_size).record_peak_size(peak_size);
+        }
+    }
+
+    /* Records that the container spilled to the heap */
+    template <typename Container>
+    constexpr void spill(size_t inline_capacity, size_t element_size) {
+        if (!std::is_constant_evaluated()) {
+            capacity_profile<Container>(inline_capacity, element_size).record_spill();
+        }
+    }
+};
+
+struct NoPeakSizeTracker {
+    constexpr void note(size_t) {}
+    template <typename Container>
+    constexpr void finish(size_t, size_t, size_t) {}
+    template <typename Container>
+    constexpr void spill(size_t, size_t) {}
+};
+
+}  /* namespace capacity_profile_detail */
+
+/* `PeakSizeTracker` is the member that containers keep for profiling, which is empty (and should
+be declared `[[no_unique_address]]`) unless `CPP_CONTAINERS_CAPACITY_PROFILING` is enabled */
+using PeakSizeTracker = std::conditional_t<
+    CPP_CONTAINERS_CAPACITY_PROFILING,
+    capacity_profile_detail::ActivePeakSizeTracker,
+    capacity_profile_detail::NoPeakSizeTracker
+>;
+
+#endif
@@ -0,0 +1,146 @@
+/*
+@file container_counters.h
+@brief Defines optional per-container-type event counters, which the containers in this repository
+update when `CPP_CONTAINERS_INSTRUMENTATION` is defined to a nonzero value.
+
+This file includes the following types and functions:
+- `ContainerCounters`
+- `container_counters<Container>()`
+- `record_container_event<Container>(counter, n)`
+- `for_each_container_counters(f)` and `write_container_counters_report(out)`
+*/
+
+#ifndef CONTAINER_COUNTERS_H
+#define CONTAINER_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <source_location>
+#include <string_view>
+#include <type_traits>
+
+/* Instrumentation is off by default, in which case `record_container_event` compiles to nothing.
+Define `CPP_CONTAINERS_INSTRUMENTATION` to 1 (before including any container header, or for the
+whole program) to turn it on. */
+#if !defined(CPP_CONTAINERS_INSTRUMENTATION)
+#define CPP_CONTAINERS_INSTRUMENTATION 0
+#endif
+
+/* `ContainerCounters` holds the event counts shared by every container of one type. Unlike
+`AllocationCounters` (see `counting_allocator.h`), which sees calls to one allocator, these are
+recorded by the containers themselves, and so also cover events that involve no allocator call,
+such as moving elements within a buffer. The counters are relaxed atomics. */
+struct ContainerCounters {
+    /* Buffers allocated and deallocated, and their sizes in bytes */
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> bytes_deallocated{0};
+    /* Times that elements moved from inline (stack) storage to a heap buffer */
+    std::atomic<uint64_t> spills{0};
+    /* Times that a heap buffer was replaced by, or grown in place into, a larger one */
+    std::atomic<uint64_t> reallocations{0};
+    /* Elements moved (or relocated) to a new position, by growth or by insertion/erasure */
+    std::atomic<uint64_t> element_moves{0};
+
+    /* The name of the container type, and the next entry in the list of all counters */
+    std::string_view container_name;
+    ContainerCounters *next = nullptr;
+
+    /* Sets every counter back to zero */
+    void reset() {
+        for (auto counter : {
+            &allocations, &deallocations, &bytes_allocated, &bytes_deallocated, &spills,
+            &reallocations, &element_moves
+        }) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace container_counters_detail {
+
+/* The head of the (lock-free, push-only) list of the counters of every container type that has
+recorded an event so far */
+inline std::atomic<ContainerCounters*> all_counters{nullptr};
+
+/* Extracts the name of `Container` from the name of a function templated on it, as given by
+`std::source_location` (which is "... [with Container = NAME]" on GCC and "... [Container = NAME]"
+on Clang, either of which may list further template parameters after a ';' or ", "); returns the
+whole function name if the format is not recognized. */
+inline std::string_view container_name_from(std::string_view function_name) {
+    constexpr std::string_view key = "Container = ";
+    auto start = function_name.find(key);
+    if (start == std::string_view::npos) {
+        return function_name;
+    }
+    start += key.size();
+    auto end = function_name.find(';', start);
+    if (end == std::string_view::npos) {
+        end = function_name.rfind(']');
+    }
+    if (end == std::string_view::npos || end < start) {
+        end = function_name.size();
+    }
+    return function_name.substr(start, end - start);
+}
+
+/* Names `counters` after the container type in `function_name`, and adds it to `all_counters` */
+inline void register_counters(ContainerCounters &counters, std::string_view function_name) {
+    counters.container_name = container_name_from(function_name);
+    counters.next = all_counters.load(std::memory_order_relaxed);
+    while (!all_counters.compare_exchange_weak(counters.next, &counters)) {}
+}
+
+}  /* namespace container_counters_detail */
+
+/* Returns the counters shared by every container of type `Container` */
+template <typename Container>
+ContainerCounters& container_counters() {
+    static ContainerCounters counters;
+    [[maybe_unused]] static const bool registered = (
+        container_counters_detail::register_counters(
+            counters, std::source_location::current().function_name()
+        ),
+        true
+    );
+    return counters;
+}
+
+/* Adds `n` to the counter `counter` of the container type `Container`, if instrumentation is
+enabled. Does nothing during constant evaluation. */
+template <typename Container>
+constexpr void record_container_event(
+    [[maybe_unused]] std::atomic<uint64_t> ContainerCounters::*counter,
+    [[maybe_unused]] uint64_t n = 1
+) {
+#if CPP_CONTAINERS_INSTRUMENTATION
+    if (!std::is_constant_evaluated()) {
+        (container_counters<Container>().*counter).fetch_add(n, std::memory_order_relaxed);
+    }
+#endif
+}
+
+/* Calls `f(counters)` for the counters of every container type that has recorded an event */
+template <typename F>
+void for_each_container_counters(F &&f) {
+    auto counters = container_counters_detail::all_counters.load(std::memory_order_acquire);
+    for (; counters; counters = counters->next) {
+        f(*counters);
+    }
+}
+
+/* Writes one CSV line per container type that has recorded an event (preceded by a header line)
+to `out`, so that the hot paths of a program can be compared across runs. */
+inline void write_container_counters_report(std::ostream &out) {
+    out << "container,allocations,deallocations,bytes_allocated,bytes_deallocated,spills,"
+           "reallocations,element_moves\n";
+    for_each_container_counters([&out](const ContainerCounters &c) {
+        out << '"' << c.container_name << '"' << ',' << c.allocations << ',' << c.deallocations
+            << ',' << c.bytes_allocated << ',' << c.bytes_deallocated << ',' << c.spills << ','
+            << c.reallocations << ',' << c.element_moves << '\n';
+    });
+}
+
+#endif
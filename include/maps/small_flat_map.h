@@ -0,0 +1,681 @@
+/*
+@file small_flat_map.h
+@brief Defines and implements `SmallFlatSet<K, N>` and `SmallFlatMap<K, V, N>`, ordered associative
+containers which keep their keys sorted in a `StackAssistedVector`, and so make zero dynamic
+memory allocations until they hold more than `N` elements.
+
+This file includes the following types:
+- `SmallFlatSet<K, N, Compare, Allocator>`
+- `SmallFlatMap<K, V, N, Compare, Allocator>`
+*/
+
+#ifndef SMALL_FLAT_MAP_H
+#define SMALL_FLAT_MAP_H
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "vector_variations/stack_assisted_vector.h"
+#include "simd/simd_search.h"
+
+namespace small_flat_map_detail {
+
+/* `transparent<Compare>` is satisfied iff `Compare` allows heterogeneous lookup, i.e. comparing
+keys with values of other types (as `std::less<>` does), in which case the lookup functions accept
+any such type. */
+template <typename Compare>
+concept transparent = requires { typename Compare::is_transparent; };
+
+/* `SortedKeys<K, N, Compare, Allocator>` holds the sorted keys of a `SmallFlatSet` or a
+`SmallFlatMap`, along with the comparator, and implements the searches.
+
+Searches scan the keys linearly while there are at most `linear_search_threshold` of them, and
+binary-search them otherwise: on a few keys, a scan has fewer branch mispredictions than a binary
+search. If `K` is an arithmetic type compared with `std::less`, so that two keys are equivalent
+iff they are equal, `find_index` also scans up to `simd_search_threshold` keys with `simd_find`
+(see `simd_search.h`), which checks a whole vector of keys per instruction. (Below
+`linear_search_threshold`, the scalar scan is faster than dispatching to the SIMD kernels.) */
+template <typename K, size_t N, typename Compare, typename Allocator>
+struct SortedKeys {
+    StackAssistedVector<K, N, Allocator> keys;
+    [[no_unique_address]] Compare compare;
+
+    static constexpr bool uses_simd_search =
+        simd_searchable<K> &&
+        (std::is_same_v<Compare, std::less<K>> || std::is_same_v<Compare, std::less<>>);
+
+    static constexpr size_t linear_search_threshold = 8;
+    static constexpr size_t simd_search_threshold = 64;
+
+    constexpr SortedKeys(const Compare &compare_, const Allocator &allocator)
+    : keys(allocator), compare{compare_} {}
+
+    /* Returns the index of the first key which is not less than `key`, or `keys.size()` if there
+    is none. */
+    template <typename Q>
+    constexpr size_t lower_bound_index(const Q &key) const {
+        auto n = keys.size();
+        if (n <= linear_search_threshold) {
+            size_t i = 0;
+            while (i < n && compare(keys[i], key)) {
+                ++i;
+            }
+            return i;
+        }
+
+        /* A branchless binary search: the range halves on every step whatever the comparison
+        says, so the loop has no branches to mispredict, only a conditional move */
+        auto base = keys.begin();
+        while (n > 1) {
+            auto half = n / 2;
+            base = (compare(base[half - 1], key) ? base + half : base);
+            n -= half;
+        }
+        return (base - keys.begin()) + compare(*base, key);
+    }
+
+    /* Returns the index of the key equivalent to `key`, or `keys.size()` if there is none. */
+    template <typename Q>
+    constexpr size_t find_index(const Q &key) const {
+        if constexpr (uses_simd_search && std::is_same_v<Q, K>) {
+            auto n = keys.size();
+            if (!std::is_constant_evaluated() &&
+                n > linear_search_threshold && n <= simd_search_threshold) {
+                return simd_find(keys.data(), n, key);
+            }
+        }
+        auto i = lower_bound_index(key);
+        return ((i != keys.size() && !compare(key, keys[i])) ? i : keys.size());
+    }
+
+    /* Returns true iff `key` would be inserted at `index`, i.e. iff no key equivalent to `key` is
+    stored there (given that `index` is `lower_bound_index(key)`). */
+    template <typename Q>
+    constexpr bool is_new_at(size_t index, const Q &key) const {
+        return index == keys.size() || compare(key, keys[index]);
+    }
+
+    /* Fills `tagged` with the elements of `[first, last)`, each paired with its position, then
+    sorts them by key (as given by `key_of` on the element) and removes all but the first of every
+    group of elements with equivalent keys, as if the elements were inserted one by one. This takes
+    a single sort (breaking ties by position, so that no stable sort, and so no buffer, is needed),
+    so building a container from `n` unsorted elements takes O(n log n) time rather than the O(n^2)
+    of inserting them one by one. */
+    template <typename Tagged, typename InputIt, typename KeyOf>
+    constexpr void sort_unique(Tagged &tagged, InputIt first, InputIt last, KeyOf key_of) const {
+        if constexpr (std::forward_iterator<InputIt>) {
+            tagged.reserve(std::distance(first, last));
+        }
+        for (size_t position = 0; first != last; ++first, ++position) {
+            tagged.emplace_back(*first, position);
+        }
+        std::sort(tagged.begin(), tagged.end(), [&](const auto &a, const auto &b) {
+            if (compare(key_of(a.first), key_of(b.first))) {
+                return true;
+            }
+            return !compare(key_of(b.first), key_of(a.first)) && a.second < b.second;
+        });
+        auto is_duplicate = [&](const auto &a, const auto &b) {
+            return !compare(key_of(a.first), key_of(b.first));
+        };
+        tagged.erase(std::unique(tagged.begin(), tagged.end(), is_duplicate), tagged.end());
+    }
+};
+
+}  /* namespace small_flat_map_detail */
+
+/* `SmallFlatSet<K, N, Compare, Allocator>` is an ordered set of unique keys, stored sorted (by
+`Compare`) in a `StackAssistedVector<K, N>`. Like that vector, it makes zero dynamic memory
+allocations until it holds more than `N` keys, and `reserve` preallocates space for more.
+
+Lookups take O(log n) time (see `SortedKeys` above for how small sets are searched), while
+insertions and erasures shift the keys after the position in question, so take O(n) time. This
+makes the set best suited to small sets, or to sets which are built once and then mostly queried;
+constructing the set from a range of (unsorted) keys sorts them and removes duplicates in one go.
+Inserting or erasing keys invalidates all iterators. */
+template <
+    typename K, size_t N, typename Compare = std::less<K>, typename Allocator = std::allocator<K>
+>
+struct SmallFlatSet {
+    using key_type        = K;
+    using value_type      = K;
+    using key_compare     = Compare;
+    using value_compare   = Compare;
+    using allocator_type  = Allocator;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using reference       = const K&;
+    using const_reference = const K&;
+    /* The keys of a set must not be modified, so both iterators are const */
+    using iterator        = typename StackAssistedVector<K, N, Allocator>::const_iterator;
+    using const_iterator  = iterator;
+
+    /* --- CONSTRUCTORS --- */
+
+    /* Constructs an empty `SmallFlatSet`. */
+    constexpr SmallFlatSet(const Compare &compare = {}, const Allocator &allocator = {})
+    : sorted(compare, allocator) {}
+
+    constexpr SmallFlatSet(const Allocator &allocator) : sorted(Compare(), allocator) {}
+
+    /* Constructs a `SmallFlatSet` holding the keys in `[first, last)`, which need not be sorted,
+    keeping only the first of any equivalent keys. */
+    template <std::input_iterator InputIt>
+    constexpr SmallFlatSet(
+        InputIt first, InputIt last, const Compare &compare = {}, const Allocator &allocator = {}
+    ) : sorted(compare, allocator) {
+        using Tagged = std::pair<K, size_t>;
+        using TaggedAllocator =
+            typename std::allocator_traits<Allocator>::template rebind_alloc<Tagged>;
+        StackAssistedVector<Tagged, N, TaggedAllocator> tagged{TaggedAllocator(allocator)};
+        sorted.sort_unique(tagged, first, last, std::identity{});
+        sorted.keys.reserve(tagged.size());
+        for (auto &[key, position] : tagged) {
+            sorted.keys.push_back(std::move(key));
+        }
+    }
+
+    constexpr SmallFlatSet(
+        std::initializer_list<K> init, const Compare &compare = {}, const Allocator &allocator = {}
+    ) : SmallFlatSet(init.begin(), init.end(), compare, allocator) {}
+
+    /* --- ITERATORS --- */
+
+    constexpr iterator begin() const { return sorted.keys.begin(); }
+    constexpr iterator cbegin() const { return begin(); }
+    constexpr iterator end() const { return sorted.keys.end(); }
+    constexpr iterator cend() const { return end(); }
+
+    /* --- GETTERS --- */
+
+    constexpr bool empty() const { return sorted.keys.empty(); }
+    constexpr size_type size() const { return sorted.keys.size(); }
+    constexpr size_type capacity() const { return sorted.keys.capacity(); }
+    constexpr key_compare key_comp() const { return sorted.compare; }
+
+    /* Returns the keys, in sorted order, as a contiguous array. */
+    constexpr std::span<const K> keys() const { return {sorted.keys.begin(), sorted.keys.end()}; }
+
+    /* --- LOOKUP --- */
+
+    /* Returns an iterator to the key equivalent to `key`, or `end()` if there is none. */
+    constexpr iterator find(const K &key) const { return begin() + sorted.find_index(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr iterator find(const Q &key) const { return begin() + sorted.find_index(key); }
+
+    /* Returns true iff the set holds a key equivalent to `key`. */
+    constexpr bool contains(const K &key) const { return find(key) != end(); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr bool contains(const Q &key) const { return find(key) != end(); }
+
+    /* Returns the number of keys equivalent to `key` (which is either 0 or 1). */
+    constexpr size_type count(const K &key) const { return contains(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr size_type count(const Q &key) const { return contains(key); }
+
+    /* Returns an iterator to the first key which is not less than `key`. */
+    constexpr iterator lower_bound(const K &key) const {
+        return begin() + sorted.lower_bound_index(key);
+    }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr iterator lower_bound(const Q &key) const {
+        return begin() + sorted.lower_bound_index(key);
+    }
+
+    /* --- MODIFIERS --- */
+
+    /* Reserves space for at least `new_capacity` keys. */
+    constexpr void reserve(size_type new_capacity) { sorted.keys.reserve(new_capacity); }
+
+    constexpr void clear() { sorted.keys.clear(); }
+
+    /* Inserts `key` unless the set already holds an equivalent key. Returns an iterator to the key
+    in the set, and whether it was inserted. */
+    constexpr std::pair<iterator, bool> insert(const K &key) { return insert_key(key); }
+    constexpr std::pair<iterator, bool> insert(K &&key) { return insert_key(std::move(key)); }
+
+    /* Inserts every key in `[first, last)`, as `insert(*it)` would. */
+    template <std::input_iterator InputIt>
+    constexpr void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    /* Constructs a key from `args`, and inserts it as `insert` would. */
+    template <typename... Ts>
+    constexpr std::pair<iterator, bool> emplace(Ts&&... args) {
+        return insert_key(K(std::forward<Ts>(args)...));
+    }
+
+    /* Erases the key at `position`, and returns an iterator to the key after it. */
+    constexpr iterator erase(const_iterator position) { return sorted.keys.erase(position); }
+
+    /* Erases the key equivalent to `key`, if any, and returns the number of keys erased. */
+    constexpr size_type erase(const K &key) { return erase_key(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare> && (!std::is_convertible_v<Q, iterator>)
+    constexpr size_type erase(const Q &key) { return erase_key(key); }
+
+    /* Two sets are equal iff they hold equal keys. */
+    friend constexpr bool operator== (const SmallFlatSet &a, const SmallFlatSet &b) {
+        return std::ranges::equal(a.keys(), b.keys());
+    }
+
+private:
+    small_flat_map_detail::SortedKeys<K, N, Compare, Allocator> sorted;
+
+    template <typename Key>
+    constexpr std::pair<iterator, bool> insert_key(Key &&key) {
+        auto index = sorted.lower_bound_index(key);
+        if (!sorted.is_new_at(index, key)) {
+            return {begin() + index, false};
+        }
+        sorted.keys.insert(sorted.keys.begin() + index, std::forward<Key>(key));
+        return {begin() + index, true};
+    }
+
+    template <typename Q>
+    constexpr size_type erase_key(const Q &key) {
+        auto index = sorted.find_index(key);
+        if (index == size()) {
+            return 0;
+        }
+        sorted.keys.erase(sorted.keys.begin() + index);
+        return 1;
+    }
+};
+
+/* `SmallFlatMap<K, V, N, Compare, Allocator>` is an ordered map from unique keys to values, which
+stores its keys sorted (by `Compare`) in one `StackAssistedVector<K, N>` and the corresponding
+values in another `StackAssistedVector<V, N>`. Like `SmallFlatSet`, it makes zero dynamic memory
+allocations until it holds more than `N` entries, and has O(log n) lookups but O(n) insertions
+and erasures. Keeping the keys apart from the values means that searches only touch the keys
+(which, for arithmetic keys, lets small maps be searched with SIMD instructions), and that either
+can be used as a contiguous array through `keys()` and `values()`.
+
+As a consequence, iterators do not point to `std::pair<const K, V>` objects, but dereference to
+`std::pair<const K&, V&>` proxies, so `it->first`, `it->second` and `auto [key, value] = *it` all
+work as usual, but `auto &entry = *it` does not compile. Inserting or erasing entries invalidates
+all iterators. */
+template <
+    typename K, typename V, size_t N, typename Compare = std::less<K>,
+    typename Allocator = std::allocator<std::pair<const K, V>>
+>
+struct SmallFlatMap {
+private:
+    using KeyAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<K>;
+    using ValueAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<V>;
+
+    /* Iterates over the entries of a `SmallFlatMap`, as a pointer into the keys along with a
+    pointer into the values. */
+    template <bool Const>
+    struct Iterator {
+        using Value = std::conditional_t<Const, const V, V>;
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = std::pair<K, V>;
+        using difference_type   = ptrdiff_t;
+        using reference         = std::pair<const K&, Value&>;
+
+        /* `operator->` returns a proxy holding the `reference`, as there is no pair to point to */
+        struct pointer {
+            reference entry;
+            constexpr const reference* operator-> () const { return &entry; }
+        };
+
+        const K *key = nullptr;
+        Value *value = nullptr;
+
+        constexpr Iterator() = default;
+        constexpr Iterator(const K *key_, Value *value_) : key{key_}, value{value_} {}
+
+        /* An `iterator` converts to a `const_iterator` */
+        template <bool OtherConst>
+        requires (Const && !OtherConst)
+        constexpr Iterator(const Iterator<OtherConst> &other)
+        : key{other.key}, value{other.value} {}
+
+        constexpr reference operator* () const { return {*key, *value}; }
+        constexpr pointer operator-> () const { return {**this}; }
+        constexpr reference operator[] (difference_type n) const { return *(*this + n); }
+
+        constexpr Iterator& operator++ () { ++key; ++value; return *this; }
+        constexpr Iterator& operator-- () { --key; --value; return *this; }
+        constexpr Iterator operator++ (int) { auto old = *this; ++*this; return old; }
+        constexpr Iterator operator-- (int) { auto old = *this; --*this; return old; }
+        constexpr Iterator& operator+= (difference_type n) { key += n; value += n; return *this; }
+        constexpr Iterator& operator-= (difference_type n) { key -= n; value -= n; return *this; }
+
+        friend constexpr Iterator operator+ (Iterator it, difference_type n) { return it += n; }
+        friend constexpr Iterator operator+ (difference_type n, Iterator it) { return it += n; }
+        friend constexpr Iterator operator- (Iterator it, difference_type n) { return it -= n; }
+        friend constexpr difference_type operator- (const Iterator &a, const Iterator &b) {
+            return a.key - b.key;
+        }
+        friend constexpr bool operator== (const Iterator &a, const Iterator &b) {
+            return a.key == b.key;
+        }
+        friend constexpr auto operator<=> (const Iterator &a, const Iterator &b) {
+            return a.key <=> b.key;
+        }
+    };
+
+public:
+    using key_type        = K;
+    using mapped_type     = V;
+    using value_type      = std::pair<K, V>;
+    using key_compare     = Compare;
+    using allocator_type  = Allocator;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using reference       = std::pair<const K&, V&>;
+    using const_reference = std::pair<const K&, const V&>;
+    using iterator        = Iterator<false>;
+    using const_iterator  = Iterator<true>;
+
+    /* --- CONSTRUCTORS --- */
+
+    /* Constructs an empty `SmallFlatMap`. */
+    constexpr SmallFlatMap(const Compare &compare = {}, const Allocator &allocator = {})
+    : sorted(compare, KeyAllocator(allocator)), mapped(ValueAllocator(allocator)) {}
+
+    constexpr SmallFlatMap(const Allocator &allocator) : SmallFlatMap(Compare(), allocator) {}
+
+    /* Constructs a `SmallFlatMap` holding the entries in `[first, last)`, which need not be sorted
+    by key. As with `std::map`, only the first of any entries with equivalent keys is kept. */
+    template <std::input_iterator InputIt>
+    constexpr SmallFlatMap(
+        InputIt first, InputIt last, const Compare &compare = {}, const Allocator &allocator = {}
+    ) : SmallFlatMap(compare, allocator) {
+        using Tagged = std::pair<value_type, size_t>;
+        using TaggedAllocator =
+            typename std::allocator_traits<Allocator>::template rebind_alloc<Tagged>;
+        StackAssistedVector<Tagged, N, TaggedAllocator> tagged{TaggedAllocator(allocator)};
+        sorted.sort_unique(
+            tagged, first, last, [](const value_type &entry) -> const K& { return entry.first; }
+        );
+        reserve(tagged.size());
+        for (auto &[entry, position] : tagged) {
+            sorted.keys.push_back(std::move(entry.first));
+            mapped.push_back(std::move(entry.second));
+        }
+    }
+
+    constexpr SmallFlatMap(
+        std::initializer_list<value_type> init,
+        const Compare &compare = {}, const Allocator &allocator = {}
+    ) : SmallFlatMap(init.begin(), init.end(), compare, allocator) {}
+
+    /* --- ITERATORS --- */
+
+    constexpr iterator begin() { return {sorted.keys.begin(), mapped.begin()}; }
+    constexpr const_iterator begin() const { return {sorted.keys.begin(), mapped.begin()}; }
+    constexpr const_iterator cbegin() const { return begin(); }
+    constexpr iterator end() { return begin() + size(); }
+    constexpr const_iterator end() const { return begin() + size(); }
+    constexpr const_iterator cend() const { return end(); }
+
+    /* --- GETTERS --- */
+
+    constexpr bool empty() const { return sorted.keys.empty(); }
+    constexpr size_type size() const { return sorted.keys.size(); }
+    constexpr size_type capacity() const { return sorted.keys.capacity(); }
+    constexpr key_compare key_comp() const { return sorted.compare; }
+
+    /* Returns the keys, in sorted order, as a contiguous array. */
+    constexpr std::span<const K> keys() const { return {sorted.keys.begin(), sorted.keys.end()}; }
+
+    /* Returns the values, in the order of their keys, as a contiguous array. */
+    constexpr std::span<V> values() { return {mapped.begin(), mapped.end()}; }
+    constexpr std::span<const V> values() const { return {mapped.begin(), mapped.end()}; }
+
+    /* --- LOOKUP --- */
+
+    /* Returns an iterator to the entry whose key is equivalent to `key`, or `end()` if there is
+    none. */
+    constexpr iterator find(const K &key) { return begin() + sorted.find_index(key); }
+    constexpr const_iterator find(const K &key) const { return begin() + sorted.find_index(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr iterator find(const Q &key) { return begin() + sorted.find_index(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr const_iterator find(const Q &key) const { return begin() + sorted.find_index(key); }
+
+    /* Returns true iff the map holds an entry whose key is equivalent to `key`. */
+    constexpr bool contains(const K &key) const { return find(key) != end(); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr bool contains(const Q &key) const { return find(key) != end(); }
+
+    /* Returns the number of entries whose key is equivalent to `key` (which is either 0 or 1). */
+    constexpr size_type count(const K &key) const { return contains(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr size_type count(const Q &key) const { return contains(key); }
+
+    /* Returns an iterator to the first entry whose key is not less than `key`. */
+    constexpr iterator lower_bound(const K &key) {
+        return begin() + sorted.lower_bound_index(key);
+    }
+    constexpr const_iterator lower_bound(const K &key) const {
+        return begin() + sorted.lower_bound_index(key);
+    }
+
+    /* Returns the value whose key is equivalent to `key`, and throws `std::out_of_range` if there
+    is none. */
+    constexpr V& at(const K &key) { return mapped[checked_index(key)]; }
+    constexpr const V& at(const K &key) const { return mapped[checked_index(key)]; }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr V& at(const Q &key) { return mapped[checked_index(key)]; }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare>
+    constexpr const V& at(const Q &key) const { return mapped[checked_index(key)]; }
+
+    /* Returns the value whose key is equivalent to `key`, inserting a value-initialized one if
+    there is none. */
+    constexpr V& operator[] (const K &key) { return try_emplace(key).first->second; }
+    constexpr V& operator[] (K &&key) { return try_emplace(std::move(key)).first->second; }
+
+    /* --- MODIFIERS --- */
+
+    /* Reserves space for at least `new_capacity` entries. */
+    constexpr void reserve(size_type new_capacity) {
+        sorted.keys.reserve(new_capacity);
+        mapped.reserve(new_capacity);
+    }
+
+    constexpr void clear() {
+        sorted.keys.clear();
+        mapped.clear();
+    }
+
+    /* Inserts a value constructed from `args` under `key`, unless the map already holds an entry
+    whose key is equivalent to `key` (in which case nothing is constructed, and `args` are left
+    untouched). Returns an iterator to the entry under `key`, and whether it was inserted. */
+    template <typename... Ts>
+    constexpr std::pair<iterator, bool> try_emplace(const K &key, Ts&&... args) {
+        return try_emplace_key(key, std::forward<Ts>(args)...);
+    }
+    template <typename... Ts>
+    constexpr std::pair<iterator, bool> try_emplace(K &&key, Ts&&... args) {
+        return try_emplace_key(std::move(key), std::forward<Ts>(args)...);
+    }
+
+    /* Inserts `entry`, unless the map already holds an entry whose key is equivalent to
+    `entry.first`. Returns an iterator to the entry under that key, and whether it was inserted. */
+    constexpr std::pair<iterator, bool> insert(const value_type &entry) {
+        return try_emplace_key(entry.first, entry.second);
+    }
+    constexpr std::pair<iterator, bool> insert(value_type &&entry) {
+        return try_emplace_key(std::move(entry.first), std::move(entry.second));
+    }
+
+    /* Inserts every entry in `[first, last)`, as `insert(*it)` would. */
+    template <std::input_iterator InputIt>
+    constexpr void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    /* Constructs an entry from `args`, and inserts it as `insert` would. */
+    template <typename... Ts>
+    constexpr std::pair<iterator, bool> emplace(Ts&&... args) {
+        return insert(value_type(std::forward<Ts>(args)...));
+    }
+
+    /* Assigns `value` to the value under `key`, or inserts it under `key` if there is none.
+    Returns an iterator to the entry under `key`, and whether it was inserted. */
+    template <typename M>
+    constexpr std::pair<iterator, bool> insert_or_assign(const K &key, M &&value) {
+        return insert_or_assign_key(key, std::forward<M>(value));
+    }
+    template <typename M>
+    constexpr std::pair<iterator, bool> insert_or_assign(K &&key, M &&value) {
+        return insert_or_assign_key(std::move(key), std::forward<M>(value));
+    }
+
+    /* Erases the entry at `position`, and returns an iterator to the entry after it. */
+    constexpr iterator erase(const_iterator position) {
+        auto index = position - begin();
+        sorted.keys.erase(sorted.keys.begin() + index);
+        mapped.erase(mapped.begin() + index);
+        return begin() + index;
+    }
+    constexpr iterator erase(iterator position) { return erase(const_iterator(position)); }
+
+    /* Erases the entry whose key is equivalent to `key`, if any, and returns the number of entries
+    erased. */
+    constexpr size_type erase(const K &key) { return erase_key(key); }
+    template <typename Q>
+    requires small_flat_map_detail::transparent<Compare> &&
+             (!std::is_convertible_v<Q, const_iterator>)
+    constexpr size_type erase(const Q &key) { return erase_key(key); }
+
+    /* Two maps are equal iff they hold equal keys, mapped to equal values. */
+    friend constexpr bool operator== (const SmallFlatMap &a, const SmallFlatMap &b) {
+        return std::ranges::equal(a.keys(), b.keys()) &&
+               std::ranges::equal(a.values(), b.values());
+    }
+
+private:
+    /* The keys, and the value of every key at the same index */
+    small_flat_map_detail::SortedKeys<K, N, Compare, KeyAllocator> sorted;
+    StackAssistedVector<V, N, ValueAllocator> mapped;
+
+    /* Returns the index of the entry under `key`, and throws `std::out_of_range` if there is
+    none. */
+    template <typename Q>
+    constexpr size_type checked_index(const Q &key) const {
+        auto index = sorted.find_index(key);
+        if (index == size()) {
+            throw std::out_of_range("SmallFlatMap: key not found");
+        }
+        return index;
+    }
+
+    template <typename Key, typename... Ts>
+    constexpr std::pair<iterator, bool> try_emplace_key(Key &&key, Ts&&... args) {
+        auto index = sorted.lower_bound_index(key);
+        if (!sorted.is_new_at(index, key)) {
+            return {begin() + index, false};
+        }
+        insert_at(index, std::forward<Key>(key), std::forward<Ts>(args)...);
+        return {begin() + index, true};
+    }
+
+    template <typename Key, typename M>
+    constexpr std::pair<iterator, bool> insert_or_assign_key(Key &&key, M &&value) {
+        auto index = sorted.lower_bound_index(key);
+        if (!sorted.is_new_at(index, key)) {
+            mapped[index] = std::forward<M>(value);
+            return {begin() + index, false};
+        }
+        insert_at(index, std::forward<Key>(key), std::forward<M>(value));
+        return {begin() + index, true};
+    }
+
+    /* Inserts `key` and a value constructed from `args` at `index`. If inserting the value throws,
+    the key is erased again, so that every key keeps its value. */
+    template <typename Key, typename... Ts>
+    constexpr void insert_at(size_type index, Key &&key, Ts&&... args) {
+        sorted.keys.insert(sorted.keys.begin() + index, K(std::forward<Key>(key)));
+        try {
+            mapped.insert(mapped.begin() + index, V(std::forward<Ts>(args)...));
+        } catch (...) {
+            sorted.keys.erase(sorted.keys.begin() + index);
+            throw;
+        }
+    }
+
+    template <typename Q>
+    constexpr size_type erase_key(const Q &key) {
+        auto index = sorted.find_index(key);
+        if (index == size()) {
+            return 0;
+        }
+        erase(begin() + index);
+        return 1;
+    }
+};
+
+/* Specialize `std::formatter` for `SmallFlatSet<K, N, Compare, Allocator>` */
+template <typename K, size_t N, typename Compare, typename Allocator>
+struct std::formatter<SmallFlatSet<K, N, Compare, Allocator>> : public std::formatter<std::string>
+{
+    auto format(
+        const SmallFlatSet<K, N, Compare, Allocator> &set, std::format_context &format_context
+    ) const {
+        auto output = format_context.out();
+        std::format_to(output, "{{");
+        if (!set.empty()) {
+            std::format_to(output, "{}", *set.begin());
+            for (auto it = set.begin() + 1; it != set.end(); ++it) {
+                std::format_to(output, ", {}", *it);
+            }
+        }
+        std::format_to(output, "}}");
+        return output;
+    }
+};
+
+/* Specialize `std::formatter` for `SmallFlatMap<K, V, N, Compare, Allocator>` */
+template <typename K, typename V, size_t N, typename Compare, typename Allocator>
+struct std::formatter<SmallFlatMap<K, V, N, Compare, Allocator>>
+: public std::formatter<std::string>
+{
+    auto format(
+        const SmallFlatMap<K, V, N, Compare, Allocator> &map, std::format_context &format_context
+    ) const {
+        auto output = format_context.out();
+        std::format_to(output, "{{");
+        if (!map.empty()) {
+            std::format_to(output, "{}: {}", map.begin()->first, map.begin()->second);
+            for (auto it = map.begin() + 1; it != map.end(); ++it) {
+                std::format_to(output, ", {}: {}", it->first, it->second);
+            }
+        }
+        std::format_to(output, "}}");
+        return output;
+    }
+};
+
+#endif
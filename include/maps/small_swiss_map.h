@@ -0,0 +1,879 @@
+/*
+@file small_swiss_map.h
+@brief Defines and implements `SmallSwissMap<K, V, N>`, an open-addressing hash map in the style
+of Abseil's Swiss tables, whose table is stored inline (making zero dynamic memory allocations)
+until it holds more than `N` entries.
+
+This file includes the following types:
+- `SmallSwissMap<K, V, N, Hash, KeyEqual, Allocator, MaxLoadFactor>`
+*/
+
+#ifndef SMALL_SWISS_MAP_H
+#define SMALL_SWISS_MAP_H
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ratio>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "vector_variations/relocation.h"
+#include "vector_variations/stack_assisted_vector.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace swiss_map_detail {
+
+/* The table is split into groups of `group_size` slots, whose control bytes are matched at once */
+inline constexpr size_t group_size = 16;
+
+/* Every slot has a control byte, which is either `empty`, `deleted` (a tombstone, which lookups
+must probe past), or, if the slot is full, the low 7 bits of the hash of its key (so it is
+non-negative). After the last control byte comes a `sentinel`, at which iteration stops. */
+inline constexpr int8_t empty = -128;
+inline constexpr int8_t deleted = -2;
+inline constexpr int8_t sentinel = -1;
+
+/* `Group` holds the control bytes of one group, and returns bitmasks (bit `i` for slot `i`) of the
+slots whose control bytes match some condition. With SSE2 (part of the x86-64 baseline), each
+match is a single comparison and `movemask`; otherwise, the bytes are compared one at a time. */
+struct Group {
+#if defined(__SSE2__)
+    __m128i bytes;
+
+    explicit Group(const int8_t *ctrl)
+    : bytes{_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))} {}
+
+    /* Slots whose control byte is `value` */
+    uint32_t match(int8_t value) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), bytes)));
+    }
+
+    /* Slots which are `empty` or `deleted`, i.e. whose control byte is below `sentinel` */
+    uint32_t match_free() const {
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(sentinel), bytes))
+        );
+    }
+#else
+    const int8_t *bytes;
+
+    explicit Group(const int8_t *ctrl) : bytes{ctrl} {}
+
+    uint32_t match(int8_t value) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_size; ++i) {
+            mask |= static_cast<uint32_t>(bytes[i] == value) << i;
+        }
+        return mask;
+    }
+
+    uint32_t match_free() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_size; ++i) {
+            mask |= static_cast<uint32_t>(bytes[i] < sentinel) << i;
+        }
+        return mask;
+    }
+#endif
+
+    uint32_t match_empty() const { return match(empty); }
+};
+
+/* `transparent_lookup<Hash, KeyEqual>` is satisfied iff both `Hash` and `KeyEqual` accept types
+other than the key type, in which case the lookup functions accept any such type. */
+template <typename Hash, typename KeyEqual>
+concept transparent_lookup =
+    requires { typename Hash::is_transparent; typename KeyEqual::is_transparent; };
+
+}  /* namespace swiss_map_detail */
+
+/* `SmallSwissMap<K, V, N, Hash, KeyEqual, Allocator, MaxLoadFactor>` is an unordered map from
+unique keys to values, which stores its entries in an open-addressing hash table (a "Swiss table").
+
+The table has a power-of-two number of slots, which are split into groups of 16. Every slot has a
+one-byte control byte, which is either empty, deleted, or holds 7 bits of the hash of the slot's
+key (`H2`), while the other bits of the hash (`H1`) choose the group at which probing starts. A
+lookup compares the control bytes of a whole group with `H2` at once (with SSE2 instructions where
+available), and so only compares keys that (almost certainly) match; it then moves on to further
+groups (quadratically) until it finds a group with an empty slot. Erasing an entry marks its slot
+as deleted, unless its group still has an empty slot (in which case no probe can have passed the
+group, and the slot is simply marked as empty).
+
+Like `StackAssistedVector`, the map keeps its table inline (in the map object itself) while it is
+small: the inline table has the fewest slots that hold `N` entries under the maximum load factor,
+so the map makes zero dynamic memory allocations until it holds more than `N` entries. Beyond
+that, the table lives on the heap, and doubles whenever the number of entries and deleted slots
+would exceed the maximum load factor (`MaxLoadFactor`, a `std::ratio`, 7/8 by default). If most of
+those are deleted slots, the table is instead rebuilt at the same size. `reserve(n)` sizes the
+table for `n` entries up front, and `rehash(n)` rebuilds it with at least `n` slots (or as few as
+the entries allow, which may bring it back inline).
+
+Entries never move, except when the table is rebuilt, which invalidates all iterators; erasing an
+entry only invalidates iterators to that entry. As in `SmallFlatMap`, the key and value of an entry
+are stored as a `std::pair<K, V>` (rather than a `std::pair<const K, V>`, so that rebuilding the
+table can move keys rather than copy them), and iterators dereference to `std::pair<const K&, V&>`
+proxies, so `it->second` and `auto [key, value] = *it` work as usual, but `auto &entry = *it`
+does not compile. */
+template <
+    typename K, typename V, size_t N,
+    typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+    typename Allocator = std::allocator<std::pair<const K, V>>,
+    typename MaxLoadFactor = std::ratio<7, 8>
+>
+requires (N > 0 && MaxLoadFactor::num > 0 && MaxLoadFactor::num < MaxLoadFactor::den)
+struct SmallSwissMap {
+private:
+    using Slot = std::pair<K, V>;
+    using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+    using SlotTraits = std::allocator_traits<SlotAllocator>;
+    using CtrlAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<int8_t>;
+    using CtrlTraits = std::allocator_traits<CtrlAllocator>;
+
+    static constexpr size_t group_size = swiss_map_detail::group_size;
+
+    /* Iterates over the full slots of a `SmallSwissMap`, as a pointer into the control bytes
+    along with a pointer into the slots. */
+    template <bool Const>
+    struct Iterator {
+        using Value = std::conditional_t<Const, const V, V>;
+        using SlotPointer = std::conditional_t<Const, const Slot*, Slot*>;
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::pair<K, V>;
+        using difference_type   = ptrdiff_t;
+        using reference         = std::pair<const K&, Value&>;
+
+        /* `operator->` returns a proxy holding the `reference`, as there is no pair to point to */
+        struct pointer {
+            reference entry;
+            constexpr const reference* operator-> () const { return &entry; }
+        };
+
+        const int8_t *ctrl = nullptr;
+        SlotPointer slot = nullptr;
+
+        Iterator() = default;
+        Iterator(const int8_t *ctrl_, SlotPointer slot_) : ctrl{ctrl_}, slot{slot_} {}
+
+        /* An `iterator` converts to a `const_iterator` */
+        template <bool OtherConst>
+        requires (Const && !OtherConst)
+        Iterator(const Iterator<OtherConst> &other) : ctrl{other.ctrl}, slot{other.slot} {}
+
+        reference operator* () const { return {slot->first, slot->second}; }
+        pointer operator-> () const { return {**this}; }
+
+        Iterator& operator++ () {
+            ++ctrl;
+            ++slot;
+            skip_free_slots();
+            return *this;
+        }
+        Iterator operator++ (int) { auto old = *this; ++*this; return old; }
+
+        friend bool operator== (const Iterator &a, const Iterator &b) { return a.ctrl == b.ctrl; }
+
+        /* Advances to the next full slot, or to the sentinel */
+        void skip_free_slots() {
+            while (*ctrl < swiss_map_detail::sentinel) {
+                ++ctrl;
+                ++slot;
+            }
+        }
+    };
+
+public:
+    using key_type        = K;
+    using mapped_type     = V;
+    using value_type      = std::pair<K, V>;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using allocator_type  = Allocator;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using reference       = std::pair<const K&, V&>;
+    using const_reference = std::pair<const K&, const V&>;
+    using iterator        = Iterator<false>;
+    using const_iterator  = Iterator<true>;
+
+    /* --- CONSTRUCTORS --- */
+
+    /* Constructs an empty `SmallSwissMap`, with an inline table. */
+    SmallSwissMap(
+        const Hash &hash = {}, const KeyEqual &equal = {}, const Allocator &allocator_ = {}
+    ) : hasher_{hash}, key_equal_{equal}, allocator{allocator_} {
+        reset_to_inline_table();
+    }
+
+    SmallSwissMap(const Allocator &allocator_) : SmallSwissMap(Hash(), KeyEqual(), allocator_) {}
+
+    /* Constructs a `SmallSwissMap` holding the entries in `[first, last)`, keeping only the first
+    of any entries with equivalent keys. */
+    template <std::input_iterator InputIt>
+    SmallSwissMap(
+        InputIt first, InputIt last,
+        const Hash &hash = {}, const KeyEqual &equal = {}, const Allocator &allocator_ = {}
+    ) : SmallSwissMap(hash, equal, allocator_) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            reserve(std::distance(first, last));
+        }
+        insert(first, last);
+    }
+
+    SmallSwissMap(
+        std::initializer_list<value_type> init,
+        const Hash &hash = {}, const KeyEqual &equal = {}, const Allocator &allocator_ = {}
+    ) : SmallSwissMap(init.begin(), init.end(), hash, equal, allocator_) {}
+
+    /* Copies the table of `other` as is, control bytes and all, so no key is hashed again. */
+    SmallSwissMap(const SmallSwissMap &other)
+    : hasher_{other.hasher_}, key_equal_{other.key_equal_},
+      allocator{SlotTraits::select_on_container_copy_construction(other.allocator)} {
+        reset_to_inline_table();
+        copy_table_from(other);
+    }
+
+    /* Steals the table of `other` if it is on the heap, or moves its entries otherwise. Either
+    way, `other` is left empty, with an inline table. */
+    SmallSwissMap(SmallSwissMap &&other)
+    : hasher_{std::move(other.hasher_)}, key_equal_{std::move(other.key_equal_)},
+      allocator{std::move(other.allocator)} {
+        take_table_from(other);
+    }
+
+    /* Replaces this map's entries with copies of `other`'s, copying its table as the copy
+    constructor does. As with `std::unordered_map`, `other`'s allocator is copied iff
+    `propagate_on_container_copy_assignment` is true. If copying an entry throws, the map is left
+    empty. */
+    SmallSwissMap& operator= (const SmallSwissMap &other) {
+        if (this != &other) {
+            release_table();
+            hasher_ = other.hasher_;
+            key_equal_ = other.key_equal_;
+            if constexpr (SlotTraits::propagate_on_container_copy_assignment::value) {
+                allocator = other.allocator;
+            }
+            copy_table_from(other);
+        }
+        return *this;
+    }
+
+    /* Like the move constructor, after destroying this map's entries, if `other`'s table may be
+    freed by this map's allocator: that is, if `propagate_on_container_move_assignment` is true
+    (in which case the allocator is moved along with the table), or if the allocators are equal.
+    Otherwise, `other`'s entries are moved one by one into a table allocated with this map's
+    allocator. Either way, `other` is left empty. */
+    SmallSwissMap& operator= (SmallSwissMap &&other) {
+        if (this != &other) {
+            release_table();
+            hasher_ = std::move(other.hasher_);
+            key_equal_ = std::move(other.key_equal_);
+            constexpr bool propagate = SlotTraits::propagate_on_container_move_assignment::value;
+            if (propagate || allocator == other.allocator) {
+                if constexpr (propagate) {
+                    allocator = std::move(other.allocator);
+                }
+                take_table_from(other);
+            } else {
+                reserve(other.size_);
+                for (size_t i = 0; i < other.capacity_; ++i) {
+                    if (is_full(other.ctrl()[i])) {
+                        insert_moved_entry(other.slots()[i]);
+                    }
+                }
+                other.release_table();
+            }
+        }
+        return *this;
+    }
+
+    ~SmallSwissMap() {
+        destroy_entries();
+        deallocate_heap_table();
+    }
+
+    /* --- ITERATORS --- */
+
+    iterator begin() { return iterator_at_or_after(0); }
+    const_iterator begin() const { return iterator_at_or_after(0); }
+    const_iterator cbegin() const { return begin(); }
+    iterator end() { return iterator_at(capacity_); }
+    const_iterator end() const { return iterator_at(capacity_); }
+    const_iterator cend() const { return end(); }
+
+    /* --- GETTERS --- */
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    /* Returns the number of slots in the table */
+    size_type capacity() const { return capacity_; }
+    size_type bucket_count() const { return capacity_; }
+
+    /* Returns true iff the table is stored inline, rather than on the heap */
+    bool is_inline() const { return heap_ctrl == nullptr; }
+
+    float load_factor() const { return static_cast<float>(size_) / capacity_; }
+    static constexpr float max_load_factor() {
+        return static_cast<float>(MaxLoadFactor::num) / MaxLoadFactor::den;
+    }
+
+    hasher hash_function() const { return hasher_; }
+    key_equal key_eq() const { return key_equal_; }
+
+    /* --- LOOKUP --- */
+
+    /* Returns an iterator to the entry whose key is equal to `key`, or `end()` if there is none. */
+    iterator find(const K &key) { return iterator_at(find_index(key)); }
+    const_iterator find(const K &key) const { return iterator_at(find_index(key)); }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual>
+    iterator find(const Q &key) { return iterator_at(find_index(key)); }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual>
+    const_iterator find(const Q &key) const { return iterator_at(find_index(key)); }
+
+    /* Returns true iff the map holds an entry whose key is equal to `key`. */
+    bool contains(const K &key) const { return find_index(key) != capacity_; }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual>
+    bool contains(const Q &key) const { return find_index(key) != capacity_; }
+
+    /* Returns the number of entries whose key is equal to `key` (which is either 0 or 1). */
+    size_type count(const K &key) const { return contains(key); }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual>
+    size_type count(const Q &key) const { return contains(key); }
+
+    /* Returns the value whose key is equal to `key`, and throws `std::out_of_range` if there is
+    none. */
+    V& at(const K &key) { return slots()[checked_index(key)].second; }
+    const V& at(const K &key) const { return slots()[checked_index(key)].second; }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual>
+    V& at(const Q &key) { return slots()[checked_index(key)].second; }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual>
+    const V& at(const Q &key) const { return slots()[checked_index(key)].second; }
+
+    /* Returns the value whose key is equal to `key`, inserting a value-initialized one if there
+    is none. */
+    V& operator[] (const K &key) { return try_emplace(key).first->second; }
+    V& operator[] (K &&key) { return try_emplace(std::move(key)).first->second; }
+
+    /* --- MODIFIERS --- */
+
+    /* Makes room for at least `n` entries in total, so that inserting them does not rebuild the
+    table. */
+    void reserve(size_type n) {
+        if (n > max_size_for(capacity_)) {
+            rebuild(capacity_for(n));
+        }
+    }
+
+    /* Rebuilds the table with at least `n` slots, or with the fewest slots that hold the current
+    entries (which may be the inline table) if `n` is smaller than that. This also clears out all
+    deleted slots. */
+    void rehash(size_type n) {
+        auto new_capacity = std::max(capacity_for(size_), std::bit_ceil(std::max(n, group_size)));
+        rebuild(std::max(new_capacity, inline_capacity));
+    }
+
+    /* Destroys every entry, but keeps the table. */
+    void clear() {
+        destroy_entries();
+        std::fill_n(ctrl(), capacity_, swiss_map_detail::empty);
+        size_ = 0;
+        growth_left = max_size_for(capacity_);
+    }
+
+    /* Inserts a value constructed from `args` under `key`, unless the map already holds an entry
+    whose key is equal to `key` (in which case nothing is constructed, and `args` are left
+    untouched). Returns an iterator to the entry under `key`, and whether it was inserted. */
+    template <typename... Ts>
+    std::pair<iterator, bool> try_emplace(const K &key, Ts&&... args) {
+        return try_emplace_key(key, std::forward<Ts>(args)...);
+    }
+    template <typename... Ts>
+    std::pair<iterator, bool> try_emplace(K &&key, Ts&&... args) {
+        return try_emplace_key(std::move(key), std::forward<Ts>(args)...);
+    }
+
+    /* Inserts `entry`, unless the map already holds an entry whose key is equal to `entry.first`.
+    Returns an iterator to the entry under that key, and whether it was inserted. */
+    std::pair<iterator, bool> insert(const value_type &entry) {
+        return try_emplace_key(entry.first, entry.second);
+    }
+    std::pair<iterator, bool> insert(value_type &&entry) {
+        return try_emplace_key(std::move(entry.first), std::move(entry.second));
+    }
+
+    /* Inserts every entry in `[first, last)`, as `insert(*it)` would. */
+    template <std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    /* Constructs an entry from `args`, and inserts it as `insert` would. */
+    template <typename... Ts>
+    std::pair<iterator, bool> emplace(Ts&&... args) {
+        return insert(value_type(std::forward<Ts>(args)...));
+    }
+
+    /* Assigns `value` to the value under `key`, or inserts it under `key` if there is none.
+    Returns an iterator to the entry under `key`, and whether it was inserted. */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const K &key, M &&value) {
+        return insert_or_assign_key(key, std::forward<M>(value));
+    }
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(K &&key, M &&value) {
+        return insert_or_assign_key(std::move(key), std::forward<M>(value));
+    }
+
+    /* Erases the entry at `position`, and returns an iterator to the entry after it. */
+    iterator erase(const_iterator position) {
+        auto index = static_cast<size_t>(position.ctrl - ctrl());
+        erase_at(index);
+        return iterator_at_or_after(index + 1);
+    }
+    iterator erase(iterator position) { return erase(const_iterator(position)); }
+
+    /* Erases the entry whose key is equal to `key`, if any, and returns the number of entries
+    erased. */
+    size_type erase(const K &key) { return erase_key(key); }
+    template <typename Q>
+    requires swiss_map_detail::transparent_lookup<Hash, KeyEqual> &&
+             (!std::is_convertible_v<Q, const_iterator>)
+    size_type erase(const Q &key) { return erase_key(key); }
+
+    /* Two maps are equal iff they hold the same keys, mapped to equal values. */
+    friend bool operator== (const SmallSwissMap &a, const SmallSwissMap &b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (auto [key, value] : a) {
+            auto index = b.find_index(key);
+            if (index == b.capacity_ || !(b.slots()[index].second == value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    /* Returns the number of entries a table of `capacity` slots may hold (counting deleted slots
+    as entries) under the maximum load factor */
+    static constexpr size_t max_size_for(size_t capacity) {
+        return capacity / MaxLoadFactor::den * MaxLoadFactor::num +
+               capacity % MaxLoadFactor::den * MaxLoadFactor::num / MaxLoadFactor::den;
+    }
+
+    /* Returns the fewest slots (a power of two, and at least one group) that hold `n` entries */
+    static constexpr size_t capacity_for(size_t n) {
+        size_t capacity = group_size;
+        while (max_size_for(capacity) < n) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    /* `inline_capacity` = The number of slots in the inline table, which holds `N` entries */
+    static constexpr size_t inline_capacity = capacity_for(N);
+
+    /* The inline table: the control bytes (and sentinel), and the slots, kept in an union so that
+    they are not constructed along with the map */
+    int8_t inline_ctrl[inline_capacity + 1];
+    union {
+        Slot inline_slots[inline_capacity];
+    };
+
+    /* The heap table, or `nullptr` while the inline table is in use */
+    int8_t *heap_ctrl = nullptr;
+    Slot *heap_slots = nullptr;
+
+    /* `capacity_` = The number of slots in the table; `size_` = The number of entries;
+    `growth_left` = The number of empty slots that may still be filled before the table must be
+    rebuilt */
+    size_t capacity_ = inline_capacity;
+    size_t size_ = 0;
+    size_t growth_left = max_size_for(inline_capacity);
+
+    [[no_unique_address]] Hash hasher_;
+    [[no_unique_address]] KeyEqual key_equal_;
+    [[no_unique_address]] SlotAllocator allocator;
+
+    int8_t* ctrl() { return (heap_ctrl ? heap_ctrl : inline_ctrl); }
+    const int8_t* ctrl() const { return (heap_ctrl ? heap_ctrl : inline_ctrl); }
+    Slot* slots() { return (heap_slots ? heap_slots : inline_slots); }
+    const Slot* slots() const { return (heap_slots ? heap_slots : inline_slots); }
+
+    static bool is_full(int8_t control) { return control >= 0; }
+
+    iterator iterator_at(size_t index) { return {ctrl() + index, slots() + index}; }
+    const_iterator iterator_at(size_t index) const { return {ctrl() + index, slots() + index}; }
+
+    /* Returns an iterator to the first full slot at or after `index` */
+    template <typename Self>
+    static auto iterator_at_or_after(Self &self, size_t index) {
+        auto it = self.iterator_at(index);
+        it.skip_free_slots();
+        return it;
+    }
+    iterator iterator_at_or_after(size_t index) { return iterator_at_or_after(*this, index); }
+    const_iterator iterator_at_or_after(size_t index) const {
+        return iterator_at_or_after(*this, index);
+    }
+
+    /* Returns the hash of `key`. The result of `Hash` is mixed first, as `std::hash` is the
+    identity for integers (which would leave `H2` the same for all small keys). */
+    template <typename Q>
+    size_t hash_of(const Q &key) const {
+        auto hash = static_cast<uint64_t>(hasher_(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    /* Calls `visit(group_start)` on the first slot of every group in the probe sequence of `hash`
+    until it returns true. The groups are probed quadratically (after the `i`th group, the next
+    one is `i` groups further), which visits every group once as the number of groups is a power
+    of two. */
+    template <typename F>
+    void probe(size_t hash, F &&visit) const {
+        auto group_mask = capacity_ / group_size - 1;
+        auto group = (hash >> 7) & group_mask;
+        for (size_t step = 1; !visit(group * group_size); ++step) {
+            group = (group + step) & group_mask;
+        }
+    }
+
+    /* Returns the index of the slot holding `key`, or `capacity_` if there is none */
+    template <typename Q>
+    size_t find_index(const Q &key) const { return find_index(key, hash_of(key)); }
+
+    template <typename Q>
+    size_t find_index(const Q &key, size_t hash) const {
+        auto result = capacity_;
+        auto control = h2(hash);
+        auto ctrl_ = ctrl();
+        auto slots_ = slots();
+        probe(hash, [&](size_t group_start) {
+            swiss_map_detail::Group group(ctrl_ + group_start);
+            for (auto mask = group.match(control); mask != 0; mask &= mask - 1) {
+                auto index = group_start + std::countr_zero(mask);
+                if (key_equal_(slots_[index].first, key)) {
+                    result = index;
+                    return true;
+                }
+            }
+            /* A group with an empty slot ends every probe sequence that reaches it */
+            return group.match_empty() != 0;
+        });
+        return result;
+    }
+
+    /* Returns the index of the first empty or deleted slot in the probe sequence of `hash` */
+    size_t find_free_index(size_t hash) const {
+        size_t result = 0;
+        probe(hash, [&](size_t group_start) {
+            auto mask = swiss_map_detail::Group(ctrl() + group_start).match_free();
+            result = group_start + std::countr_zero(mask);
+            return mask != 0;
+        });
+        return result;
+    }
+
+    template <typename Q>
+    size_t checked_index(const Q &key) const {
+        auto index = find_index(key);
+        if (index == capacity_) {
+            throw std::out_of_range("SmallSwissMap: key not found");
+        }
+        return index;
+    }
+
+    template <typename Key, typename... Ts>
+    std::pair<iterator, bool> try_emplace_key(Key &&key, Ts&&... args) {
+        auto hash = hash_of(key);
+        if (auto index = find_index(key, hash); index != capacity_) {
+            return {iterator_at(index), false};
+        }
+        auto index = insert_index(hash);
+        SlotTraits::construct(
+            allocator, slots() + index, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)),
+            std::forward_as_tuple(std::forward<Ts>(args)...)
+        );
+        mark_full(index, hash);
+        return {iterator_at(index), true};
+    }
+
+    template <typename Key, typename M>
+    std::pair<iterator, bool> insert_or_assign_key(Key &&key, M &&value) {
+        auto [it, inserted] = try_emplace_key(std::forward<Key>(key), std::forward<M>(value));
+        if (!inserted) {
+            it->second = std::forward<M>(value);
+        }
+        return {it, inserted};
+    }
+
+    /* Returns the index of the slot in which to insert a new entry with hash `hash`, rebuilding
+    the table first if that would take the last empty slot that the load factor allows */
+    size_t insert_index(size_t hash) {
+        auto index = find_free_index(hash);
+        if (growth_left == 0 && ctrl()[index] == swiss_map_detail::empty) {
+            /* If at least half of the slots counted against the load factor are deleted, rebuilding
+            the table at the same size is enough to make room */
+            auto full_enough = (size_ >= max_size_for(capacity_) / 2);
+            rebuild(full_enough ? capacity_ * 2 : capacity_);
+            index = find_free_index(hash);
+        }
+        return index;
+    }
+
+    /* Marks the slot at `index`, into which an entry with hash `hash` was just constructed, as
+    full */
+    void mark_full(size_t index, size_t hash) {
+        growth_left -= (ctrl()[index] == swiss_map_detail::empty);
+        ctrl()[index] = h2(hash);
+        ++size_;
+    }
+
+    void erase_at(size_t index) {
+        SlotTraits::destroy(allocator, slots() + index);
+        --size_;
+        auto group_start = index & ~(group_size - 1);
+        if (swiss_map_detail::Group(ctrl() + group_start).match_empty() != 0) {
+            ctrl()[index] = swiss_map_detail::empty;
+            ++growth_left;
+        } else {
+            ctrl()[index] = swiss_map_detail::deleted;
+        }
+    }
+
+    template <typename Q>
+    size_type erase_key(const Q &key) {
+        auto index = find_index(key);
+        if (index == capacity_) {
+            return 0;
+        }
+        erase_at(index);
+        return 1;
+    }
+
+    /* Switches to an empty inline table (without destroying any entries) */
+    void reset_to_inline_table() {
+        heap_ctrl = nullptr;
+        heap_slots = nullptr;
+        capacity_ = inline_capacity;
+        size_ = 0;
+        growth_left = max_size_for(inline_capacity);
+        std::fill_n(inline_ctrl, inline_capacity, swiss_map_detail::empty);
+        inline_ctrl[inline_capacity] = swiss_map_detail::sentinel;
+    }
+
+    /* Switches to a new, empty heap table of `capacity` slots (without destroying any entries or
+    deallocating the current table). Both arrays are allocated before the map is updated, so if
+    either allocation throws, the map keeps its current table. */
+    void allocate_heap_table(size_t capacity) {
+        CtrlAllocator ctrl_allocator(allocator);
+        auto new_ctrl = CtrlTraits::allocate(ctrl_allocator, capacity + 1);
+        Slot *new_slots;
+        try {
+            new_slots = SlotTraits::allocate(allocator, capacity);
+        } catch (...) {
+            CtrlTraits::deallocate(ctrl_allocator, new_ctrl, capacity + 1);
+            throw;
+        }
+        heap_ctrl = new_ctrl;
+        heap_slots = new_slots;
+        capacity_ = capacity;
+        size_ = 0;
+        growth_left = max_size_for(capacity);
+        std::fill_n(heap_ctrl, capacity, swiss_map_detail::empty);
+        heap_ctrl[capacity] = swiss_map_detail::sentinel;
+    }
+
+    /* Copies the table of `other` (control bytes and all) into this map, which must hold an empty
+    inline table. If copying an entry throws, the entries copied so far are destroyed and the heap
+    table (if any) is deallocated, leaving an empty inline table, before the exception is
+    rethrown. */
+    void copy_table_from(const SmallSwissMap &other) {
+        if (other.capacity_ != inline_capacity) {
+            allocate_heap_table(other.capacity_);
+        }
+        std::memcpy(ctrl(), other.ctrl(), capacity_ + 1);
+        size_t i = 0;
+        try {
+            for (; i < capacity_; ++i) {
+                if (is_full(ctrl()[i])) {
+                    SlotTraits::construct(allocator, slots() + i, other.slots()[i]);
+                }
+            }
+        } catch (...) {
+            for (size_t j = 0; j < i; ++j) {
+                if (is_full(ctrl()[j])) {
+                    SlotTraits::destroy(allocator, slots() + j);
+                }
+            }
+            deallocate_heap_table();
+            reset_to_inline_table();
+            throw;
+        }
+        size_ = other.size_;
+        growth_left = other.growth_left;
+    }
+
+    /* Destroys every entry and deallocates the heap table (if any), leaving an empty inline
+    table */
+    void release_table() {
+        destroy_entries();
+        deallocate_heap_table();
+        reset_to_inline_table();
+    }
+
+    void deallocate_heap_table() {
+        if (heap_ctrl) {
+            CtrlAllocator ctrl_allocator(allocator);
+            CtrlTraits::deallocate(ctrl_allocator, heap_ctrl, capacity_ + 1);
+            SlotTraits::deallocate(allocator, heap_slots, capacity_);
+        }
+    }
+
+    /* Destroys every entry (without updating the control bytes) */
+    void destroy_entries() {
+        if constexpr (!std::is_trivially_destructible_v<Slot>) {
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (is_full(ctrl()[i])) {
+                    SlotTraits::destroy(allocator, slots() + i);
+                }
+            }
+        }
+    }
+
+    /* Moves every entry into a new table of `new_capacity` slots (which is the inline table if
+    `new_capacity` is `inline_capacity`), clearing out all deleted slots. */
+    void rebuild(size_t new_capacity) {
+        auto old_ctrl = ctrl();
+        auto old_slots = slots();
+        auto old_capacity = capacity_;
+        auto old_size = size_;
+        auto old_heap_ctrl = heap_ctrl;
+        auto old_heap_slots = heap_slots;
+
+        if (new_capacity == inline_capacity && !old_heap_ctrl) {
+            /* Clearing out the deleted slots of the inline table: its entries are moved out to a
+            temporary (inline) buffer first */
+            StackAssistedVector<Slot, inline_capacity, SlotAllocator> entries(allocator);
+            for (size_t i = 0; i < old_capacity; ++i) {
+                if (is_full(old_ctrl[i])) {
+                    entries.push_back(std::move(old_slots[i]));
+                    SlotTraits::destroy(allocator, old_slots + i);
+                }
+            }
+            reset_to_inline_table();
+            for (auto &entry : entries) {
+                insert_moved_entry(entry);
+            }
+            return;
+        }
+
+        if (new_capacity == inline_capacity) {
+            reset_to_inline_table();
+        } else {
+            allocate_heap_table(new_capacity);
+        }
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (is_full(old_ctrl[i])) {
+                auto hash = hash_of(old_slots[i].first);
+                auto index = find_free_index(hash);
+                relocate_range(allocator, old_slots + i, 1, slots() + index);
+                mark_full(index, hash);
+            }
+        }
+        size_ = old_size;
+
+        if (old_heap_ctrl) {
+            CtrlAllocator ctrl_allocator(allocator);
+            CtrlTraits::deallocate(ctrl_allocator, old_heap_ctrl, old_capacity + 1);
+            SlotTraits::deallocate(allocator, old_heap_slots, old_capacity);
+        }
+    }
+
+    /* Move-constructs `entry` into a table that is known to have room for it and not to hold its
+    key */
+    void insert_moved_entry(Slot &entry) {
+        auto hash = hash_of(entry.first);
+        auto index = find_free_index(hash);
+        SlotTraits::construct(allocator, slots() + index, std::move(entry));
+        mark_full(index, hash);
+    }
+
+    /* Takes over the table of `other` (see the move constructor), assuming that this map holds no
+    entries and no heap table */
+    void take_table_from(SmallSwissMap &other) {
+        if (other.heap_ctrl) {
+            heap_ctrl = other.heap_ctrl;
+            heap_slots = other.heap_slots;
+            capacity_ = other.capacity_;
+        } else {
+            reset_to_inline_table();
+            std::memcpy(inline_ctrl, other.inline_ctrl, inline_capacity + 1);
+            for (size_t i = 0; i < inline_capacity; ++i) {
+                if (is_full(inline_ctrl[i])) {
+                    relocate_range(allocator, other.inline_slots + i, 1, inline_slots + i);
+                }
+            }
+        }
+        size_ = other.size_;
+        growth_left = other.growth_left;
+        other.reset_to_inline_table();
+    }
+};
+
+/* Specialize `std::formatter` for `SmallSwissMap`. The entries are written in iteration order. */
+template <
+    typename K, typename V, size_t N, typename Hash, typename KeyEqual, typename Allocator,
+    typename MaxLoadFactor
+>
+struct std::formatter<SmallSwissMap<K, V, N, Hash, KeyEqual, Allocator, MaxLoadFactor>>
+: public std::formatter<std::string>
+{
+    auto format(
+        const SmallSwissMap<K, V, N, Hash, KeyEqual, Allocator, MaxLoadFactor> &map,
+        std::format_context &format_context
+    ) const {
+        auto output = format_context.out();
+        std::format_to(output, "{{");
+        bool first = true;
+        for (auto [key, value] : map) {
+            if (first) {
+                std::format_to(output, "{}: {}", key, value);
+            } else {
+                std::format_to(output, ", {}: {}", key, value);
+            }
+            first = false;
+        }
+        std::format_to(output, "}}");
+        return output;
+    }
+};
+
+#endif
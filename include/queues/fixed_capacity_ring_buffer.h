@@ -0,0 +1,387 @@
+/*
+@file fixed_capacity_ring_buffer.h
+@brief Defines and implements `FixedCapacityRingBuffer<T, Capacity, Allocator>`, a double-ended
+queue with fixed compile-time capacity.
+
+This file includes the following types:
+- `FixedCapacityRingBuffer<T, Capacity, Allocator>`
+*/
+
+#ifndef FIXED_CAPACITY_RING_BUFFER_H
+#define FIXED_CAPACITY_RING_BUFFER_H
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/* `FixedCapacityRingBuffer<T, Capacity, Allocator>` is a double-ended queue which stores at most
+`Capacity` elements inline, like `FixedCapacityVector`, but which treats its storage as a circular
+buffer: the elements start at some index `head` and wrap around from the end of the storage to its
+beginning. Pushing and popping at either end are thus O(1), without shifting any elements, which
+makes it suitable for bounded work queues and sliding windows.
+
+When `Capacity` is a power of two, wrapping an index around is a single bitwise AND with
+`Capacity - 1`; otherwise, it is a comparison and a subtraction (never a division).
+
+As in `FixedCapacityVector`, the storage is kept in an union, so that `T` need not be
+default-constructible, and every member function is usable during constant evaluation. Pushing
+onto a full ring buffer (or popping from an empty one) is a precondition violation, checked by
+`assert`; `push_n` and `pop_n` instead transfer as many elements as they can. */
+template <typename T, size_t Capacity, typename Allocator = std::allocator<T>>
+requires (Capacity > 0)
+struct FixedCapacityRingBuffer {
+private:
+    /* `Iterator<Const>` walks the elements from front to back, by their logical index */
+    template <bool Const>
+    struct Iterator {
+        using RingBuffer = std::conditional_t<
+            Const, const FixedCapacityRingBuffer, FixedCapacityRingBuffer
+        >;
+
+        using value_type        = T;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+        using difference_type   = ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+
+        RingBuffer *ring = nullptr;
+        difference_type index = 0;
+
+        constexpr Iterator() = default;
+        constexpr Iterator(RingBuffer *ring_, difference_type index_)
+        : ring{ring_}, index{index_} {}
+
+        /* Every iterator converts to a const iterator (this is a template so that it is not taken
+        for the copy constructor) */
+        template <bool OtherConst>
+        requires (Const && !OtherConst)
+        constexpr Iterator(const Iterator<OtherConst> &other)
+        : ring{other.ring}, index{other.index} {}
+
+        constexpr reference operator* () const { return (*ring)[index]; }
+        constexpr pointer operator-> () const { return &(*ring)[index]; }
+        constexpr reference operator[] (difference_type n) const { return (*ring)[index + n]; }
+
+        constexpr Iterator& operator++ () { ++index; return *this; }
+        constexpr Iterator& operator-- () { --index; return *this; }
+        constexpr Iterator operator++ (int) { auto old = *this; ++index; return old; }
+        constexpr Iterator operator-- (int) { auto old = *this; --index; return old; }
+        constexpr Iterator& operator+= (difference_type n) { index += n; return *this; }
+        constexpr Iterator& operator-= (difference_type n) { index -= n; return *this; }
+
+        friend constexpr Iterator operator+ (Iterator it, difference_type n) { return it += n; }
+        friend constexpr Iterator operator+ (difference_type n, Iterator it) { return it += n; }
+        friend constexpr Iterator operator- (Iterator it, difference_type n) { return it -= n; }
+        friend constexpr difference_type operator- (const Iterator &a, const Iterator &b) {
+            return a.index - b.index;
+        }
+
+        /* Iterators are only comparable if they belong to the same ring buffer, so comparing
+        their indices suffices */
+        friend constexpr bool operator== (const Iterator &a, const Iterator &b) {
+            return a.index == b.index;
+        }
+        friend constexpr auto operator<=> (const Iterator &a, const Iterator &b) {
+            return a.index <=> b.index;
+        }
+    };
+
+public:
+    using value_type             = T;
+    using allocator_type         = Allocator;
+    using reference              = value_type&;
+    using const_reference        = value_type const&;
+    using size_type              = size_t;
+    using difference_type        = ptrdiff_t;
+    using iterator               = Iterator<false>;
+    using const_iterator         = Iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /* --- ITERATORS --- */
+    constexpr iterator begin() { return iterator(this, 0); }
+    constexpr const_iterator begin() const { return const_iterator(this, 0); }
+    constexpr const_iterator cbegin() const { return begin(); }
+
+    constexpr iterator end() { return iterator(this, current_size); }
+    constexpr const_iterator end() const { return const_iterator(this, current_size); }
+    constexpr const_iterator cend() const { return end(); }
+
+    constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
+    constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    constexpr const_reverse_iterator crbegin() const { return rbegin(); }
+
+    constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
+    constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+    constexpr const_reverse_iterator crend() const { return rend(); }
+
+    /* --- GETTERS --- */
+
+    /* Returns true iff this `FixedCapacityRingBuffer` contains zero elements. */
+    constexpr bool empty() const { return size() == 0; }
+
+    /* Returns true iff this `FixedCapacityRingBuffer` contains `Capacity` elements. */
+    constexpr bool full() const { return size() == Capacity; }
+
+    /* Returns the current number of elements stored in this `FixedCapacityRingBuffer`. */
+    constexpr size_type size() const { return current_size; }
+
+    /* Returns the maximum number of elements this `FixedCapacityRingBuffer` could hold, which is
+    its fixed capacity. */
+    constexpr size_type max_size() const { return capacity(); }
+
+    /* Returns the capacity of this `FixedCapacityRingBuffer`. */
+    constexpr size_type capacity() const { return Capacity; }
+
+    /* --- ELEMENT ACCESS OPERATORS/FUNCTIONS --- */
+
+    /* Element `index` is the `index`th element from the front. */
+    constexpr reference operator[] (size_type index) { return elements[wrap(head + index)]; }
+    constexpr const_reference operator[] (size_type index) const {
+        return elements[wrap(head + index)];
+    }
+    constexpr reference at(size_type index) {
+        check_if_out_of_bounds(index);
+        return (*this)[index];
+    }
+    constexpr const_reference at(size_type index) const {
+        check_if_out_of_bounds(index);
+        return (*this)[index];
+    }
+    constexpr reference front() { return elements[head]; }
+    constexpr const_reference front() const { return elements[head]; }
+    constexpr reference back() { return (*this)[current_size - 1]; }
+    constexpr const_reference back() const { return (*this)[current_size - 1]; }
+
+    /* --- MUTATORS --- */
+
+    /* Appends a new element, constructed in-place from `args`, to the back. */
+    template <typename... Ts>
+    constexpr reference emplace_back(Ts&&... args) {
+        assert(!full());
+        auto position = elements + wrap(head + current_size);
+        std::allocator_traits<Allocator>::construct(allocator, position, std::forward<Ts>(args)...);
+        ++current_size;
+        return *position;
+    }
+
+    /* Prepends a new element, constructed in-place from `args`, to the front. */
+    template <typename... Ts>
+    constexpr reference emplace_front(Ts&&... args) {
+        assert(!full());
+        auto new_head = wrap(head + Capacity - 1);
+        std::allocator_traits<Allocator>::construct(
+            allocator, elements + new_head, std::forward<Ts>(args)...
+        );
+        head = new_head;
+        ++current_size;
+        return elements[head];
+    }
+
+    constexpr void push_back(const T &element) { emplace_back(element); }
+    constexpr void push_back(T &&element) { emplace_back(std::move(element)); }
+    constexpr void push_front(const T &element) { emplace_front(element); }
+    constexpr void push_front(T &&element) { emplace_front(std::move(element)); }
+
+    /* Removes the element at the back. */
+    constexpr void pop_back() {
+        assert(!empty());
+        --current_size;
+        std::allocator_traits<Allocator>::destroy(allocator, elements + wrap(head + current_size));
+    }
+
+    /* Removes the element at the front. */
+    constexpr void pop_front() {
+        assert(!empty());
+        std::allocator_traits<Allocator>::destroy(allocator, elements + head);
+        head = wrap(head + 1);
+        --current_size;
+    }
+
+    /* Appends copies of the `n` elements starting at `source` to the back, or as many of them as
+    fit, and returns the number of elements appended. The free space after the back is at most two
+    contiguous segments of the storage (up to the end of the storage, then from its beginning),
+    each of which is filled with one bulk copy (a `std::memcpy` for trivially copyable `T`). */
+    constexpr size_type push_n(const T *source, size_type n) {
+        n = std::min(n, Capacity - current_size);
+        auto tail = wrap(head + current_size);
+        auto first_segment = std::min(n, Capacity - tail);
+        copy_construct_segment(source, first_segment, elements + tail);
+        copy_construct_segment(source + first_segment, n - first_segment, elements);
+        current_size += n;
+        return n;
+    }
+
+    /* Moves the `n` elements at the front (or all elements, if there are fewer) to the `n`
+    elements starting at `dest` by move-assignment, removes them, and returns the number of
+    elements moved. As in `push_n`, the elements are moved as (at most) two contiguous segments. */
+    constexpr size_type pop_n(T *dest, size_type n) {
+        n = std::min(n, current_size);
+        auto first_segment = std::min(n, Capacity - head);
+        move_assign_and_destroy_segment(elements + head, first_segment, dest);
+        move_assign_and_destroy_segment(elements, n - first_segment, dest + first_segment);
+        head = wrap(head + n);
+        current_size -= n;
+        return n;
+    }
+
+    /* Erases all elements, after which `size()` will return zero. */
+    constexpr void clear() {
+        for (size_type i = 0; i < current_size; ++i) {
+            std::allocator_traits<Allocator>::destroy(allocator, elements + wrap(head + i));
+        }
+        head = 0;
+        current_size = 0;
+    }
+
+    /* --- CONSTRUCTORS AND DESTRUCTOR --- */
+
+    constexpr FixedCapacityRingBuffer(const Allocator &allocator_ = {}) : allocator{allocator_} {}
+
+    /* Constructs a `FixedCapacityRingBuffer` with the contents of the range `[first, last)`. */
+    template <typename InputIt>
+    requires (!std::is_integral_v<InputIt>)
+    constexpr FixedCapacityRingBuffer(
+        InputIt first, InputIt last, const Allocator &allocator_ = {}
+    ) : allocator{allocator_} {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    /* Initializer-list constructor */
+    constexpr FixedCapacityRingBuffer(
+        std::initializer_list<T> init, const Allocator &allocator_ = {}
+    ) : FixedCapacityRingBuffer(init.begin(), init.end(), allocator_) {}
+
+    /* Copy constructor. As with `std::vector`, the copy's allocator is given by
+    `select_on_container_copy_construction`. The copy starts at the beginning of its storage. */
+    constexpr FixedCapacityRingBuffer(const FixedCapacityRingBuffer &other)
+    : allocator{std::allocator_traits<Allocator>::select_on_container_copy_construction(
+        other.allocator
+    )} {
+        for (const auto &element : other) {
+            emplace_back(element);
+        }
+    }
+
+    /* Move constructor. The elements are moved one at a time, after which `other` is empty. */
+    constexpr FixedCapacityRingBuffer(FixedCapacityRingBuffer &&other)
+    : allocator{other.allocator} {
+        for (auto &element : other) {
+            emplace_back(std::move(element));
+        }
+        other.clear();
+    }
+
+    /* Destructor */
+    constexpr ~FixedCapacityRingBuffer() {
+        clear();
+    }
+
+private:
+    union {
+        /* `elements` stores the at-most `Capacity` elements in this `FixedCapacityRingBuffer`.
+        As in `FixedCapacityVector`, it is kept in an union to prevent it from being automatically
+        initialized. */
+        T elements[Capacity];
+    };
+    /* `head` = The index in `elements` of the front element */
+    size_t head = 0;
+    /* `current_size` = The current number of elements */
+    size_t current_size = 0;
+    /* `allocator` = An instance of type `Allocator`, used to construct/destroy elements. */
+    [[no_unique_address]] Allocator allocator;
+
+    /* Whether segments can be copied (and moved) with `std::memcpy` */
+    static constexpr bool uses_memcpy =
+        std::is_trivially_copyable_v<T> &&
+        std::is_same_v<typename std::allocator_traits<Allocator>::pointer, T*> &&
+        !requires (Allocator &a, T *p) { a.construct(p, std::declval<const T&>()); };
+
+    /* Maps `index`, which must be less than `2 * Capacity`, to `[0, Capacity)` */
+    static constexpr size_t wrap(size_t index) {
+        if constexpr (std::has_single_bit(Capacity)) {
+            return index & (Capacity - 1);
+        } else {
+            return (index >= Capacity ? index - Capacity : index);
+        }
+    }
+
+    /* Copy-constructs the `count` elements starting at `source` into the uninitialized storage
+    starting at `dest` */
+    constexpr void copy_construct_segment(const T *source, size_t count, T *dest) {
+        if constexpr (uses_memcpy) {
+            if (!std::is_constant_evaluated()) {
+                if (count != 0) {
+                    std::memcpy(static_cast<void*>(dest), source, count * sizeof(T));
+                }
+                return;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            std::allocator_traits<Allocator>::construct(allocator, dest + i, source[i]);
+        }
+    }
+
+    /* Move-assigns the `count` elements starting at `source` to those starting at `dest`, then
+    destroys the elements at `source` */
+    constexpr void move_assign_and_destroy_segment(T *source, size_t count, T *dest) {
+        if constexpr (uses_memcpy) {
+            if (!std::is_constant_evaluated()) {
+                if (count != 0) {
+                    std::memcpy(static_cast<void*>(dest), source, count * sizeof(T));
+                }
+                return;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            dest[i] = std::move(source[i]);
+            std::allocator_traits<Allocator>::destroy(allocator, source + i);
+        }
+    }
+
+    /* Throws `std::out_of_range` if `index` is out of bounds for this `FixedCapacityRingBuffer`. */
+    constexpr void check_if_out_of_bounds(size_type index) const {
+        if (index >= size()) {
+            throw std::out_of_range(
+                std::format("FixedCapacityRingBuffer: index ({}) >= size ({})\n", index, size())
+            );
+        }
+    }
+};
+
+/* Specialize `std::formatter` for `FixedCapacityRingBuffer<T, Capacity, Allocator>` */
+template <typename T, size_t Capacity, typename Allocator>
+struct std::formatter<FixedCapacityRingBuffer<T, Capacity, Allocator>>
+: public std::formatter<std::string>
+{
+    auto format(
+        const FixedCapacityRingBuffer<T, Capacity, Allocator> &ring,
+        std::format_context &format_context
+    ) const {
+        auto output = format_context.out();
+        std::format_to(output, "{{");
+        if (!ring.empty()) {
+            std::format_to(output, "{}", ring.front());
+            for (size_t i = 1; i < ring.size(); ++i) {
+                std::format_to(output, ", {}", ring[i]);
+            }
+        }
+        std::format_to(output, "}}");
+        return output;
+    }
+};
+
+#endif
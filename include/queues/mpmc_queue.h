@@ -0,0 +1,345 @@
+/*
+@file mpmc_queue.h
+@brief Defines and implements `FixedCapacityMPMCQueue<T, Capacity>`, a bounded queue which any
+number of threads may push to and pop from concurrently, without locks on the common path.
+
+This file includes the following types:
+- `FixedCapacityMPMCQueue<T, Capacity>`
+*/
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace mpmc_queue_detail {
+
+/* The assumed size of a cache line (see `spsc_queue.h`) */
+inline constexpr size_t cache_line_size = 64;
+
+/* `Slot<T>` holds one (possibly absent) element, along with the sequence number that says whose
+turn it is to use the slot. The element is kept in a union, as in `FixedCapacityVector`, so that
+`T` need not be default-constructible. Slots are aligned to cache lines, so that threads working
+on neighbouring slots do not contend for the same line. */
+template <typename T>
+struct alignas(cache_line_size) Slot {
+    std::atomic<size_t> sequence;
+    union {
+        T element;
+    };
+
+    Slot() {}
+    ~Slot() {}
+};
+
+/* `WaitList` lets threads sleep until some event (say, "an element was pushed") happens, using
+`std::atomic::wait`, which is a futex wait on Linux. When no thread is waiting, notifying costs a
+fence and a load of `waiters` (which is only written by waiting threads), so the lock-free paths
+only make system calls when someone actually waits.
+
+A waiter registers itself, reads the event count, re-checks its condition, and only then sleeps
+until the event count changes. A notifier makes its change, then checks for registered waiters.
+The sequentially consistent fences on both sides guarantee that either the waiter sees the change
+when re-checking, or the notifier sees the waiter (and bumps the event count, so that the waiter
+does not sleep, or is woken up). */
+struct WaitList {
+    alignas(cache_line_size) std::atomic<uint32_t> waiters{0};
+    std::atomic<uint32_t> events{0};
+
+    /* Blocks until `try_operation()` returns true */
+    template <typename F>
+    void wait_until(F &&try_operation) {
+        while (!try_operation()) {
+            waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto observed_events = events.load(std::memory_order_relaxed);
+            bool done = try_operation();
+            if (!done) {
+                events.wait(observed_events, std::memory_order_relaxed);
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (done) {
+                return;
+            }
+        }
+    }
+
+    /* Wakes up every waiter, after the caller has made the change they may be waiting for */
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) != 0) {
+            events.fetch_add(1, std::memory_order_relaxed);
+            events.notify_all();
+        }
+    }
+};
+
+}  /* namespace mpmc_queue_detail */
+
+/* `FixedCapacityMPMCQueue<T, Capacity>` is a FIFO queue of at most `Capacity` elements, which any
+number of producer and consumer threads may use concurrently. It is Dmitry Vyukov's bounded MPMC
+queue: every slot has a sequence number, and producers and consumers claim positions (which only
+ever increase) by incrementing `enqueue_position` and `dequeue_position` with a compare-and-swap.
+The slot at position `p` is ready
+- for the producer that claims `p` once its sequence number is `p` (i.e. the consumer of position
+  `p - Capacity` is done with it), after which the producer sets it to `p + 1`;
+- for the consumer that claims `p` once its sequence number is `p + 1` (i.e. the producer of
+  position `p` is done with it), after which the consumer sets it to `p + Capacity`.
+So a push or pop is one compare-and-swap on a shared position and one release store to the slot,
+and producers only contend with producers (and consumers with consumers). The elements are stored
+inline, so the queue never allocates.
+
+The `try_*` functions return immediately when the queue is full (or empty). `push` and `pop`
+instead sleep until they can succeed (see `WaitList` above); as waking up costs a system call,
+they first retry for a little while. `try_push_n` and `try_pop_n` claim a run of consecutive
+positions with a single compare-and-swap.
+
+Note that a `try_pop` may fail while the queue is non-empty, if the producer of the element at the
+front has claimed its position but not yet finished constructing the element (and likewise for a
+`try_push` on a queue with free space). */
+template <typename T, size_t Capacity>
+requires (Capacity >= 2)
+struct FixedCapacityMPMCQueue {
+    using value_type = T;
+    using size_type  = size_t;
+
+    FixedCapacityMPMCQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /* The queue is shared between threads by reference, and is neither copied nor moved */
+    FixedCapacityMPMCQueue(const FixedCapacityMPMCQueue&) = delete;
+    FixedCapacityMPMCQueue& operator= (const FixedCapacityMPMCQueue&) = delete;
+
+    /* Destroys the elements that were pushed but not popped. No other thread may be using the
+    queue at this point. */
+    ~FixedCapacityMPMCQueue() {
+        auto end = enqueue_position.load(std::memory_order_acquire);
+        for (auto position = dequeue_position.load(std::memory_order_acquire); position != end;
+             ++position) {
+            std::destroy_at(&slot(position).element);
+        }
+    }
+
+    /* --- GETTERS --- */
+
+    /* Returns the capacity of this `FixedCapacityMPMCQueue`. */
+    static constexpr size_type capacity() { return Capacity; }
+
+    /* Returns the approximate number of elements in the queue (counting elements that are being
+    pushed or popped). */
+    size_type size() const {
+        auto dequeued = dequeue_position.load(std::memory_order_acquire);
+        auto enqueued = enqueue_position.load(std::memory_order_acquire);
+        return (enqueued > dequeued ? enqueued - dequeued : 0);
+    }
+
+    /* Returns true iff `size()` is zero. */
+    bool empty() const { return size() == 0; }
+
+    /* --- PRODUCERS --- */
+
+    /* Constructs an element from `args` at the back of the queue and returns true, or returns
+    false (without constructing anything) if the queue is full. */
+    template <typename... Ts>
+    bool try_emplace(Ts&&... args) {
+        size_t position;
+        if (try_claim(enqueue_position, 0, 1, position) == 0) {
+            return false;
+        }
+        fill_slot(position, std::forward<Ts>(args)...);
+        not_empty.notify();
+        return true;
+    }
+
+    bool try_push(const T &element) { return try_emplace(element); }
+    bool try_push(T &&element) { return try_emplace(std::move(element)); }
+
+    /* Constructs an element from `args` at the back of the queue, waiting for a free slot if the
+    queue is full. */
+    template <typename... Ts>
+    void emplace(Ts&&... args) {
+        auto position = claim(enqueue_position, 0, not_full);
+        fill_slot(position, std::forward<Ts>(args)...);
+        not_empty.notify();
+    }
+
+    void push(const T &element) { emplace(element); }
+    void push(T &&element) { emplace(std::move(element)); }
+
+    /* Pushes copies of the `n` elements starting at `source`, or of as many of them as fit in the
+    free slots at the back, and returns the number of elements pushed. */
+    size_type try_push_n(const T *source, size_type n) {
+        size_t position;
+        auto count = try_claim(enqueue_position, 0, n, position);
+        for (size_t i = 0; i < count; ++i) {
+            fill_slot(position + i, source[i]);
+        }
+        if (count != 0) {
+            not_empty.notify();
+        }
+        return count;
+    }
+
+    /* --- CONSUMERS --- */
+
+    /* Moves the front element into `out` (by move-assignment), removes it, and returns true, or
+    returns false if the queue is empty. */
+    bool try_pop(T &out) {
+        size_t position;
+        if (try_claim(dequeue_position, 1, 1, position) == 0) {
+            return false;
+        }
+        empty_slot(position, [&out](T &element) { out = std::move(element); });
+        not_full.notify();
+        return true;
+    }
+
+    /* Removes and returns the front element, or returns `std::nullopt` if the queue is empty. */
+    std::optional<T> try_pop() {
+        size_t position;
+        if (try_claim(dequeue_position, 1, 1, position) == 0) {
+            return std::nullopt;
+        }
+        std::optional<T> result;
+        empty_slot(position, [&result](T &element) { result.emplace(std::move(element)); });
+        not_full.notify();
+        return result;
+    }
+
+    /* Removes and returns the front element, waiting for one if the queue is empty. */
+    T pop() {
+        auto position = claim(dequeue_position, 1, not_empty);
+        std::optional<T> result;
+        empty_slot(position, [&result](T &element) { result.emplace(std::move(element)); });
+        not_full.notify();
+        return std::move(*result);
+    }
+
+    /* Moves up to `n` elements from the front into the `n` elements starting at `dest` (by
+    move-assignment), removes them, and returns the number of elements moved. */
+    size_type try_pop_n(T *dest, size_type n) {
+        size_t position;
+        auto count = try_claim(dequeue_position, 1, n, position);
+        for (size_t i = 0; i < count; ++i) {
+            empty_slot(position + i, [&](T &element) { dest[i] = std::move(element); });
+        }
+        if (count != 0) {
+            not_full.notify();
+        }
+        return count;
+    }
+
+private:
+    using Slot = mpmc_queue_detail::Slot<T>;
+
+    /* The next position to push to and to pop from, on separate cache lines */
+    alignas(mpmc_queue_detail::cache_line_size) std::atomic<size_t> enqueue_position{0};
+    alignas(mpmc_queue_detail::cache_line_size) std::atomic<size_t> dequeue_position{0};
+
+    /* Consumers waiting for an element, and producers waiting for a free slot */
+    mpmc_queue_detail::WaitList not_empty;
+    mpmc_queue_detail::WaitList not_full;
+
+    Slot slots[Capacity];
+
+    /* The number of failed attempts `claim` makes before going to sleep */
+    static constexpr int spin_count = 64;
+
+    /* Returns the slot of the (ever-increasing) position `position` */
+    Slot& slot(size_t position) {
+        if constexpr (std::has_single_bit(Capacity)) {
+            return slots[position & (Capacity - 1)];
+        } else {
+            return slots[position % Capacity];
+        }
+    }
+
+    /* Claims up to `max_count` consecutive positions from `next_position` (which is either
+    `enqueue_position`, with `offset` 0, or `dequeue_position`, with `offset` 1) whose slots are
+    ready, i.e. whose sequence numbers are the position plus `offset`. Sets `first` to the first
+    claimed position and returns the number of positions claimed, which is 0 if the slot at
+    `next_position` is not ready, i.e. if the queue is full (or empty). */
+    size_t try_claim(
+        std::atomic<size_t> &next_position, size_t offset, size_t max_count, size_t &first
+    ) {
+        if (max_count == 0) {
+            return 0;
+        }
+        auto position = next_position.load(std::memory_order_relaxed);
+        while (true) {
+            auto sequence = slot(position).sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<ptrdiff_t>(sequence - (position + offset));
+            if (difference < 0) {
+                /* The slot is still in use from the previous lap: the queue is full (or empty) */
+                return 0;
+            }
+            if (difference > 0) {
+                /* Another thread claimed `position` already; start over from the current one */
+                position = next_position.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            /* Extend the run of ready slots. Slots that are ready for us at this point stay
+            ready until they are claimed, and claiming any of them requires claiming `position`
+            first, which makes the compare-and-swap below fail. */
+            size_t count = 1;
+            while (count < max_count &&
+                   slot(position + count).sequence.load(std::memory_order_acquire) ==
+                       position + count + offset) {
+                ++count;
+            }
+            if (next_position.compare_exchange_weak(
+                position, position + count, std::memory_order_relaxed
+            )) {
+                first = position;
+                return count;
+            }
+        }
+    }
+
+    /* Claims one position from `next_position` (as in `try_claim`) and returns it, retrying
+    `spin_count` times and then sleeping on `wait_list` until a slot is ready */
+    size_t claim(
+        std::atomic<size_t> &next_position, size_t offset, mpmc_queue_detail::WaitList &wait_list
+    ) {
+        size_t position;
+        for (int attempt = 0; attempt < spin_count; ++attempt) {
+            if (try_claim(next_position, offset, 1, position) != 0) {
+                return position;
+            }
+        }
+        wait_list.wait_until([&] { return try_claim(next_position, offset, 1, position) != 0; });
+        return position;
+    }
+
+    /* Constructs an element from `args` in the slot of the claimed position `position`, and hands
+    the slot over to the consumer of `position` */
+    template <typename... Ts>
+    void fill_slot(size_t position, Ts&&... args) {
+        auto &s = slot(position);
+        std::construct_at(&s.element, std::forward<Ts>(args)...);
+        s.sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /* Passes the element in the slot of the claimed position `position` to `consume`, destroys
+    it, and hands the slot over to the producer of position `position + Capacity` */
+    template <typename F>
+    void empty_slot(size_t position, F &&consume) {
+        auto &s = slot(position);
+        consume(s.element);
+        std::destroy_at(&s.element);
+        s.sequence.store(position + Capacity, std::memory_order_release);
+    }
+};
+
+#endif
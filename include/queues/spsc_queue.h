@@ -0,0 +1,255 @@
+/*
+@file spsc_queue.h
+@brief Defines and implements `FixedCapacitySPSCQueue<T, Capacity>`, a lock-free bounded queue
+for passing elements from one producer thread to one consumer thread, which never allocates.
+
+This file includes the following types:
+- `FixedCapacitySPSCQueue<T, Capacity>`
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace spsc_queue_detail {
+
+/* The assumed size of a cache line. (`std::hardware_destructive_interference_size` would be the
+standard choice, but its value may differ between compiler flags, which GCC warns about when it is
+used in a header.) */
+inline constexpr size_t cache_line_size = 64;
+
+}  /* namespace spsc_queue_detail */
+
+/* `FixedCapacitySPSCQueue<T, Capacity>` is a FIFO queue of at most `Capacity` elements, where one
+thread (the producer) pushes elements and one other thread (the consumer) pops them, without locks
+and without ever allocating. The elements are stored inline in the same kind of union-wrapped
+`T[Capacity]` array as `FixedCapacityVector`, so `T` need not be default-constructible.
+
+The producer owns `tail` (the number of elements pushed so far) and the consumer owns `head` (the
+number of elements popped so far). Each publishes its index with a release store, and reads the
+other's with an acquire load, which makes the construction of an element visible before it is
+popped, and its destruction visible before its slot is reused. To avoid cache-line ping-pong:
+- `head` and `tail` live on separate cache lines, with the elements on lines of their own;
+- each side keeps a private copy of the other side's index (`cached_tail` for the consumer,
+  `cached_head` for the producer), next to its own index, and only reloads the shared index when
+  the cached one says that the queue is empty (or full). In a steady stream, a thread thus reads
+  the other thread's cache line about once per `Capacity` elements rather than once per element.
+The batch functions `try_push_n` and `try_pop_n` go further, publishing a whole batch with a
+single store.
+
+`head` and `tail` only ever increase, and are mapped to slots modulo `Capacity`, which is a bitwise
+AND if `Capacity` is a power of two (recommended) and a division otherwise.
+
+Every `try_push*` function must only be called by the producer, and every `try_pop*` function only
+by the consumer. `size()` and `empty()` may be called from either thread, but are only snapshots. */
+template <typename T, size_t Capacity>
+requires (Capacity > 0)
+struct FixedCapacitySPSCQueue {
+    using value_type = T;
+    using size_type  = size_t;
+
+    FixedCapacitySPSCQueue() {}
+
+    /* The queue is shared between two threads by reference, and is neither copied nor moved */
+    FixedCapacitySPSCQueue(const FixedCapacitySPSCQueue&) = delete;
+    FixedCapacitySPSCQueue& operator= (const FixedCapacitySPSCQueue&) = delete;
+
+    /* Destroys the elements that were pushed but not popped. No other thread may be using the
+    queue at this point. */
+    ~FixedCapacitySPSCQueue() {
+        auto tail_index = tail.load(std::memory_order_acquire);
+        for (auto i = head.load(std::memory_order_relaxed); i != tail_index; ++i) {
+            std::destroy_at(elements + slot(i));
+        }
+    }
+
+    /* --- GETTERS --- */
+
+    /* Returns the capacity of this `FixedCapacitySPSCQueue`. */
+    static constexpr size_type capacity() { return Capacity; }
+
+    /* Returns the number of elements in the queue at some point during the call. */
+    size_type size() const {
+        /* Load `head` first: `tail` can only grow in the meantime, so the difference never
+        underflows */
+        auto head_index = head.load(std::memory_order_acquire);
+        auto tail_index = tail.load(std::memory_order_acquire);
+        return tail_index - head_index;
+    }
+
+    /* Returns true iff the queue was empty at some point during the call. */
+    bool empty() const { return size() == 0; }
+
+    /* --- PRODUCER --- */
+
+    /* Constructs an element from `args` at the back of the queue and returns true, or returns
+    false (without constructing anything) if the queue is full. */
+    template <typename... Ts>
+    bool try_emplace(Ts&&... args) {
+        auto tail_index = tail.load(std::memory_order_relaxed);
+        if (tail_index - cached_head == Capacity) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (tail_index - cached_head == Capacity) {
+                return false;
+            }
+        }
+        std::construct_at(elements + slot(tail_index), std::forward<Ts>(args)...);
+        tail.store(tail_index + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T &element) { return try_emplace(element); }
+    bool try_push(T &&element) { return try_emplace(std::move(element)); }
+
+    /* Pushes copies of the `n` elements starting at `source`, or of as many of them as fit, and
+    returns the number of elements pushed. The batch is published with a single store, and is
+    copied as at most two contiguous segments (each one `std::memcpy` for trivially copyable
+    `T`). If a copy throws, nothing is pushed. */
+    size_type try_push_n(const T *source, size_type n) {
+        auto tail_index = tail.load(std::memory_order_relaxed);
+        if (Capacity - (tail_index - cached_head) < n) {
+            cached_head = head.load(std::memory_order_acquire);
+        }
+        n = std::min(n, Capacity - (tail_index - cached_head));
+        auto first = slot(tail_index);
+        auto first_segment = std::min(n, Capacity - first);
+        copy_construct_segment(source, first_segment, elements + first);
+        try {
+            copy_construct_segment(source + first_segment, n - first_segment, elements);
+        } catch (...) {
+            std::destroy_n(elements + first, first_segment);
+            throw;
+        }
+        tail.store(tail_index + n, std::memory_order_release);
+        return n;
+    }
+
+    /* --- CONSUMER --- */
+
+    /* Moves the front element into `out` (by move-assignment), removes it, and returns true, or
+    returns false if the queue is empty. */
+    bool try_pop(T &out) {
+        auto head_index = head.load(std::memory_order_relaxed);
+        if (!ensure_available(head_index, 1)) {
+            return false;
+        }
+        auto element = elements + slot(head_index);
+        out = std::move(*element);
+        std::destroy_at(element);
+        head.store(head_index + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Removes and returns the front element, or returns `std::nullopt` if the queue is empty. */
+    std::optional<T> try_pop() {
+        auto head_index = head.load(std::memory_order_relaxed);
+        if (!ensure_available(head_index, 1)) {
+            return std::nullopt;
+        }
+        auto element = elements + slot(head_index);
+        std::optional<T> result(std::move(*element));
+        std::destroy_at(element);
+        head.store(head_index + 1, std::memory_order_release);
+        return result;
+    }
+
+    /* Moves up to `n` elements from the front into the `n` elements starting at `dest` (by
+    move-assignment), removes them, and returns the number of elements moved. As in `try_push_n`,
+    the batch is released with a single store, and moved as at most two contiguous segments. */
+    size_type try_pop_n(T *dest, size_type n) {
+        auto head_index = head.load(std::memory_order_relaxed);
+        ensure_available(head_index, n);
+        n = std::min(n, cached_tail - head_index);
+        auto first = slot(head_index);
+        auto first_segment = std::min(n, Capacity - first);
+        move_assign_and_destroy_segment(elements + first, first_segment, dest);
+        move_assign_and_destroy_segment(elements, n - first_segment, dest + first_segment);
+        head.store(head_index + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    /* The consumer's cache line: the number of elements popped, and the last value of `tail` the
+    consumer has seen */
+    alignas(spsc_queue_detail::cache_line_size) std::atomic<size_t> head{0};
+    size_t cached_tail = 0;
+
+    /* The producer's cache line: the number of elements pushed, and the last value of `head` the
+    producer has seen */
+    alignas(spsc_queue_detail::cache_line_size) std::atomic<size_t> tail{0};
+    size_t cached_head = 0;
+
+    /* The elements, starting on a cache line of their own (so that writing the first element does
+    not invalidate the producer's line) */
+    union {
+        alignas(spsc_queue_detail::cache_line_size) T elements[Capacity];
+    };
+
+    /* Whether segments can be copied (and moved) with `std::memcpy` */
+    static constexpr bool uses_memcpy = std::is_trivially_copyable_v<T>;
+
+    /* Maps the (ever-increasing) index `index` to a slot of `elements` */
+    static constexpr size_t slot(size_t index) {
+        if constexpr (std::has_single_bit(Capacity)) {
+            return index & (Capacity - 1);
+        } else {
+            return index % Capacity;
+        }
+    }
+
+    /* Returns true iff at least `n` elements are available to the consumer, which is at
+    `head_index`, reloading `tail` into `cached_tail` if the cached value says otherwise */
+    bool ensure_available(size_t head_index, size_t n) {
+        if (cached_tail - head_index < n) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            return cached_tail - head_index >= n;
+        }
+        return true;
+    }
+
+    /* Copy-constructs the `count` elements starting at `source` into the uninitialized storage
+    starting at `dest`. If a copy throws, the copies already made are destroyed. */
+    static void copy_construct_segment(const T *source, size_t count, T *dest) {
+        if constexpr (uses_memcpy) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(dest), source, count * sizeof(T));
+            }
+        } else {
+            size_t i = 0;
+            try {
+                for (; i < count; ++i) {
+                    std::construct_at(dest + i, source[i]);
+                }
+            } catch (...) {
+                std::destroy_n(dest, i);
+                throw;
+            }
+        }
+    }
+
+    /* Move-assigns the `count` elements starting at `source` to those starting at `dest`, then
+    destroys the elements at `source` */
+    static void move_assign_and_destroy_segment(T *source, size_t count, T *dest) {
+        if constexpr (uses_memcpy) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(dest), source, count * sizeof(T));
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                dest[i] = std::move(source[i]);
+                std::destroy_at(source + i);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,437 @@
+/*
+@file simd_search.h
+@brief Defines linear search algorithms (find, count, and the index of the minimum/maximum) over
+contiguous arrays, with SIMD kernels for arithmetic element types.
+
+This file includes the following:
+- `simd_searchable<T>`, which is satisfied iff the SIMD kernels support the element type `T`
+- `scalar_find`, `scalar_count`, `scalar_min_index`, and `scalar_max_index`, which work for any
+  element type and during constant evaluation
+- `simd_find`, `simd_count`, `simd_min_index`, and `simd_max_index`, which dispatch to the best
+  available SIMD kernels for `simd_searchable` element types
+
+Every algorithm takes a pointer `p` to `n` elements, and returns either an index into `[0, n)` or,
+if there is no such index (for instance, if `value` is not found, or if `n` is 0), `n` itself.
+
+On x86-64 with GCC or Clang, the kernels are chosen as follows:
+- If the program is compiled with AVX-512F and AVX-512BW enabled, the AVX-512 kernels are always
+  used. These also handle the tail of the array (and arrays shorter than one vector) with masked
+  loads rather than with scalar code.
+- Otherwise, the AVX2 kernels are used if the CPU supports AVX2 (which is detected at runtime,
+  unless AVX2 is enabled at compile time), and the SSE2 kernels are used if not. These handle the
+  tail by reloading the last full vector of the array, and fall back to scalar code for arrays
+  shorter than one vector.
+On other platforms, the scalar algorithms are used.
+
+Equality uses the same semantics as `operator==` (so for floating-point types, `-0.0` equals `0.0`
+and NaN equals nothing). The minimum/maximum kernels only exist for integer types (of at most 4
+bytes for AVX2, and of any size for AVX-512), as the result of `std::min_element` on floating-point
+values with NaNs depends on the order of comparisons; other types use the scalar algorithms.
+*/
+
+#ifndef SIMD_SEARCH_H
+#define SIMD_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <concepts>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_SEARCH_X86 1
+#include <immintrin.h>
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#define SIMD_SEARCH_AVX512 1
+#endif
+#endif
+
+/* `simd_searchable<T>` is satisfied iff `T` is an arithmetic type (other than `bool`) of 1, 2, 4,
+or 8 bytes, which are the element types that the SIMD kernels support. */
+template <typename T>
+concept simd_searchable =
+    std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+/* --- SCALAR ALGORITHMS --- */
+
+/* Returns the index of the first element of `p[0..n)` equal to `value`, or `n` if there is none */
+template <typename T>
+constexpr size_t scalar_find(const T *p, size_t n, const T &value) {
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
+
+/* Returns the number of elements of `p[0..n)` equal to `value` */
+template <typename T>
+constexpr size_t scalar_count(const T *p, size_t n, const T &value) {
+    size_t result = 0;
+    for (size_t i = 0; i < n; ++i) {
+        result += (p[i] == value);
+    }
+    return result;
+}
+
+/* Returns the index of the first smallest element of `p[0..n)` (as in `std::min_element`), or
+`n` if `n` is 0 */
+template <typename T>
+constexpr size_t scalar_min_index(const T *p, size_t n) {
+    if (n == 0) {
+        return n;
+    }
+    size_t result = 0;
+    for (size_t i = 1; i < n; ++i) {
+        if (p[i] < p[result]) {
+            result = i;
+        }
+    }
+    return result;
+}
+
+/* Returns the index of the first largest element of `p[0..n)` (as in `std::max_element`), or
+`n` if `n` is 0 */
+template <typename T>
+constexpr size_t scalar_max_index(const T *p, size_t n) {
+    if (n == 0) {
+        return n;
+    }
+    size_t result = 0;
+    for (size_t i = 1; i < n; ++i) {
+        if (p[result] < p[i]) {
+            result = i;
+        }
+    }
+    return result;
+}
+
+#if defined(SIMD_SEARCH_X86)
+
+/* The kernels for each instruction set live in their own namespace. Each namespace provides the
+primitives below, after which `simd_search_algorithms.inc` defines the algorithms on top of them
+(it is included once per instruction set, as every function must be compiled with the `target`
+attribute of its instruction set for the intrinsics to be inlined into it):
+- `lanes<T>`: The number of elements of type `T` per vector
+- `bits_per_lane<T>`: The number of bits per element in the masks returned by `match_mask`
+- `has_masked_loads`: Whether `match_mask_tail` can be used for arrays shorter than one vector
+- `has_minmax<T>`: Whether `load`, `vmin`, and `vmax` exist for `T`
+- `broadcast(value)`: A vector with every element equal to `value`
+- `match_mask(p, needle)`: A bitmask of the elements of the vector at `p` that equal `needle`
+- `match_mask_tail(p, remaining, needle)`: The same, for only the first `remaining < lanes<T>`
+  elements at `p` */
+namespace simd_search_detail {
+
+#define SIMD_SEARCH_TARGET_AVX2 __attribute__((target("avx2")))
+
+/* SSE2 is part of the x86-64 baseline, so these need no `target` attribute */
+namespace sse2 {
+#define SIMD_SEARCH_TARGET
+    template <typename T> inline constexpr size_t lanes = 16 / sizeof(T);
+    template <typename T> inline constexpr size_t bits_per_lane = sizeof(T);
+    inline constexpr bool has_masked_loads = false;
+    template <typename T> inline constexpr bool has_minmax = false;
+
+    template <typename T>
+    [[gnu::always_inline]] inline auto broadcast(T value) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm_set1_ps(value);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm_set1_pd(value);
+        } else if constexpr (sizeof(T) == 1) {
+            return _mm_set1_epi8(static_cast<char>(value));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm_set1_epi16(static_cast<short>(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm_set1_epi32(static_cast<int>(value));
+        } else {
+            return _mm_set1_epi64x(static_cast<long long>(value));
+        }
+    }
+
+    template <typename T, typename V>
+    [[gnu::always_inline]] inline uint32_t match_mask(const T *p, V needle) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm_movemask_epi8(_mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(p), needle)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm_movemask_epi8(_mm_castpd_si128(_mm_cmpeq_pd(_mm_loadu_pd(p), needle)));
+        } else {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if constexpr (sizeof(T) == 1) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+            } else if constexpr (sizeof(T) == 2) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi16(v, needle));
+            } else if constexpr (sizeof(T) == 4) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi32(v, needle));
+            } else {
+                /* SSE2 has no 64-bit comparison; two 64-bit elements are equal iff both of their
+                32-bit halves are */
+                auto halves = _mm_cmpeq_epi32(v, needle);
+                auto swapped = _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1));
+                return _mm_movemask_epi8(_mm_and_si128(halves, swapped));
+            }
+        }
+    }
+
+    /* Reloads the last full vector ending at `p + remaining` (which the algorithms guarantee is
+    readable), and discards the bits of the elements before `p` */
+    template <typename T, typename V>
+    [[gnu::always_inline]] inline uint32_t match_mask_tail(const T *p, size_t remaining, V needle) {
+        auto overlap = lanes<T> - remaining;
+        return match_mask(p - overlap, needle) >> (overlap * bits_per_lane<T>);
+    }
+
+    template <typename T> void load(const T*);
+    template <typename V> V vmin(V, V);
+    template <typename V> V vmax(V, V);
+
+#include "simd/simd_search_algorithms.inc"
+#undef SIMD_SEARCH_TARGET
+}
+
+namespace avx2 {
+#define SIMD_SEARCH_TARGET SIMD_SEARCH_TARGET_AVX2
+    template <typename T> inline constexpr size_t lanes = 32 / sizeof(T);
+    template <typename T> inline constexpr size_t bits_per_lane = sizeof(T);
+    inline constexpr bool has_masked_loads = false;
+    template <typename T> inline constexpr bool has_minmax = std::is_integral_v<T> && sizeof(T) <= 4;
+
+    template <typename T>
+    SIMD_SEARCH_TARGET [[gnu::always_inline]] inline auto broadcast(T value) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm256_set1_ps(value);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_set1_pd(value);
+        } else if constexpr (sizeof(T) == 1) {
+            return _mm256_set1_epi8(static_cast<char>(value));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_set1_epi16(static_cast<short>(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_set1_epi32(static_cast<int>(value));
+        } else {
+            return _mm256_set1_epi64x(static_cast<long long>(value));
+        }
+    }
+
+    template <typename T, typename V>
+    SIMD_SEARCH_TARGET [[gnu::always_inline]] inline uint32_t match_mask(const T *p, V needle) {
+        if constexpr (std::is_same_v<T, float>) {
+            auto eq = _mm256_cmp_ps(_mm256_loadu_ps(p), needle, _CMP_EQ_OQ);
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_castps_si256(eq)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            auto eq = _mm256_cmp_pd(_mm256_loadu_pd(p), needle, _CMP_EQ_OQ);
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_castpd_si256(eq)));
+        } else {
+            auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            if constexpr (sizeof(T) == 1) {
+                return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+            } else if constexpr (sizeof(T) == 2) {
+                return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, needle)));
+            } else if constexpr (sizeof(T) == 4) {
+                return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(v, needle)));
+            } else {
+                return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(v, needle)));
+            }
+        }
+    }
+
+    template <typename T, typename V>
+    SIMD_SEARCH_TARGET [[gnu::always_inline]] inline uint32_t match_mask_tail(
+        const T *p, size_t remaining, V needle
+    ) {
+        auto overlap = lanes<T> - remaining;
+        return match_mask(p - overlap, needle) >> (overlap * bits_per_lane<T>);
+    }
+
+    template <typename T>
+    SIMD_SEARCH_TARGET [[gnu::always_inline]] inline __m256i load(const T *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    template <typename T>
+    SIMD_SEARCH_TARGET [[gnu::always_inline]] inline __m256i vmin(__m256i a, __m256i b) {
+        if constexpr (sizeof(T) == 1) {
+            return (std::is_signed_v<T> ? _mm256_min_epi8(a, b) : _mm256_min_epu8(a, b));
+        } else if constexpr (sizeof(T) == 2) {
+            return (std::is_signed_v<T> ? _mm256_min_epi16(a, b) : _mm256_min_epu16(a, b));
+        } else {
+            return (std::is_signed_v<T> ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b));
+        }
+    }
+
+    template <typename T>
+    SIMD_SEARCH_TARGET [[gnu::always_inline]] inline __m256i vmax(__m256i a, __m256i b) {
+        if constexpr (sizeof(T) == 1) {
+            return (std::is_signed_v<T> ? _mm256_max_epi8(a, b) : _mm256_max_epu8(a, b));
+        } else if constexpr (sizeof(T) == 2) {
+            return (std::is_signed_v<T> ? _mm256_max_epi16(a, b) : _mm256_max_epu16(a, b));
+        } else {
+            return (std::is_signed_v<T> ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b));
+        }
+    }
+
+#include "simd/simd_search_algorithms.inc"
+#undef SIMD_SEARCH_TARGET
+}
+
+#if defined(SIMD_SEARCH_AVX512)
+/* AVX-512 is only ever enabled at compile time, so these need no `target` attribute either */
+namespace avx512 {
+#define SIMD_SEARCH_TARGET
+    template <typename T> inline constexpr size_t lanes = 64 / sizeof(T);
+    template <typename T> inline constexpr size_t bits_per_lane = 1;
+    inline constexpr bool has_masked_loads = true;
+    template <typename T> inline constexpr bool has_minmax = std::is_integral_v<T>;
+
+    template <typename T>
+    [[gnu::always_inline]] inline auto broadcast(T value) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_set1_ps(value);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm512_set1_pd(value);
+        } else if constexpr (sizeof(T) == 1) {
+            return _mm512_set1_epi8(static_cast<char>(value));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_set1_epi16(static_cast<short>(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_set1_epi32(static_cast<int>(value));
+        } else {
+            return _mm512_set1_epi64(static_cast<long long>(value));
+        }
+    }
+
+    /* Compares the elements of `p` selected by `k` against `needle`; the other elements are
+    neither loaded nor reported as matches (and may lie outside of the array). */
+    template <typename T, typename V>
+    [[gnu::always_inline]] inline uint64_t match_mask_masked(const T *p, uint64_t k, V needle) {
+        if constexpr (std::is_same_v<T, float>) {
+            auto v = _mm512_maskz_loadu_ps(static_cast<__mmask16>(k), p);
+            return _mm512_mask_cmp_ps_mask(static_cast<__mmask16>(k), v, needle, _CMP_EQ_OQ);
+        } else if constexpr (std::is_same_v<T, double>) {
+            auto v = _mm512_maskz_loadu_pd(static_cast<__mmask8>(k), p);
+            return _mm512_mask_cmp_pd_mask(static_cast<__mmask8>(k), v, needle, _CMP_EQ_OQ);
+        } else if constexpr (sizeof(T) == 1) {
+            auto v = _mm512_maskz_loadu_epi8(static_cast<__mmask64>(k), p);
+            return _mm512_mask_cmpeq_epi8_mask(static_cast<__mmask64>(k), v, needle);
+        } else if constexpr (sizeof(T) == 2) {
+            auto v = _mm512_maskz_loadu_epi16(static_cast<__mmask32>(k), p);
+            return _mm512_mask_cmpeq_epi16_mask(static_cast<__mmask32>(k), v, needle);
+        } else if constexpr (sizeof(T) == 4) {
+            auto v = _mm512_maskz_loadu_epi32(static_cast<__mmask16>(k), p);
+            return _mm512_mask_cmpeq_epi32_mask(static_cast<__mmask16>(k), v, needle);
+        } else {
+            auto v = _mm512_maskz_loadu_epi64(static_cast<__mmask8>(k), p);
+            return _mm512_mask_cmpeq_epi64_mask(static_cast<__mmask8>(k), v, needle);
+        }
+    }
+
+    template <typename T, typename V>
+    [[gnu::always_inline]] inline uint64_t match_mask(const T *p, V needle) {
+        return match_mask_masked(p, ~uint64_t{0}, needle);
+    }
+
+    template <typename T, typename V>
+    [[gnu::always_inline]] inline uint64_t match_mask_tail(const T *p, size_t remaining, V needle) {
+        return match_mask_masked(p, (uint64_t{1} << remaining) - 1, needle);
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] inline __m512i load(const T *p) {
+        return _mm512_loadu_si512(p);
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] inline __m512i vmin(__m512i a, __m512i b) {
+        if constexpr (sizeof(T) == 1) {
+            return (std::is_signed_v<T> ? _mm512_min_epi8(a, b) : _mm512_min_epu8(a, b));
+        } else if constexpr (sizeof(T) == 2) {
+            return (std::is_signed_v<T> ? _mm512_min_epi16(a, b) : _mm512_min_epu16(a, b));
+        } else if constexpr (sizeof(T) == 4) {
+            return (std::is_signed_v<T> ? _mm512_min_epi32(a, b) : _mm512_min_epu32(a, b));
+        } else {
+            return (std::is_signed_v<T> ? _mm512_min_epi64(a, b) : _mm512_min_epu64(a, b));
+        }
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] inline __m512i vmax(__m512i a, __m512i b) {
+        if constexpr (sizeof(T) == 1) {
+            return (std::is_signed_v<T> ? _mm512_max_epi8(a, b) : _mm512_max_epu8(a, b));
+        } else if constexpr (sizeof(T) == 2) {
+            return (std::is_signed_v<T> ? _mm512_max_epi16(a, b) : _mm512_max_epu16(a, b));
+        } else if constexpr (sizeof(T) == 4) {
+            return (std::is_signed_v<T> ? _mm512_max_epi32(a, b) : _mm512_max_epu32(a, b));
+        } else {
+            return (std::is_signed_v<T> ? _mm512_max_epi64(a, b) : _mm512_max_epu64(a, b));
+        }
+    }
+
+#include "simd/simd_search_algorithms.inc"
+#undef SIMD_SEARCH_TARGET
+}
+#endif
+
+/* Returns true iff the CPU supports AVX2. This is only checked once. */
+inline bool cpu_supports_avx2() {
+#if defined(__AVX2__)
+    return true;
+#else
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#endif
+}
+
+}  /* namespace simd_search_detail */
+
+/* Dispatches `algorithm` to the kernels of the best available instruction set (see above) */
+#if defined(SIMD_SEARCH_AVX512)
+#define SIMD_SEARCH_DISPATCH(algorithm, ...) \
+    return simd_search_detail::avx512::algorithm(__VA_ARGS__)
+#else
+#define SIMD_SEARCH_DISPATCH(algorithm, ...) \
+    return (simd_search_detail::cpu_supports_avx2() \
+        ? simd_search_detail::avx2::algorithm(__VA_ARGS__) \
+        : simd_search_detail::sse2::algorithm(__VA_ARGS__))
+#endif
+
+#else
+
+#define SIMD_SEARCH_DISPATCH(algorithm, ...) return scalar_##algorithm(__VA_ARGS__)
+
+#endif
+
+/* --- SIMD ALGORITHMS --- */
+
+/* Returns the index of the first element of `p[0..n)` equal to `value`, or `n` if there is none */
+template <simd_searchable T>
+size_t simd_find(const T *p, size_t n, T value) {
+    SIMD_SEARCH_DISPATCH(find, p, n, value);
+}
+
+/* Returns the number of elements of `p[0..n)` equal to `value` */
+template <simd_searchable T>
+size_t simd_count(const T *p, size_t n, T value) {
+    SIMD_SEARCH_DISPATCH(count, p, n, value);
+}
+
+/* Returns the index of the first smallest element of `p[0..n)`, or `n` if `n` is 0 */
+template <simd_searchable T>
+size_t simd_min_index(const T *p, size_t n) {
+    SIMD_SEARCH_DISPATCH(min_index, p, n);
+}
+
+/* Returns the index of the first largest element of `p[0..n)`, or `n` if `n` is 0 */
+template <simd_searchable T>
+size_t simd_max_index(const T *p, size_t n) {
+    SIMD_SEARCH_DISPATCH(max_index, p, n);
+}
+
+#undef SIMD_SEARCH_DISPATCH
+
+#endif
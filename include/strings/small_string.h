@@ -0,0 +1,673 @@
+/*
+@file small_string.h
+@brief Defines and implements `SmallString<N, CacheHash, Allocator, Layout>`, a string which stores
+up to `N` characters inline (making zero dynamic memory allocations), using the storage of
+`StackAssistedVector<char, N + 1>`.
+
+This file includes the following types:
+- `SmallString<N, CacheHash, Allocator, Layout>`
+*/
+
+#ifndef SMALL_STRING_H
+#define SMALL_STRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "simd/simd_search.h"
+#include "vector_variations/growth_policies.h"
+#include "vector_variations/stack_assisted_vector.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace small_string_detail {
+
+template <typename T>
+T load(const char *p) {
+    T result;
+    std::memcpy(&result, p, sizeof(T));
+    return result;
+}
+
+/* Returns the index of the first differing byte of `x` and `y`, which must differ, where each
+holds bytes loaded from memory (so the first byte is the lowest on little-endian machines) */
+template <typename T>
+size_t first_differing_byte(T x, T y) {
+    return static_cast<size_t>(std::countr_zero(x ^ y)) / 8;
+}
+
+/* Returns the index of the first position at which `a[0..n)` and `b[0..n)` differ, or `n` if they
+are equal. With SSE2, 16 bytes are compared at a time, and the last (partial) block is compared by
+reloading the last 16 bytes; shorter strings are compared as one or two (overlapping) 8-byte or
+4-byte words, so that the short strings which dominate keys need no loop at all. */
+inline size_t first_mismatch(const char *a, const char *b, size_t n) {
+    if constexpr (std::endian::native == std::endian::little) {
+#if defined(__SSE2__)
+        if (n >= 16) {
+            auto mismatch_mask = [&](size_t i) {
+                auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                auto y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^ 0xFFFFu;
+            };
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                if (auto mask = mismatch_mask(i)) {
+                    return i + std::countr_zero(mask);
+                }
+            }
+            if (i < n) {
+                if (auto mask = mismatch_mask(n - 16)) {
+                    return n - 16 + std::countr_zero(mask);
+                }
+            }
+            return n;
+        }
+#endif
+        if (n >= 8) {
+            for (size_t i = 0; i + 8 <= n; i += 8) {
+                if (auto x = load<uint64_t>(a + i), y = load<uint64_t>(b + i); x != y) {
+                    return i + first_differing_byte(x, y);
+                }
+            }
+            if (auto x = load<uint64_t>(a + n - 8), y = load<uint64_t>(b + n - 8); x != y) {
+                return n - 8 + first_differing_byte(x, y);
+            }
+            return n;
+        }
+        if (n >= 4) {
+            if (auto x = load<uint32_t>(a), y = load<uint32_t>(b); x != y) {
+                return first_differing_byte(x, y);
+            }
+            if (auto x = load<uint32_t>(a + n - 4), y = load<uint32_t>(b + n - 4); x != y) {
+                return n - 4 + first_differing_byte(x, y);
+            }
+            return n;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] != b[i]) {
+            return i;
+        }
+    }
+    return n;
+}
+
+/* Returns a mask with the highest bit of each zero byte of `x` set (and possibly the highest bits
+of some bytes following a zero byte, which does not matter when looking for the first one) */
+template <typename T>
+T zero_bytes(T x) {
+    constexpr T ones = static_cast<T>(~T{0}) / 0xFF;
+    return (x - ones) & ~x & static_cast<T>(ones << 7);
+}
+
+/* Returns the index of the first byte of `word` equal to `c`, or `npos` */
+template <typename T>
+size_t find_in_word(T word, char c) {
+    constexpr T ones = static_cast<T>(~T{0}) / 0xFF;
+    auto mask = zero_bytes(static_cast<T>(word ^ (ones * static_cast<unsigned char>(c))));
+    return (mask == 0 ? std::string_view::npos : static_cast<size_t>(std::countr_zero(mask)) / 8);
+}
+
+/* Returns the index of the first occurrence of `c` in `p[0..n)`, or `n`. Long strings are searched
+with `simd_find`, but as its kernels fall back to scalar code for strings shorter than one (up to
+64-byte) vector, shorter strings are searched here 16 bytes at a time with SSE2, or as one or two
+(overlapping) words. */
+inline size_t find_char(const char *p, size_t n, char c) {
+    constexpr auto npos = std::string_view::npos;
+    if (n >= 64) {
+        return simd_find(p, n, c);
+    }
+    if constexpr (std::endian::native == std::endian::little) {
+#if defined(__SSE2__)
+        if (n >= 16) {
+            auto needle = _mm_set1_epi8(c);
+            auto match_mask = [&](size_t i) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            };
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                if (auto mask = match_mask(i)) {
+                    return i + std::countr_zero(mask);
+                }
+            }
+            if (i < n) {
+                if (auto mask = match_mask(n - 16)) {
+                    return n - 16 + std::countr_zero(mask);
+                }
+            }
+            return n;
+        }
+#endif
+        if (n >= 8) {
+            for (size_t i = 0; i + 8 <= n; i += 8) {
+                if (auto index = find_in_word(load<uint64_t>(p + i), c); index != npos) {
+                    return i + index;
+                }
+            }
+            if (auto index = find_in_word(load<uint64_t>(p + n - 8), c); index != npos) {
+                return n - 8 + index;
+            }
+            return n;
+        }
+        if (n >= 4) {
+            if (auto index = find_in_word(load<uint32_t>(p), c); index != npos) {
+                return index;
+            }
+            if (auto index = find_in_word(load<uint32_t>(p + n - 4), c); index != npos) {
+                return n - 4 + index;
+            }
+            return n;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] == c) {
+            return i;
+        }
+    }
+    return n;
+}
+
+/* Returns the index of the first occurrence of `needle[0..m)` in `haystack[0..n)`, or `npos`.
+With SSE2, every block of 16 candidate positions is filtered by comparing both the first and the
+last character of the needle at once, and only the positions matching both are compared in full. */
+inline size_t find_substring(const char *haystack, size_t n, const char *needle, size_t m) {
+    constexpr auto npos = std::string_view::npos;
+    if (m == 0) {
+        return 0;
+    }
+    if (m > n) {
+        return npos;
+    }
+    if (m == 1) {
+        auto index = find_char(haystack, n, needle[0]);
+        return (index == n ? npos : index);
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    auto first = _mm_set1_epi8(needle[0]);
+    auto last = _mm_set1_epi8(needle[m - 1]);
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        auto block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        auto block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + m - 1));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))
+        ));
+        for (; mask != 0; mask &= mask - 1) {
+            auto candidate = i + std::countr_zero(mask);
+            if (std::memcmp(haystack + candidate + 1, needle + 1, m - 2) == 0) {
+                return candidate;
+            }
+        }
+    }
+#endif
+    /* The remaining candidate positions (all of them, for short haystacks) are found by searching
+    for the first character of the needle */
+    for (auto last_candidate = n - m; i <= last_candidate; ++i) {
+        i += find_char(haystack + i, last_candidate + 1 - i, needle[0]);
+        if (i > last_candidate) {
+            break;
+        }
+        if (std::memcmp(haystack + i + 1, needle + 1, m - 1) == 0) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+/* Hashes `p[0..n)` 8 bytes at a time, mixing each word in with a multiplication. Strings shorter
+than 8 bytes are read as two (overlapping) 4-byte words, or as their first, middle, and last
+bytes, so that hashing needs no byte-by-byte loop. The result is never 0 (which `HashCache` uses
+to mean "not computed"). */
+inline size_t hash_bytes(const char *p, size_t n) {
+    constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    auto mix = [](uint64_t h, uint64_t word) {
+        h = (h ^ word) * multiplier;
+        return h ^ (h >> 32);
+    };
+    uint64_t h = mix(0x243F6A8885A308D3ull, n);
+    if (n >= 8) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            h = mix(h, load<uint64_t>(p + i));
+        }
+        if (i < n) {
+            h = mix(h, load<uint64_t>(p + n - 8));
+        }
+    } else if (n >= 4) {
+        h = mix(h, uint64_t{load<uint32_t>(p)} << 32 | load<uint32_t>(p + n - 4));
+    } else if (n > 0) {
+        auto a = static_cast<unsigned char>(p[0]);
+        auto b = static_cast<unsigned char>(p[n / 2]);
+        auto c = static_cast<unsigned char>(p[n - 1]);
+        h = mix(h, uint64_t{a} << 16 | uint64_t{b} << 8 | c);
+    }
+    h = mix(h, h >> 29);
+    return static_cast<size_t>(h + (h == 0));
+}
+
+/* `HashCache` stores the hash of a string once it has been computed (or 0 if it has not been, or
+has been invalidated since). It is an atomic (accessed with relaxed loads and stores, which are
+plain moves on common platforms) so that `hash()` may be called concurrently on a shared string. */
+struct HashCache {
+    mutable std::atomic<size_t> value{0};
+
+    HashCache() = default;
+    HashCache(const HashCache &other) : value{other.value.load(std::memory_order_relaxed)} {}
+    HashCache& operator= (const HashCache &other) {
+        value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+};
+
+struct NoHashCache {};
+
+}  /* namespace small_string_detail */
+
+/* `SmallString<N, CacheHash, Allocator, Layout>` is a string of `char`s, which stores up to `N`
+characters inline and makes zero dynamic memory allocations until it holds more than that. (For
+comparison, libstdc++'s `std::string` stores up to 15 characters inline.) Its characters are kept
+in a `StackAssistedVector<char, N + 1, Allocator, DoublingGrowth, Layout>`, whose extra inline
+character (and, once on the heap, whose capacity, which is always kept above the size) leaves
+room for a null terminator. By default, `Layout` is `CompactSAVLayout<uint32_t>`, so that
+`SmallString<23>` is 32 bytes, like `std::string`.
+
+Beyond the usual string operations:
+- The null terminator is only written on demand, by `c_str()`, so appending never writes it. (Use
+  `view()`, or the implicit conversion to `std::string_view`, to read a `const SmallString`.)
+- Appending reserves room for the appended characters and for the terminator with a single
+  geometric growth, rather than growing once for the characters and again for the terminator.
+- `find` searches with SIMD instructions: for characters 16 bytes at a time with SSE2 (or with
+  `simd_find`, for long strings), and for substrings by filtering candidate positions 16 at a time.
+  Comparisons likewise find the first differing character 16 bytes at a time. Short strings are
+  searched and compared a word at a time instead.
+- `hash()` reads the string a word at a time. If `CacheHash` is true, the hash is also cached in
+  the string (at the cost of 8 more bytes), and recomputed only after the string is modified (which
+  includes any non-const access to its characters). `std::hash<SmallString<...>>` calls `hash()`. */
+template <
+    size_t N, bool CacheHash = false, typename Allocator = std::allocator<char>,
+    typename Layout = CompactSAVLayout<uint32_t>
+>
+struct SmallString {
+public:
+    using value_type      = char;
+    using traits_type     = std::char_traits<char>;
+    using allocator_type  = Allocator;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using reference       = char&;
+    using const_reference = const char&;
+    using pointer         = char*;
+    using const_pointer   = const char*;
+    using iterator        = char*;
+    using const_iterator  = const char*;
+
+    static constexpr size_type npos = std::string_view::npos;
+
+    /* --- CONSTRUCTORS --- */
+
+    SmallString(const Allocator &allocator = {}) : chars(allocator) {}
+
+    SmallString(const char *s, const Allocator &allocator = {})
+    : SmallString(std::string_view(s), allocator) {}
+
+    explicit SmallString(std::string_view s, const Allocator &allocator = {})
+    : chars(allocator) {
+        append(s);
+    }
+
+    SmallString(size_type count, char c, const Allocator &allocator = {}) : chars(allocator) {
+        append(count, c);
+    }
+
+    template <std::input_iterator InputIt>
+    SmallString(InputIt first, InputIt last, const Allocator &allocator = {}) : chars(allocator) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            reserve(std::distance(first, last));
+        }
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    /* Copies `other`'s characters. (Copying `chars` itself would reserve exactly `other.size()`
+    characters on the heap, leaving no room for the null terminator.) */
+    SmallString(const SmallString &other)
+    : chars(std::allocator_traits<Allocator>::select_on_container_copy_construction(
+          other.chars.get_allocator()
+      )),
+      hash_cache(other.hash_cache) {
+        chars.reserve(other.size() + 1);
+        chars.append_range(other.view());
+    }
+
+    SmallString(SmallString &&other) = default;
+
+    /* Copies `other`'s characters, reusing this string's capacity if it suffices */
+    SmallString& operator= (const SmallString &other) {
+        if (this != &other) {
+            assign(other.view());
+            hash_cache = other.hash_cache;
+        }
+        return *this;
+    }
+
+    /* Takes over `other`'s characters (stealing its heap array, if any), leaving it empty */
+    SmallString& operator= (SmallString &&other) {
+        if (this != &other) {
+            std::destroy_at(&chars);
+            std::construct_at(&chars, std::move(other.chars));
+            hash_cache = other.hash_cache;
+            other.modified();
+        }
+        return *this;
+    }
+
+    SmallString& operator= (std::string_view s) { return assign(s); }
+
+    /* Replaces the characters with those of `s` (which may be part of this string) */
+    SmallString& assign(std::string_view s) {
+        if (aliases(s)) {
+            SmallString copy(s);
+            return *this = std::move(copy);
+        }
+        chars.clear();
+        return append(s);
+    }
+
+    /* --- ITERATORS --- */
+
+    iterator begin() { modified(); return chars.begin(); }
+    const_iterator begin() const { return chars.begin(); }
+    const_iterator cbegin() const { return begin(); }
+    iterator end() { return begin() + size(); }
+    const_iterator end() const { return begin() + size(); }
+    const_iterator cend() const { return end(); }
+
+    /* --- GETTERS --- */
+
+    bool empty() const { return chars.empty(); }
+    size_type size() const { return chars.size(); }
+    size_type length() const { return size(); }
+
+    /* Returns the number of characters the string can hold without growing (not counting the
+    room kept for the null terminator) */
+    size_type capacity() const { return chars.capacity() - 1; }
+
+    /* Returns true iff the characters are stored inline */
+    bool is_inline() const { return chars.is_inline(); }
+
+    char* data() { return begin(); }
+    const char* data() const { return begin(); }
+
+    /* Writes a null terminator after the last character (for which there is always room), and
+    returns the characters */
+    const char* c_str() {
+        auto *characters = chars.begin();
+        characters[size()] = '\0';
+        return characters;
+    }
+
+    std::string_view view() const { return {begin(), size()}; }
+    operator std::string_view() const { return view(); }
+
+    char& operator[] (size_type index) { return begin()[index]; }
+    const char& operator[] (size_type index) const { return begin()[index]; }
+
+    /* Like `operator[]`, but throws `std::out_of_range` if `index` is out of bounds */
+    char& at(size_type index) { return (*this)[checked(index)]; }
+    const char& at(size_type index) const { return (*this)[checked(index)]; }
+
+    char& front() { return (*this)[0]; }
+    const char& front() const { return (*this)[0]; }
+    char& back() { return (*this)[size() - 1]; }
+    const char& back() const { return (*this)[size() - 1]; }
+
+    /* --- SEARCHING AND COMPARING --- */
+
+    /* Returns the index of the first occurrence of `c` at or after `position`, or `npos` */
+    size_type find(char c, size_type position = 0) const {
+        if (position >= size()) {
+            return npos;
+        }
+        auto index = small_string_detail::find_char(begin() + position, size() - position, c);
+        return (index == size() - position ? npos : position + index);
+    }
+
+    /* Returns the index of the first occurrence of `s` at or after `position`, or `npos` */
+    size_type find(std::string_view s, size_type position = 0) const {
+        if (position > size()) {
+            return npos;
+        }
+        auto index = small_string_detail::find_substring(
+            begin() + position, size() - position, s.data(), s.size()
+        );
+        return (index == npos ? npos : position + index);
+    }
+
+    bool contains(char c) const { return find(c) != npos; }
+    bool contains(std::string_view s) const { return find(s) != npos; }
+
+    bool starts_with(std::string_view s) const {
+        return s.size() <= size() &&
+               small_string_detail::first_mismatch(begin(), s.data(), s.size()) == s.size();
+    }
+    bool ends_with(std::string_view s) const {
+        return s.size() <= size() &&
+               small_string_detail::first_mismatch(end() - s.size(), s.data(), s.size()) == s.size();
+    }
+
+    /* Compares this string with `s` lexicographically (comparing characters as `unsigned char`,
+    as `std::char_traits<char>` does), and returns a negative value, 0, or a positive value */
+    int compare(std::string_view s) const {
+        auto common = std::min(size(), s.size());
+        auto index = small_string_detail::first_mismatch(begin(), s.data(), common);
+        if (index < common) {
+            return static_cast<unsigned char>((*this)[index]) <
+                   static_cast<unsigned char>(s[index]) ? -1 : 1;
+        }
+        return (size() < s.size() ? -1 : (size() > s.size() ? 1 : 0));
+    }
+
+    friend bool operator== (const SmallString &a, std::string_view b) {
+        return a.size() == b.size() &&
+               small_string_detail::first_mismatch(a.begin(), b.data(), b.size()) == b.size();
+    }
+    friend std::strong_ordering operator<=> (const SmallString &a, std::string_view b) {
+        return a.compare(b) <=> 0;
+    }
+
+    /* Returns the hash of the characters (see `small_string_detail::hash_bytes`), which is cached
+    if `CacheHash` is true */
+    size_t hash() const {
+        if constexpr (CacheHash) {
+            auto cached = hash_cache.value.load(std::memory_order_relaxed);
+            if (cached == 0) {
+                cached = small_string_detail::hash_bytes(begin(), size());
+                hash_cache.value.store(cached, std::memory_order_relaxed);
+            }
+            return cached;
+        } else {
+            return small_string_detail::hash_bytes(begin(), size());
+        }
+    }
+
+    /* --- MODIFIERS --- */
+
+    /* Makes room for at least `new_capacity` characters (and a null terminator) */
+    void reserve(size_type new_capacity) { chars.reserve(new_capacity + 1); }
+
+    /* Moves the characters back inline if they fit, or into a heap array with room for exactly
+    `size()` characters (and a null terminator) otherwise */
+    void shrink_to_fit() {
+        if (capacity() == size()) {
+            return;
+        }
+        if (size() <= N) {
+            chars.shrink_to_fit();
+            return;
+        }
+        SmallString shrunk(chars.get_allocator());
+        shrunk.chars.reserve(size() + 1);
+        shrunk.chars.append_range(view());
+        *this = std::move(shrunk);
+    }
+
+    void resize(size_type new_size, char c = '\0') {
+        if (new_size > size()) {
+            grow_for(new_size - size());
+        }
+        chars.resize(new_size, c);
+        modified();
+    }
+
+    /* Like `std::string::resize_and_overwrite`: makes room for `new_size` characters (leaving
+    those past the current size uninitialized), then lets `operation(data, new_size)` write them,
+    and keeps as many as it returns (see `StackAssistedVector::resize_and_overwrite`) */
+    template <typename Operation>
+    requires std::invocable<Operation, char*, size_type>
+    void resize_and_overwrite(size_type new_size, Operation operation) {
+        if (new_size > size()) {
+            grow_for(new_size - size());
+        }
+        chars.resize_and_overwrite(new_size, std::move(operation));
+        modified();
+    }
+
+    void clear() {
+        chars.clear();
+        modified();
+    }
+
+    void push_back(char c) {
+        grow_for(1);
+        chars.push_back(c);
+        modified();
+    }
+
+    void pop_back() {
+        chars.pop_back();
+        modified();
+    }
+
+    /* Appends the characters of `s` (which may be part of this string), growing at most once */
+    SmallString& append(std::string_view s) {
+        if (aliases(s)) {
+            auto offset = static_cast<size_t>(s.data() - chars.begin());
+            grow_for(s.size());
+            s = std::string_view(chars.begin() + offset, s.size());
+        } else {
+            grow_for(s.size());
+        }
+        chars.append_range(s);
+        modified();
+        return *this;
+    }
+
+    SmallString& append(size_type count, char c) {
+        grow_for(count);
+        chars.insert(chars.end(), count, c);
+        modified();
+        return *this;
+    }
+
+    SmallString& operator+= (std::string_view s) { return append(s); }
+    SmallString& operator+= (char c) { push_back(c); return *this; }
+
+    /* Erases `count` characters (or as many as there are) starting from `position` */
+    SmallString& erase(size_type position = 0, size_type count = npos) {
+        position = std::min(checked_position(position), size());
+        count = std::min(count, size() - position);
+        chars.erase(chars.begin() + position, chars.begin() + position + count);
+        modified();
+        return *this;
+    }
+
+private:
+    StackAssistedVector<char, N + 1, Allocator, DoublingGrowth, Layout> chars;
+
+    [[no_unique_address]] std::conditional_t<
+        CacheHash, small_string_detail::HashCache, small_string_detail::NoHashCache
+    > hash_cache;
+
+    /* Invalidates the cached hash, if any */
+    void modified() {
+        if constexpr (CacheHash) {
+            hash_cache.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /* Makes room for `count` more characters and a null terminator, growing (geometrically) at
+    most once */
+    void grow_for(size_type count) {
+        auto required = size() + count + 1;
+        if (required > chars.capacity()) {
+            auto grown = std::min(
+                DoublingGrowth::next_capacity(chars.capacity(), required, 1), chars.max_size()
+            );
+            chars.reserve(std::max(grown, required));
+        }
+    }
+
+    /* Returns true iff `s` points into this string's characters */
+    bool aliases(std::string_view s) const {
+        std::less<const char*> less;
+        return !s.empty() && !less(s.data(), begin()) && less(s.data(), begin() + chars.capacity());
+    }
+
+    size_type checked(size_type index) const {
+        if (index >= size()) {
+            throw std::out_of_range(std::format(
+                "SmallString: index {} out of range for size {}", index, size()
+            ));
+        }
+        return index;
+    }
+
+    size_type checked_position(size_type position) const {
+        if (position > size()) {
+            throw std::out_of_range(std::format(
+                "SmallString: position {} out of range for size {}", position, size()
+            ));
+        }
+        return position;
+    }
+};
+
+/* Specialize `std::hash` for `SmallString`, using its (possibly cached) `hash()` */
+template <size_t N, bool CacheHash, typename Allocator, typename Layout>
+struct std::hash<SmallString<N, CacheHash, Allocator, Layout>> {
+    size_t operator() (const SmallString<N, CacheHash, Allocator, Layout> &s) const {
+        return s.hash();
+    }
+};
+
+/* Specialize `std::formatter` for `SmallString`, formatting it as a `std::string_view` (so format
+specifications such as width and alignment apply) */
+template <size_t N, bool CacheHash, typename Allocator, typename Layout>
+struct std::formatter<SmallString<N, CacheHash, Allocator, Layout>>
+: public std::formatter<std::string_view>
+{
+    auto format(
+        const SmallString<N, CacheHash, Allocator, Layout> &s, std::format_context &format_context
+    ) const {
+        return std::formatter<std::string_view>::format(s.view(), format_context);
+    }
+};
+
+#endif
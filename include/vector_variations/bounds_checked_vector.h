@@ -1,10 +1,12 @@
 /*
 @file bounds_checked_vector.h
-@brief Defines and implements `BoundsCheckedVector<T, Allocator>`, a bounds-checked version of
-`std::vector<T, Allocator>`.
+@brief Defines and implements `BoundsCheckedVector<T, Allocator, Level>`, a bounds-checked version
+of `std::vector<T, Allocator>`.
 
 This file includes the following types:
-- `BoundsCheckedVector<T, Allocator>`
+- `BoundsCheckLevel`
+- `BoundsCheckHistory`
+- `BoundsCheckedVector<T, Allocator, Level>`
 */
 
 #ifndef BOUNDS_CHECKED_VECTOR_H
@@ -15,21 +17,131 @@ This file includes the following types:
 #include <source_location>
 #include <iostream>
 #include <format>
-#include <optional>
 #include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+/* `BoundsCheckLevel` selects how much checking and bookkeeping a `BoundsCheckedVector` does:
+- `Off`: No checking at all; `BoundsCheckedVector` behaves exactly like `std::vector`.
+- `BranchOnly`: `operator[]`, `front()`, and `back()` check their index with a single comparison
+against the size, and jump to an outlined cold function that reports the error and terminates the
+program if it is out of bounds. No bookkeeping is done by any other function, so the generated
+code for an access is that of `std::vector::operator[]` plus one compare-and-branch.
+- `Sampled`: Like `Full`, except that only one in every `BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD` size
+changes (per thread) is recorded. Every access is still checked.
+- `Full`: Every access is checked, and every construction and size change records its source
+location (see `BoundsCheckHistory`), so that out-of-bounds accesses can be reported with detailed
+diagnostics.
+The default level is `Full`, which can be changed for a whole program by defining
+`BOUNDS_CHECKED_VECTOR_DEFAULT_LEVEL` (for instance, with
+`-DBOUNDS_CHECKED_VECTOR_DEFAULT_LEVEL=BranchOnly` for release builds). */
+enum class BoundsCheckLevel { Off, BranchOnly, Sampled, Full };
+
+#ifndef BOUNDS_CHECKED_VECTOR_DEFAULT_LEVEL
+#define BOUNDS_CHECKED_VECTOR_DEFAULT_LEVEL Full
+#endif
+
+/* With `BoundsCheckLevel::Sampled`, one in every `BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD` size
+changes is recorded. This must be a power of two. */
+#ifndef BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD
+#define BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD 64
+#endif
+
+inline constexpr BoundsCheckLevel default_bounds_check_level =
+    BoundsCheckLevel::BOUNDS_CHECKED_VECTOR_DEFAULT_LEVEL;
+
+/* `BOUNDS_CHECKED_VECTOR_HISTORY_SIZE` is the number of constructions and size changes that
+`BoundsCheckHistory` remembers per thread. This must be a power of two. */
+#ifndef BOUNDS_CHECKED_VECTOR_HISTORY_SIZE
+#define BOUNDS_CHECKED_VECTOR_HISTORY_SIZE 1024
+#endif
+
+/* `BoundsCheckHistory` is a per-thread ring buffer of the most recent constructions and size
+changes of every `BoundsCheckedVector` on that thread, keyed by the address of the container.
+
+Storing the size-change history in this side table (rather than in each `BoundsCheckedVector`)
+keeps the containers small, and turns recording a size change into a few stores to a cache line
+that is almost always hot, with no dependence on the container's own memory. The history is only
+ever searched when an out-of-bounds access is reported, at which point the most recent entry for
+the offending container is looked up. This does mean that size changes made on other threads, or
+that have since been overwritten by `BOUNDS_CHECKED_VECTOR_HISTORY_SIZE` newer entries, are not
+reported. */
+struct BoundsCheckHistory {
+    static constexpr size_t capacity = BOUNDS_CHECKED_VECTOR_HISTORY_SIZE;
+    static_assert(
+        (capacity & (capacity - 1)) == 0, "BOUNDS_CHECKED_VECTOR_HISTORY_SIZE must be a power of two"
+    );
+
+    /* `construction` is stored as the `old_size` of entries that record a construction */
+    static constexpr size_t construction = static_cast<size_t>(-1);
+
+    struct Entry {
+        const void *container = nullptr;
+        std::source_location sl;
+        size_t old_size = 0, new_size = 0;
+    };
+
+    Entry entries[capacity];
+    /* `total` = The total number of entries ever recorded; the next one goes in
+    `entries[total % capacity]` */
+    size_t total = 0;
+    /* `sampled_size_changes` = The number of size changes seen by `BoundsCheckLevel::Sampled`
+    containers on this thread, used to decide which ones to record */
+    size_t sampled_size_changes = 0;
+
+    /* Returns the history of the current thread */
+    static BoundsCheckHistory& current() {
+        constinit static thread_local BoundsCheckHistory history;
+        return history;
+    }
+
+    void record(
+        const void *container, size_t old_size, size_t new_size, const std::source_location &sl
+    ) {
+        entries[total++ & (capacity - 1)] = {container, sl, old_size, new_size};
+    }
+
+    void record_construction(const void *container, const std::source_location &sl) {
+        record(container, construction, 0, sl);
+    }
+
+    /* Returns the most recent size change of `container`, or `nullptr` if there is none in the
+    history after its most recent construction. */
+    const Entry* find_last_size_change(const void *container) const {
+        auto remembered = (total < capacity ? total : capacity);
+        for (size_t i = 1; i <= remembered; ++i) {
+            const auto &entry = entries[(total - i) & (capacity - 1)];
+            if (entry.container == container) {
+                return (entry.old_size == construction ? nullptr : &entry);
+            }
+        }
+        return nullptr;
+    }
+};
 
-/* `BoundsCheckedVector<T, Allocator>` is a bounds-checked version of `std::vector<T, Allocator>`.
-All calls to `operator[]`, `front()`, or `back()` will now raise a runtime error with detailed
-diagnostic information on the event of an out-of-bounds access. The information includes:
+/* `BoundsCheckedVector<T, Allocator, Level>` is a bounds-checked version of
+`std::vector<T, Allocator>`. All calls to `operator[]`, `front()`, or `back()` will now raise a
+runtime error with detailed diagnostic information on the event of an out-of-bounds access. The
+information includes:
 1. The value of the index that was out-of-bounds,
 2. The file/function/line/column at which the out-of-bounds access occurs,
 3. The file/function/line/column at which the `BoundsCheckedVector` was last initialized, and
 4. The file/function/line/column at which the size for this `BoundsCheckedVector` last changed,
-along with information about the size change itself. */
-template <typename T, typename Allocator = std::allocator<T>>
+along with information about the size change itself.
+How much of this is done is decided by `Level`; see `BoundsCheckLevel`. */
+template <
+    typename T, typename Allocator = std::allocator<T>,
+    BoundsCheckLevel Level = default_bounds_check_level
+>
 class BoundsCheckedVector : public std::vector<T, Allocator> {
+    using Base = std::vector<T, Allocator>;
     using SourceLoc = std::source_location;  /* Allows shortening code */
 
+    /* Whether source locations are recorded at all (that is, whether `Level` is `Sampled` or
+    `Full`) */
+    static constexpr bool records_source_locations = (Level >= BoundsCheckLevel::Sampled);
+
     /* `operator[]` takes exactly one argument, but for `BoundsCheckedVector`, we need it to
     take in not only the index, but also a `std::source_location` constructed at the call site.
     This motivates us to define a type which wraps an index along with a `std::source_location`;
@@ -54,16 +166,56 @@ class BoundsCheckedVector : public std::vector<T, Allocator> {
         {}
     };
 
-    /* `last_construction_info` = The `std::source_location` corresponding to the location
-    where this `BoundsCheckedVector<T>` was last constructed or initialized. */
-    SourceLoc last_construction_info;
-    /* `last_size_change` = The size before and after the most recent change to the size of
-    this `BoundsCheckedVector<T>`. If the size was never changed, `last_size_change` will
-    remain unset. */
-    std::optional<std::pair<int, int>> last_size_change;
-    /* `last_size_change_info` = The `std::source_location` corresponding to the location of
-    the last size change. */
-    SourceLoc last_size_change_info;
+    /* `Diagnostics` holds the information recorded for `Sampled` and `Full` checking. Size
+    changes are recorded in the `BoundsCheckHistory` of the current thread instead. */
+    struct Diagnostics {
+        /* `last_construction_info` = The `std::source_location` corresponding to the location
+        where this `BoundsCheckedVector<T>` was last constructed or initialized. */
+        SourceLoc last_construction_info;
+
+        /* Also records the construction of `container` in the history, so that size changes of
+        an earlier container at the same address are not attributed to `container`. */
+        Diagnostics(const void *container, const SourceLoc &construction_info)
+        : last_construction_info{construction_info}
+        {
+            BoundsCheckHistory::current().record_construction(container, construction_info);
+        }
+    };
+
+    /* For `Off` and `BranchOnly` checking, nothing is recorded, and `NoDiagnostics` takes up no
+    space, so that the `BoundsCheckedVector` is exactly as large as a `std::vector`. */
+    struct NoDiagnostics {
+        NoDiagnostics(const void*, const SourceLoc&) {}
+    };
+
+    [[no_unique_address]] std::conditional_t<records_source_locations, Diagnostics, NoDiagnostics>
+        diagnostics;
+
+    static_assert(
+        (BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD & (BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD - 1)) == 0,
+        "BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD must be a power of two"
+    );
+
+    /* Records that the size changed from `old_size` to the current size at `curr_info`. With
+    `Sampled` checking, only the first of every `BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD` size changes
+    on this thread is recorded, and the recording itself is outlined (see `record_sampled`); with
+    `Off` or `BranchOnly` checking, nothing is recorded. */
+    void record_size_change(size_t old_size, const SourceLoc &curr_info) {
+        if constexpr (Level == BoundsCheckLevel::Sampled) {
+            auto &history = BoundsCheckHistory::current();
+            if ((history.sampled_size_changes++ & (BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD - 1)) == 0)
+                [[unlikely]] {
+                record_sampled(old_size, curr_info);
+            }
+        } else if constexpr (Level == BoundsCheckLevel::Full) {
+            BoundsCheckHistory::current().record(this, old_size, Base::size(), curr_info);
+        }
+    }
+
+    [[gnu::cold, gnu::noinline]]
+    void record_sampled(size_t old_size, const SourceLoc &curr_info) {
+        BoundsCheckHistory::current().record(this, old_size, Base::size(), curr_info);
+    }
 
     /* `format_source_location` is an utility function which pretty-formats the information
     contained within a given `std::source_location` `sl`. In VSCode, the outputted locations
@@ -76,37 +228,58 @@ class BoundsCheckedVector : public std::vector<T, Allocator> {
         );
     }
 
-    /* Checks if the index `index` passed to `operator[]` is out-of-bounds; if it is, then
-    prints detailed diagnostic output and calls `std::exit(-1)`. */
-    auto check_if_out_of_bounds(const IndexWithSourceLoc &index) const {
-        if (index < 0 || index >= static_cast<long long>(std::vector<T>::size())) {
-            /* Print the out-of-bounds index, and provide information about where this
-            `BoundsCheckedVector<T>` was most recently constructed or initialized */
+    /* Checks if `index` is out-of-bounds; if it is, then reports the error (see
+    `report_out_of_bounds`) and terminates the program. `sl` points to the location of the access,
+    or is `nullptr` if it is unknown. The comparison is done as an unsigned comparison, so that
+    negative indices are caught by the same single branch. */
+    void check_if_out_of_bounds(long long index, const SourceLoc *sl) const {
+        if constexpr (Level != BoundsCheckLevel::Off) {
+            if (static_cast<size_t>(index) >= Base::size()) [[unlikely]] {
+                report_out_of_bounds(index, sl);
+            }
+        }
+    }
+
+    /* Prints diagnostic output for the out-of-bounds access of `index` at `*sl`, then calls
+    `std::exit(-1)`. This is outlined and marked cold, so that the (never-taken) error path does
+    not take up space or registers in the code performing the access. */
+    [[gnu::cold, gnu::noinline, noreturn]]
+    void report_out_of_bounds(long long index, const SourceLoc *sl) const {
+        /* Print the out-of-bounds index (and where the access happened, if known) */
+        std::cerr << std::format(
+            "{}: Index out of bounds; {} for a std::vector of size {}\n",
+            (sl ? format_source_location(*sl) : std::string("Unknown location")), index,
+            Base::size()
+        );
+
+        if constexpr (records_source_locations) {
+            /* Provide information about where this `BoundsCheckedVector<T>` was most recently
+            constructed or initialized */
             std::cerr << std::format(
-                "{}: Index out of bounds; {} for a std::vector of size {}\n"
                 "Help: The std::vector was most recently constructed at {}\n",
-                format_source_location(index.sl), index.index, std::vector<T>::size(),
-                format_source_location(last_construction_info)
+                format_source_location(diagnostics.last_construction_info)
             );
 
-            /* If this `BoundsCheckedVector<T>` has had its size changed, print information
-            about where that size change occurred, and the size before and after that change. */
-            if (last_size_change.has_value()) {
-                auto [old_size, new_size] = *last_size_change;
-
+            /* If this `BoundsCheckedVector<T>` has had its size changed (as far as this thread's
+            history remembers), print information about where that size change occurred, and the
+            size before and after that change. */
+            if (auto entry = BoundsCheckHistory::current().find_last_size_change(this)) {
                 std::cerr << std::format(
-                    "Help: This std::vector's most recent size change was from {} to {} at {}\n"
+                    "Help: This std::vector's most recent {}size change was from {} to {} at {}\n"
                     "This does not include size changes from std::erase/std::erase_if, however.\n",
-                    old_size, new_size, format_source_location(last_size_change_info)
+                    (Level == BoundsCheckLevel::Sampled ? "sampled " : ""),
+                    entry->old_size, entry->new_size, format_source_location(entry->sl)
                 );
             } else {
-                std::cerr << "Note: This std::vector has no recorded size changes after its most "
-                             "recent construction/initialization.\n";
+                std::cerr << std::format(
+                    "Note: This std::vector has no recorded size changes after its most recent "
+                    "construction/initialization (among the last {} on this thread).\n",
+                    BoundsCheckHistory::capacity
+                );
             }
-
-            std::exit(-1);
         }
-        return;
+
+        std::exit(-1);
     }
 
 public:
@@ -114,54 +287,59 @@ public:
     /* --- IMPLEMENT operator[] --- */
 
     /* Accesses the `index`th (0-indexed) element of this `BoundsCheckedVector<T>`, terminating
-    the program if `index` is out of bounds (non-const version). */
-    auto& operator[] (const IndexWithSourceLoc &index) {
-        check_if_out_of_bounds(index);
-        return std::vector<T>::operator[](index);
+    the program if `index` is out of bounds (non-const version). With `Sampled` or `Full`
+    checking, the location of the access is captured for the error message. */
+    auto& operator[] (const IndexWithSourceLoc &index) requires records_source_locations {
+        check_if_out_of_bounds(index.index, &index.sl);
+        return Base::operator[](index.index);
     }
 
     /* Accesses the `index`th (0-indexed) element of this `BoundsCheckedVector<T>`, terminating
     the program if `index` is out of bounds (const version). */
-    const auto& operator[] (const IndexWithSourceLoc &index) const {
-        check_if_out_of_bounds(index);
-        return std::vector<T>::operator[](index);
+    const auto& operator[] (const IndexWithSourceLoc &index) const
+    requires records_source_locations {
+        check_if_out_of_bounds(index.index, &index.sl);
+        return Base::operator[](index.index);
+    }
+
+    /* With `Off` or `BranchOnly` checking, `operator[]` takes a plain index, so that the access
+    compiles to exactly the code of `std::vector::operator[]` (plus one comparison for
+    `BranchOnly`). */
+    auto& operator[] (size_t index) requires (!records_source_locations) {
+        check_if_out_of_bounds(static_cast<long long>(index), nullptr);
+        return Base::operator[](index);
+    }
+
+    const auto& operator[] (size_t index) const requires (!records_source_locations) {
+        check_if_out_of_bounds(static_cast<long long>(index), nullptr);
+        return Base::operator[](index);
     }
 
 
     /* --- IMPLEMENT OTHER RANDOM ACCESS FUNCTIONS --- */
 
     auto& front(const SourceLoc &curr_info = SourceLoc::current()) {
-        /* Delegate to `operator[]`. Explicitly construct the `IndexWithSourceLoc` using
-        the `std::source_location` for the actual call to `front()`, rather than using the
-        `std::source_location` for the internal call to `operator[]` here. */
-        return operator[]({0, curr_info});
+        /* Check the index using the `std::source_location` for the actual call to `front()` */
+        check_if_out_of_bounds(0, &curr_info);
+        return Base::front();
     }
 
     const auto& front(const SourceLoc &curr_info = SourceLoc::current()) const {
-        /* Delegate to `operator[]`. Explicitly construct the `IndexWithSourceLoc` using
-        the `std::source_location` for the actual call to `front()`, rather than using the
-        `std::source_location` for the internal call to `operator[]` here. */
-        return operator[]({0, curr_info});
+        /* Check the index using the `std::source_location` for the actual call to `front()` */
+        check_if_out_of_bounds(0, &curr_info);
+        return Base::front();
     }
 
     auto& back(const SourceLoc &curr_info = SourceLoc::current()) {
-        /* Delegate to `operator[]`. Explicitly construct the `IndexWithSourceLoc` using
-        the `std::source_location` for the actual call to `back()`, rather than using the
-        `std::source_location` for the internal call to `operator[]` here. */
-        return operator[]({
-            static_cast<IndexWithSourceLoc::IndexType>(std::vector<T>::size()) - 1,
-            curr_info
-        });
+        /* Check the index using the `std::source_location` for the actual call to `back()` */
+        check_if_out_of_bounds(static_cast<long long>(Base::size()) - 1, &curr_info);
+        return Base::back();
     }
 
     const auto& back(const SourceLoc &curr_info = SourceLoc::current()) const {
-        /* Delegate to `operator[]`. Explicitly construct the `IndexWithSourceLoc` using
-        the `std::source_location` for the actual call to `back()`, rather than using the
-        `std::source_location` for the internal call to `operator[]` here. */
-        return operator[]({
-            static_cast<IndexWithSourceLoc::IndexType>(std::vector<T>::size()) - 1,
-            curr_info
-        });
+        /* Check the index using the `std::source_location` for the actual call to `back()` */
+        check_if_out_of_bounds(static_cast<long long>(Base::size()) - 1, &curr_info);
+        return Base::back();
     }
 
     /*
@@ -170,166 +348,134 @@ public:
     function differs from the original function in exactly two ways:
     1. Each function now takes in the `std::source_location` corresponding to its call site, for
     debugging purposes; and,
-    2. Each function updates `last_size_change`/`last_size_change_info` with information about the
-    size-change it causes.
+    2. Each function calls `record_size_change` with information about the size-change it causes
+    (which, depending on `Level`, may do nothing).
     This is very straightforward. The only nuances show up in the `swap` functions, in which we
     need to remember to update information for both the current and the other `BoundsCheckedVector`
     passed in.
     */
 
     void clear(const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::clear();
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::clear();
+        record_size_change(old_size, curr_info);
     }
 
     auto insert(
-        std::vector<T>::const_iterator pos, const T &value,
+        Base::const_iterator pos, const T &value,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::insert(pos, value);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::insert(pos, value);
+        record_size_change(old_size, curr_info);
     }
 
     auto insert(
-        std::vector<T>::const_iterator pos, T &&value,
+        Base::const_iterator pos, T &&value,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::insert(pos, std::move(value));
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::insert(pos, std::move(value));
+        record_size_change(old_size, curr_info);
     }
 
     auto insert(
-        std::vector<T>::const_iterator pos, size_t count, const T &value,
+        Base::const_iterator pos, size_t count, const T &value,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::insert(pos, count, value);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::insert(pos, count, value);
+        record_size_change(old_size, curr_info);
     }
 
     template <typename InputIterator>
     auto insert(
-        std::vector<T>::const_iterator pos, InputIterator first, InputIterator last,
+        Base::const_iterator pos, InputIterator first, InputIterator last,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::insert(pos, first, last);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::insert(pos, first, last);
+        record_size_change(old_size, curr_info);
     }
 
     auto insert(
-        std::vector<T>::const_iterator pos, std::initializer_list<T> init,
+        Base::const_iterator pos, std::initializer_list<T> init,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::insert(pos, init);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::insert(pos, init);
+        record_size_change(old_size, curr_info);
     }
 
     template <typename... Args>
     auto emplace(
-        std::vector<T>::const_iterator pos, Args&&... args,
+        Base::const_iterator pos, Args&&... args,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::insert(pos, std::forward<Args>(args)...);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::insert(pos, std::forward<Args>(args)...);
+        record_size_change(old_size, curr_info);
     }
 
     auto erase(
-        std::vector<T>::const_iterator pos,
+        Base::const_iterator pos,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::erase(pos);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::erase(pos);
+        record_size_change(old_size, curr_info);
     }
 
     auto erase(
-        std::vector<T>::const_iterator first, std::vector<T>::const_iterator last,
+        Base::const_iterator first, Base::const_iterator last,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::erase(first, last);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::erase(first, last);
+        record_size_change(old_size, curr_info);
     }
 
     void push_back(const T &value, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::push_back(value);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::push_back(value);
+        record_size_change(old_size, curr_info);
     }
 
     void push_back(T &&value, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::push_back(std::move(value));
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::push_back(std::move(value));
+        record_size_change(old_size, curr_info);
     }
 
     template <typename... Args>
     auto emplace_back(Args&&... args, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::emplace_back(std::forward<Args>(args)...);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::emplace_back(std::forward<Args>(args)...);
+        record_size_change(old_size, curr_info);
     }
 
     void pop_back( const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::pop_back();
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::pop_back();
+        record_size_change(old_size, curr_info);
     }
 
     void resize(size_t count, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::resize(count);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::resize(count);
+        record_size_change(old_size, curr_info);
     }
 
     void resize(size_t count, const T &element, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::resize(count, element);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::resize(count, element);
+        record_size_change(old_size, curr_info);
     }
 
     void assign(size_t count, const T &element, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::assign(count, element);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::assign(count, element);
+        record_size_change(old_size, curr_info);
     }
 
     template <typename InputIterator>
@@ -337,44 +483,34 @@ public:
         InputIterator first, InputIterator last, 
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::assign(first, last);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::assign(first, last);
+        record_size_change(old_size, curr_info);
     }
 
     void assign(std::initializer_list<T> init, const SourceLoc &curr_info = SourceLoc::current()) {
-        auto old_size = std::vector<T>::size();
-        std::vector<T>::assign(init);
-        auto new_size = std::vector<T>::size();
-        last_size_change = {old_size, new_size};
-        last_size_change_info = curr_info;
+        auto old_size = Base::size();
+        Base::assign(init);
+        record_size_change(old_size, curr_info);
     }
 
     void swap(BoundsCheckedVector &other, const SourceLoc &curr_info = SourceLoc::current()) {
         /* For `BoundsCheckedVector<T>::swap()`, we make sure to update the size-change info for
         both the current and the other `BoundsCheckedVector<T>`. */
-        auto old_size_this = std::vector<T>::size(), old_size_other = other.size();
-        std::vector<T>::swap(other);
-        auto new_size_this = std::vector<T>::size(), new_size_other = other.size();
-        last_size_change = {old_size_this, new_size_this};
-        other.last_size_change = {old_size_other, new_size_other};
-        last_size_change_info = other.last_size_change_info = curr_info;
+        auto old_size_this = Base::size(), old_size_other = other.size();
+        Base::swap(other);
+        record_size_change(old_size_this, curr_info);
+        other.record_size_change(old_size_other, curr_info);
     }
 
     friend void swap(
         BoundsCheckedVector &a, BoundsCheckedVector &b,
         const SourceLoc &curr_info = SourceLoc::current()
     ) {
-        /* Delegate to `BoundsCheckedVector<T>::swap()` */
-        a.swap(b);
-
-        /* For the non-member `swap` function on `BoundsCheckedVector<T>`s, we make sure to
-        set the size-change info to reflect the call to that non-member `swap` function,
-        rather than the internal call to `a.swap(b)` in the line above (which is what it would
-        be set to if we did not add the line below). */
-        a.last_size_change_info = b.last_size_change_info = curr_info;
+        /* Delegate to `BoundsCheckedVector<T>::swap()`, passing along the `std::source_location`
+        of the call to this non-member `swap` function (rather than that of the internal call to
+        `a.swap(b)`), so that the size-change info reflects the former. */
+        a.swap(b, curr_info);
     }
 
 
@@ -390,65 +526,67 @@ public:
     BoundsCheckedVector(
         const Allocator &alloc = {},
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(alloc), last_construction_info{curr_info}
+    ) : Base(alloc), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         size_t size_,
         const Allocator &alloc = {},
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(size_, alloc), last_construction_info{curr_info}
+    ) : Base(size_, alloc), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         size_t size_, const T &element, const Allocator &alloc = {},
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(size_, element, alloc), last_construction_info{curr_info}
+    ) : Base(size_, element, alloc), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         std::initializer_list<T> init, const Allocator &alloc = {},
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(init, alloc), last_construction_info{curr_info}
+    ) : Base(init, alloc), diagnostics{this, curr_info}
     {}
 
     template <typename InputIterator>
     BoundsCheckedVector(
         InputIterator first, InputIterator last, const Allocator &alloc = {},
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(first, last, alloc), last_construction_info{curr_info}
+    ) : Base(first, last, alloc), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         const BoundsCheckedVector &other,
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(other), last_construction_info{curr_info}
+    ) : Base(other), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         const BoundsCheckedVector &other, const Allocator &alloc,
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(other, alloc), last_construction_info{curr_info}
+    ) : Base(other, alloc), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         BoundsCheckedVector &&other,
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(std::move(other)), last_construction_info{curr_info}
+    ) : Base(std::move(other)), diagnostics{this, curr_info}
     {}
 
     BoundsCheckedVector(
         BoundsCheckedVector &&other, const Allocator &alloc,
         const SourceLoc &curr_info = SourceLoc::current()
-    ) : std::vector<T>(std::move(other), alloc), last_construction_info{curr_info}
+    ) : Base(std::move(other), alloc), diagnostics{this, curr_info}
     {}
 };
 
-/* Specialize `std::formatter` for `BoundsCheckedVector<T, Allocator>` */
-template <typename T, typename Allocator>
-struct std::formatter<BoundsCheckedVector<T, Allocator>> : public std::formatter<std::string> {
+/* Specialize `std::formatter` for `BoundsCheckedVector<T, Allocator, Level>` */
+template <typename T, typename Allocator, BoundsCheckLevel Level>
+struct std::formatter<BoundsCheckedVector<T, Allocator, Level>>
+: public std::formatter<std::string>
+{
     auto format(
-        const BoundsCheckedVector<T, Allocator> &v,
+        const BoundsCheckedVector<T, Allocator, Level> &v,
         std::format_context &format_context
     ) const {
         auto output = format_context.out();
@@ -0,0 +1,189 @@
+/*
+@file bulk_construction.h
+@brief Defines the helpers that the vector variations use to construct many elements at once (for
+instance, when appending or inserting a whole range), rather than one `push_back` at a time.
+
+This file includes the following:
+- `container_compatible_range<R, T>`
+- `uses_bulk_copy_v<T, Allocator, It>`
+- `construct_from_range(allocator, dest, first, count)`
+- `assign_from_range(allocator, dest, live, first, count)`
+- `value_construct_n(allocator, dest, count)`
+- `default_construct_n(allocator, dest, count)`
+*/
+
+#ifndef BULK_CONSTRUCTION_H
+#define BULK_CONSTRUCTION_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include "vector_variations/relocation.h"
+
+/* `container_compatible_range<R, T>` is true iff the elements of the range `R` can be used to
+construct elements of type `T`; this mirrors the exposition-only concept of the same name that
+C++23 uses for `append_range` and `insert_range`. */
+template <typename R, typename T>
+concept container_compatible_range =
+    std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, T>;
+
+/* `uses_bulk_copy_v<T, Allocator, It>` is true iff copying elements of type `T` from the iterator
+`It` into memory from `Allocator` may be done with `std::memcpy`. This requires that `T` be
+trivially copyable, that `It` be a contiguous iterator over `T`s, and (as for
+`uses_trivial_relocation_v`) that `Allocator` hand out raw `T*` pointers and not customize element
+construction. */
+template <typename T, typename Allocator, typename It>
+inline constexpr bool uses_bulk_copy_v =
+    std::is_trivially_copyable_v<T> &&
+    std::contiguous_iterator<It> &&
+    std::is_same_v<std::remove_cv_t<std::iter_value_t<It>>, T> &&
+    std::is_same_v<typename std::allocator_traits<Allocator>::pointer, T*> &&
+    !allocator_customizes_construction<Allocator, T>;
+
+/* Constructs the `count` elements starting at `first` into the uninitialized storage starting at
+`dest`, and returns the iterator following the last element read. If any construction throws, the
+elements constructed so far are destroyed before the exception is rethrown.
+
+If `uses_bulk_copy_v<T, Allocator, It>` holds, this is a single `std::memcpy`; otherwise, each
+element is constructed from `*first` through `std::allocator_traits`, one at a time. */
+template <typename T, typename Allocator, std::input_iterator It>
+constexpr It construct_from_range(Allocator &allocator, T *dest, It first, size_t count) {
+    if constexpr (uses_bulk_copy_v<T, Allocator, It>) {
+        if (!std::is_constant_evaluated()) {
+            if constexpr (std::is_pointer_v<It>) {
+                /* Any pointer but a null one (which an empty range may have) can be passed to
+                `std::memcpy` along with a zero `count`. Checking for null rather than for zero lets
+                the compiler drop the check for pointers that cannot be null, such as the elements
+                of a `FixedCapacityVector`, which keeps it from assuming that nothing was copied. */
+                if (first != nullptr) {
+                    std::memcpy(
+                        static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T)
+                    );
+                }
+            } else if (count != 0) {
+                /* `count` may be zero with `first` not being dereferenceable */
+                std::memcpy(
+                    static_cast<void*>(dest), static_cast<const void*>(std::to_address(first)),
+                    count * sizeof(T)
+                );
+            }
+            return first + count;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for (; i < count; ++i, ++first) {
+            std::allocator_traits<Allocator>::construct(allocator, dest + i, *first);
+        }
+    } catch (...) {
+        for (size_t j = 0; j < i; ++j) {
+            std::allocator_traits<Allocator>::destroy(allocator, dest + j);
+        }
+        throw;
+    }
+    return first;
+}
+
+/* Replaces the `live` elements starting at `dest` with the `count` elements starting at `first`
+(with room for `count` elements at `dest`), reusing the existing elements where possible: the first
+`min(live, count)` elements are assigned to, the elements left over from `first` are constructed
+after them (see `construct_from_range`), and the live elements left over are destroyed. Returns the
+iterator following the last element read. If `uses_bulk_copy_v<T, Allocator, It>` holds, this is a
+single `std::memcpy` (trivially copyable elements need no destruction). */
+template <typename T, typename Allocator, std::input_iterator It>
+constexpr It assign_from_range(Allocator &allocator, T *dest, size_t live, It first, size_t count) {
+    if constexpr (uses_bulk_copy_v<T, Allocator, It>) {
+        if (!std::is_constant_evaluated()) {
+            return construct_from_range(allocator, dest, first, count);
+        }
+    }
+
+    size_t i = 0;
+    for (; i < live && i < count; ++i, ++first) {
+        dest[i] = *first;
+    }
+    if (count > live) {
+        return construct_from_range(allocator, dest + live, first, count - live);
+    }
+    for (; i < live; ++i) {
+        std::allocator_traits<Allocator>::destroy(allocator, dest + i);
+    }
+    return first;
+}
+
+/* Value-initializes `count` elements in the uninitialized storage starting at `dest`, as
+`std::allocator_traits<Allocator>::construct(allocator, p)` does for each of them. Unless
+`Allocator` customizes element construction, including construction from no arguments (as
+`DefaultInitAllocator` does), or we are in a constant evaluation, this is done by
+`std::uninitialized_value_construct_n`, which zeroes trivial types in bulk (with a `std::memset`)
+rather than element by element. If any construction throws, the elements constructed so far are
+destroyed before the exception is rethrown. */
+template <typename T, typename Allocator>
+constexpr void value_construct_n(Allocator &allocator, T *dest, size_t count) {
+    if constexpr (
+        std::is_same_v<typename std::allocator_traits<Allocator>::pointer, T*> &&
+        !allocator_customizes_construction<Allocator, T> &&
+        !requires (Allocator &a, T *p) { a.construct(p); }
+    ) {
+        if (!std::is_constant_evaluated()) {
+            std::uninitialized_value_construct_n(dest, count);
+            return;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for (; i < count; ++i) {
+            std::allocator_traits<Allocator>::construct(allocator, dest + i);
+        }
+    } catch (...) {
+        for (size_t j = 0; j < i; ++j) {
+            std::allocator_traits<Allocator>::destroy(allocator, dest + j);
+        }
+        throw;
+    }
+}
+
+/* Default-initializes `count` elements in the uninitialized storage starting at `dest`, like
+`std::uninitialized_default_construct_n`. For trivially default-constructible types, this leaves
+the elements uninitialized (and so does nothing), unless `Allocator` customizes element
+construction, or we are in a constant evaluation (where elements must be initialized before they
+are read, so they are value-initialized instead). If any construction throws, the elements
+constructed so far are destroyed before the exception is rethrown. */
+template <typename T, typename Allocator>
+constexpr void default_construct_n(Allocator &allocator, T *dest, size_t count) {
+    if constexpr (
+        std::is_trivially_default_constructible_v<T> &&
+        std::is_same_v<typename std::allocator_traits<Allocator>::pointer, T*> &&
+        !allocator_customizes_construction<Allocator, T>
+    ) {
+        if (!std::is_constant_evaluated()) {
+            return;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for (; i < count; ++i) {
+            if constexpr (allocator_customizes_construction<Allocator, T>) {
+                std::allocator_traits<Allocator>::construct(allocator, dest + i);
+            } else if (std::is_constant_evaluated()) {
+                std::construct_at(dest + i);
+            } else {
+                ::new (static_cast<void*>(dest + i)) T;
+            }
+        }
+    } catch (...) {
+        for (size_t j = 0; j < i; ++j) {
+            std::allocator_traits<Allocator>::destroy(allocator, dest + j);
+        }
+        throw;
+    }
+}
+
+#endif
@@ -0,0 +1,327 @@
+/*
+@file concurrent_segmented_vector.h
+@brief Defines and implements `ConcurrentSegmentedVector<T, ChunkSize, Allocator>`, an append-only
+variation on `SegmentedVector` which any number of threads may append to (and read from)
+concurrently, without locks.
+
+This file includes the following types:
+- `ConcurrentSegmentedVector<T, ChunkSize, Allocator>`
+*/
+
+#ifndef CONCURRENT_SEGMENTED_VECTOR_H
+#define CONCURRENT_SEGMENTED_VECTOR_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vector_variations/segmented_vector.h"
+
+namespace concurrent_segmented_vector_detail {
+
+/* The assumed size of a cache line (see `spsc_queue.h`) */
+inline constexpr size_t cache_line_size = 64;
+
+}  /* namespace concurrent_segmented_vector_detail */
+
+/* `ConcurrentSegmentedVector<T, ChunkSize, Allocator>` is an append-only dynamically-resizable
+array, which any number of threads may append elements to, and read published elements from,
+concurrently. It follows the design of `SegmentedVector<T, ChunkSize, GeometricSegments>`: the
+elements live in segments of `ChunkSize`, `2 * ChunkSize`, `4 * ChunkSize`, ... elements, which are
+never reallocated, so appending never moves elements, and references to elements stay valid for the
+lifetime of the vector.
+
+Appending is lock-free:
+- an append first claims the next index (or, for `grow_by(n)`, the next `n` indices) with a single
+  `fetch_add` on the shared size, so appending threads never wait for each other;
+- if the segment holding that index has not been allocated yet, the appending thread allocates it
+  and installs it in the (fixed-size) segment table with a compare-and-swap, and if another thread
+  installed the segment first, it frees its own and uses theirs;
+- the element is then constructed in place, and published by setting its flag with release
+  semantics. Every segment keeps its elements contiguous, followed by one flag byte per element
+  (so that allocating a segment only has to clear the flags, not touch the elements).
+
+The thread which claims the first index of a segment also allocates the segment after it, so that
+other threads rarely find a segment missing, and racing to allocate a segment (and freeing all but
+one of the copies) only happens for the first two segments.
+
+Because appends complete out of order, an index below `size()` may belong to an element that is
+still being constructed. `is_published(i)` (or `at(i)`, which throws otherwise) tells whether the
+element `i` may be read, and synchronizes with its construction; `operator[]` and the iterators do
+not check, and so should only be used on elements known to be published (for instance, because the
+thread which appended them has been joined, or `is_published` returned true).
+
+If the constructor of an element throws, its index stays claimed but unpublished, and is skipped by
+the destructor. The vector itself can be neither copied nor moved, as other threads may refer to
+it. */
+template <typename T, size_t ChunkSize = 64, typename Allocator = std::allocator<T>>
+requires (ChunkSize > 0 && std::has_single_bit(ChunkSize))
+struct ConcurrentSegmentedVector {
+private:
+    using Traits = std::allocator_traits<Allocator>;
+    using Flag = std::atomic<bool>;
+
+    /* Iterates over the elements by index; every dereference looks up the segment table, which
+    is not a concern as iteration is meant for after all appends have completed */
+    template <bool Const>
+    struct Iterator {
+        using Vector = std::conditional_t<Const, const ConcurrentSegmentedVector,
+                                                 ConcurrentSegmentedVector>;
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = T;
+        using difference_type   = ptrdiff_t;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+
+        Vector *vector = nullptr;
+        size_t index = 0;
+
+        Iterator() = default;
+        Iterator(Vector *vector_, size_t index_) : vector{vector_}, index{index_} {}
+
+        template <bool OtherConst>
+        requires (Const && !OtherConst)
+        Iterator(const Iterator<OtherConst> &other) : vector{other.vector}, index{other.index} {}
+
+        reference operator* () const { return (*vector)[index]; }
+        pointer operator-> () const { return &(*vector)[index]; }
+        reference operator[] (difference_type n) const { return (*vector)[index + n]; }
+
+        Iterator& operator++ () { ++index; return *this; }
+        Iterator operator++ (int) { auto old = *this; ++index; return old; }
+        Iterator& operator-- () { --index; return *this; }
+        Iterator operator-- (int) { auto old = *this; --index; return old; }
+        Iterator& operator+= (difference_type n) { index += n; return *this; }
+        Iterator& operator-= (difference_type n) { index -= n; return *this; }
+        friend Iterator operator+ (Iterator it, difference_type n) { return it += n; }
+        friend Iterator operator+ (difference_type n, Iterator it) { return it += n; }
+        friend Iterator operator- (Iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator- (const Iterator &a, const Iterator &b) {
+            return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+        }
+
+        friend bool operator== (const Iterator &a, const Iterator &b) { return a.index == b.index; }
+        friend auto operator<=> (const Iterator &a, const Iterator &b) { return a.index <=> b.index; }
+    };
+
+public:
+    using value_type      = T;
+    using allocator_type  = Allocator;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using reference       = T&;
+    using const_reference = const T&;
+    using iterator        = Iterator<false>;
+    using const_iterator  = Iterator<true>;
+
+    /* --- CONSTRUCTORS --- */
+
+    ConcurrentSegmentedVector(const Allocator &allocator_ = {}) : allocator{allocator_} {}
+
+    ConcurrentSegmentedVector(const ConcurrentSegmentedVector&) = delete;
+    ConcurrentSegmentedVector& operator= (const ConcurrentSegmentedVector&) = delete;
+
+    /* Destroys every published element. No other thread may be using the vector. */
+    ~ConcurrentSegmentedVector() {
+        auto size_ = size();
+        for (size_t segment = 0; segment < max_segments; ++segment) {
+            auto *elements = segment_table[segment].load(std::memory_order_acquire);
+            if (!elements) {
+                continue;
+            }
+            auto start = GeometricSegments::segment_start<ChunkSize>(segment);
+            auto length = GeometricSegments::segment_size<ChunkSize>(segment);
+            auto *flags = flags_of(elements, length);
+            for (size_t i = 0; i < length && start + i < size_; ++i) {
+                if (flags[i].load(std::memory_order_relaxed)) {
+                    Traits::destroy(allocator, elements + i);
+                }
+            }
+            deallocate_segment(elements, length);
+        }
+    }
+
+    /* --- ITERATORS (which do not check that elements are published) --- */
+
+    iterator begin() { return {this, 0}; }
+    const_iterator begin() const { return {this, 0}; }
+    iterator end() { return {this, size()}; }
+    const_iterator end() const { return {this, size()}; }
+
+    /* --- GETTERS --- */
+
+    /* Returns the number of indices claimed so far, including those of elements which are still
+    being constructed (see `is_published`) */
+    size_type size() const { return claimed.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    /* Returns the number of elements which fit in the segments allocated so far */
+    size_type capacity() const {
+        size_t result = 0;
+        for (size_t segment = 0; segment < max_segments; ++segment) {
+            if (segment_table[segment].load(std::memory_order_relaxed)) {
+                result += GeometricSegments::segment_size<ChunkSize>(segment);
+            }
+        }
+        return result;
+    }
+
+    /* Returns true iff the element `index` has been constructed, in which case everything that the
+    appending thread did before publishing it is visible to the calling thread */
+    bool is_published(size_type index) const {
+        if (index >= size()) {
+            return false;
+        }
+        auto [segment, offset] = GeometricSegments::locate<ChunkSize>(index);
+        auto *elements = segment_table[segment].load(std::memory_order_acquire);
+        auto length = GeometricSegments::segment_size<ChunkSize>(segment);
+        return elements && flags_of(elements, length)[offset].load(std::memory_order_acquire);
+    }
+
+    /* Returns the element `index`, which must be published */
+    T& operator[] (size_type index) { return element(index); }
+    const T& operator[] (size_type index) const { return element(index); }
+
+    /* Returns the element `index`, and throws `std::out_of_range` if it is not (yet) published */
+    T& at(size_type index) { return element(checked(index)); }
+    const T& at(size_type index) const { return element(checked(index)); }
+
+    /* --- MODIFIERS --- */
+
+    /* Constructs an element from `args` at the next index, and returns a reference to it */
+    template <typename... Ts>
+    T& emplace_back(Ts&&... args) {
+        auto index = claimed.fetch_add(1, std::memory_order_relaxed);
+        return construct_at(index, std::forward<Ts>(args)...);
+    }
+
+    /* Appends `value` at the next index, and returns that index */
+    size_type push_back(const T &value) {
+        auto index = claimed.fetch_add(1, std::memory_order_relaxed);
+        construct_at(index, value);
+        return index;
+    }
+    size_type push_back(T &&value) {
+        auto index = claimed.fetch_add(1, std::memory_order_relaxed);
+        construct_at(index, std::move(value));
+        return index;
+    }
+
+    /* Claims the next `n` indices at once, value-initializes elements there, and returns the first
+    of those indices. The elements are published one by one as they are constructed. */
+    size_type grow_by(size_type n) {
+        auto first = claimed.fetch_add(n, std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) {
+            construct_at(first + i);
+        }
+        return first;
+    }
+
+    /* Like `grow_by(n)`, but copy-constructs every element from `value` */
+    size_type grow_by(size_type n, const T &value) {
+        auto first = claimed.fetch_add(n, std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) {
+            construct_at(first + i, value);
+        }
+        return first;
+    }
+
+    /* Allocates segments until at least `n` elements fit, so that appending those does not
+    allocate. May be called concurrently with appends. */
+    void reserve(size_type n) {
+        if (n == 0) {
+            return;
+        }
+        auto last_segment = GeometricSegments::locate<ChunkSize>(n - 1).segment;
+        for (size_t segment = 0; segment <= last_segment; ++segment) {
+            ensure_segment(segment);
+        }
+    }
+
+private:
+    /* `max_segments` = The number of segments needed to hold any index representable in `size_t` */
+    static constexpr size_t max_segments = 64 - std::countr_zero(ChunkSize);
+
+    [[no_unique_address]] Allocator allocator;
+
+    /* `claimed` = The number of indices claimed by appends so far. It is kept on its own cache
+    line, as every append writes to it. */
+    alignas(concurrent_segmented_vector_detail::cache_line_size) std::atomic<size_t> claimed{0};
+
+    /* `segment_table[k]` = The elements of the segment `k`, or `nullptr` if it has not been
+    allocated yet */
+    alignas(concurrent_segmented_vector_detail::cache_line_size)
+        std::atomic<T*> segment_table[max_segments] = {};
+
+    T& element(size_t index) const {
+        auto [segment, offset] = GeometricSegments::locate<ChunkSize>(index);
+        return segment_table[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    /* A segment of `length` elements is allocated as an array of `T`, long enough to also hold
+    `length` flags after the elements */
+    static constexpr size_t allocation_length(size_t length) {
+        return length + (length * sizeof(Flag) + sizeof(T) - 1) / sizeof(T);
+    }
+
+    static Flag* flags_of(T *elements, size_t length) {
+        return reinterpret_cast<Flag*>(elements + length);
+    }
+
+    size_t checked(size_t index) const {
+        if (!is_published(index)) {
+            throw std::out_of_range(std::format(
+                "ConcurrentSegmentedVector: element {} is not published (size {})", index, size()
+            ));
+        }
+        return index;
+    }
+
+    template <typename... Ts>
+    T& construct_at(size_t index, Ts&&... args) {
+        auto [segment, offset] = GeometricSegments::locate<ChunkSize>(index);
+        auto *elements = ensure_segment(segment);
+        if (offset == 0 && segment + 1 < max_segments) {
+            /* Allocate the next segment ahead of the threads which will need it */
+            ensure_segment(segment + 1);
+        }
+        auto length = GeometricSegments::segment_size<ChunkSize>(segment);
+        Traits::construct(allocator, elements + offset, std::forward<Ts>(args)...);
+        flags_of(elements, length)[offset].store(true, std::memory_order_release);
+        return elements[offset];
+    }
+
+    /* Returns the elements of the segment `segment`, allocating and installing the segment if no
+    thread has yet */
+    T* ensure_segment(size_t segment) {
+        auto *elements = segment_table[segment].load(std::memory_order_acquire);
+        if (elements) {
+            return elements;
+        }
+        auto length = GeometricSegments::segment_size<ChunkSize>(segment);
+        auto *new_elements = Traits::allocate(allocator, allocation_length(length));
+        std::uninitialized_value_construct_n(flags_of(new_elements, length), length);
+        if (segment_table[segment].compare_exchange_strong(
+            elements, new_elements, std::memory_order_acq_rel, std::memory_order_acquire
+        )) {
+            return new_elements;
+        }
+        /* Another thread installed the segment first */
+        deallocate_segment(new_elements, length);
+        return elements;
+    }
+
+    void deallocate_segment(T *elements, size_t length) {
+        std::destroy_n(flags_of(elements, length), length);
+        Traits::deallocate(allocator, elements, allocation_length(length));
+    }
+};
+
+#endif
@@ -10,11 +10,21 @@ This file includes the following types:
 #ifndef FIXED_CAPACITY_VECTOR_H
 #define FIXED_CAPACITY_VECTOR_H
 
+#include "simd/simd_search.h"
+#include "instrumentation/container_counters.h"
+#include "vector_variations/bulk_construction.h"
+#include "vector_variations/insert_erase.h"
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <cassert>
 #include <format>
+#include <iterator>
+#include <optional>
+#include <ranges>
 #include <string>
+#include <version>
 
 /* `FixedCapacityVector<T, Capacity, Allocator>` is a dynamically-resizable array with fixed
 compile-time capacity `Capacity`. Based on the upcoming C++26 feature, `std::inplace_vector`
@@ -94,19 +104,52 @@ struct FixedCapacityVector {
             }
         } else if (new_size > size()) {
             /* If the current `size()` is less than the `new_size`, then append default-inserted
-            elements until we have exactly `new_size` elements in total. */
-            for (size_t i = size(); i < new_size; ++i) {
-                std::allocator_traits<Allocator>::construct(
-                    allocator,
-                    begin() + i
-                );
-            }
+            elements until we have exactly `new_size` elements in total (zeroing them in bulk, for
+            trivial types; see `value_construct_n`). */
+            value_construct_n(allocator, end(), new_size - size());
         }
 
         /* Finally, update `current_size` */
         current_size = new_size;
     }
 
+    /* Equivalent to `resize(new_size)`, except that the appended elements are default-initialized
+    rather than value-initialized; for trivially default-constructible types (such as `int` or
+    `char`), this means that they are left uninitialized, for the caller to overwrite. */
+    constexpr void resize_for_overwrite(size_type new_size) {
+        assert(new_size <= capacity());
+
+        if (new_size < size()) {
+            for (size_t i = new_size; i < size(); ++i) {
+                std::allocator_traits<Allocator>::destroy(allocator, begin() + i);
+            }
+        } else if (new_size > size()) {
+            default_construct_n(allocator, end(), new_size - size());
+        }
+
+        current_size = new_size;
+    }
+
+    /* Equivalent to `resize_for_overwrite(new_size)`. */
+    constexpr void resize_default_init(size_type new_size) { resize_for_overwrite(new_size); }
+
+    /* Resizes this `FixedCapacityVector` by letting `operation` write the elements, like C++23's
+    `std::basic_string::resize_and_overwrite`: the elements past the current `size()` (up to
+    `new_size`) are default-initialized, then `operation(data, new_size)` writes any of the first
+    `new_size` elements and returns how many of them to keep, which becomes the new `size()`. See
+    `StackAssistedVector::resize_and_overwrite` for an example. */
+    template <typename Operation>
+    requires std::invocable<Operation, T*, size_type>
+    constexpr void resize_and_overwrite(size_type new_size, Operation operation) {
+        assert(new_size <= capacity());
+        if (new_size > size()) {
+            resize_for_overwrite(new_size);
+        }
+        auto kept = static_cast<size_type>(std::move(operation)(begin(), new_size));
+        assert(kept <= new_size);
+        resize_for_overwrite(kept);
+    }
+
     /* --- ELEMENT ACCESS OPERATORS/FUNCTIONS --- */
     constexpr reference operator[] (size_type index) { return elements[index]; }
     constexpr const_reference operator[] (size_type index) const { return elements[index]; }
@@ -126,6 +169,48 @@ struct FixedCapacityVector {
     constexpr T* data() { return (empty() ? nullptr : begin()); }
     constexpr const T* data() const { return (empty() ? nullptr : begin()); }
 
+    /* --- SEARCH --- */
+
+    /* For arithmetic element types (see `simd_searchable` in `simd_search.h`), the functions below
+    are implemented with SIMD kernels. The `Capacity` elements live inline in this
+    `FixedCapacityVector`, so small vectors of, e.g., `int` can be searched in a handful of vector
+    comparisons rather than an element-by-element loop. During constant evaluation (and for all
+    other element types), they fall back to plain loops with identical results. */
+
+    /* Returns an iterator to the first element equal to `value`, or `end()` if there is none. */
+    constexpr iterator find(const T &value) { return begin() + first_index_of(value); }
+    constexpr const_iterator find(const T &value) const { return begin() + first_index_of(value); }
+
+    /* Returns the number of elements equal to `value`. */
+    constexpr size_type count(const T &value) const {
+        if constexpr (uses_simd_search) {
+            if (!std::is_constant_evaluated()) {
+                return simd_count(elements, current_size, value);
+            }
+        }
+        return scalar_count(elements, current_size, value);
+    }
+
+    /* Returns true iff some element is equal to `value`. */
+    constexpr bool contains(const T &value) const { return first_index_of(value) != size(); }
+
+    /* Returns the index of the first element equal to `value`, or `std::nullopt` if there is
+    none. */
+    constexpr std::optional<size_type> index_of(const T &value) const {
+        auto index = first_index_of(value);
+        return (index == size() ? std::nullopt : std::optional<size_type>(index));
+    }
+
+    /* Returns an iterator to the first smallest element (as in `std::min_element`), or `end()` if
+    this `FixedCapacityVector` is empty. */
+    constexpr iterator min_element() { return begin() + min_index(); }
+    constexpr const_iterator min_element() const { return begin() + min_index(); }
+
+    /* Returns an iterator to the first largest element (as in `std::max_element`), or `end()` if
+    this `FixedCapacityVector` is empty. */
+    constexpr iterator max_element() { return begin() + max_index(); }
+    constexpr const_iterator max_element() const { return begin() + max_index(); }
+
 
     /* --- MUTATORS --- */
 
@@ -162,6 +247,37 @@ struct FixedCapacityVector {
         );
     }
 
+    /* Appends the elements of `range` to the end of this `FixedCapacityVector`, as C++23's
+    `std::vector::append_range` does. If the number of elements is known up front (that is, if
+    `range` is a forward or a sized range), then they are constructed in bulk; this is a single
+    `std::memcpy` if `T` is trivially copyable and `range` is contiguous (see
+    `bulk_construction.h`). Otherwise, the elements are appended one by one. `range` must not
+    overlap with this `FixedCapacityVector`. */
+    template <container_compatible_range<T> R>
+    constexpr void append_range(R &&range) {
+        if constexpr (std::ranges::forward_range<R> || std::ranges::sized_range<R>) {
+            auto n = static_cast<size_type>(std::ranges::distance(range));
+            assert(size() + n <= Capacity);
+            construct_from_range(allocator, end(), std::ranges::begin(range), n);
+            current_size += n;
+        } else {
+            for (auto &&element : range) {
+                emplace_back(std::forward<decltype(element)>(element));
+            }
+        }
+    }
+
+    /* Appends `n` default-initialized elements (which, for trivially default-constructible types,
+    are left uninitialized) to the end of this `FixedCapacityVector`, and returns an iterator to
+    the first of them, so that the caller may write the elements in place. */
+    constexpr iterator append_n_uninitialized(size_type n) {
+        assert(size() + n <= Capacity);
+        auto first = end();
+        default_construct_n(allocator, first, n);
+        current_size += n;
+        return first;
+    }
+
     /* Removes the last element of this `FixedCapacityVector`. */
     constexpr void pop_back() {
         assert(!empty());
@@ -187,35 +303,57 @@ struct FixedCapacityVector {
         current_size = 0;
     }
 
+    /* Exchanges the elements of this `FixedCapacityVector` with those of `other`. The first
+    `min(size(), other.size())` elements of each are swapped in place, and only the rest are
+    relocated to the other side (see `swap_ranges_relocating`). As with `std::vector`, the
+    allocators are swapped iff `propagate_on_container_swap` is true. */
     constexpr void swap(FixedCapacityVector &other) {
-        static_assert(false, "Unimplemented, sorry!");
+        if (this == &other) {
+            return;
+        }
+
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(allocator, other.allocator);
+        }
+
+        record_container_event<FixedCapacityVector>(
+            &ContainerCounters::element_moves, current_size + other.current_size
+        );
+        swap_ranges_relocating(allocator, elements, current_size, other.elements, other.current_size);
+        std::swap(current_size, other.current_size);
+    }
+
+    /* Exchanges the elements of `a` and `b` (see `FixedCapacityVector::swap`) */
+    friend constexpr void swap(FixedCapacityVector &a, FixedCapacityVector &b) {
+        a.swap(b);
     }
 
     /* Inserts a copy of `element` immediately before `position`. */
     constexpr iterator insert(const_iterator position, const T& element) {
-        assert(size() <= Capacity);
+        assert(size() < Capacity);
+
+        /* Shifting the elements after `position` would move `element` if it is one of them, so
+        we insert a copy of it instead. */
+        if (is_element(element)) {
+            T copy(element);
+            return insert(position, std::move(copy));
+        }
 
         /* Non-const equivalent of `position`, needed for mutation */
         auto pos = begin() + (position - begin());
 
         /* First, we make space for the inserted element by shifting all elements after it one to
-        the right. To do this, we iterate backwards from `end()` to just after the position of
-        insertion, and move-construct each element into the next position. */
-        for (auto it = end(); it != pos; --it) {
-            /* Move-construct the element at `it` from the element stored at `it - 1`. */
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it,
-                std::move(*(it - 1))
-            );
-        }
-
-        /* Finally, copy `element` to the position of insertion. */
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            pos,
-            element
-        );
+        the right (see `insert_erase.h`). This leaves either a moved-from element or uninitialized
+        storage at the position of insertion, so we then either copy-assign or copy-construct
+        `element` there. */
+        open_gap_at(pos, 1, [&](size_type live) {
+            if (live != 0) {
+                *pos = element;
+            } else {
+                std::allocator_traits<Allocator>::construct(allocator, pos, element);
+            }
+        });
 
         ++current_size;
 
@@ -226,27 +364,20 @@ struct FixedCapacityVector {
     /* Move-constructs an element from `element`, and inserts it immediately before `position`. */
     constexpr iterator insert(const_iterator position, T&& element) {
         /* Identical to the implementation of `insert(const_iterator, const T&)`, except that the
-        inserted element is now move-constructed (rather than copy-constructed) from `element`. */
+        inserted element is now moved (rather than copied) from `element`. */
 
-        assert(size() <= Capacity);
+        assert(size() < Capacity);
 
         /* Non-const equivalent of `position`, needed for mutation */
         auto pos = begin() + (position - begin());
 
-        for (auto it = end(); it != pos; --it) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it,
-                std::move(*(it - 1))
-            );
-        }
-
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            pos,
-            std::move(element)  /* Move-construct the inserted element from the given `element`,
-                                   instead of copy-constructing it as before. */
-        );
+        open_gap_at(pos, 1, [&](size_type live) {
+            if (live != 0) {
+                *pos = std::move(element);
+            } else {
+                std::allocator_traits<Allocator>::construct(allocator, pos, std::move(element));
+            }
+        });
 
         ++current_size;
 
@@ -257,7 +388,7 @@ struct FixedCapacityVector {
     constexpr iterator insert(const_iterator position, size_type n, const T& element) {
         /* Identical to the implementation of `insert(const_iterator, const T&)`, except that we
         now have to shift all elements after `position` by `n` to the right rather than by one,
-        and that we have to perform `n` copy-constructs of `element` instead of one. */
+        and that we have to write `n` copies of `element` instead of one. */
 
         assert(size() + n <= Capacity);
 
@@ -272,23 +403,18 @@ struct FixedCapacityVector {
         }
 
         /* Make space for the `n` elements to be inserted by shifting all elements after the
-        position of insertion `n` to the right. */
-        for (auto it = end(); it != pos; --it) {
-            /* Move-construct the element at `it + n - 1` from the element stored at `it - 1`. */
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it + n - 1,
-                std::move(*(it - 1))
-            );
-        }
-
-        /* Finally, write `n` copies of `element` starting from the position of insertion. */
-        for (iterator curr_pos = pos; curr_pos < pos + n; ++curr_pos) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                curr_pos,
-                element
-            );
+        position of insertion `n` to the right, and then write `n` copies of `element` starting
+        from the position of insertion (or of a copy of it, if shifting would move it). */
+        auto fill = [&](const T &value) {
+            open_gap_at(pos, n, [&](size_type live) {
+                fill_gap_n(allocator, pos, live, n, value);
+            });
+        };
+        if (is_element(element)) {
+            T copy(element);
+            fill(copy);
+        } else {
+            fill(element);
         }
 
         current_size += n;
@@ -304,86 +430,51 @@ struct FixedCapacityVector {
     the minimal check needed to conform to the standard. */
     requires (!std::is_integral_v<InputIt>)
     constexpr iterator insert(const_iterator position, InputIt first, InputIt last) {
-        /* Identical to the implementation of `insert(const_iterator, size_type n, const T&)`,
-        except that `n` is now given by `std::distance(first, last)`, and that the elements
-        to be inserted are now given by dereferencing iterators in the range `[first, last)`. */
-
-        /* Non-const equivalent of `position`, needed for mutation */
-        auto pos = begin() + (position - begin());
-
-        if (first == last) {
-            /* Note that we cannot just `return position`, because `position` is a `const_iterator`
-            and not an `iterator`. `return pos`, however, does exactly what we want. */
-            return pos;
-        }
-
-        /* Compute `n`, the number of elements we will be inserting */
-        auto n = std::distance(first, last);
-
-        assert(size() + n <= Capacity);
-
-        for (auto it = end(); it != pos; --it) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it + n - 1,
-                std::move(*(it - 1))
-            );
+        /* If `InputIt` is at least a forward iterator, then the number of elements to insert can
+        be computed up front with `std::distance`, and the elements are inserted in bulk (see
+        `insert_counted`). A single-pass iterator would be consumed by `std::distance`, so its
+        elements are appended one by one instead, and then rotated into place. */
+        auto offset = position - begin();
+        if constexpr (std::forward_iterator<InputIt>) {
+            insert_counted(offset, first, static_cast<size_type>(std::distance(first, last)));
+        } else {
+            auto old_size = current_size;
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+            std::rotate(begin() + offset, begin() + old_size, end());
         }
+        return begin() + offset;
+    }
 
-        /* Finally, write the `n` elements in the range `[first, last)` to the range starting
-        from the position of insertion. */
-        for (auto curr_pos = pos; first != last; ++curr_pos, ++first) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                curr_pos,
-                *first
+    /* Inserts the elements of `range` immediately before `position`, as C++23's
+    `std::vector::insert_range` does, and returns an iterator to the first inserted element. As in
+    `append_range`, if the number of elements is known up front, then they are constructed in
+    bulk. `range` must not overlap with this `FixedCapacityVector`. */
+    template <container_compatible_range<T> R>
+    constexpr iterator insert_range(const_iterator position, R &&range) {
+        auto offset = position - begin();
+        if constexpr (std::ranges::forward_range<R> || std::ranges::sized_range<R>) {
+            insert_counted(
+                offset, std::ranges::begin(range),
+                static_cast<size_type>(std::ranges::distance(range))
             );
+        } else {
+            auto old_size = current_size;
+            append_range(std::forward<R>(range));
+            std::rotate(begin() + offset, begin() + old_size, end());
         }
-
-        current_size += n;
-
-        /* Return the position of the first element inserted. */
-        return pos;
+        return begin() + offset;
     }
 
     /* Removes the element at `position` from this `FixedCapacityVector`. */
     constexpr iterator erase(const_iterator position) {
         assert(position != end());
-
-        /* `position` is a `const_iterator`, so we cannot use it for the mutation we need to
-        perform. Thus, we compute `pos`, which is the non-`const` equivalent of `position`. */
-        iterator pos = begin() + (position - begin());
-
-        /* First, we delete the element at `position` by shifting all elements after it one to
-        the left. To do this, we iterate forwards from the position of insertion to just before
-        `end() - 1`, and move-assign each element to the next element. */
-        while (pos != (end() - 1)) {
-            /* Move-assign the element at `pos` to the element at `pos + 1`. */
-            *pos = std::move(*(pos + 1));
-            ++pos;
-        }
-
-        /* This leaves us with an extra moved-from element at the position `end() - 1`, which
-        we now destroy. */
-        std::allocator_traits<Allocator>::destroy(
-            allocator,
-            pos  /* `pos` will always equal `end() - 1` after the above loop terminates */
-        );
-        
-        --current_size;
-
-        /* Return the iterator to the position immediately following the removed element. This is
-        given by the iterator that is the same distance away from `begin()` as the position of the
-        original, now-removed element was. */
-        return begin() + (position - begin());
+        return erase(position, position + 1);
     }
 
     /* Removes the element(s) in the range `[first, last)` from this `FixedCapacityVector`. */
     constexpr iterator erase(const_iterator first, const_iterator last) {
-        /* Identical to the implementation of `erase(const_iterator)`, except that we now have to
-        shift all elements after `last` by `n` to the left instead of one, where `n` is the number
-        of elements in the range `[first, last)`. */
-
         /* Non-const equivalent of `first`, needed for mutation */
         auto pos = begin() + (first - begin());
 
@@ -394,31 +485,20 @@ struct FixedCapacityVector {
         /* Compute `n`, the number of elements we will be erasing. There is no need to use
         `std::distance` here, as both `first` and `last` are assumed to be iterators into
         this `FixedCapacityVector`. */
-        auto n = last - first;
+        auto n = static_cast<size_type>(last - first);
 
         /* Delete the range `[first, last)` by shifting all elements in `[last, end())` `n` to
-        the left. */
-        while (pos != (end() - n)) {
-            /* Move-assign the element at `pos` to the element at `pos + n`. */
-            *pos = std::move(*(pos + n));
-            ++pos;
-        }
-
-        /* This leaves us with `n` extra moved-from elements starting from `end() - n`, which
-        we now destroy. */
-        while (pos != end()) {
-            std::allocator_traits<Allocator>::destroy(
-                allocator,
-                pos++
-            );
-        }
+        the left, and destroying the `n` elements left over at the end (see `insert_erase.h`). */
+        record_container_event<FixedCapacityVector>(
+            &ContainerCounters::element_moves, end() - (pos + n)
+        );
+        close_gap(allocator, pos, end(), n);
 
         current_size -= n;
 
-        /* Return the iterator to the position immediately following the last removed element. This
-        is given by the iterator that is the same distance away from `begin()` as the position of
-        the last removed element was. */
-        return begin() + (first - begin());
+        /* Return the iterator to the position immediately following the last removed element,
+        which now sits where the first removed element was. */
+        return pos;
     }
 
     constexpr FixedCapacityVector(const Allocator &allocator_ = {}) : allocator{allocator_} {}
@@ -453,39 +533,43 @@ struct FixedCapacityVector {
     template <typename InputIt>
     requires (!std::is_integral_v<InputIt>)
     constexpr FixedCapacityVector(InputIt first, InputIt last, const Allocator &allocator_ = {})
-    : current_size(std::distance(first, last)),
-      allocator{allocator_} {
-        for (size_type i = 0; i < current_size; ++i) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                begin() + i,
-                *(first++)
-            );
-        }
+    : allocator{allocator_} {
+        insert(end(), first, last);
     }
 
-    /* Copy constructor */
+#if defined(__cpp_lib_containers_ranges)
+    /* Constructs a `FixedCapacityVector` with the elements of `range` (this is the constructor
+    that C++23's `std::ranges::to` uses). */
+    template <container_compatible_range<T> R>
+    constexpr FixedCapacityVector(std::from_range_t, R &&range, const Allocator &allocator_ = {})
+    : allocator{allocator_} {
+        append_range(std::forward<R>(range));
+    }
+#endif
+
+    /* Copy constructor. As with `std::vector`, the copy's allocator is given by
+    `select_on_container_copy_construction`, which for stateful allocators (such as
+    `ArenaAllocator`) is usually a copy of `other`'s allocator. */
+    constexpr FixedCapacityVector(const FixedCapacityVector &other)
+    : FixedCapacityVector(
+        other,
+        std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)
+    ) {}
+
+    /* Copy constructor, using the allocator `allocator_` */
     constexpr FixedCapacityVector(
-        const FixedCapacityVector &other, const Allocator &allocator_ = {}
+        const FixedCapacityVector &other, const Allocator &allocator_
     ) : allocator{allocator_} {
+        construct_from_range(allocator, begin(), other.begin(), other.size());
         current_size = other.size();
-        for (size_type i = 0; i < current_size; ++i) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                begin() + i,
-                other[i]
-            );
-        }
     }
 
-    /* Move constructor */
+    /* Move constructor. The elements of `other` are moved from, but (like those of a moved-from
+    `std::array`) remain in `other`, whose destructor destroys them. */
     constexpr FixedCapacityVector(FixedCapacityVector &&other)
     : current_size{other.current_size},
       allocator{other.allocator}
     {
-        /* The responsibility for cleaning up the elements is now transferred to us */
-        other.current_size = 0;  /* Prevent double-destructor calls for elements */
-
         for (size_type i = 0; i < current_size; ++i) {
             std::allocator_traits<Allocator>::construct(
                 allocator,
@@ -500,6 +584,64 @@ struct FixedCapacityVector {
     : FixedCapacityVector(init.begin(), init.end(), allocator_)
     {}
 
+    /* Copy assignment operator. The elements of `other` are assigned over the existing elements,
+    and the rest are constructed after them (or the surplus elements destroyed); see
+    `assign_from_range`. As with `std::vector`, `other`'s allocator is copied iff
+    `propagate_on_container_copy_assignment` is true. */
+    constexpr FixedCapacityVector& operator= (const FixedCapacityVector &other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
+            /* Our elements must be destroyed by the allocator that constructed them */
+            if (allocator != other.allocator) {
+                clear();
+            }
+            allocator = other.allocator;
+        }
+
+        assign_from_range(allocator, elements, current_size, other.elements, other.current_size);
+        current_size = other.current_size;
+        return *this;
+    }
+
+    /* Move assignment operator. The elements of `other` are moved over the existing elements, as in
+    the copy assignment operator, which leaves `other` with its (moved-from) elements. */
+    constexpr FixedCapacityVector& operator= (FixedCapacityVector &&other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+            if (allocator != other.allocator) {
+                clear();
+            }
+            /* `other` still needs its allocator to destroy its (moved-from) elements */
+            allocator = other.allocator;
+        }
+
+        /* Moving a trivially copyable element is copying it, which may be done in bulk */
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            assign_from_range(allocator, elements, current_size, other.elements, other.current_size);
+        } else {
+            assign_from_range(
+                allocator, elements, current_size,
+                std::make_move_iterator(other.elements), other.current_size
+            );
+        }
+        current_size = other.current_size;
+        return *this;
+    }
+
+    /* Replaces the elements with those of `init` */
+    constexpr FixedCapacityVector& operator= (std::initializer_list<T> init) {
+        assert(init.size() <= Capacity);
+        assign_from_range(allocator, elements, current_size, init.begin(), init.size());
+        current_size = init.size();
+        return *this;
+    }
+
     /* Destructor */
     constexpr ~FixedCapacityVector() {
         /* Call the destructor on every element in this `FixedCapacityVector`. */
@@ -519,6 +661,82 @@ private:
     elements. */
     Allocator allocator;
 
+    /* Whether the search functions use the SIMD kernels, which requires that the elements are
+    stored as a plain array of a `simd_searchable` type. */
+    static constexpr bool uses_simd_search =
+        simd_searchable<T> && std::is_same_v<pointer, T*>;
+
+    /* Returns the index of the first element equal to `value`, or `size()` if there is none. */
+    constexpr size_type first_index_of(const T &value) const {
+        if constexpr (uses_simd_search) {
+            if (!std::is_constant_evaluated()) {
+                return simd_find(elements, current_size, value);
+            }
+        }
+        return scalar_find(elements, current_size, value);
+    }
+
+    /* Returns the index of the first smallest element, or `size()` if there are no elements. */
+    constexpr size_type min_index() const {
+        if constexpr (uses_simd_search) {
+            if (!std::is_constant_evaluated()) {
+                return simd_min_index(elements, current_size);
+            }
+        }
+        return scalar_min_index(elements, current_size);
+    }
+
+    /* Returns the index of the first largest element, or `size()` if there are no elements. */
+    constexpr size_type max_index() const {
+        if constexpr (uses_simd_search) {
+            if (!std::is_constant_evaluated()) {
+                return simd_max_index(elements, current_size);
+            }
+        }
+        return scalar_max_index(elements, current_size);
+    }
+
+    /* Returns true iff `element` is one of the elements of this `FixedCapacityVector`, which
+    shifting them would move. Pointers into different objects cannot be compared in a constant
+    evaluation, so there this conservatively returns true. */
+    constexpr bool is_element(const T &element) const {
+        if (std::is_constant_evaluated()) {
+            return true;
+        }
+        std::less<const T*> less;
+        return !less(std::addressof(element), begin()) && less(std::addressof(element), end());
+    }
+
+    /* Shifts the elements in `[pos, end())` exactly `n` positions to the right with `open_gap`, and
+    then calls `fill(live)`, where `live` is how many of the `n` positions starting from `pos` still
+    hold (moved-from) elements, which `fill` must assign to rather than construct into. If `fill`
+    throws, the elements are shifted back (see `open_and_fill_gap`). Assumes that there is room for
+    `n` more elements, and does not update `current_size`. */
+    template <typename Fill>
+    constexpr void open_gap_at(iterator pos, size_type n, Fill fill) {
+        record_container_event<FixedCapacityVector>(
+            &ContainerCounters::element_moves, end() - pos
+        );
+        open_and_fill_gap(allocator, pos, end(), n, std::move(fill));
+    }
+
+    /* Inserts the `n` elements starting at `first` at `begin() + offset`: shifts the tail right by
+    `n`, and then assigns or constructs the new elements (see `fill_gap`). */
+    template <typename It>
+    constexpr void insert_counted(size_type offset, It first, size_type n) {
+        if (n == 0) {
+            return;
+        }
+
+        assert(size() + n <= Capacity);
+
+        auto pos = begin() + offset;
+        open_gap_at(pos, n, [&](size_type live) {
+            fill_gap(allocator, pos, live, n, first);
+        });
+        current_size += n;
+    }
+
     /* Throws `std::out_of_range` if `index` is out of bounds for this `FixedCapacityVector`. */
     constexpr void check_if_out_of_bounds(size_type index) {
         if (index >= size()) {
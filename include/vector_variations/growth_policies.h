@@ -0,0 +1,142 @@
+/*
+@file growth_policies.h
+@brief Defines the growth policies that decide how much `StackAssistedVector` grows its capacity
+by whenever it runs out of space.
+
+This file includes the following types:
+- `GeometricGrowth<Numerator, Denominator>`, along with the aliases `OneAndAHalfGrowth`,
+  `DoublingGrowth`, and `GoldenRatioGrowth`
+- `LinearChunkGrowth<ChunkSize>`
+- `JemallocSizeClasses` and `GlibcSizeClasses`
+- `AllocatorBucketGrowth<SizeClasses, BasePolicy>`
+
+A growth policy is any type `P` that provides a static member function
+
+    static constexpr size_t next_capacity(
+        size_t current_capacity, size_t required_capacity, size_t element_size
+    );
+
+returning the capacity (in elements) to grow to, given the current capacity, the minimum capacity
+that is required, and `sizeof` the element type. The returned capacity should be at least
+`required_capacity`; containers will enforce this regardless.
+*/
+
+#ifndef GROWTH_POLICIES_H
+#define GROWTH_POLICIES_H
+
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include <concepts>
+
+/* `growth_policy<P>` is satisfied iff `P` can be used as a growth policy (see above). */
+template <typename P>
+concept growth_policy = requires (size_t n) {
+    { P::next_capacity(n, n, n) } -> std::convertible_to<size_t>;
+};
+
+/* `GeometricGrowth<Numerator, Denominator>` multiplies the current capacity by the growth factor
+`Numerator / Denominator` (which must be greater than 1). Larger factors mean fewer reallocations;
+smaller factors mean less unused capacity, and allow memory freed by earlier reallocations to be
+reused by later ones (which is impossible for factors at or above the golden ratio). */
+template <size_t Numerator, size_t Denominator>
+requires (Numerator > Denominator && Denominator > 0)
+struct GeometricGrowth {
+    static constexpr size_t next_capacity(
+        size_t current_capacity, size_t required_capacity, [[maybe_unused]] size_t element_size
+    ) {
+        /* Computes `current_capacity * Numerator / Denominator` while avoiding overflow in the
+        intermediate product for large capacities. Always grow by at least one element, so that
+        small capacities (where the product would round down to `current_capacity`) still grow. */
+        auto scaled = current_capacity / Denominator * Numerator +
+                      current_capacity % Denominator * Numerator / Denominator;
+        return std::max({scaled, current_capacity + 1, required_capacity});
+    }
+};
+
+/* Grows the capacity by a factor of 1.5 (as done by MSVC's and folly's vectors) */
+using OneAndAHalfGrowth = GeometricGrowth<3, 2>;
+
+/* Grows the capacity by a factor of 2 (as done by libstdc++'s and libc++'s vectors). This is the
+default growth policy for `StackAssistedVector`. */
+using DoublingGrowth = GeometricGrowth<2, 1>;
+
+/* Grows the capacity by a factor of 1.618, just below the golden ratio; growth factors below the
+golden ratio allow the buffers freed by earlier reallocations to eventually be coalesced to
+satisfy a later reallocation. */
+using GoldenRatioGrowth = GeometricGrowth<1618, 1000>;
+
+/* `LinearChunkGrowth<ChunkSize>` grows the capacity by exactly `ChunkSize` elements at a time (or
+by as many chunks as are needed to reach the required capacity). This bounds the unused capacity
+at `ChunkSize` elements, at the cost of a linear number of reallocations. */
+template <size_t ChunkSize>
+requires (ChunkSize > 0)
+struct LinearChunkGrowth {
+    static constexpr size_t next_capacity(
+        size_t current_capacity, size_t required_capacity, [[maybe_unused]] size_t element_size
+    ) {
+        auto target = std::max(current_capacity + ChunkSize, required_capacity);
+
+        /* Round `target` up so that the capacity grows by a whole number of chunks */
+        auto chunks = (target - current_capacity + ChunkSize - 1) / ChunkSize;
+        return current_capacity + chunks * ChunkSize;
+    }
+};
+
+/* `JemallocSizeClasses::round_up(bytes)` returns the size of the smallest jemalloc size class that
+can hold `bytes` bytes. jemalloc uses 8 and 16 as its smallest classes, spaces classes 16 bytes
+apart up to 128, and above that uses exactly four evenly-spaced classes per doubling (for instance,
+160, 192, 224, and 256). */
+struct JemallocSizeClasses {
+    static constexpr size_t round_up(size_t bytes) {
+        if (bytes <= 8) {
+            return 8;
+        }
+        if (bytes <= 16) {
+            return 16;
+        }
+
+        /* `2^lg` is the smallest power of two that is at least `bytes` */
+        auto lg = static_cast<size_t>(std::bit_width(bytes - 1));
+        auto spacing = std::max<size_t>(16, size_t{1} << (lg - 3));
+        return (bytes + spacing - 1) & ~(spacing - 1);
+    }
+};
+
+/* `GlibcSizeClasses::round_up(bytes)` returns the usable size of the smallest chunk that glibc's
+malloc would hand out for a request of `bytes` bytes. Chunks below the default mmap threshold
+(128 KiB) are multiples of 16 bytes (with at least 32), of which all but an 8-byte header are
+usable; larger requests are served by `mmap`, and so are rounded up to whole 4 KiB pages, less a
+16-byte header. */
+struct GlibcSizeClasses {
+    static constexpr size_t mmap_threshold = size_t{128} * 1024;
+    static constexpr size_t page_size = 4096;
+
+    static constexpr size_t round_up(size_t bytes) {
+        if (bytes + 8 < mmap_threshold) {
+            auto chunk = std::max<size_t>(32, (bytes + 8 + 15) & ~size_t{15});
+            return chunk - 8;
+        }
+        return ((bytes + 16 + page_size - 1) & ~(page_size - 1)) - 16;
+    }
+};
+
+/* `AllocatorBucketGrowth<SizeClasses, BasePolicy>` computes a capacity using `BasePolicy`, and
+then enlarges it to use up all of the memory that the allocator would actually hand out for it,
+as given by `SizeClasses` (for instance, `JemallocSizeClasses` or `GlibcSizeClasses`). The bytes
+that would otherwise be wasted as internal fragmentation within the allocator's size class thus
+become usable capacity, delaying the next reallocation for free. */
+template <typename SizeClasses = JemallocSizeClasses, growth_policy BasePolicy = DoublingGrowth>
+struct AllocatorBucketGrowth {
+    static constexpr size_t next_capacity(
+        size_t current_capacity, size_t required_capacity, size_t element_size
+    ) {
+        auto capacity = std::max<size_t>(
+            BasePolicy::next_capacity(current_capacity, required_capacity, element_size),
+            required_capacity
+        );
+        return SizeClasses::round_up(capacity * element_size) / element_size;
+    }
+};
+
+#endif
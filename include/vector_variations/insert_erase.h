@@ -0,0 +1,189 @@
+/*
+@file insert_erase.h
+@brief Defines the engine that the vector variations use to shift their elements when inserting
+into (or erasing from) the middle of a contiguous buffer.
+
+This file includes the following:
+- `open_gap(allocator, position, last, n)`
+- `fill_gap(allocator, position, live, n, first)`
+- `fill_gap_n(allocator, position, live, n, value)`
+- `undo_open_gap(allocator, position, last, n, live)`
+- `open_and_fill_gap(allocator, position, last, n, fill)`
+- `close_gap(allocator, position, last, n)`
+*/
+
+#ifndef INSERT_ERASE_H
+#define INSERT_ERASE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "vector_variations/bulk_construction.h"
+#include "vector_variations/relocation.h"
+
+/* Inserting `n` elements at `position` into the live elements `[begin, last)` of a buffer (with
+room for at least `n` more elements after `last`) is done in two steps:
+
+1. `open_gap(allocator, position, last, n)` shifts the elements `[position, last)` `n` positions to
+   the right, which leaves a gap `[position, position + n)`. It returns the number `live` of slots
+   at the start of the gap which still hold (moved-from) elements; the remaining `n - live` slots
+   are uninitialized storage.
+2. The caller then fills the gap, assigning the new elements to the first `live` slots and
+   constructing them in the rest, for instance with `fill_gap` or `fill_gap_n`.
+
+Shifting never constructs an element on top of a live one: if `n` is at most the length of the
+tail, the last `n` elements of the tail are move-constructed into the uninitialized slots after
+`last` (as with `std::uninitialized_move`), and the rest of the tail is shifted over live elements
+with `std::move_backward`. Otherwise, the whole tail is move-constructed past `last`. If
+`uses_trivial_relocation_v<T, Allocator>` holds, the tail is instead shifted with a single
+`std::memmove`, after which the whole gap is uninitialized (so `live` is 0). */
+template <typename T, typename Allocator>
+constexpr size_t open_gap(Allocator &allocator, T *position, T *last, size_t n) {
+    auto tail = static_cast<size_t>(last - position);
+    if (n == 0) {
+        return 0;
+    }
+
+    if constexpr (uses_trivial_relocation_v<T, Allocator>) {
+        if (!std::is_constant_evaluated()) {
+            relocate_overlapping_range<T, Allocator>(position, tail, position + n);
+            return 0;
+        }
+    }
+
+    if (n <= tail) {
+        /* The last `n` elements of the tail move to uninitialized storage past `last`... */
+        for (size_t i = 0; i < n; ++i) {
+            std::allocator_traits<Allocator>::construct(
+                allocator, last + i, std::move(*(last - n + i))
+            );
+        }
+        /* ...and the rest of the tail moves over live elements, starting from the back */
+        std::move_backward(position, last - n, last);
+        return n;
+    }
+
+    /* Every element of the tail moves to uninitialized storage past `last` */
+    for (size_t i = 0; i < tail; ++i) {
+        std::allocator_traits<Allocator>::construct(
+            allocator, position + n + i, std::move(position[i])
+        );
+    }
+    return tail;
+}
+
+/* Fills the gap of `n` slots at `position` left by `open_gap` (whose first `live` slots hold
+elements) with the `n` elements starting at `first`, and returns the iterator following the last
+element read. The live slots are assigned to, and the rest are constructed in bulk (see
+`construct_from_range`). */
+template <typename T, typename Allocator, std::input_iterator It>
+constexpr It fill_gap(Allocator &allocator, T *position, size_t live, size_t n, It first) {
+    for (size_t i = 0; i < live; ++i, ++first) {
+        position[i] = *first;
+    }
+    return construct_from_range(allocator, position + live, first, n - live);
+}
+
+/* Like `fill_gap`, but fills the gap with `n` copies of `value`, which must not be an element of
+the buffer (as the elements are shifted before `value` is read). If constructing a copy throws,
+the copies constructed so far are destroyed before the exception is rethrown. */
+template <typename T, typename Allocator>
+constexpr void fill_gap_n(Allocator &allocator, T *position, size_t live, size_t n, const T &value) {
+    std::fill_n(position, live, value);
+    size_t i = live;
+    try {
+        for (; i < n; ++i) {
+            std::allocator_traits<Allocator>::construct(allocator, position + i, value);
+        }
+    } catch (...) {
+        for (size_t j = live; j < i; ++j) {
+            std::allocator_traits<Allocator>::destroy(allocator, position + j);
+        }
+        throw;
+    }
+}
+
+/* Undoes `open_gap(allocator, position, last, n)`, which returned `live`, after filling the gap
+has failed (by throwing), so that `[begin, last)` again holds the live elements. This assumes that
+the first `live` slots of the gap still hold elements and that the rest are uninitialized, as
+`fill_gap` and `fill_gap_n` leave them when they throw. If the tail was relocated, it is relocated
+back. Otherwise, it is move-assigned back over the first `last - position` slots (which all hold
+elements), and the elements constructed past `last` are destroyed. Either way, `[position, last)`
+holds the original tail again. */
+template <typename T, typename Allocator>
+constexpr void undo_open_gap(
+    Allocator &allocator, T *position, T *last, size_t n, [[maybe_unused]] size_t live
+) {
+    auto tail = static_cast<size_t>(last - position);
+    if (n == 0 || tail == 0) {
+        return;
+    }
+
+    if constexpr (uses_trivial_relocation_v<T, Allocator>) {
+        if (!std::is_constant_evaluated()) {
+            relocate_overlapping_range<T, Allocator>(position + n, tail, position);
+            return;
+        }
+    }
+
+    /* If `n` is at most the length of the tail, the gap is entirely live (`live == n`), and the
+    tail's last `n` elements end up past `last`; otherwise, the gap's first `tail` slots are live
+    (`live == tail`), and the whole tail ends up past `position + n`. */
+    assert(live == std::min(n, tail));
+    std::move(position + n, last + n, position);
+    for (auto it = std::max(last, position + n); it != last + n; ++it) {
+        std::allocator_traits<Allocator>::destroy(allocator, it);
+    }
+}
+
+/* Shifts the elements `[position, last)` `n` positions to the right (see `open_gap`), and then calls
+`fill(live)` to fill the gap (for instance, with `fill_gap`). If `fill` throws, leaving the gap as
+`fill_gap` does, the gap is closed again (see `undo_open_gap`) before the exception is rethrown, so
+that the caller, which only counts the new elements once this returns, still owns exactly the
+elements `[begin, last)`. */
+template <typename T, typename Allocator, typename Fill>
+constexpr void open_and_fill_gap(Allocator &allocator, T *position, T *last, size_t n, Fill fill) {
+    auto live = open_gap(allocator, position, last, n);
+    try {
+        fill(live);
+    } catch (...) {
+        undo_open_gap(allocator, position, last, n, live);
+        throw;
+    }
+}
+
+/* Erases the `n` elements `[position, position + n)` from the live elements `[begin, last)` of a
+buffer, by shifting the elements `[position + n, last)` `n` positions to the left with
+`std::move` and then destroying the `n` moved-from elements left at the end. If
+`uses_trivial_relocation_v<T, Allocator>` holds, the erased elements are destroyed first, and the
+tail is then shifted with a single `std::memmove`. Either way, the caller then owns `n` fewer
+elements, ending at `last - n`. */
+template <typename T, typename Allocator>
+constexpr void close_gap(Allocator &allocator, T *position, T *last, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    if constexpr (uses_trivial_relocation_v<T, Allocator>) {
+        if (!std::is_constant_evaluated()) {
+            for (size_t i = 0; i < n; ++i) {
+                std::allocator_traits<Allocator>::destroy(allocator, position + i);
+            }
+            relocate_overlapping_range<T, Allocator>(
+                position + n, static_cast<size_t>(last - (position + n)), position
+            );
+            return;
+        }
+    }
+
+    auto new_last = std::move(position + n, last, position);
+    for (auto it = new_last; it != last; ++it) {
+        std::allocator_traits<Allocator>::destroy(allocator, it);
+    }
+}
+
+#endif
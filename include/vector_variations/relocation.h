@@ -0,0 +1,139 @@
+/*
+@file relocation.h
+@brief Defines the `is_trivially_relocatable<T>` trait, along with the relocation helpers that the
+vector variations use to move elements between (or within) buffers in bulk.
+
+This file includes the following:
+- `is_trivially_relocatable<T>` (and `is_trivially_relocatable_v<T>`)
+- `uses_trivial_relocation_v<T, Allocator>`
+- `relocate_range(allocator, source, count, dest)`
+- `relocate_overlapping_range(source, count, dest)`
+- `swap_ranges_relocating(allocator, a, a_count, b, b_count)`
+*/
+
+#ifndef RELOCATION_H
+#define RELOCATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/* `is_trivially_relocatable<T>` is true iff an object of type `T` can be "relocated" (that is,
+move-constructed to a new address, followed by the destruction of the original object) by simply
+copying its bytes to the new address and then forgetting about the original object.
+
+Every trivially-copyable type is trivially relocatable, and so that is the default. However, many
+types that are not trivially copyable are still trivially relocatable; for instance, a type holding
+a `std::unique_ptr` or a raw owning pointer (like `NonDefaultConstructibleClass` in `main.cpp`)
+can be relocated with a `memcpy`, even though its move constructor and destructor are non-trivial.
+Such types can opt in to the trivial relocation fast paths by specializing this trait:
+
+    template <>
+    struct is_trivially_relocatable<MyType> : std::true_type {};
+
+Conversely, a trivially-copyable type can opt out by specializing this trait to `std::false_type`. */
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+/* `allocator_customizes_construction<Allocator, T>` is true iff `Allocator` provides its own
+`construct` or `destroy` member functions for `T`. If it does, then we must go through
+`std::allocator_traits` for every element, because the allocator may be relying on observing
+every construction and destruction (note that `std::allocator<T>` has no such members since
+C++20). */
+template <typename Allocator, typename T>
+concept allocator_customizes_construction =
+    requires (Allocator &allocator, T *p) { allocator.destroy(p); } ||
+    requires (Allocator &allocator, T *p, T &&value) { allocator.construct(p, std::move(value)); };
+
+/* `uses_trivial_relocation_v<T, Allocator>` is true iff elements of type `T` stored in memory from
+`Allocator` may be relocated using `std::memcpy`/`std::memmove`. This requires that `T` be
+trivially relocatable, that `Allocator` hand out raw `T*` pointers, and that `Allocator` not
+customize element construction/destruction. */
+template <typename T, typename Allocator>
+inline constexpr bool uses_trivial_relocation_v =
+    is_trivially_relocatable_v<T> &&
+    std::is_same_v<typename std::allocator_traits<Allocator>::pointer, T*> &&
+    !allocator_customizes_construction<Allocator, T>;
+
+/* Relocates the `count` elements starting at `source` to the uninitialized storage starting at
+`dest`. Afterwards, the original elements in the `source` range have been destroyed. The two
+ranges must not overlap.
+
+If `uses_trivial_relocation_v<T, Allocator>` holds, this is a single `std::memcpy`; otherwise,
+each element is move-constructed at its destination and then destroyed, one at a time. */
+template <typename T, typename Allocator>
+constexpr void relocate_range(Allocator &allocator, T *source, size_t count, T *dest) {
+    if constexpr (uses_trivial_relocation_v<T, Allocator>) {
+        if (!std::is_constant_evaluated()) {
+            /* `count` may be zero with `source` or `dest` being `nullptr`, which `std::memcpy`
+            does not allow. */
+            if (count != 0) {
+                std::memcpy(
+                    static_cast<void*>(dest), static_cast<const void*>(source), count * sizeof(T)
+                );
+            }
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        /* Move `source[i]` to `dest + i`, then destroy the moved-from element at `source + i` */
+        std::allocator_traits<Allocator>::construct(allocator, dest + i, std::move(source[i]));
+        std::allocator_traits<Allocator>::destroy(allocator, source + i);
+    }
+}
+
+/* Relocates the `count` elements starting at `source` to the storage starting at `dest`, where
+the two ranges are allowed to overlap; this is used to shift elements within a single buffer
+when inserting or erasing. Afterwards, every position in the `source` range that does not also
+lie in the `dest` range should be treated as uninitialized storage.
+
+This is only available when `uses_trivial_relocation_v<T, Allocator>` holds (in which case it is
+a single `std::memmove`), and it must not be called during constant evaluation. */
+template <typename T, typename Allocator>
+requires uses_trivial_relocation_v<T, Allocator>
+inline void relocate_overlapping_range(T *source, size_t count, T *dest) {
+    if (count != 0) {
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(source), count * sizeof(T));
+    }
+}
+
+/* Exchanges the `a_count` elements starting at `a` with the `b_count` elements starting at `b`,
+where each buffer has room for the other's elements (and the two do not overlap). The first
+`min(a_count, b_count)` elements of each are swapped in place, and the remaining elements of the
+longer range are then relocated (see `relocate_range`) to the end of the shorter one, so that no
+element is moved more than needed. If `uses_trivial_relocation_v<T, Allocator>` holds, the
+elements are swapped as raw bytes. */
+template <typename T, typename Allocator>
+constexpr void swap_ranges_relocating(
+    Allocator &allocator, T *a, size_t a_count, T *b, size_t b_count
+) {
+    auto common = std::min(a_count, b_count);
+    bool trivial_swap = false;
+    if constexpr (uses_trivial_relocation_v<T, Allocator>) {
+        trivial_swap = !std::is_constant_evaluated();
+    }
+    if (trivial_swap) {
+        auto a_bytes = reinterpret_cast<unsigned char*>(a);
+        std::swap_ranges(a_bytes, a_bytes + common * sizeof(T), reinterpret_cast<unsigned char*>(b));
+    } else {
+        using std::swap;
+        for (size_t i = 0; i < common; ++i) {
+            swap(a[i], b[i]);
+        }
+    }
+
+    if (a_count > common) {
+        relocate_range(allocator, a + common, a_count - common, b + common);
+    } else {
+        relocate_range(allocator, b + common, b_count - common, a + common);
+    }
+}
+
+#endif
@@ -0,0 +1,631 @@
+/*
+@file soa_vector.h
+@brief Defines and implements `BasicSoAVector<InlineCapacity, Growable, Allocator, Ts...>`, a
+"structure of arrays" vector whose rows are made up of one field of each type in `Ts...`, and
+which stores each field (column) in its own contiguous array.
+
+This file includes the following types:
+- `BasicSoAVector<InlineCapacity, Growable, Allocator, Ts...>`
+- `SoAVector<Ts...>`, `StackAssistedSoAVector<StackCapacity, Ts...>`, and
+  `FixedCapacitySoAVector<Capacity, Ts...>`
+*/
+
+#ifndef SOA_VECTOR_H
+#define SOA_VECTOR_H
+
+#include "vector_variations/growth_policies.h"
+#include "vector_variations/relocation.h"
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace soa_detail {
+
+/* `UninitializedArray<T, N>` holds storage for `N` objects of type `T` without constructing them.
+As in `FixedCapacityVector`, the array is kept in an union, which prevents it from being
+automatically initialized (and destroyed), and which allows `T` to be non-default-constructible. */
+template <typename T, size_t N>
+struct UninitializedArray {
+    union {
+        T elements[N];
+    };
+
+    constexpr UninitializedArray() {}
+    constexpr ~UninitializedArray() {}
+};
+
+/* With zero capacity, there is no storage at all (arrays of size zero are not allowed) */
+template <typename T>
+struct UninitializedArray<T, 0> {
+    static constexpr T *elements = nullptr;
+};
+
+/* The columns of a heap buffer each start on a cache-line boundary, so that they are suitably
+aligned for SIMD loads, and so that no cache line is shared by two columns. Heap buffers are
+allocated as arrays of `CacheLine`s. */
+struct alignas(64) CacheLine {
+    std::byte bytes[64];
+};
+
+/* `RowIterator<Const, Ts...>` is a random-access iterator over the rows of a `BasicSoAVector`.
+Dereferencing it gives a proxy reference to a row, which is a `std::tuple` of references to the
+fields in each column (`std::tuple<Ts&...>`, or `std::tuple<const Ts&...>` if `Const` is true).
+Proxy references can be used with structured bindings, and assigning a tuple to one assigns each
+field:
+
+    for (auto [id, position] : soa) { position += 1.0f; }
+    soa[0] = std::tuple(7, 0.0f);
+
+As the reference type is not an actual reference, this is only an input iterator as far as the
+C++17 iterator categories are concerned (like the iterators of, e.g., `std::views::zip`). */
+template <bool Const, typename... Ts>
+struct RowIterator {
+    using value_type        = std::tuple<Ts...>;
+    using reference         =
+        std::conditional_t<Const, std::tuple<const Ts&...>, std::tuple<Ts&...>>;
+    using difference_type   = ptrdiff_t;
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using Columns           =
+        std::conditional_t<Const, std::tuple<const Ts*...>, std::tuple<Ts*...>>;
+
+    /* `columns` = The first element of each column; `index` = The index of the current row */
+    Columns columns{};
+    difference_type index = 0;
+
+    constexpr RowIterator() = default;
+    constexpr RowIterator(Columns columns_, difference_type index_)
+    : columns{columns_}, index{index_} {}
+
+    /* Every iterator converts to a const iterator (this is a template so that it is not taken
+    for the copy constructor) */
+    template <bool OtherConst>
+    requires (Const && !OtherConst)
+    constexpr RowIterator(const RowIterator<OtherConst, Ts...> &other)
+    : columns{other.columns}, index{other.index} {}
+
+    constexpr reference operator* () const { return (*this)[0]; }
+    constexpr reference operator[] (difference_type n) const {
+        return std::apply(
+            [this, n](auto*... column) { return reference(column[index + n]...); }, columns
+        );
+    }
+
+    constexpr RowIterator& operator++ () { ++index; return *this; }
+    constexpr RowIterator& operator-- () { --index; return *this; }
+    constexpr RowIterator operator++ (int) { auto old = *this; ++index; return old; }
+    constexpr RowIterator operator-- (int) { auto old = *this; --index; return old; }
+    constexpr RowIterator& operator+= (difference_type n) { index += n; return *this; }
+    constexpr RowIterator& operator-= (difference_type n) { index -= n; return *this; }
+
+    friend constexpr RowIterator operator+ (RowIterator it, difference_type n) { return it += n; }
+    friend constexpr RowIterator operator+ (difference_type n, RowIterator it) { return it += n; }
+    friend constexpr RowIterator operator- (RowIterator it, difference_type n) { return it -= n; }
+    friend constexpr difference_type operator- (const RowIterator &a, const RowIterator &b) {
+        return a.index - b.index;
+    }
+
+    /* Iterators are only comparable if they belong to the same `BasicSoAVector`, so comparing
+    their indices suffices */
+    friend constexpr bool operator== (const RowIterator &a, const RowIterator &b) {
+        return a.index == b.index;
+    }
+    friend constexpr auto operator<=> (const RowIterator &a, const RowIterator &b) {
+        return a.index <=> b.index;
+    }
+};
+
+}  /* namespace soa_detail */
+
+/* `BasicSoAVector<InlineCapacity, Growable, Allocator, Ts...>` is a dynamically-resizable array of
+rows, where every row consists of one field of each of the types `Ts...`. Unlike a vector of
+structs (say, `StackAssistedVector<Record, N>`), which interleaves the fields of every row in
+memory, it stores each field in its own contiguous array (a "column"). A loop that only reads one
+or two fields of every row then only pulls those columns through the cache, rather than every
+field of every row, and each column can be handed to SIMD code as a `std::span` (see `column<I>()`).
+
+The storage of the columns is given by the two template parameters `InlineCapacity` and
+`Growable`:
+- `SoAVector<Ts...>` (no inline capacity, growable) always stores its columns in one heap buffer,
+  like `std::vector`.
+- `StackAssistedSoAVector<StackCapacity, Ts...>` (growable) stores the first `StackCapacity` rows
+  inline, like `StackAssistedVector`, and moves to a heap buffer once that is exceeded.
+- `FixedCapacitySoAVector<Capacity, Ts...>` (not growable) only ever stores up to `Capacity` rows
+  inline, like `FixedCapacityVector`.
+Inline columns are `union`-wrapped arrays, as in `FixedCapacityVector`; a heap buffer holds every
+column, each one starting on a cache line of its own. The heap buffer grows by `DoublingGrowth`.
+
+Rows are accessed through proxy references (see `soa_detail::RowIterator` above). As the element
+types differ, `Allocator` is an allocator of `std::byte`, which is rebound as needed.
+
+Since the columns are addressed through the storage of the object itself (or a heap buffer whose
+columns are found with `reinterpret_cast`), this class is not usable during constant
+evaluation. */
+template <size_t InlineCapacity, bool Growable, typename Allocator, typename... Ts>
+requires (sizeof...(Ts) > 0 && (Growable || InlineCapacity > 0))
+struct BasicSoAVector {
+    using value_type      = std::tuple<Ts...>;
+    using allocator_type  = Allocator;
+    using reference       = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator        = soa_detail::RowIterator<false, Ts...>;
+    using const_iterator  = soa_detail::RowIterator<true, Ts...>;
+
+    /* `column_type<I>` = The type of the fields in the `I`th column */
+    template <size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    /* The number of columns, which is the number of fields in every row */
+    static constexpr size_t column_count = sizeof...(Ts);
+
+
+    /* --- ITERATORS --- */
+
+    iterator begin() { return iterator(columns, 0); }
+    const_iterator begin() const { return const_iterator(columns, 0); }
+    const_iterator cbegin() const { return begin(); }
+
+    iterator end() { return iterator(columns, current_size); }
+    const_iterator end() const { return const_iterator(columns, current_size); }
+    const_iterator cend() const { return end(); }
+
+
+    /* --- GETTERS --- */
+
+    /* Returns true iff this `BasicSoAVector` contains zero rows. */
+    bool empty() const { return size() == 0; }
+
+    /* Returns the current number of rows stored in this `BasicSoAVector`. */
+    size_type size() const { return current_size; }
+
+    /* Returns the maximum number of rows this `BasicSoAVector` could theoretically hold. */
+    size_type max_size() const {
+        if constexpr (!Growable) {
+            return InlineCapacity;
+        } else {
+            /* The heap buffer (as a whole, including the padding of up to one cache line after
+            each column) must not be larger than what the `Allocator` allows. */
+            LineAllocator line_allocator(allocator);
+            auto max_lines = std::allocator_traits<LineAllocator>::max_size(line_allocator);
+            return (max_lines - column_count) * sizeof(soa_detail::CacheLine) / row_bytes;
+        }
+    }
+
+    /* Returns the current capacity of this `BasicSoAVector`. */
+    size_type capacity() const {
+        return (on_heap() ? heap_capacity : InlineCapacity);
+    }
+
+
+    /* --- COLUMN ACCESS --- */
+
+    /* Returns the `I`th column, which holds the `I`th field of every row, as a contiguous span.
+    The span is invalidated by anything that changes the capacity of this `BasicSoAVector`. */
+    template <size_t I>
+    std::span<column_type<I>> column() { return {std::get<I>(columns), current_size}; }
+    template <size_t I>
+    std::span<const column_type<I>> column() const { return {std::get<I>(columns), current_size}; }
+
+    /* Returns a pointer to the first field of the `I`th column (as with `data()` in `std::vector`,
+    this may or may not be `nullptr` if this `BasicSoAVector` is empty). */
+    template <size_t I>
+    column_type<I>* data() { return std::get<I>(columns); }
+    template <size_t I>
+    const column_type<I>* data() const { return std::get<I>(columns); }
+
+
+    /* --- ROW ACCESS --- */
+
+    reference operator[] (size_type index) { return begin()[index]; }
+    const_reference operator[] (size_type index) const { return begin()[index]; }
+    reference at(size_type index) {
+        check_if_out_of_bounds(index);
+        return begin()[index];
+    }
+    const_reference at(size_type index) const {
+        check_if_out_of_bounds(index);
+        return begin()[index];
+    }
+    reference front() { return begin()[0]; }
+    const_reference front() const { return begin()[0]; }
+    reference back() { return begin()[current_size - 1]; }
+    const_reference back() const { return begin()[current_size - 1]; }
+
+
+    /* --- CAPACITY-CHANGING METHODS --- */
+
+    /* Increases the capacity of this `BasicSoAVector` to at least `new_capacity` rows. Does
+    nothing if the capacity is already large enough. For `FixedCapacitySoAVector`, `new_capacity`
+    must be at most `Capacity`. */
+    void reserve(size_type new_capacity) {
+        if (new_capacity <= capacity()) {
+            return;
+        }
+        if constexpr (Growable) {
+            reallocate(new_capacity);
+        } else {
+            assert(false && "FixedCapacitySoAVector: reserve() beyond the fixed capacity");
+        }
+    }
+
+    /* Resizes this `BasicSoAVector` to contain exactly `new_size` rows, by removing rows from the
+    end or by appending rows whose fields are all value-initialized. */
+    void resize(size_type new_size) {
+        if (new_size < current_size) {
+            destroy_rows(new_size, current_size);
+        } else if (new_size > current_size) {
+            reserve(new_size);
+            /* If constructing a field throws, the rows appended so far are destroyed again */
+            auto i = current_size;
+            try {
+                for (; i < new_size; ++i) {
+                    construct_row(columns, i);
+                }
+            } catch (...) {
+                destroy_rows(current_size, i);
+                throw;
+            }
+        }
+        current_size = new_size;
+    }
+
+
+    /* --- MUTATORS --- */
+
+    /* Appends a row whose fields are constructed from `fields` (one argument per column), and
+    returns a reference to it. The arguments may refer to rows of this `BasicSoAVector` itself,
+    even if it has to grow: the new row is constructed before the existing rows are moved. */
+    template <typename... Us>
+    requires (sizeof...(Us) == sizeof...(Ts))
+    reference emplace_back(Us&&... fields) {
+        if (current_size == capacity()) {
+            if constexpr (Growable) {
+                auto new_capacity = DoublingGrowth::next_capacity(
+                    capacity(), current_size + 1, row_bytes
+                );
+                auto new_columns = allocate_columns(new_capacity);
+                try {
+                    construct_row(new_columns, current_size, std::forward<Us>(fields)...);
+                } catch (...) {
+                    deallocate_columns(new_columns, new_capacity);
+                    throw;
+                }
+                adopt_columns(new_columns, new_capacity);
+                return (*this)[current_size++];
+            } else {
+                assert(false && "FixedCapacitySoAVector: emplace_back() beyond the fixed capacity");
+            }
+        }
+        construct_row(columns, current_size, std::forward<Us>(fields)...);
+        return (*this)[current_size++];
+    }
+
+    /* Appends a copy of the row `row`. */
+    void push_back(const value_type &row) {
+        std::apply([this](const Ts&... fields) { emplace_back(fields...); }, row);
+    }
+
+    /* Appends the row `row`, moving each of its fields. */
+    void push_back(value_type &&row) {
+        std::apply([this](Ts&... fields) { emplace_back(std::move(fields)...); }, row);
+    }
+
+    /* Removes the last row of this `BasicSoAVector`. */
+    void pop_back() {
+        assert(!empty());
+        destroy_rows(current_size - 1, current_size);
+        --current_size;
+    }
+
+    /* Removes every row, after which `size()` will return zero. */
+    void clear() {
+        destroy_rows(0, current_size);
+        current_size = 0;
+    }
+
+    /* Removes the row at `position`, and returns an iterator to the row after it. */
+    iterator erase(const_iterator position) {
+        assert(position != end());
+        return erase(position, position + 1);
+    }
+
+    /* Removes the rows in the range `[first, last)`, and returns an iterator to the row after
+    them. As in `FixedCapacityVector`, the rows after `last` are shifted to the left by
+    move-assignment, one column at a time, and the moved-from rows at the end are destroyed. */
+    iterator erase(const_iterator first, const_iterator last) {
+        auto start = static_cast<size_type>(first.index);
+        auto n = static_cast<size_type>(last.index - first.index);
+        if (n != 0) {
+            for_each_column([&](auto *column) {
+                std::move(column + start + n, column + current_size, column + start);
+            });
+            destroy_rows(current_size - n, current_size);
+            current_size -= n;
+        }
+        return begin() + start;
+    }
+
+
+    /* --- CONSTRUCTORS AND DESTRUCTOR --- */
+
+    BasicSoAVector(const Allocator &allocator_ = {}) : allocator{allocator_} {}
+
+    /* Constructs a `BasicSoAVector` with `initial_size` rows whose fields are value-initialized. */
+    BasicSoAVector(size_type initial_size, const Allocator &allocator_ = {})
+    : allocator{allocator_} {
+        construct_guarded([&] { resize(initial_size); });
+    }
+
+    /* Initializer-list constructor, e.g. `SoAVector<int, float> soa{{1, 1.0f}, {2, 2.0f}};` */
+    BasicSoAVector(std::initializer_list<value_type> init, const Allocator &allocator_ = {})
+    : allocator{allocator_} {
+        construct_guarded([&] {
+            reserve(init.size());
+            for (const auto &row : init) {
+                push_back(row);
+            }
+        });
+    }
+
+    /* Copy constructor. As with `std::vector`, the copy's allocator is given by
+    `select_on_container_copy_construction`. */
+    BasicSoAVector(const BasicSoAVector &other)
+    : allocator{std::allocator_traits<Allocator>::select_on_container_copy_construction(
+        other.allocator
+    )} {
+        construct_guarded([&] {
+            reserve(other.size());
+            for (size_type i = 0; i < other.size(); ++i) {
+                std::apply([this, i](auto*... column) {
+                    construct_row(columns, i, column[i]...);
+                }, other.columns);
+                ++current_size;
+            }
+        });
+    }
+
+    /* Move constructor. A heap buffer is taken over from `other`, whereas inline rows are moved
+    one field at a time (after which `other` is left empty). */
+    BasicSoAVector(BasicSoAVector &&other)
+    : allocator{other.allocator} {
+        if (other.on_heap()) {
+            columns = other.columns;
+            heap_capacity = other.heap_capacity;
+            current_size = other.current_size;
+            other.columns = other.inline_column_pointers();
+            other.heap_capacity = 0;
+            other.current_size = 0;
+        } else {
+            construct_guarded([&] {
+                for (size_type i = 0; i < other.size(); ++i) {
+                    std::apply([this, i](auto*... column) {
+                        construct_row(columns, i, std::move(column[i])...);
+                    }, other.columns);
+                    ++current_size;
+                }
+            });
+            other.clear();
+        }
+    }
+
+    /* Destructor */
+    ~BasicSoAVector() {
+        clear();
+        deallocate_columns();
+    }
+
+private:
+    using ColumnPointers = std::tuple<Ts*...>;
+    using LineAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<soa_detail::CacheLine>;
+    static_assert(
+        std::is_same_v<
+            typename std::allocator_traits<LineAllocator>::pointer, soa_detail::CacheLine*
+        >,
+        "BasicSoAVector requires an allocator whose pointers are plain pointers"
+    );
+    static_assert(
+        ((alignof(Ts) <= alignof(soa_detail::CacheLine)) && ...),
+        "BasicSoAVector does not support field types aligned to more than a cache line"
+    );
+
+    /* `row_bytes` = The combined size of one field of each column */
+    static constexpr size_t row_bytes = (sizeof(Ts) + ...);
+
+    /* `inline_columns` = The inline storage of every column (which is empty if `InlineCapacity`
+    is zero). */
+    [[no_unique_address]] std::tuple<soa_detail::UninitializedArray<Ts, InlineCapacity>...>
+        inline_columns;
+    /* `columns` = The first element of every column, either in `inline_columns` or in the heap
+    buffer (whose first column starts at the beginning of the buffer) */
+    ColumnPointers columns = inline_column_pointers();
+    /* `current_size` = The current number of rows */
+    size_t current_size = 0;
+    /* `heap_capacity` = The capacity of the heap buffer, or 0 if the columns are stored inline */
+    size_t heap_capacity = 0;
+    /* `allocator` = An instance of type `Allocator`, used to allocate the heap buffer and to
+    construct/destroy fields. It takes up no space if `Allocator` is stateless. */
+    [[no_unique_address]] Allocator allocator;
+
+    /* Returns true iff the columns are stored in a heap buffer */
+    bool on_heap() const { return heap_capacity != 0; }
+
+    /* Returns the first element of every column in `inline_columns` */
+    ColumnPointers inline_column_pointers() {
+        return std::apply(
+            [](auto&... arrays) { return ColumnPointers(arrays.elements...); }, inline_columns
+        );
+    }
+
+    /* Calls `f(column)` for the first element `column` of every column */
+    template <typename F>
+    void for_each_column(F &&f) {
+        std::apply([&f](auto*... column) { (f(column), ...); }, columns);
+    }
+
+    /* Constructs the fields of row `index` of `target` from `fields` (or value-initializes them,
+    if `fields` is empty). If constructing a field throws, the fields of the row constructed so far
+    are destroyed before the exception is rethrown. */
+    template <typename... Us>
+    void construct_row(const ColumnPointers &target, size_type index, Us&&... fields) {
+        size_t constructed = 0;
+        try {
+            if constexpr (sizeof...(Us) == 0) {
+                std::apply([&](auto*... column) {
+                    ((std::allocator_traits<Allocator>::construct(allocator, column + index),
+                      ++constructed), ...);
+                }, target);
+            } else {
+                [&]<size_t... I>(std::index_sequence<I...>) {
+                    ((std::allocator_traits<Allocator>::construct(
+                        allocator, std::get<I>(target) + index, std::forward<Us>(fields)
+                    ), ++constructed), ...);
+                }(std::index_sequence_for<Ts...>{});
+            }
+        } catch (...) {
+            auto destroy_if_constructed = [&](size_t column_index, auto *field) {
+                if (column_index < constructed) {
+                    std::allocator_traits<Allocator>::destroy(allocator, field);
+                }
+            };
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (destroy_if_constructed(I, std::get<I>(target) + index), ...);
+            }(std::index_sequence_for<Ts...>{});
+            throw;
+        }
+    }
+
+    /* Runs `build` in a constructor; if it throws, the rows built so far are destroyed and the
+    heap buffer (if any) is deallocated before the exception is rethrown, as the destructor will
+    not run */
+    template <typename Build>
+    void construct_guarded(Build build) {
+        try {
+            build();
+        } catch (...) {
+            clear();
+            deallocate_columns();
+            throw;
+        }
+    }
+
+    /* Destroys the fields of the rows in `[first, last)` */
+    void destroy_rows(size_type first, size_type last) {
+        for_each_column([&](auto *column) {
+            for (size_type i = first; i < last; ++i) {
+                std::allocator_traits<Allocator>::destroy(allocator, column + i);
+            }
+        });
+    }
+
+    /* Returns the offset in bytes of column `I` in a heap buffer of capacity `capacity`. Every
+    column is padded to a whole number of cache lines. */
+    template <size_t I>
+    static size_t column_offset(size_t capacity) {
+        constexpr size_t field_sizes[] = {sizeof(Ts)...};
+        constexpr size_t line = sizeof(soa_detail::CacheLine);
+        size_t offset = 0;
+        for (size_t j = 0; j < I; ++j) {
+            offset += (field_sizes[j] * capacity + line - 1) / line * line;
+        }
+        return offset;
+    }
+
+    /* Returns the number of cache lines in a heap buffer of capacity `capacity` */
+    static size_t buffer_lines(size_t capacity) {
+        return column_offset<column_count>(capacity) / sizeof(soa_detail::CacheLine);
+    }
+
+    /* Allocates a heap buffer of capacity `capacity`, and returns the first element of each of its
+    columns */
+    ColumnPointers allocate_columns(size_t capacity) {
+        LineAllocator line_allocator(allocator);
+        auto buffer = reinterpret_cast<std::byte*>(
+            std::allocator_traits<LineAllocator>::allocate(line_allocator, buffer_lines(capacity))
+        );
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return ColumnPointers(
+                reinterpret_cast<Ts*>(buffer + column_offset<I>(capacity))...
+            );
+        }(std::index_sequence_for<Ts...>{});
+    }
+
+    /* Deallocates the heap buffer, if there is one */
+    void deallocate_columns() {
+        if (on_heap()) {
+            deallocate_columns(columns, heap_capacity);
+        }
+    }
+
+    /* Deallocates the heap buffer of capacity `capacity` whose columns are `buffer_columns` */
+    void deallocate_columns(const ColumnPointers &buffer_columns, size_t capacity) {
+        LineAllocator line_allocator(allocator);
+        std::allocator_traits<LineAllocator>::deallocate(
+            line_allocator,
+            reinterpret_cast<soa_detail::CacheLine*>(std::get<0>(buffer_columns)),
+            buffer_lines(capacity)
+        );
+    }
+
+    /* Relocates every row to `new_columns` (a heap buffer of capacity `new_capacity`), then
+    deallocates the old heap buffer (if any) and switches over to the new one */
+    void adopt_columns(const ColumnPointers &new_columns, size_t new_capacity) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (relocate_column(std::get<I>(columns), std::get<I>(new_columns)), ...);
+        }(std::index_sequence_for<Ts...>{});
+        deallocate_columns();
+        columns = new_columns;
+        heap_capacity = new_capacity;
+    }
+
+    /* Relocates the `current_size` fields of one column from `source` to `dest`. This is a single
+    `std::memcpy` per column for trivially relocatable field types (see `relocation.h`). */
+    template <typename T>
+    void relocate_column(T *source, T *dest) {
+        typename std::allocator_traits<Allocator>::template rebind_alloc<T> column_allocator(
+            allocator
+        );
+        relocate_range(column_allocator, source, current_size, dest);
+    }
+
+    /* Moves every row to a new heap buffer of capacity `new_capacity` */
+    void reallocate(size_t new_capacity) {
+        adopt_columns(allocate_columns(new_capacity), new_capacity);
+    }
+
+    /* Throws `std::out_of_range` if `index` is out of bounds for this `BasicSoAVector`. */
+    void check_if_out_of_bounds(size_type index) const {
+        if (index >= size()) {
+            throw std::out_of_range(
+                std::format("BasicSoAVector: index ({}) >= size ({})\n", index, size())
+            );
+        }
+    }
+};
+
+/* A `BasicSoAVector` which always stores its columns in a heap buffer */
+template <typename... Ts>
+using SoAVector = BasicSoAVector<0, true, std::allocator<std::byte>, Ts...>;
+
+/* A `BasicSoAVector` which stores up to `StackCapacity` rows inline before moving to the heap */
+template <size_t StackCapacity, typename... Ts>
+using StackAssistedSoAVector =
+    BasicSoAVector<StackCapacity, true, std::allocator<std::byte>, Ts...>;
+
+/* A `BasicSoAVector` which stores up to `Capacity` rows inline, and never allocates */
+template <size_t Capacity, typename... Ts>
+using FixedCapacitySoAVector = BasicSoAVector<Capacity, false, std::allocator<std::byte>, Ts...>;
+
+#endif
@@ -1,27 +1,180 @@
 /*
 @file stack_assisted_vector.h
-@brief Defines and implements `StackAssistedVector<T, StackCapacity, Allocator>`, a variation on
-`std::vector` that preallocates stack space for the first `StackCapacity` elements.
+@brief Defines and implements `StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy,
+Layout>`, a variation on `std::vector` that preallocates stack space for the first `StackCapacity`
+elements.
 
 This file includes the following types:
-- `StackAssistedVector<T, StackCapacity, Allocator>`
+- `StandardSAVLayout` and `CompactSAVLayout<SizeType>`
+- `StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy, Layout>`
+- `CompactStackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy>`
 */
 
 #ifndef STACK_ASSISTED_VECTOR_H
 #define STACK_ASSISTED_VECTOR_H
 
 #include <cstddef>
+#include <cstdint>
+#include <concepts>
 #include <memory>
+#include <algorithm>
+#include <functional>
 #include <limits>
 #include <cassert>
 #include <format>
+#include <iterator>
+#include <ranges>
 #include <string>
+#include <stdexcept>
+#include <version>
+#include "vector_variations/relocation.h"
+#include "vector_variations/bulk_construction.h"
+#include "vector_variations/insert_erase.h"
+#include "vector_variations/growth_policies.h"
+#include "allocators/allocator_hooks.h"
+#include "instrumentation/container_counters.h"
+#include "instrumentation/capacity_profile.h"
+
+/* A `StackAssistedVector` layout decides how the bookkeeping fields of a `StackAssistedVector` are
+stored; that is, how it keeps track of its size, of whether its elements are on the stack or on the
+heap, and of the location and capacity of its dynamic array in the latter case. Each layout `L`
+provides a class template `L::storage<T, StackCapacity>` which contains
+- `fixed_array`, the stack storage for up to `StackCapacity` elements of type `T`;
+- `current_size`, the current number of elements;
+- `on_heap()`, which returns true iff the elements are stored in the dynamic array;
+- `heap_array()`/`heap_capacity()`, which return the dynamic array and its capacity (and which may
+only be called when `on_heap()` returns true);
+- `set_heap_array(p, capacity)`, which records that the elements are now stored in the dynamic array
+`p` with capacity `capacity`; and
+- `set_on_stack()`, which records that the elements are now stored in `fixed_array`.
+- `max_capacity`, the largest capacity the layout can represent. */
+
+/* `StandardSAVLayout` stores a pointer to the dynamic array (which is `nullptr` when the elements
+are on the stack), followed by the `fixed_array` (which shares its memory with the capacity of the
+dynamic array), and then the size as a `size_t`. */
+struct StandardSAVLayout {
+    template <typename T, size_t StackCapacity>
+    struct storage {
+        /* If elements are being stored on the heap, then they will reside in `dynamic_array`.
+        Otherwise, if elements are being stored on the stack, then `dynamic_array` will be set to
+        `nullptr` and the elements will reside in `fixed_array` (defined below). Whether or not
+        `dynamic_array` is `nullptr` serves as the discriminator for which of the two union members
+        below is the active one. */
+        T *dynamic_array = nullptr;
+
+        union {
+            /* `fixed_array` stores at most `StackCapacity` elements of type `T` on the stack; if
+            elements are being kept on the stack, then they will always reside in `fixed_array`.
+            Now, the reason that `fixed_array` is kept in an union (besides having it share the
+            same memory as `current_dynamic_capacity` and hence save storage) is because whenever
+            something is put inside an `union`, it is not automatically initialized. If
+            `fixed_array` was made a regular member, then initializing `StackAssistedVector` would
+            also initialize `fixed_array`, which would always result in `StackCapacity` calls to the
+            default constructor of `T`. Instead, by having `fixed_array` reside within an `union`,
+            its elements are not automatically default-constructed; not only does this save the
+            overhead of `StackCapacity` calls to `T::T()`, but it also allows for the type `T` to
+            be not default-constructible, giving `StackAssistedVector` an ability that `std::array`
+            does not have. Choosing to not initialize the elements of `fixed_array` by default,
+            however, means that we must use placement-new and placement-delete to eventually
+            construct the elements, in order to abide by C++'s object lifetime rules. */
+            T fixed_array[StackCapacity];
+
+            /* When `dynamic_array` is not `nullptr`, `current_dynamic_capacity` represents the
+            current size of `dynamic_array`, which is equivalent to the current capacity we have
+            for storing elements on the heap. Storing this in an union along with `fixed_array`
+            saves storage. */
+            size_t current_dynamic_capacity = 0;
+        };
+
+        /* `current_size` = The current number of elements stored within the `StackAssistedVector` */
+        size_t current_size = 0;
+
+        static constexpr size_t max_capacity = std::numeric_limits<size_t>::max();
+
+        constexpr bool on_heap() const { return dynamic_array != nullptr; }
+        constexpr T* heap_array() const { return dynamic_array; }
+        constexpr size_t heap_capacity() const { return current_dynamic_capacity; }
+
+        constexpr void set_heap_array(T *array, size_t capacity) {
+            dynamic_array = array;
+            current_dynamic_capacity = capacity;
+        }
+        constexpr void set_on_stack() { dynamic_array = nullptr; }
+
+        /* The anonymous union above has a deleted destructor whenever `T` is not trivially
+        destructible, so the destructor must be user-provided. Elements are destroyed by
+        `StackAssistedVector` itself. */
+        constexpr storage() {}
+        constexpr ~storage() {}
+    };
+};
+
+/* `CompactSAVLayout<SizeType>` minimizes the size of a `StackAssistedVector`, for use when very
+many (mostly small) vectors are kept around. Compared to `StandardSAVLayout`:
+- The pointer to the dynamic array shares its memory with `fixed_array` (rather than the capacity
+doing so), so there is no separate pointer;
+- Whether the elements are on the heap is tracked with a single bit, stolen from the highest bit of
+the capacity of the dynamic array; and
+- The size and the capacity are stored as `SizeType` (`uint32_t` by default), which limits the
+capacity to `2^(bits in SizeType - 1) - 1` elements.
+Together with a stateless allocator, this makes `CompactStackAssistedVector<int, 2>` just 16 bytes
+(8 for the union of `fixed_array` and the pointer, and 4 each for the size and capacity). */
+template <std::unsigned_integral SizeType = uint32_t>
+struct CompactSAVLayout {
+    template <typename T, size_t StackCapacity>
+    struct storage {
+        union {
+            /* `fixed_array` stores the elements while they are on the stack (see the comment on
+            `StandardSAVLayout::storage::fixed_array`)... */
+            T fixed_array[StackCapacity];
+
+            /* ...and once they move to the heap, `dynamic_array` points to them instead. */
+            T *dynamic_array = nullptr;
+        };
+
+        /* `current_size` = The current number of elements stored within the `StackAssistedVector` */
+        SizeType current_size = 0;
+
+        /* `current_dynamic_capacity` = The capacity of `dynamic_array` when `is_on_heap` is set */
+        SizeType current_dynamic_capacity : std::numeric_limits<SizeType>::digits - 1 = 0;
+
+        /* `is_on_heap` = Whether the elements are in `dynamic_array` (rather than `fixed_array`);
+        this is the discriminator for which of the two union members above is the active one. */
+        SizeType is_on_heap : 1 = 0;
+
+        static constexpr size_t max_capacity =
+            (size_t{1} << (std::numeric_limits<SizeType>::digits - 1)) - 1;
+        static_assert(StackCapacity <= max_capacity, "StackCapacity is too large for SizeType");
+
+        constexpr bool on_heap() const { return is_on_heap; }
+        constexpr T* heap_array() const { return dynamic_array; }
+        constexpr size_t heap_capacity() const { return current_dynamic_capacity; }
+
+        constexpr void set_heap_array(T *array, size_t capacity) {
+            dynamic_array = array;
+            current_dynamic_capacity = static_cast<SizeType>(capacity);
+            is_on_heap = 1;
+        }
+        constexpr void set_on_stack() { is_on_heap = 0; }
+
+        constexpr storage() {}
+        constexpr ~storage() {}
+    };
+};
 
-/* `StackAssistedVector<T, StackCapacity, Allocator>` is a dynamically-resizable array which
-preallocates stack space for exactly `StackCapacity` elements, and which guarantees
-zero dynamic memory allocations until that `StackCapacity` is exceeded. */
-template <typename T, size_t Capacity, typename Allocator = std::allocator<T>>
-struct StackAssistedVector {
+/* `StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy, Layout>` is a
+dynamically-resizable array which preallocates stack space for exactly `StackCapacity` elements,
+and which guarantees zero dynamic memory allocations until that `StackCapacity` is exceeded.
+Whenever the capacity is exhausted, `GrowthPolicy` decides the new capacity (see
+`growth_policies.h`), and `Layout` decides how the bookkeeping fields are stored (see above). */
+template <
+    typename T, size_t Capacity, typename Allocator = std::allocator<T>,
+    growth_policy GrowthPolicy = DoublingGrowth, typename Layout = StandardSAVLayout
+>
+struct StackAssistedVector : private Layout::template storage<T, Capacity> {
+    using Storage = typename Layout::template storage<T, Capacity>;
+
+public:
     using value_type             = T;
     using allocator_type         = Allocator;
     using pointer                = typename std::allocator_traits<Allocator>::pointer;
@@ -38,8 +191,8 @@ struct StackAssistedVector {
 
     /* --- ITERATORS --- */
 
-    constexpr iterator begin() { return (dynamic_array ? dynamic_array : fixed_array); }
-    constexpr const_iterator begin() const { return (dynamic_array ? dynamic_array : fixed_array); }
+    constexpr iterator begin() { return (on_heap() ? heap_array() : fixed_array); }
+    constexpr const_iterator begin() const { return (on_heap() ? heap_array() : fixed_array); }
     constexpr const_iterator cbegin() const { return begin(); }
 
     constexpr iterator end() { return begin() + current_size; }
@@ -75,15 +228,22 @@ struct StackAssistedVector {
         of objects of type `T` that can be allocated. */
         auto limit_from_allocator = std::allocator_traits<Allocator>::max_size(allocator);
 
-        /* Take the minimum of those two values */
-        return std::min(limit_from_ptrdiff_type, limit_from_allocator);
+        /* Finally, the `Layout` may not be able to represent arbitrarily large capacities. Take
+        the minimum of all three values. */
+        return std::min({limit_from_ptrdiff_type, limit_from_allocator, Storage::max_capacity});
     }
 
     /* Returns the current capacity of this `StackAssistedVector`. */
     constexpr size_type capacity() const {
-        return (dynamic_array ? current_dynamic_capacity : Capacity);
+        return (on_heap() ? heap_capacity() : Capacity);
     }
 
+    /* Returns true iff the elements are stored in `fixed_array` (rather than on the heap). */
+    constexpr bool is_inline() const { return !on_heap(); }
+
+    /* Returns a copy of the allocator used by this `StackAssistedVector`. */
+    constexpr allocator_type get_allocator() const { return allocator; }
+
 
     /* --- CAPACITY-CHANGING METHODS (resize, reserve, shrink_to_fit) --- */
 
@@ -96,6 +256,8 @@ struct StackAssistedVector {
     will be appended to achieve that `new_size`. */
     constexpr void resize(size_type new_size) {
         if (new_size < size()) {
+            peak_size_tracker.note(current_size);
+
             /* If the current `size()` is greater than `new_size`, then destroy all but the first
             `new_size` elements. */
             for (size_t i = new_size; i < size(); ++i) {
@@ -110,13 +272,8 @@ struct StackAssistedVector {
             reserve(new_size);
 
             /* ...then append default-inserted elements until we have exactly `new_size` elements
-            in total. */
-            for (size_t i = size(); i < new_size; ++i) {
-                std::allocator_traits<Allocator>::construct(
-                    allocator,
-                    begin() + i
-                );
-            }
+            in total (zeroing them in bulk, for trivial types; see `value_construct_n`). */
+            value_construct_n(allocator, end(), new_size - size());
         }
 
         /* Finally, update `current_size` */
@@ -130,6 +287,7 @@ struct StackAssistedVector {
         /* Identical to the implementation of `resize(size_t new_size)`, except for the one
         difference marked below. See the comments there. */
         if (new_size < size()) {
+            peak_size_tracker.note(current_size);
             for (size_t i = new_size + 1; i < size(); ++i) {
                 std::allocator_traits<Allocator>::destroy(
                     allocator,
@@ -151,7 +309,53 @@ struct StackAssistedVector {
         current_size = new_size;
     }
 
-    /* Increases the capacity of this `StackAssistedVector` to at least `count` elements. */
+    /* Equivalent to `resize(new_size)`, except that the appended elements are default-initialized
+    rather than value-initialized; for trivially default-constructible types (such as `int` or
+    `char`), this means that they are left uninitialized, for the caller to overwrite. This saves
+    zeroing memory that is about to be written anyway (for instance, by a decoder). */
+    constexpr void resize_for_overwrite(size_type new_size) {
+        if (new_size < size()) {
+            peak_size_tracker.note(current_size);
+            for (size_t i = new_size; i < size(); ++i) {
+                std::allocator_traits<Allocator>::destroy(allocator, begin() + i);
+            }
+        } else if (new_size > size()) {
+            reserve(new_size);
+            default_construct_n(allocator, end(), new_size - size());
+        }
+
+        current_size = new_size;
+    }
+
+    /* Equivalent to `resize_for_overwrite(new_size)`. */
+    constexpr void resize_default_init(size_type new_size) { resize_for_overwrite(new_size); }
+
+    /* Resizes this `StackAssistedVector` by letting `operation` write the elements, like C++23's
+    `std::basic_string::resize_and_overwrite`. First, room is made for `new_size` elements, of
+    which the first `min(size(), new_size)` keep their values, and the rest are default-initialized
+    (so left uninitialized, for trivially default-constructible types). Then,
+    `operation(data, new_size)` is called with a pointer `data` to the first element; it may write
+    any of the `new_size` elements, and returns the number of elements to keep (at most
+    `new_size`), which becomes the new `size()`. This is meant for filling a buffer from a source
+    which may write fewer elements than requested, such as `read`:
+
+        buffer.resize_and_overwrite(n, [&](char *data, size_t count) {
+            return std::max<ssize_t>(read(fd, data, count), 0);
+        }); */
+    template <typename Operation>
+    requires std::invocable<Operation, T*, size_type>
+    constexpr void resize_and_overwrite(size_type new_size, Operation operation) {
+        if (new_size > size()) {
+            resize_for_overwrite(new_size);
+        }
+        auto kept = static_cast<size_type>(std::move(operation)(begin(), new_size));
+        assert(kept <= new_size);
+        resize_for_overwrite(kept);
+    }
+
+    /* Increases the capacity of this `StackAssistedVector` to at least `count` elements. Throws
+    `std::length_error` if `count` exceeds `max_size()`. (Every other way of setting the size or
+    the capacity, such as `resize` or the size constructors, reserves through here.) */
     constexpr void reserve(size_type new_capacity) {
 
         /* If the current capacity is already at least the requested capacity, return. */
@@ -159,21 +363,28 @@ struct StackAssistedVector {
             return;
         }
 
+        /* The `Layout` may store the capacity in fewer bits than a `size_t`, so it must never be
+        asked to record a capacity above `max_size()`. */
+        if (new_capacity > max_size()) {
+            throw std::length_error("StackAssistedVector: requested capacity exceeds max_size()");
+        }
+
+        /* If the elements are already on the heap, first try to grow the dynamic array without
+        moving the elements one by one (see `try_grow_heap_array_in_place`). */
+        if (on_heap() && try_grow_heap_array_in_place(new_capacity)) {
+            return;
+        }
+
         /* Otherwise, allocate a new dynamic array of size `n`... */
-        auto new_dynamic_array = std::allocator_traits<Allocator>::allocate(
-            allocator, new_capacity
-        );
+        auto new_heap_array = allocate_heap_array(new_capacity);
 
         /* ...move the currently-stored elements to that new dynamic array and destroy the
         original elements... */
-        move_from_then_destroy_range(begin(), current_size, new_dynamic_array);
-
-        /* ...then deallocate the original dynamic array, if we were using one. */
-        deallocate_dynamic_array();
+        move_from_then_destroy_range(begin(), current_size, new_heap_array);
 
-        /* Update `dynamic_array` and `current_dynamic_capacity` */
-        dynamic_array = new_dynamic_array;
-        current_dynamic_capacity = new_capacity;
+        /* ...then deallocate the original dynamic array (if we were using one), and record the new
+        dynamic array and its capacity. */
+        replace_heap_array(new_heap_array, new_capacity);
     }
 
     /* Requests the removal of unused capacity; that is, makes a NON-BINDING request to decrease
@@ -187,30 +398,30 @@ struct StackAssistedVector {
             return;
         } else if (current_size <= Capacity) {
             /* If the current size is at most the `StackCapacity` of this `StackAssistedVector`
-            and if elements are currently stored on the heap (that is, in `dynamic_array`), then
+            and if elements are currently stored on the heap (that is, in the dynamic array), then
             we will move those elements back to the `fixed_array` on the stack.
             
             If elements were already stored on the stack, then there is nothing to do; we always
             have to keep `fixed_array` around anyways. */
-            if (dynamic_array) {
+            if (on_heap()) {
 
-                /* First, save the value of `current_dynamic_capacity` in `dynamic_capacity`.
-                This is needed because it is in an `union` with `fixed_array`, which we write
-                to below (thus invalidating `current_dynamic_capacity`, which we need later). */
-                auto dynamic_capacity = current_dynamic_capacity;
+                /* First, save the dynamic array and its capacity. This is needed because
+                depending on the `Layout`, either or both of them may share memory with
+                `fixed_array`, which we write to below. */
+                auto old_heap_array = heap_array();
+                auto old_heap_capacity = heap_capacity();
 
-                /* Now, we move all currently-stored elements from `dynamic_array` back to
+                /* Now, we move all currently-stored elements from the dynamic array back to
                 `fixed_array`... */
-                move_from_then_destroy_range(dynamic_array, current_size, fixed_array);
+                set_on_stack();
+                move_from_then_destroy_range(old_heap_array, current_size, fixed_array);
+                record_deallocation(old_heap_capacity);
 
                 /* ...and then deallocate the dynamic array we were using. Note that we cannot use
-                `deallocate_dynamic_array` here, since that uses the `current_dynamic_capacity`
-                field, which was invalidated by the writes to `fixed_array` above (as `fixed_array`
-                and `current_dynamic_capacity` are members of the same `union`). */
-                std::allocator_traits<Allocator>::deallocate(dynamic_array, dynamic_capacity);
-
-                /* All elements are back on the stack, so we set `dynamic_array` to `nullptr`. */
-                dynamic_array = nullptr;
+                `deallocate_heap_array` here, since we are no longer `on_heap()`. */
+                std::allocator_traits<Allocator>::deallocate(
+                    allocator, old_heap_array, old_heap_capacity
+                );
             }
         } else {
             /* If the current size is smaller than the current capacity, but not small enough to fit
@@ -220,20 +431,20 @@ struct StackAssistedVector {
             assert(current_size < capacity());  /* Sanity check */
 
             /* First, allocate a new dynamic array with size equal to `current_size`... */
-            auto new_dynamic_array = std::allocator_traits<Allocator>::allocate(
+            auto new_heap_array = std::allocator_traits<Allocator>::allocate(
                 allocator, current_size
             );
+            record_allocation(current_size);
 
-            /* ...move the currently-stored elements from `dynamic_array` to `new_dynamic_array`
+            /* ...move the currently-stored elements from the dynamic array to `new_heap_array`
             and destroy the original elements... */
-            move_from_then_destroy_range(dynamic_array, current_size, new_dynamic_array);
+            move_from_then_destroy_range(heap_array(), current_size, new_heap_array);
             
             /* ...then deallocate the original dynamic array. */
-            deallocate_dynamic_array();
+            deallocate_heap_array();
 
-            /* Update `dynamic_array` and `current_dynamic_capacity` */
-            dynamic_array = new_dynamic_array;
-            current_dynamic_capacity = current_size;
+            /* Record the new dynamic array and its capacity */
+            set_heap_array(new_heap_array, current_size);
         }
     }
 
@@ -267,11 +478,13 @@ struct StackAssistedVector {
     template <typename... Ts>
     constexpr void emplace_back(Ts&&... args) {
 
-        /* If we have reached the current capacity, then increase the capacity using `reserve`.
-        This involves reallocation, and so invalidates all existing iterators to this
-        `StackAssistedVector`. By default, we always double the capacity when it is reached. */
+        /* If we have reached the current capacity, then the capacity must grow (which invalidates
+        all existing iterators to this `StackAssistedVector`). This is done by
+        `grow_and_emplace_back`, which keeps `args` valid even if they refer to elements of this
+        `StackAssistedVector`. */
         if (current_size == capacity()) {
-            reserve(2 * capacity());
+            grow_and_emplace_back(std::forward<Ts>(args)...);
+            return;
         }
 
         /* Construct the element in-place from `args` at the location one after the current end
@@ -286,43 +499,57 @@ struct StackAssistedVector {
 
     /* Appends a copy of the given element `element` to the end of this `StackAssistedVector`. */
     constexpr void push_back(const T &element) {
-
-        /* If we have reached the current capacity, then increase the capacity using `reserve`.
-        This involves reallocation, and so invalidates all existing iterators to this
-        `StackAssistedVector`. By default, we always double the capacity when it is reached. */
-        if (current_size == capacity()) {
-            reserve(2 * capacity());
-        }
-
-        /* Append a copy of `element` and increment `current_size` */
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            begin() + (current_size++),
-            element  /* Invokes the copy constructor of `T` */
-        );
+        /* Invokes the copy constructor of `T` */
+        emplace_back(element);
     }
 
     /* Moves and appends the given element `element` to the end of this `StackAssistedVector`. */
     constexpr void push_back(T&& element) {
+        /* Invokes the move constructor of `T` */
+        emplace_back(std::move(element));
+    }
 
-        /* If we have reached the current capacity, then increase the capacity using `reserve`.
-        This involves reallocation, and so invalidates all existing iterators to this
-        `StackAssistedVector`. By default, we always double the capacity when it is reached. */
-        if (current_size == capacity()) {
-            reserve(2 * capacity());
+    /* Appends the elements of `range` to the end of this `StackAssistedVector`, as C++23's
+    `std::vector::append_range` does. If the number of elements is known up front (that is, if
+    `range` is a forward or a sized range), then the capacity is checked and increased (by the
+    `GrowthPolicy`) only once, and the elements are then constructed in bulk; this is a single
+    `std::memcpy` if `T` is trivially copyable and `range` is contiguous (see
+    `bulk_construction.h`). Otherwise, the elements are appended one by one. `range` must not
+    overlap with this `StackAssistedVector`. */
+    template <container_compatible_range<T> R>
+    constexpr void append_range(R &&range) {
+        if constexpr (std::ranges::forward_range<R> || std::ranges::sized_range<R>) {
+            auto n = static_cast<size_type>(std::ranges::distance(range));
+            if (current_size + n > capacity()) {
+                reserve(grown_capacity(current_size + n));
+            }
+            construct_from_range(allocator, end(), std::ranges::begin(range), n);
+            current_size += n;
+        } else {
+            for (auto &&element : range) {
+                emplace_back(std::forward<decltype(element)>(element));
+            }
         }
+    }
 
-        /* Move and append `element`, and also increment `current_size` */
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            begin() + (current_size++),
-            std::move(element)  /* Invokes the move constructor of `T` */
-        );
+    /* Appends `n` default-initialized elements (which, for trivially default-constructible types,
+    are left uninitialized) to the end of this `StackAssistedVector`, checking the capacity only
+    once, and returns an iterator to the first of them, so that the caller may write the elements
+    in place. */
+    constexpr iterator append_n_uninitialized(size_type n) {
+        if (current_size + n > capacity()) {
+            reserve(grown_capacity(current_size + n));
+        }
+        auto first = end();
+        default_construct_n(allocator, first, n);
+        current_size += n;
+        return first;
     }
 
     /* Removes the last element of this `StackAssistedVector`. */
     constexpr void pop_back() {
         assert(!empty());
+        peak_size_tracker.note(current_size);
 
         /* Destroy the last element and decrement `current_size` */
         std::allocator_traits<Allocator>::destroy(
@@ -333,6 +560,7 @@ struct StackAssistedVector {
 
     /* Erases all elements from the container, after which `size()` will return zero. */
     constexpr void clear() {
+        peak_size_tracker.note(current_size);
 
         /* Destroy every element, then set `current_size` to 0. */
         auto begin_ptr = begin();
@@ -346,87 +574,134 @@ struct StackAssistedVector {
         current_size = 0;
     }
 
+    /* Exchanges the elements of this `StackAssistedVector` with those of `other`. If both sets of
+    elements are on the heap, then only the dynamic arrays are exchanged, in O(1). Otherwise, only
+    the elements on the stack are moved: if one side is on the heap, then the other side's elements
+    are relocated into its `fixed_array` before it takes over the dynamic array, and if both sides
+    are on the stack, then their first `min(size(), other.size())` elements are swapped in place,
+    and the rest are relocated (see `swap_ranges_relocating`). As with `std::vector`, the
+    allocators are swapped iff `propagate_on_container_swap` is true, and must be equal otherwise. */
     constexpr void swap(StackAssistedVector &other) {
-        static_assert(false, "Unimplemented, sorry!");
+        if (this == &other) {
+            return;
+        }
+        peak_size_tracker.note(current_size);
+        other.peak_size_tracker.note(other.current_size);
+
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(allocator, other.allocator);
+        } else {
+            assert(allocator == other.allocator);
+        }
+
+        if (on_heap() && other.on_heap()) {
+            auto array = heap_array();
+            auto array_capacity = heap_capacity();
+            set_heap_array(other.heap_array(), other.heap_capacity());
+            other.set_heap_array(array, array_capacity);
+        } else if (on_heap()) {
+            take_heap_array_from(*this, other);
+        } else if (other.on_heap()) {
+            take_heap_array_from(other, *this);
+        } else {
+            record_container_event<StackAssistedVector>(
+                &ContainerCounters::element_moves, current_size + other.current_size
+            );
+            swap_ranges_relocating(
+                allocator, fixed_array, current_size, other.fixed_array, other.current_size
+            );
+        }
+
+        std::swap(current_size, other.current_size);
+    }
+
+    /* Exchanges the elements of `a` and `b` (see `StackAssistedVector::swap`) */
+    friend constexpr void swap(StackAssistedVector &a, StackAssistedVector &b) {
+        a.swap(b);
     }
 
     /* Inserts a copy of `element` immediately before `position`. */
     constexpr iterator insert(const_iterator position, const T& element) {
-        /* `offset` = the distance between `begin()` and `position`. This is needed because after
-        the call to `reserve()` below, `begin()` may have changed, meaning that `position` may
-        no longer represent a valid iterator in this `StackAssistedVector`. However, we can always
-        find the position of insertion as `begin() + offset`. */
+        /* `offset` = the distance between `begin()` and `position`. This is needed because if the
+        capacity grows below, `begin()` may change, meaning that `position` may no longer
+        represent a valid iterator in this `StackAssistedVector`. However, we can always find the
+        position of insertion as `begin() + offset`. */
         auto offset = position - begin();
-
-        /* If we have reached the current capacity, then increase the capacity using `reserve`.
-        This involves reallocation, and so invalidates all existing iterators to this
-        `StackAssistedVector`. By default, we always double the capacity when it is reached. */
-        if (current_size == capacity()) {
-            reserve(2 * size());
+        auto aliased = is_element(element);
+
+        /* If we have reached the current capacity, and it cannot grow in place, then we move the
+        elements to a new dynamic array, constructing the copy of `element` there first (see
+        `grow_and_insert`). If `element` is one of the elements, then it must stay where it is
+        until it has been copied. */
+        if (!make_room_in_place(1, aliased)) {
+            grow_and_insert(offset, 1, [&](T *dest) {
+                std::allocator_traits<Allocator>::construct(allocator, dest, element);
+            });
+            return begin() + offset;
         }
 
-        /* First, we make space for the inserted element by shifting all elements after it one to
-        the right. To do this, we iterate backwards from `end()` to just after the position of
-        insertion, and move-construct each element into the next position. */
-        for (auto it = end(), insert_pos = begin() + offset; it != insert_pos; --it) {
-            /* Move-construct the element at `it` from the element stored at `it - 1`. */
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it,
-                std::move(*(it - 1))
-            );
+        /* Shifting the elements would move `element` if it is one of them, so we insert a copy of
+        it instead. */
+        if (aliased) {
+            T copy(element);
+            return insert(begin() + offset, std::move(copy));
         }
 
-        /* Finally, copy `element` to the position of insertion, which is given by
-        `begin() + offset`. */
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            begin() + offset,
-            element
-        );
+        /* Then, we make space for the inserted element by shifting all elements after it one to
+        the right (see `insert_erase.h`). This leaves either a moved-from element or uninitialized
+        storage at the position of insertion, so we then either copy-assign or copy-construct
+        `element` there. */
+        auto insert_pos = begin() + offset;
+        open_gap_at(offset, 1, [&](size_type live) {
+            if (live != 0) {
+                *insert_pos = element;
+            } else {
+                std::allocator_traits<Allocator>::construct(allocator, insert_pos, element);
+            }
+        });
 
         ++current_size;
 
         /* Return the position of insertion; that is, an iterator to the inserted element */
-        return begin() + offset;
+        return insert_pos;
     }
 
     /* Move-constructs an element from `element`, and inserts it immediately before `position`. */
     constexpr iterator insert(const_iterator position, T&& element) {
         /* Identical to the implementation of `insert(const_iterator, const T&)`, except that the
-        inserted element is now move-constructed (rather than copy-constructed) from `element`. */
+        inserted element is now moved (rather than copied) from `element`. */
 
         auto offset = position - begin();
 
-        if (current_size == capacity()) {
-            reserve(2 * size());
-        }
-
-        for (auto it = end(), insert_pos = begin() + offset; it != insert_pos; --it) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it,
-                std::move(*(it - 1))
-            );
+        if (!make_room_in_place(1, false)) {
+            grow_and_insert(offset, 1, [&](T *dest) {
+                std::allocator_traits<Allocator>::construct(allocator, dest, std::move(element));
+            });
+            return begin() + offset;
         }
 
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            begin() + offset,
-            std::move(element)  /* Move-construct the inserted element from the given `element`,
-                                   instead of copy-constructing it as before. */
-        );
+        auto insert_pos = begin() + offset;
+        open_gap_at(offset, 1, [&](size_type live) {
+            if (live != 0) {
+                *insert_pos = std::move(element);
+            } else {
+                std::allocator_traits<Allocator>::construct(
+                    allocator, insert_pos, std::move(element)
+                );
+            }
+        });
 
         ++current_size;
 
-        return begin() + offset;
+        return insert_pos;
     }
 
     /* Inserts `n` copies of `element` immediately before `position`. */
     constexpr iterator insert(const_iterator position, size_type n, const T& element) {
         /* Identical to the implementation of `insert(const_iterator, const T&)`, except that we
         now have to shift all elements after `position` by `n` to the right rather than by one,
-        and that we have to perform `n` copy-constructs of `element` instead of one. */
+        and that we have to write `n` copies of `element` instead of one. */
 
         auto offset = position - begin();
 
@@ -438,36 +713,30 @@ struct StackAssistedVector {
             return begin() + offset;
         }
 
-        if (current_size + n > capacity()) {
-
-            /* Always double the capacity */
-            auto new_capacity = capacity();
-            while (new_capacity < current_size + n) {
-                new_capacity *= 2;
-            }
-
-            reserve(new_capacity);
-        }
-
-        /* Make space for the `n` elements to be inserted by shifting all elements after the
-        position of insertion `n` to the right. */
-        auto insert_pos = begin() + offset;
-        for (auto it = end(); it != insert_pos; --it) {
-            /* Move-construct the element at `it + n - 1` from the element stored at `it - 1`. */
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it + n - 1,
-                std::move(*(it - 1))
-            );
+        /* If the `n` elements do not fit, then construct them in a new dynamic array and move the
+        other elements around them (see `grow_and_insert`). */
+        auto aliased = is_element(element);
+        if (!make_room_in_place(n, aliased)) {
+            grow_and_insert(offset, n, [&](T *dest) {
+                fill_gap_n(allocator, dest, 0, n, element);
+            });
+            return begin() + offset;
         }
 
-        /* Finally, write `n` copies of `element` starting from the position of insertion. */
-        for (size_type i = 0; i < n; ++i) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                insert_pos++,
-                element
-            );
+        /* Otherwise, make space for the `n` elements to be inserted by shifting all elements after
+        the position of insertion `n` to the right, and then write `n` copies of `element`
+        starting from the position of insertion (or of a copy of it, if shifting would move
+        it). */
+        auto fill = [&](const T &value) {
+            open_gap_at(offset, n, [&](size_type live) {
+                fill_gap_n(allocator, begin() + offset, live, n, value);
+            });
+        };
+        if (aliased) {
+            T copy(element);
+            fill(copy);
+        } else {
+            fill(element);
         }
 
         current_size += n;
@@ -483,92 +752,53 @@ struct StackAssistedVector {
     the minimal check needed to conform to the standard. */
     requires (!std::is_integral_v<InputIt>)
     constexpr iterator insert(const_iterator position, InputIt first, InputIt last) {
-        /* Identical to the implementation of `insert(const_iterator, size_type n, const T&)`,
-        except that `n` is now given by `std::distance(first, last)`, and that the elements
-        to be inserted are now given by dereferencing iterators in the range `[first, last)`. */
+        /* If `InputIt` is at least a forward iterator, then the number of elements to insert can
+        be computed up front with `std::distance`, and the elements are inserted in bulk (see
+        `insert_counted`). A single-pass iterator would be consumed by `std::distance`, so its
+        elements are appended one by one instead, and then rotated into place. */
         auto offset = position - begin();
-
-        if (first == last) {
-            /* Note that we cannot just `return position`, because `position` is a `const_iterator`
-            and not an `iterator`. We can obtain an equivalent `iterator` as `begin() + offset`,
-            however. */
-            return begin() + offset;
-        }
-
-        /* Compute `n`, the number of elements we will be inserting */
-        auto n = std::distance(first, last);
-
-        if (current_size + n > capacity()) {
-            auto new_capacity = capacity();
-            while (new_capacity < current_size + n) {
-                new_capacity *= 2;
+        if constexpr (std::forward_iterator<InputIt>) {
+            insert_counted(offset, first, static_cast<size_type>(std::distance(first, last)));
+        } else {
+            auto old_size = current_size;
+            for (; first != last; ++first) {
+                emplace_back(*first);
             }
-
-            reserve(new_capacity);
-        }
-
-        auto insert_pos = begin() + offset;
-        for (auto it = end(); it != insert_pos; --it) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                it + n - 1,
-                std::move(*(it - 1))
-            );
+            std::rotate(begin() + offset, begin() + old_size, end());
         }
+        return begin() + offset;
+    }
 
-        /* Finally, write the `n` elements in the range `[first, last)` to the range starting
-        from the position of insertion. */
-        for (size_type i = 0; i < n; ++i) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                insert_pos++,
-                *(first++)
+    /* Inserts the elements of `range` immediately before `position`, as C++23's
+    `std::vector::insert_range` does, and returns an iterator to the first inserted element. As in
+    `append_range`, if the number of elements is known up front, then the capacity is checked only
+    once, and the elements are constructed in bulk. `range` must not overlap with this
+    `StackAssistedVector`. */
+    template <container_compatible_range<T> R>
+    constexpr iterator insert_range(const_iterator position, R &&range) {
+        auto offset = position - begin();
+        if constexpr (std::ranges::forward_range<R> || std::ranges::sized_range<R>) {
+            insert_counted(
+                offset, std::ranges::begin(range),
+                static_cast<size_type>(std::ranges::distance(range))
             );
+        } else {
+            auto old_size = current_size;
+            append_range(std::forward<R>(range));
+            std::rotate(begin() + offset, begin() + old_size, end());
         }
-
-        current_size += n;
-
-        /* Return the position of the first element inserted. */
         return begin() + offset;
     }
 
     /* Removes the element at `position` from this `StackAssistedVector`. */
     constexpr iterator erase(const_iterator position) {
         assert(position != end());
-
-        /* `position` is a `const_iterator`, so we cannot use it for the mutation we need to
-        perform. Thus, we compute `pos`, which is the non-`const` equivalent of `position`. */
-        iterator pos = begin() + (position - begin());
-
-        /* First, we delete the element at `position` by shifting all elements after it one to
-        the left. To do this, we iterate forwards from the position of insertion to just before
-        `end() - 1`, and move-assign each element to the next element. */
-        while (pos != (end() - 1)) {
-            /* Move-assign the element at `pos` to the element at `pos + 1`. */
-            *pos = std::move(*(pos + 1));
-            ++pos;
-        }
-
-        /* This leaves us with an extra moved-from element at the position `end() - 1`, which
-        we now destroy. */
-        std::allocator_traits<Allocator>::destroy(
-            allocator,
-            pos  /* `pos` will always equal `end() - 1` after the above loop terminates */
-        );
-        
-        --current_size;
-
-        /* Return the iterator to the position immediately following the removed element. This is
-        given by the iterator that is the same distance away from `begin()` as the position of the
-        original, now-removed element was. */
-        return begin() + (position - begin());
+        return erase(position, position + 1);
     }
 
     /* Removes the element(s) in the range `[first, last)` from this `StackAssistedVector`. */
     constexpr iterator erase(const_iterator first, const_iterator last) {
-        /* Identical to the implementation of `erase(const_iterator)`, except that we now have to
-        shift all elements after `last` by `n` to the left instead of one, where `n` is the number
-        of elements in the range `[first, last)`. */
+        peak_size_tracker.note(current_size);
 
         /* Non-const equivalent of `first`, needed for mutation */
         auto pos = begin() + (first - begin());
@@ -580,31 +810,22 @@ struct StackAssistedVector {
         /* Compute `n`, the number of elements we will be erasing. There is no need to use
         `std::distance` here, as both `first` and `last` are assumed to be iterators into
         this `StackAssistedVector`. */
-        auto n = last - first;
+        auto n = static_cast<size_type>(last - first);
 
         /* Delete the range `[first, last)` by shifting all elements in `[last, end())` `n` to
-        the left. */
-        while (pos != (end() - n)) {
-            /* Move-assign the element at `pos` to the element at `pos + n`. */
-            *pos = std::move(*(pos + n));
-            ++pos;
-        }
-
-        /* This leaves us with `n` extra moved-from elements starting from `end() - n`, which
-        we now destroy. */
-        while (pos != end()) {
-            std::allocator_traits<Allocator>::destroy(
-                allocator,
-                pos++
-            );
-        }
+        the left, and destroying the `n` elements left over at the end. If `T` is trivially
+        relocatable, the erased elements are destroyed first, and the shift is a single
+        `std::memmove` instead (see `insert_erase.h`). */
+        record_container_event<StackAssistedVector>(
+            &ContainerCounters::element_moves, end() - (pos + n)
+        );
+        close_gap(allocator, pos, end(), n);
 
         current_size -= n;
 
-        /* Return the iterator to the position immediately following the last removed element. This
-        is given by the iterator that is the same distance away from `begin()` as the position of
-        the last removed element was. */
-        return begin() + (first - begin());
+        /* Return the iterator to the position immediately following the last removed element,
+        which now sits where the first removed element was. */
+        return pos;
     }
 
     /* --- CONSTRUCTORS --- */
@@ -647,48 +868,54 @@ struct StackAssistedVector {
     requires (!std::is_integral_v<InputIt>)
     constexpr StackAssistedVector(InputIt first, InputIt last, const Allocator &allocator_ = {})
     : allocator{allocator_} {
-        size_type initial_size(std::distance(first, last));
-        reserve(initial_size);
-
-        current_size = initial_size;
-        for (size_type i = 0; i < current_size; ++i) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                begin() + i,
-                *(first++)
-            );
+        /* Reserve exactly as much as needed (if that is known up front), rather than letting
+        `insert` choose a capacity with the `GrowthPolicy` */
+        if constexpr (std::forward_iterator<InputIt>) {
+            reserve(static_cast<size_type>(std::distance(first, last)));
         }
-
+        insert(end(), first, last);
     }
 
-    /* Copy constructor */
+#if defined(__cpp_lib_containers_ranges)
+    /* Constructs a `StackAssistedVector` with the elements of `range` (this is the constructor
+    that C++23's `std::ranges::to` uses). */
+    template <container_compatible_range<T> R>
+    constexpr StackAssistedVector(std::from_range_t, R &&range, const Allocator &allocator_ = {})
+    : allocator{allocator_} {
+        append_range(std::forward<R>(range));
+    }
+#endif
+
+    /* Copy constructor. As with `std::vector`, the copy's allocator is given by
+    `select_on_container_copy_construction`, which for stateful allocators (such as
+    `ArenaAllocator`) is usually a copy of `other`'s allocator. */
+    constexpr StackAssistedVector(const StackAssistedVector &other)
+    : StackAssistedVector(
+        other,
+        std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)
+    ) {}
+
+    /* Copy constructor, using the allocator `allocator_` */
     constexpr StackAssistedVector(
-        const StackAssistedVector &other, const Allocator &allocator_ = {}
+        const StackAssistedVector &other, const Allocator &allocator_
     ) : allocator{allocator_} {
         reserve(other.size());
-
+        construct_from_range(allocator, begin(), other.begin(), other.size());
         current_size = other.size();
-        for (size_type i = 0; i < current_size; ++i) {
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                begin() + i,
-                other[i]
-            );
-        }
     }
 
     /* Move constructor */
     constexpr StackAssistedVector(StackAssistedVector &&other)
-    : dynamic_array{other.dynamic_array},
-      current_size{other.current_size},
-      allocator{other.allocator}
+    : allocator{other.allocator}
     {
-        if (dynamic_array) {
-            current_dynamic_capacity = other.current_dynamic_capacity;
+        current_size = other.current_size;
+        if (other.on_heap()) {
+            set_heap_array(other.heap_array(), other.heap_capacity());
 
-            /* The responsibility for cleaning up `dynamic_array` is now transferred to us */
+            /* The responsibility for cleaning up the dynamic array is now transferred to us */
+            other.peak_size_tracker.note(other.current_size);
             other.current_size = 0;  /* Prevent double-destructor calls for elements */
-            other.dynamic_array = nullptr;  /* Prevent double-free of `dynamic_array` */
+            other.set_on_stack();  /* Prevent double-free of the dynamic array */
         } else {
             for (size_type i = 0; i < current_size; ++i) {
                 std::allocator_traits<Allocator>::construct(
@@ -705,54 +932,114 @@ struct StackAssistedVector {
     : StackAssistedVector(init.begin(), init.end(), allocator_)
     {}
 
+    /* --- ASSIGNMENT OPERATORS --- */
+
+    /* Copy assignment operator. The elements of `other` are assigned over the existing elements,
+    and then constructed in the existing capacity (see `assign_from_range`), so that nothing is
+    allocated unless `other.size()` exceeds `capacity()`; in that case, the elements are destroyed,
+    and a dynamic array of exactly `other.size()` elements replaces the current one. As with
+    `std::vector`, `other`'s allocator is copied iff `propagate_on_container_copy_assignment` is
+    true. */
+    constexpr StackAssistedVector& operator= (const StackAssistedVector &other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
+            /* Our dynamic array must be freed by the allocator that allocated it */
+            if (allocator != other.allocator) {
+                release_storage();
+            }
+            allocator = other.allocator;
+        }
+
+        assign_elements(other.begin(), other.size());
+        return *this;
+    }
+
+    /* Move assignment operator. If `other`'s elements are on the heap, and its dynamic array may
+    be freed by our allocator (that is, if the allocators are equal, or if
+    `propagate_on_container_move_assignment` is true, in which case `other`'s allocator is moved
+    too), then our elements and dynamic array are released, and we take over `other`'s dynamic
+    array in O(1), leaving `other` empty. Otherwise, `other`'s elements are moved over ours, reusing
+    our capacity as the copy assignment operator does. */
+    constexpr StackAssistedVector& operator= (StackAssistedVector &&other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        constexpr bool propagate =
+            std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value;
+        if (other.on_heap() && (propagate || allocator == other.allocator)) {
+            release_storage();
+            if constexpr (propagate) {
+                allocator = std::move(other.allocator);
+            }
+            set_heap_array(other.heap_array(), other.heap_capacity());
+            current_size = other.current_size;
+
+            /* The responsibility for cleaning up the dynamic array is now transferred to us */
+            other.peak_size_tracker.note(other.current_size);
+            other.current_size = 0;
+            other.set_on_stack();
+            return *this;
+        }
+
+        if constexpr (propagate) {
+            if (allocator != other.allocator) {
+                release_storage();
+            }
+            /* `other` still needs its allocator to destroy its (moved-from) elements */
+            allocator = other.allocator;
+        }
+
+        /* Moving a trivially copyable element is copying it, which may be done in bulk */
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            assign_elements(other.begin(), other.size());
+        } else {
+            assign_elements(std::make_move_iterator(other.begin()), other.size());
+        }
+        return *this;
+    }
+
+    /* Replaces the elements with those of `init` */
+    constexpr StackAssistedVector& operator= (std::initializer_list<T> init) {
+        assign_elements(init.begin(), init.size());
+        return *this;
+    }
+
     /* Destructor */
     ~StackAssistedVector() {
-        /* Call the destructor on every element in this `StackAssistedVector`... */
+        /* Record the largest size we reached, if capacity profiling is enabled... */
+        peak_size_tracker.template finish<StackAssistedVector>(current_size, Capacity, sizeof(T));
+
+        /* ...call the destructor on every element in this `StackAssistedVector`... */
         clear();
 
         /* ...then deallocate the dynamic array itself, if we were using one */
-        deallocate_dynamic_array();
+        deallocate_heap_array();
     }
 
 private:
 
-    /* If elements are being stored on the heap, then they will reside in `dynamic_array`.
-    Otherwise, if elements are being stored on the stack, then `dynamic_array` will be set to
-    `nullptr` and the elements will reside in `fixed_array` (defined below). Whether or not
-    `dynamic_array` is `nullptr` serves as the discriminator for which of the two union members
-    below is the active one. */
-    T *dynamic_array = nullptr;
-
-    union {
-        /* `fixed_array` stores at most `StackCapacity` elements of type `T` on the stack; if
-        elements are being kept on the stack, then they will always reside in `fixed_array`.
-        Now, the reason that `fixed_array` is kept in an union (besides having it share the
-        same memory as `current_dynamic_capacity` and hence save storage) is because whenever
-        something is put inside an `union`, it is not automatically initialized. If `fixed_array`
-        was made a regular member of `StackAssistedVector`, then initializing `StackAssistedVector`
-        would also initialize `fixed_array`, which would always result in `StackCapacity` calls to
-        the default constructor of `T`. Instead, by having `fixed_array` reside within an `union`,
-        its elements are not automatically default-constructed; not only does this save the overhead
-        of `StackCapacity` calls to `T::T()`, but it also allows for the type `T` to be not
-        default-constructible, giving `StackCapacity` an ability that `std::array` does not
-        have. Choosing to not initialize the elements of `fixed_array` by default, however,
-        means that we must use placement-new and placement-delete to eventually construct the
-        elements, in order to abide by C++'s object lifetime rules. */
-        T fixed_array[Capacity];
-
-        /* When `dynamic_array` is not `nullptr`, `current_dynamic_capacity` represents the
-        current size of `dynamic_array`, which is equivalent to the current capacity we have
-        for storing elements on the heap. Storing this in an union along with `fixed_array`
-        saves storage. */
-        size_type current_dynamic_capacity = 0;
-    };
-
-    /* `current_size` = The current number of elements stored within this `StackAssistedVector`. */
-    size_type current_size = 0;
+    /* The bookkeeping fields (`fixed_array`, `current_size`, and the dynamic array along with its
+    capacity) live in the `Layout`'s storage, which we inherit from. */
+    using Storage::fixed_array;
+    using Storage::current_size;
+    using Storage::on_heap;
+    using Storage::heap_array;
+    using Storage::heap_capacity;
+    using Storage::set_heap_array;
+    using Storage::set_on_stack;
 
     /* `allocator` = An instance of type `Allocator`, used to allocate/construct/destroy/deallocate
-    elements. */
-    Allocator allocator;
+    elements. It takes up no space if `Allocator` is stateless. */
+    [[no_unique_address]] Allocator allocator;
+
+    /* `peak_size_tracker` = The largest size this `StackAssistedVector` reached, which is only
+    tracked (and only takes up space) if `CPP_CONTAINERS_CAPACITY_PROFILING` is enabled. See
+    `capacity_profile.h`. */
+    [[no_unique_address]] PeakSizeTracker peak_size_tracker;
 
     /* Throws `std::out_of_range` if `index` is out of bounds for this `StackAssistedVector`. */
     constexpr void check_if_out_of_bounds(size_type index) {
@@ -766,48 +1053,314 @@ private:
         }
     }
 
+    /* Returns the capacity to grow to when at least `required_capacity` elements must fit, as
+    chosen by the `GrowthPolicy`. The result is always at least `required_capacity`, and is capped
+    at `max_size()`. Throws `std::length_error` if `required_capacity` exceeds `max_size()`. */
+    constexpr size_type grown_capacity(size_type required_capacity) const {
+        if (required_capacity > max_size()) {
+            throw std::length_error("StackAssistedVector: required capacity exceeds max_size()");
+        }
+
+        size_type new_capacity = GrowthPolicy::next_capacity(capacity(), required_capacity, sizeof(T));
+        return std::clamp(new_capacity, required_capacity, max_size());
+    }
+
+    /* Attempts to grow the dynamic array to `new_capacity` elements without allocating a separate
+    buffer and moving the elements across, returning true on success. This is possible if:
+    - `Allocator` provides `expand`, which grows the buffer in place; or, if
+    - `Allocator` provides `reallocate` (e.g. `MallocAllocator`, which uses `realloc`/`mremap`) and
+    `T` is trivially relocatable, so that the elements may be carried over as raw bytes. As this
+    may change the addresses of the elements, it is only tried if `allow_reallocate` is true.
+    On failure, nothing is changed. Assumes that the elements are `on_heap()`. */
+    constexpr bool try_grow_heap_array_in_place(size_type new_capacity, bool allow_reallocate = true) {
+        if (std::is_constant_evaluated()) {
+            return false;
+        }
+
+        if constexpr (allocator_has_expand<Allocator>) {
+            if (allocator.expand(heap_array(), heap_capacity(), new_capacity)) {
+                record_reallocation_in_place(new_capacity);
+                set_heap_array(heap_array(), new_capacity);
+                return true;
+            }
+        }
+
+        if constexpr (allocator_has_reallocate<Allocator> && uses_trivial_relocation_v<T, Allocator>) {
+            if (!allow_reallocate) {
+                return false;
+            }
+            if (auto p = allocator.reallocate(heap_array(), heap_capacity(), new_capacity)) {
+                record_reallocation_in_place(new_capacity);
+                set_heap_array(p, new_capacity);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /* Destroys every element and deallocates the dynamic array (if we are using one), leaving this
+    `StackAssistedVector` empty, with its capacity back to `StackCapacity`. */
+    constexpr void release_storage() {
+        clear();
+        deallocate_heap_array();
+        set_on_stack();
+    }
+
+    /* Replaces the elements with the `n` elements starting at `first`, reusing the existing
+    elements and capacity if possible (see `assign_from_range`). If the capacity does not suffice,
+    then the elements are destroyed first, and then exactly `n` elements are reserved. */
+    template <typename It>
+    constexpr void assign_elements(It first, size_type n) {
+        peak_size_tracker.note(current_size);
+        if (n > capacity()) {
+            clear();
+            reserve(n);
+        }
+        assign_from_range(allocator, begin(), current_size, first, n);
+        current_size = n;
+    }
+
+    /* Used by `swap` when only `heap_side`'s elements are on the heap: relocates `inline_side`'s
+    elements into the `fixed_array` of `heap_side`, which then hands its dynamic array over to
+    `inline_side`. Does not update the sizes. */
+    static constexpr void take_heap_array_from(
+        StackAssistedVector &heap_side, StackAssistedVector &inline_side
+    ) {
+        /* Save the dynamic array first, as it may share its memory with `fixed_array` */
+        auto array = heap_side.heap_array();
+        auto array_capacity = heap_side.heap_capacity();
+        heap_side.set_on_stack();
+        inline_side.move_from_then_destroy_range(
+            inline_side.fixed_array, inline_side.current_size, heap_side.fixed_array
+        );
+        inline_side.set_heap_array(array, array_capacity);
+    }
+
+    /* Returns true iff there is room for `n` more elements after growing the capacity (by the
+    `GrowthPolicy`) without moving the elements one by one, if needed (see
+    `try_grow_heap_array_in_place`). If `keep_addresses` is true, then the elements must also stay
+    at their current addresses (for instance, because the caller is about to copy one of them).
+    If this returns false, then nothing is changed, and the caller should use `grow_and_insert`. */
+    constexpr bool make_room_in_place(size_type n, bool keep_addresses) {
+        if (current_size + n <= capacity()) {
+            return true;
+        }
+        return on_heap() &&
+               try_grow_heap_array_in_place(grown_capacity(current_size + n), !keep_addresses);
+    }
+
+    /* Inserts `n` new elements at `begin() + offset` by moving all elements to a new dynamic array
+    (with the capacity chosen by the `GrowthPolicy`), in one pass: first, `construct_new(dest)`
+    constructs the `n` new elements in uninitialized storage at `dest`, their final position in the
+    new dynamic array; then the elements before and after the position of insertion are moved
+    around them. This moves every existing element once, rather than once by `reserve` and then
+    once more to open the gap, and as the existing elements are still in place while the new ones
+    are constructed, `construct_new` may safely read them. If `construct_new` throws (having
+    destroyed any elements it constructed), then nothing is changed. Updates `current_size`. */
+    template <typename ConstructNew>
+    constexpr void grow_and_insert(size_type offset, size_type n, ConstructNew construct_new) {
+        auto new_capacity = grown_capacity(current_size + n);
+        auto new_heap_array = std::allocator_traits<Allocator>::allocate(allocator, new_capacity);
+        try {
+            construct_new(new_heap_array + offset);
+        } catch (...) {
+            std::allocator_traits<Allocator>::deallocate(allocator, new_heap_array, new_capacity);
+            throw;
+        }
+        record_allocation(new_capacity);
+        record_growth();
+
+        move_from_then_destroy_range(begin(), offset, new_heap_array);
+        move_from_then_destroy_range(
+            begin() + offset, current_size - offset, new_heap_array + offset + n
+        );
+        replace_heap_array(new_heap_array, new_capacity);
+        current_size += n;
+    }
+
+    /* Appends an element constructed from `args` when there is no room for it, keeping `args`
+    valid even if they refer to elements of this `StackAssistedVector`: the capacity grows through
+    `expand` (which keeps the elements in place), or else the element is constructed directly in
+    the new dynamic array by `grow_and_insert`. If `Allocator` provides `reallocate` (which may move
+    the elements) and `T` is trivially relocatable, the element is instead constructed on the side
+    first, and then moved into place once the capacity has grown. */
+    template <typename... Ts>
+    constexpr void grow_and_emplace_back(Ts&&... args) {
+        if constexpr (allocator_has_reallocate<Allocator> && uses_trivial_relocation_v<T, Allocator>) {
+            if (on_heap() && !std::is_constant_evaluated()) {
+                T element(std::forward<Ts>(args)...);
+                if (make_room_in_place(1, false)) {
+                    std::allocator_traits<Allocator>::construct(
+                        allocator, begin() + (current_size++), std::move(element)
+                    );
+                } else {
+                    grow_and_insert(current_size, 1, [&](T *dest) {
+                        std::allocator_traits<Allocator>::construct(allocator, dest, std::move(element));
+                    });
+                }
+                return;
+            }
+        }
+
+        if (make_room_in_place(1, true)) {
+            std::allocator_traits<Allocator>::construct(
+                allocator, begin() + (current_size++), std::forward<Ts>(args)...
+            );
+            return;
+        }
+        grow_and_insert(current_size, 1, [&](T *dest) {
+            std::allocator_traits<Allocator>::construct(allocator, dest, std::forward<Ts>(args)...);
+        });
+    }
+
+    /* Allocates a dynamic array of `new_capacity` elements, for the elements to be moved to */
+    constexpr T* allocate_heap_array(size_type new_capacity) {
+        auto new_heap_array = std::allocator_traits<Allocator>::allocate(allocator, new_capacity);
+        record_allocation(new_capacity);
+        record_growth();
+        return new_heap_array;
+    }
+
+    /* Deallocates the dynamic array (if we are using one), and records that the elements, which
+    the caller has moved, are now stored in `new_heap_array`, of capacity `new_capacity` */
+    constexpr void replace_heap_array(T *new_heap_array, size_type new_capacity) {
+        deallocate_heap_array();
+        set_heap_array(new_heap_array, new_capacity);
+    }
+
     /* Move-constructs exactly `count` elements at `dest` from the `count` elements starting at
-    `source`. Afterwards, destroys the original elements in the `source` range. */ 
+    `source`. Afterwards, destroys the original elements in the `source` range. If `T` is
+    trivially relocatable, this is done with a single `std::memcpy` (see `relocation.h`). */
     constexpr void move_from_then_destroy_range(
         iterator source, size_t count,
         iterator dest
     ) {
-        /* Iterate over the elements to be moved */
-        for (size_t i = 0; i < count; ++i) {
-            /* Move the current element from `source` to `dest`; move `source[i]` to `dest + i` */
-            std::allocator_traits<Allocator>::construct(
-                allocator,
-                dest + i,
-                std::move(source[i])
-            );
+        record_container_event<StackAssistedVector>(&ContainerCounters::element_moves, count);
+        relocate_range(allocator, source, count, dest);
+    }
 
-            /* Destroy the moved-from element at `source + i` */
-            std::allocator_traits<Allocator>::destroy(
-                allocator,
-                source + i
-            );
+    /* Returns true iff `element` is one of the elements of this `StackAssistedVector`, which
+    growing or shifting them would move. Pointers into different objects cannot be compared in a
+    constant evaluation, so there this conservatively returns true. */
+    constexpr bool is_element(const T &element) const {
+        if (std::is_constant_evaluated()) {
+            return true;
+        }
+        std::less<const T*> less;
+        return !less(std::addressof(element), begin()) && less(std::addressof(element), end());
+    }
+
+    /* Shifts the elements in `[begin() + offset, end())` exactly `n` positions to the right with
+    `open_gap`, and then calls `fill(live)`, where `live` is how many of the `n` positions starting
+    from `begin() + offset` still hold (moved-from) elements, which `fill` must assign to rather
+    than construct into. If `fill` throws, the elements are shifted back (see `open_and_fill_gap`).
+    Assumes that `capacity()` is at least `size() + n`, and does not update `current_size`. */
+    template <typename Fill>
+    constexpr void open_gap_at(size_type offset, size_type n, Fill fill) {
+        auto insert_pos = begin() + offset;
+        record_container_event<StackAssistedVector>(
+            &ContainerCounters::element_moves, end() - insert_pos
+        );
+        open_and_fill_gap(allocator, insert_pos, end(), n, std::move(fill));
+    }
+
+    /* Inserts the `n` elements starting at `first` at `begin() + offset`. If they do not fit,
+    then the capacity is increased (by the `GrowthPolicy`) once, and the new elements are
+    constructed in bulk (see `construct_from_range`) in the new dynamic array, around which the
+    other elements are then moved (see `grow_and_insert`). Otherwise, the tail is shifted right by
+    `n`, and the new elements are assigned or constructed (see `fill_gap`). */
+    template <typename It>
+    constexpr void insert_counted(size_type offset, It first, size_type n) {
+        if (n == 0) {
+            return;
+        }
+
+        if (!make_room_in_place(n, false)) {
+            grow_and_insert(offset, n, [&](T *dest) {
+                construct_from_range(allocator, dest, first, n);
+            });
+            return;
         }
+
+        open_gap_at(offset, n, [&](size_type live) {
+            fill_gap(allocator, begin() + offset, live, n, first);
+        });
+        current_size += n;
     }
 
-    /* Deallocates `dynamic_array` via `std::allocator_traits` if it is not `nullptr`. */
-    constexpr void deallocate_dynamic_array() {
-        if (dynamic_array) {
+    /* Deallocates the dynamic array via `std::allocator_traits` if we are using one. */
+    constexpr void deallocate_heap_array() {
+        if (on_heap()) {
+            record_deallocation(heap_capacity());
             std::allocator_traits<Allocator>::deallocate(
                 allocator,
-                dynamic_array,
-                current_dynamic_capacity  /* = size of `dynamic_array` */
+                heap_array(),
+                heap_capacity()  /* = size of the dynamic array */
             );
         }
     }
+
+    /* The functions below record events in the `ContainerCounters` of this type, if
+    `CPP_CONTAINERS_INSTRUMENTATION` is enabled (see `container_counters.h`). */
+
+    /* Records the allocation of a dynamic array of `n` elements */
+    constexpr void record_allocation(size_type n) {
+        record_container_event<StackAssistedVector>(&ContainerCounters::allocations);
+        record_container_event<StackAssistedVector>(
+            &ContainerCounters::bytes_allocated, n * sizeof(T)
+        );
+    }
+
+    /* Records that the elements are moving to a new dynamic array: a reallocation if they are
+    already on the heap, or a spill if they are on the stack */
+    constexpr void record_growth() {
+        record_container_event<StackAssistedVector>(
+            (on_heap() ? &ContainerCounters::reallocations : &ContainerCounters::spills)
+        );
+        if (!on_heap()) {
+            peak_size_tracker.template spill<StackAssistedVector>(Capacity, sizeof(T));
+        }
+    }
+
+    /* Records the deallocation of a dynamic array of `n` elements */
+    constexpr void record_deallocation(size_type n) {
+        record_container_event<StackAssistedVector>(&ContainerCounters::deallocations);
+        record_container_event<StackAssistedVector>(
+            &ContainerCounters::bytes_deallocated, n * sizeof(T)
+        );
+    }
+
+    /* Records that the dynamic array grew (without an element-by-element move) to `new_capacity`
+    elements. This counts as a reallocation, but not as an allocation or a deallocation. */
+    constexpr void record_reallocation_in_place(size_type new_capacity) {
+        record_container_event<StackAssistedVector>(&ContainerCounters::reallocations);
+        record_container_event<StackAssistedVector>(
+            &ContainerCounters::bytes_deallocated, heap_capacity() * sizeof(T)
+        );
+        record_container_event<StackAssistedVector>(
+            &ContainerCounters::bytes_allocated, new_capacity * sizeof(T)
+        );
+    }
 };
 
-/* Specialize `std::formatter` for `StackAssistedVector<T, StackCapacity, Allocator>` */
-template <typename T, size_t StackCapacity, typename Allocator>
-struct std::formatter<StackAssistedVector<T, StackCapacity, Allocator>>
+/* `CompactStackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy>` is a
+`StackAssistedVector` using `CompactSAVLayout<uint32_t>`; see the comment on `CompactSAVLayout`. */
+template <
+    typename T, size_t StackCapacity, typename Allocator = std::allocator<T>,
+    growth_policy GrowthPolicy = DoublingGrowth
+>
+using CompactStackAssistedVector =
+    StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy, CompactSAVLayout<uint32_t>>;
+
+/* Specialize `std::formatter` for `StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy,
+Layout>` */
+template <typename T, size_t StackCapacity, typename Allocator, typename GrowthPolicy, typename Layout>
+struct std::formatter<StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy, Layout>>
 : public std::formatter<std::string>
 {
     auto format(
-        const StackAssistedVector<T, StackCapacity, Allocator> &v,
+        const StackAssistedVector<T, StackCapacity, Allocator, GrowthPolicy, Layout> &v,
         std::format_context &format_context
     ) const {
         auto output = format_context.out();
@@ -1,9 +1,43 @@
+/* The tests check the per-container counters too, so enable them before any container header */
+#define CPP_CONTAINERS_INSTRUMENTATION 1
+
 #include "vector_variations/stack_assisted_vector.h"
 #include "vector_variations/fixed_capacity_vector.h"
 #include "vector_variations/bounds_checked_vector.h"
+#include "vector_variations/relocation.h"
+#include "vector_variations/soa_vector.h"
+#include "vector_variations/segmented_vector.h"
+#include "vector_variations/concurrent_segmented_vector.h"
+#include "queues/fixed_capacity_ring_buffer.h"
+#include "queues/spsc_queue.h"
+#include "queues/mpmc_queue.h"
+#include "maps/small_flat_map.h"
+#include "maps/small_swiss_map.h"
+#include "strings/small_string.h"
+#include "allocators/malloc_allocator.h"
+#include "allocators/monotonic_arena.h"
+#include "allocators/pool_allocator.h"
+#include "allocators/memory_resource_adapter.h"
+#include "allocators/counting_allocator.h"
+#include "allocators/default_init_allocator.h"
+#include "instrumentation/container_counters.h"
+#include "instrumentation/capacity_profile.h"
 #include <iostream>
 #include <format>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <ranges>
+#include <set>
+#include <span>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 
 using namespace std::literals;
 
@@ -89,6 +123,64 @@ struct std::formatter<NonDefaultConstructibleClass> : public std::formatter<std:
     }
 };
 
+/* `RelocatableNonDefaultConstructibleClass` is identical to `NonDefaultConstructibleClass`, except
+that it opts in to `is_trivially_relocatable` (it only owns a raw pointer, so copying its bytes is
+a valid way to move it). Containers of it therefore take the `memcpy`/`memmove` relocation paths. */
+struct RelocatableNonDefaultConstructibleClass : NonDefaultConstructibleClass {
+    using NonDefaultConstructibleClass::NonDefaultConstructibleClass;
+};
+
+template <>
+struct is_trivially_relocatable<RelocatableNonDefaultConstructibleClass> : std::true_type {};
+
+/* `LiveCounted` keeps count of its live instances in `LiveCounted::live`, so that tests can check
+that a container destroys every element it constructs, and never constructs an element on top of
+a live one (which ASan cannot see for types whose moved-from state owns no memory, such as
+`NonDefaultConstructibleClass`). A moved-from `LiveCounted` holds the value -1. */
+struct LiveCounted {
+    static inline int64_t live = 0;
+
+    /* If non-negative, the number of copies (constructions or assignments) to allow before the
+    next one throws `std::runtime_error` */
+    static inline int64_t copies_until_throw = -1;
+
+    int value;
+
+    LiveCounted(int value_) : value{value_} { ++live; }
+    LiveCounted(const LiveCounted &other) : value{other.value} {
+        count_copy();
+        ++live;
+    }
+    LiveCounted(LiveCounted &&other) noexcept : value{std::exchange(other.value, -1)} { ++live; }
+    LiveCounted& operator= (const LiveCounted &other) {
+        count_copy();
+        value = other.value;
+        return *this;
+    }
+    LiveCounted& operator= (LiveCounted &&other) noexcept {
+        value = std::exchange(other.value, -1);
+        return *this;
+    }
+    ~LiveCounted() { --live; }
+
+    bool operator== (int other) const { return value == other; }
+
+    static void count_copy() {
+        if (copies_until_throw >= 0 && copies_until_throw-- == 0) {
+            throw std::runtime_error("LiveCounted: copy failed");
+        }
+    }
+};
+
+/* `RelocatableLiveCounted` is identical to `LiveCounted`, except that it opts in to
+`is_trivially_relocatable`, so containers of it take the `memmove` paths. */
+struct RelocatableLiveCounted : LiveCounted {
+    using LiveCounted::LiveCounted;
+};
+
+template <>
+struct is_trivially_relocatable<RelocatableLiveCounted> : std::true_type {};
+
 template <>
 struct std::formatter<std::vector<NonDefaultConstructibleClass>> : public std::formatter<std::string> {
     auto format(const std::vector<NonDefaultConstructibleClass> &v, std::format_context &format_context) const {
@@ -105,7 +197,77 @@ struct std::formatter<std::vector<NonDefaultConstructibleClass>> : public std::f
     }
 };
 
+template <BoundsCheckLevel Level>
+void bcv_test_check_level() {
+    BoundsCheckedVector<int, std::allocator<int>, Level> v{1, 2, 3};
+    v.push_back(4);
+    v.insert(v.begin(), 0);
+    v.erase(v.begin() + 2);
+    expect_equal(v.size(), size_t{4});
+    expect_equal(v[0] + v[1] + v[2] + v[3], 8);
+    expect_equal(v.front(), 0);
+    expect_equal(v.back(), 4);
+
+    decltype(v) v2(5, 1);
+    swap(v, v2);
+    expect_equal(v.size(), size_t{5});
+    expect_equal(v2.back(), 4);
+}
+
+void bcv_test_check_levels() {
+    /* Without source location bookkeeping, a `BoundsCheckedVector` is just a `std::vector` */
+    static_assert(sizeof(BoundsCheckedVector<int, std::allocator<int>, BoundsCheckLevel::Off>) == sizeof(std::vector<int>));
+    static_assert(sizeof(BoundsCheckedVector<int, std::allocator<int>, BoundsCheckLevel::BranchOnly>) == sizeof(std::vector<int>));
+
+    bcv_test_check_level<BoundsCheckLevel::Off>();
+    bcv_test_check_level<BoundsCheckLevel::BranchOnly>();
+    bcv_test_check_level<BoundsCheckLevel::Sampled>();
+    bcv_test_check_level<BoundsCheckLevel::Full>();
+}
+
+void bcv_test_size_change_history() {
+    /* Size changes are kept in a per-thread side table rather than in each container */
+    static_assert(sizeof(BoundsCheckedVector<int>) == sizeof(std::vector<int>) + sizeof(std::source_location));
+
+    auto &history = BoundsCheckHistory::current();
+    BoundsCheckedVector<int> v;
+    expect_equal(history.find_last_size_change(&v) == nullptr, true);
+
+    v.push_back(1);
+    auto line = std::source_location::current().line() - 1;
+    auto entry = history.find_last_size_change(&v);
+    expect_equal(entry != nullptr, true);
+    expect_equal(entry->old_size, size_t{0});
+    expect_equal(entry->new_size, size_t{1});
+    expect_equal(entry->sl.line(), line);
+
+    /* Reconstructing a container at the same address hides the size changes of the old one */
+    std::destroy_at(&v);
+    std::construct_at(&v);
+    expect_equal(history.find_last_size_change(&v) == nullptr, true);
+
+    /* Entries older than the history's capacity are forgotten */
+    v.push_back(2);
+    BoundsCheckedVector<int> other;
+    for (size_t i = 0; i < BoundsCheckHistory::capacity; ++i) {
+        other.push_back(0);
+    }
+    expect_equal(history.find_last_size_change(&v) == nullptr, true);
+
+    /* With sampling, only one in every `BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD` size changes on this
+    thread is recorded */
+    BoundsCheckedVector<int, std::allocator<int>, BoundsCheckLevel::Sampled> sampled;
+    auto total_before = history.total;
+    for (int i = 0; i < 4 * BOUNDS_CHECKED_VECTOR_SAMPLE_PERIOD; ++i) {
+        sampled.push_back(i);
+    }
+    expect_equal(history.total - total_before, size_t{4});
+}
+
 void test_bcv() {
+    bcv_test_check_levels();
+    bcv_test_size_change_history();
+
     BoundsCheckedVector<int> v{1, 2, 3};
     BoundsCheckedVector<int> v2(v.begin(), v.end());  // Most recent construction/initialization
 
@@ -201,19 +363,381 @@ bool vectors_equal(auto &sav, auto &vec) {
             );
 }
 
-template <size_t StackCapacity>
+/* Checks `append_range`, `insert_range`, `insert` from single-pass iterators,
+`append_n_uninitialized` and `resize_for_overwrite` on `Vector` (holding `int`s) and on `NDCCVector`
+(holding `NonDefaultConstructibleClass`es) against `std::vector`. At most 60 elements are stored. */
+template <typename Vector, typename NDCCVector>
+void vector_test_bulk_operations() {
+    Vector v;
+    std::vector<int> expected;
+
+    /* Contiguous (copied with `std::memcpy`), forward, sized, and single-pass ranges */
+    std::vector<int> contiguous{1, 2, 3, 4, 5, 6};
+    std::list<int> forward{7, 8, 9};
+    v.append_range(contiguous);
+    v.append_range(forward);
+    v.append_range(std::views::iota(10, 15));
+    std::istringstream stream("15 16 17");
+    v.append_range(std::views::istream<int>(stream));
+    for (int i = 1; i < 18; ++i) {
+        expected.push_back(i);
+    }
+    expect_equal(std::ranges::equal(v, expected), true);
+
+    auto it = v.insert_range(v.begin() + 3, contiguous);
+    expect_equal(it == v.begin() + 3, true);
+    expected.insert(expected.begin() + 3, contiguous.begin(), contiguous.end());
+    it = v.insert_range(v.end(), forward);
+    expect_equal(it == v.end() - 3, true);
+    expected.insert(expected.end(), forward.begin(), forward.end());
+    std::istringstream insert_stream("-1 -2 -3 -4");
+    it = v.insert_range(v.begin(), std::views::istream<int>(insert_stream));
+    expect_equal(it == v.begin(), true);
+    expected.insert(expected.begin(), {-1, -2, -3, -4});
+    std::istringstream iterator_stream("-5 -6");
+    v.insert(
+        v.begin() + 1, std::istream_iterator<int>(iterator_stream), std::istream_iterator<int>()
+    );
+    expected.insert(expected.begin() + 1, {-5, -6});
+    v.insert_range(v.begin() + 2, std::vector<int>{});
+    expect_equal(std::ranges::equal(v, expected), true);
+
+    /* Elements appended without initialization are written in place */
+    auto first = v.append_n_uninitialized(5);
+    for (int i = 0; i < 5; ++i) {
+        first[i] = 100 + i;
+        expected.push_back(100 + i);
+    }
+    expect_equal(std::ranges::equal(v, expected), true);
+    auto old_size = v.size();
+    v.resize_for_overwrite(50);
+    expected.resize(50);
+    for (size_t i = old_size; i < 50; ++i) {
+        v[i] = static_cast<int>(i);
+        expected[i] = static_cast<int>(i);
+    }
+    expect_equal(std::ranges::equal(v, expected), true);
+    v.resize_for_overwrite(10);
+    expected.resize(10);
+    expect_equal(std::ranges::equal(v, expected), true);
+
+    /* Elements which are not trivially copyable (or default-constructible) are constructed one by
+    one, and none may leak */
+    NDCCVector ndcc;
+    std::vector<NonDefaultConstructibleClass> ndcc_expected;
+    ndcc.append_range(contiguous);
+    ndcc_expected.insert(ndcc_expected.end(), contiguous.begin(), contiguous.end());
+    ndcc.insert_range(ndcc.begin() + 2, forward);
+    ndcc_expected.insert(ndcc_expected.begin() + 2, forward.begin(), forward.end());
+    std::vector<NonDefaultConstructibleClass> more;
+    for (int i = 20; i < 40; ++i) {
+        more.emplace_back(i);
+    }
+    ndcc.insert_range(ndcc.begin() + 1, more);
+    ndcc_expected.insert(ndcc_expected.begin() + 1, more.begin(), more.end());
+    ndcc.append_range(more);
+    ndcc_expected.insert(ndcc_expected.end(), more.begin(), more.end());
+    expect_equal(vectors_equal(ndcc, ndcc_expected), true);
+    auto copy = ndcc;
+    expect_equal(vectors_equal(copy, ndcc_expected), true);
+}
+
+/* Checks `resize_and_overwrite` and `resize_default_init` on `Vector` (holding `int`s) and on
+`StringVector` (holding `std::string`s, long enough to be allocated, so that a leak would show up
+under ASan). At most 20 elements are stored. */
+template <typename Vector, typename StringVector>
+void vector_test_resize_and_overwrite() {
+    Vector v = {1, 2, 3, 4, 5};
+
+    /* Write fewer elements than there is room for, as a short read would */
+    v.resize_and_overwrite(20, [](int *data, size_t count) {
+        expect_equal(count, size_t{20});
+        for (int i = 5; i < 12; ++i) {
+            data[i] = i * 10;
+        }
+        return 12;
+    });
+    expect_equal(v.size(), size_t{12});
+    expect_equal(std::ranges::equal(std::span(v.begin(), 5), std::vector{1, 2, 3, 4, 5}), true);
+    for (int i = 5; i < 12; ++i) {
+        expect_equal(v[i], i * 10);
+    }
+    v.resize_and_overwrite(3, [](int*, size_t) { return 2; });
+    expect_equal(std::ranges::equal(v, std::vector{1, 2}), true);
+
+    v.resize_default_init(6);
+    std::ranges::fill(v.begin() + 2, v.end(), 7);
+    expect_equal(std::ranges::equal(v, std::vector{1, 2, 7, 7, 7, 7}), true);
+
+    StringVector strings;
+    for (int i = 0; i < 10; ++i) {
+        strings.push_back(std::string(32, static_cast<char>('a' + i)));
+    }
+    strings.resize_and_overwrite(15, [](std::string *data, size_t count) {
+        for (size_t i = 10; i < count; ++i) {
+            data[i] = std::string(32, 'z');
+        }
+        return 12;
+    });
+    expect_equal(strings.size(), size_t{12});
+    expect_equal(strings[9], std::string(32, 'j'));
+    expect_equal(strings[11], std::string(32, 'z'));
+    strings.resize_and_overwrite(4, [](std::string *data, size_t) {
+        data[0] = "first";
+        return 1;
+    });
+    expect_equal(strings.size(), size_t{1});
+    expect_equal(strings[0], "first"s);
+}
+
+/* Inserts (one copy, one moved element, `n` copies, and a range) into and erases from every
+position of `Vector` (holding `LiveCounted`s or `RelocatableLiveCounted`s), including copies of
+its own elements, and checks the contents against `std::vector<int>` and that no element is
+leaked. `Vector` must have room for 40 elements. */
+template <typename Vector>
+void vector_test_insert_erase_lifetimes() {
+    using T = typename Vector::value_type;
+    auto baseline = LiveCounted::live;
+    auto matches = [](const Vector &v, const std::vector<int> &expected) {
+        return std::ranges::equal(v, expected, [](const T &a, int b) { return a == b; });
+    };
+
+    for (size_t size = 0; size <= 8; ++size) {
+        for (size_t position = 0; position <= size; ++position) {
+            for (size_t n = 0; n <= 10; ++n) {
+                {
+                    Vector v;
+                    std::vector<int> expected;
+                    for (size_t i = 0; i < size; ++i) {
+                        v.emplace_back(static_cast<int>(i));
+                        expected.push_back(static_cast<int>(i));
+                    }
+
+                    T copy(100);
+                    v.insert(v.begin() + position, copy);
+                    expected.insert(expected.begin() + position, 100);
+                    v.insert(v.begin() + position, T(200));
+                    expected.insert(expected.begin() + position, 200);
+                    v.insert(v.begin() + position, n, copy);
+                    expected.insert(expected.begin() + position, n, 100);
+                    std::vector<T> range;
+                    for (size_t i = 0; i < n; ++i) {
+                        range.emplace_back(static_cast<int>(300 + i));
+                        expected.insert(expected.begin() + position + i, static_cast<int>(300 + i));
+                    }
+                    v.insert(v.begin() + position, range.begin(), range.end());
+                    expect_equal(matches(v, expected), true);
+
+                    /* Inserting copies of an element of the vector itself, which the shift moves */
+                    int last = expected.back();
+                    v.insert(v.begin() + position, v.back());
+                    expected.insert(expected.begin() + position, last);
+                    v.insert(v.begin() + position, 2, v.back());
+                    expected.insert(expected.begin() + position, 2, last);
+                    expect_equal(matches(v, expected), true);
+
+                    v.erase(v.begin() + position);
+                    expected.erase(expected.begin() + position);
+                    auto count = std::min(n, v.size() - position);
+                    v.erase(v.begin() + position, v.begin() + position + count);
+                    expected.erase(expected.begin() + position, expected.begin() + position + count);
+                    expect_equal(matches(v, expected), true);
+                }
+                expect_equal(LiveCounted::live, baseline);
+            }
+        }
+    }
+}
+
+/* Inserts one copy, `n` copies, and a range of `n` elements into every position of `Vector`
+(holding `LiveCounted`s or `RelocatableLiveCounted`s), where the `k`th copy throws, and checks
+that the vector is left exactly as it was and that no element is leaked or destroyed twice. */
+template <typename Vector>
+void vector_test_insert_exception_safety() {
+    using T = typename Vector::value_type;
+    auto baseline = LiveCounted::live;
+    for (size_t size = 0; size <= 6; ++size) {
+        for (size_t position = 0; position <= size; ++position) {
+            for (size_t n = 1; n <= 4; ++n) {
+                for (int64_t k = 0; k < static_cast<int64_t>(n); ++k) {
+                    {
+                        Vector v;
+                        if constexpr (requires { v.reserve(size_t{}); }) {
+                            v.reserve(16);
+                        }
+                        for (size_t i = 0; i < size; ++i) {
+                            v.emplace_back(static_cast<int>(i));
+                        }
+                        T copy(100);
+                        std::vector<T> range;
+                        for (size_t i = 0; i < n; ++i) {
+                            range.emplace_back(static_cast<int>(300 + i));
+                        }
+
+                        auto throws = [&](auto insert) {
+                            LiveCounted::copies_until_throw = k;
+                            bool threw = false;
+                            try {
+                                insert();
+                            } catch (const std::runtime_error &) {
+                                threw = true;
+                            }
+                            LiveCounted::copies_until_throw = -1;
+                            return threw;
+                        };
+                        auto unchanged = [&] {
+                            return v.size() == size && std::ranges::equal(
+                                v, std::views::iota(0, static_cast<int>(size)),
+                                [](const T &a, int b) { return a == b; }
+                            );
+                        };
+
+                        if (n == 1) {
+                            expect_equal(throws([&] { v.insert(v.begin() + position, copy); }), true);
+                            expect_equal(unchanged(), true);
+                        }
+                        expect_equal(throws([&] { v.insert(v.begin() + position, n, copy); }), true);
+                        expect_equal(unchanged(), true);
+                        expect_equal(throws([&] {
+                            v.insert(v.begin() + position, range.begin(), range.end());
+                        }), true);
+                        expect_equal(unchanged(), true);
+                    }
+                    expect_equal(LiveCounted::live, baseline);
+                }
+            }
+        }
+    }
+}
+
+/* Appends or inserts (copies of) an element of `Vector` itself exactly when its capacity is
+exhausted, so that growing must not move the element before it is read, and checks the contents
+against `std::vector<int>` and that no element is leaked. `Vector` holds `LiveCounted`s or
+`RelocatableLiveCounted`s. */
+template <typename Vector>
+void sav_test_growth_with_aliasing() {
+    auto baseline = LiveCounted::live;
+    for (int operation = 0; operation < 4; ++operation) {
+        {
+            Vector v;
+            std::vector<int> expected;
+            for (int round = 0; round < 8; ++round) {
+                while (v.size() < v.capacity()) {
+                    v.emplace_back(static_cast<int>(v.size()));
+                    expected.push_back(static_cast<int>(expected.size()));
+                }
+                switch (operation) {
+                case 0:
+                    v.push_back(v.front());
+                    expected.push_back(expected.front());
+                    break;
+                case 1:
+                    v.emplace_back(v.back());
+                    expected.emplace_back(expected.back());
+                    break;
+                case 2:
+                    v.insert(v.begin() + 1, v.back());
+                    expected.insert(expected.begin() + 1, expected.back());
+                    break;
+                default:
+                    v.insert(v.begin() + v.size() / 2, 3, v.front());
+                    expected.insert(expected.begin() + expected.size() / 2, 3, expected.front());
+                    break;
+                }
+            }
+            expect_equal(
+                std::ranges::equal(v, expected, [](const auto &a, int b) { return a == b; }), true
+            );
+        }
+        expect_equal(LiveCounted::live, baseline);
+    }
+}
+
+/* Copy-assigns, move-assigns and swaps every pair of `Vector`s (holding `LiveCounted`s or
+`RelocatableLiveCounted`s) with sizes from `sizes`, sorts a `std::vector` of them, and checks the
+contents against `std::vector<int>` and that no element is leaked. */
+template <typename Vector>
+void vector_test_assignment_and_swap(std::initializer_list<size_t> sizes) {
+    using T = typename Vector::value_type;
+    auto baseline = LiveCounted::live;
+    auto make = [](size_t n, int first) {
+        Vector v;
+        for (size_t i = 0; i < n; ++i) {
+            v.emplace_back(first + static_cast<int>(i));
+        }
+        return v;
+    };
+    auto matches = [](const Vector &v, size_t n, int first) {
+        return v.size() == n && std::ranges::equal(
+            v, std::views::iota(first, first + static_cast<int>(n)),
+            [](const T &a, int b) { return a == b; }
+        );
+    };
+
+    for (auto a_size : sizes) {
+        for (auto b_size : sizes) {
+            {
+                auto a = make(a_size, 0);
+                auto b = make(b_size, 1000);
+                a = b;
+                expect_equal(matches(a, b_size, 1000), true);
+                expect_equal(matches(b, b_size, 1000), true);
+
+                auto c = make(a_size, 0);
+                c = std::move(b);
+                expect_equal(matches(c, b_size, 1000), true);
+
+                auto &alias = c;
+                c = alias;
+                expect_equal(matches(c, b_size, 1000), true);
+
+                auto x = make(a_size, 0);
+                auto y = make(b_size, 1000);
+                x.swap(y);
+                expect_equal(matches(x, b_size, 1000), true);
+                expect_equal(matches(y, a_size, 0), true);
+                swap(x, y);
+                expect_equal(matches(x, a_size, 0), true);
+                expect_equal(matches(y, b_size, 1000), true);
+            }
+            expect_equal(LiveCounted::live, baseline);
+        }
+    }
+
+    {
+        /* `std::sort` moves and swaps the vectors */
+        std::vector<Vector> vectors;
+        int first = 0;
+        for (auto size : sizes) {
+            vectors.push_back(make(size, first));
+            first += 100;
+        }
+        std::ranges::sort(vectors, std::greater{}, [](const Vector &v) { return v.size(); });
+        for (size_t i = 1; i < vectors.size(); ++i) {
+            expect_equal(vectors[i - 1].size() >= vectors[i].size(), true);
+        }
+        for (auto &v : vectors) {
+            auto v_first = v.empty() ? 0 : v.front().value;
+            expect_equal(v_first % 100, 0);
+            expect_equal(matches(v, v.size(), v_first), true);
+        }
+    }
+    expect_equal(LiveCounted::live, baseline);
+}
+
+template <size_t StackCapacity, typename T = NonDefaultConstructibleClass>
 void sav_test_erase_with_capacity(bool exceed_stack_capacity) {
-    StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> initial_sav;
+    StackAssistedVector<T, StackCapacity> initial_sav;
     for (size_t i = 0; i < (exceed_stack_capacity ? 3 * StackCapacity : StackCapacity); ++i) {
         initial_sav.push_back(i);
     }
 
     /* Test erasing a single element */
     for (size_t i = 0; i < initial_sav.size(); ++i) {
-        std::vector<NonDefaultConstructibleClass> vec(initial_sav.begin(), initial_sav.end());
+        std::vector<T> vec(initial_sav.begin(), initial_sav.end());
         auto vec_it = vec.erase(vec.begin() + i);
 
-        StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> curr_sav(initial_sav);
+        StackAssistedVector<T, StackCapacity> curr_sav(initial_sav);
         auto curr_sav_it = curr_sav.erase(curr_sav.begin() + i);
 
         expect_equal(vectors_equal(curr_sav, vec), true);
@@ -223,10 +747,10 @@ void sav_test_erase_with_capacity(bool exceed_stack_capacity) {
     /* Test erasing a range of iterators */
     for (size_t l = 0; l < initial_sav.size(); ++l) {
         for (size_t r = l; r <= initial_sav.size(); ++r) {  /* Second iterator can be `end()` */
-            std::vector<NonDefaultConstructibleClass> vec(initial_sav.begin(), initial_sav.end());
+            std::vector<T> vec(initial_sav.begin(), initial_sav.end());
             auto vec_it = vec.erase(vec.begin() + l, vec.begin() + r);
 
-            StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> curr_sav(initial_sav);
+            StackAssistedVector<T, StackCapacity> curr_sav(initial_sav);
             auto curr_sav_it = curr_sav.erase(curr_sav.begin() + l, curr_sav.begin() + r);
 
             expect_equal(vectors_equal(curr_sav, vec), true);
@@ -243,22 +767,31 @@ void sav_test_erase() {
         sav_test_erase_with_capacity<10>(b);
         sav_test_erase_with_capacity<50>(b);
         sav_test_erase_with_capacity<100>(b);
+
+        /* Repeat with an element type that takes the trivial relocation fast paths */
+        using RNDCC = RelocatableNonDefaultConstructibleClass;
+        sav_test_erase_with_capacity<1, RNDCC>(b);
+        sav_test_erase_with_capacity<2, RNDCC>(b);
+        sav_test_erase_with_capacity<5, RNDCC>(b);
+        sav_test_erase_with_capacity<10, RNDCC>(b);
+        sav_test_erase_with_capacity<50, RNDCC>(b);
+        sav_test_erase_with_capacity<100, RNDCC>(b);
     }
 }
 
-template <size_t StackCapacity>
+template <size_t StackCapacity, typename T = NonDefaultConstructibleClass>
 void sav_test_insert_with_capacity(bool exceed_stack_capacity) {
-    StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> initial_sav;
+    StackAssistedVector<T, StackCapacity> initial_sav;
     for (size_t i = 0; i < (exceed_stack_capacity ? 3 * StackCapacity : StackCapacity); ++i) {
         initial_sav.push_back(i);
     }
 
     /* Test inserting a single element */
     for (size_t i = 0; i <= initial_sav.size(); ++i) {  /* can pass end() to `insert` */
-        std::vector<NonDefaultConstructibleClass> vec(initial_sav.begin(), initial_sav.end());
+        std::vector<T> vec(initial_sav.begin(), initial_sav.end());
         auto vec_it = vec.insert(vec.begin() + i, -1);
 
-        StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> curr_sav(initial_sav);
+        StackAssistedVector<T, StackCapacity> curr_sav(initial_sav);
         auto curr_sav_it = curr_sav.insert(curr_sav.begin() + i, -1);
 
         expect_equal(vectors_equal(curr_sav, vec), true);
@@ -268,10 +801,10 @@ void sav_test_insert_with_capacity(bool exceed_stack_capacity) {
     /* Test inserting `n` copies of a single element */
     for (auto n : std::vector<size_t>{0, 1, 2, 5, StackCapacity, StackCapacity + 1}) {
         for (size_t i = 0; i <= initial_sav.size(); ++i) {
-            std::vector<NonDefaultConstructibleClass> vec(initial_sav.begin(), initial_sav.end());
+            std::vector<T> vec(initial_sav.begin(), initial_sav.end());
             auto vec_it = vec.insert(vec.begin() + i, n, -1);
 
-            StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> curr_sav(initial_sav);
+            StackAssistedVector<T, StackCapacity> curr_sav(initial_sav);
             auto curr_sav_it = curr_sav.insert(curr_sav.begin() + i, n, -1);
 
             expect_equal(vectors_equal(curr_sav, vec), true);
@@ -291,13 +824,13 @@ void sav_test_insert_with_capacity(bool exceed_stack_capacity) {
             for (size_t r = l; r <= range_to_be_inserted.size(); ++r) {  /* Second iterator can be `end()` */
                 for (size_t i = 0; i <= initial_sav.size(); ++i) {
                     /* Try inserting `range_to_be_inserted[l..r)` before `sav.begin() + i` */
-                    std::vector<NonDefaultConstructibleClass> vec(initial_sav.begin(), initial_sav.end());
+                    std::vector<T> vec(initial_sav.begin(), initial_sav.end());
                     auto vec_it = vec.insert(
                         vec.begin() + i,
                         range_to_be_inserted.begin() + l, range_to_be_inserted.begin() + r
                     );
 
-                    StackAssistedVector<NonDefaultConstructibleClass, StackCapacity> curr_sav(initial_sav);
+                    StackAssistedVector<T, StackCapacity> curr_sav(initial_sav);
                     auto curr_sav_it = curr_sav.insert(
                         curr_sav.begin() + i,
                         range_to_be_inserted.begin() + l, range_to_be_inserted.begin() + r
@@ -319,13 +852,260 @@ void sav_test_insert() {
         sav_test_insert_with_capacity<10>(b);
         sav_test_insert_with_capacity<50>(b);
         sav_test_insert_with_capacity<100>(b);
+
+        /* Repeat with an element type that takes the trivial relocation fast paths */
+        using RNDCC = RelocatableNonDefaultConstructibleClass;
+        sav_test_insert_with_capacity<1, RNDCC>(b);
+        sav_test_insert_with_capacity<2, RNDCC>(b);
+        sav_test_insert_with_capacity<5, RNDCC>(b);
+        sav_test_insert_with_capacity<10, RNDCC>(b);
+        sav_test_insert_with_capacity<50, RNDCC>(b);
+        sav_test_insert_with_capacity<100, RNDCC>(b);
+    }
+
+    /* Inserting and erasing neither leaks elements nor constructs over live ones, inline or on
+    the heap */
+    vector_test_insert_erase_lifetimes<StackAssistedVector<LiveCounted, 40>>();
+    vector_test_insert_erase_lifetimes<StackAssistedVector<LiveCounted, 4>>();
+    vector_test_insert_erase_lifetimes<StackAssistedVector<RelocatableLiveCounted, 40>>();
+    vector_test_insert_erase_lifetimes<StackAssistedVector<RelocatableLiveCounted, 4>>();
+
+    /* An insertion whose copy throws leaves the vector as it was */
+    vector_test_insert_exception_safety<StackAssistedVector<LiveCounted, 4>>();
+    vector_test_insert_exception_safety<StackAssistedVector<RelocatableLiveCounted, 4>>();
+
+    /* Growing while appending or inserting one of the elements reads it before moving it */
+    sav_test_growth_with_aliasing<StackAssistedVector<LiveCounted, 4>>();
+    sav_test_growth_with_aliasing<StackAssistedVector<RelocatableLiveCounted, 4>>();
+    sav_test_growth_with_aliasing<CompactStackAssistedVector<LiveCounted, 2>>();
+}
+
+template <typename GrowthPolicy>
+void sav_test_growth_policy_with() {
+    StackAssistedVector<NonDefaultConstructibleClass, 4, std::allocator<NonDefaultConstructibleClass>, GrowthPolicy> sav;
+    std::vector<NonDefaultConstructibleClass> vec;
+    for (int i = 0; i < 1000; ++i) {
+        auto old_capacity = sav.capacity();
+        sav.push_back(i);
+        vec.push_back(i);
+
+        /* Whenever the capacity grows, it must grow to exactly what `GrowthPolicy` asked for */
+        if (sav.capacity() != old_capacity) {
+            expect_equal(
+                sav.capacity(),
+                GrowthPolicy::next_capacity(old_capacity, old_capacity + 1, sizeof(NonDefaultConstructibleClass))
+            );
+        }
+    }
+    expect_equal(vectors_equal(sav, vec), true);
+
+    /* Inserting into an empty vector must also grow correctly */
+    StackAssistedVector<NonDefaultConstructibleClass, 1, std::allocator<NonDefaultConstructibleClass>, GrowthPolicy> sav2;
+    sav2.insert(sav2.begin(), 1);
+    sav2.insert(sav2.begin(), 0);
+    sav2.insert(sav2.end(), 10, 2);
+    expect_equal(sav2.size(), size_t{12});
+    expect_equal(*sav2[0].field + *sav2[1].field + *sav2[11].field, 3);
+}
+
+void sav_test_growth_policies() {
+    static_assert(JemallocSizeClasses::round_up(33) == 48);
+    static_assert(JemallocSizeClasses::round_up(129) == 160);
+    static_assert(JemallocSizeClasses::round_up(4097) == 5120);
+    static_assert(GlibcSizeClasses::round_up(1) == 24);
+    static_assert(GlibcSizeClasses::round_up(100) == 104);
+    static_assert(LinearChunkGrowth<64>::next_capacity(4, 5, 4) == 68);
+    static_assert(LinearChunkGrowth<64>::next_capacity(4, 200, 4) == 260);
+
+    sav_test_growth_policy_with<OneAndAHalfGrowth>();
+    sav_test_growth_policy_with<DoublingGrowth>();
+    sav_test_growth_policy_with<GoldenRatioGrowth>();
+    sav_test_growth_policy_with<AllocatorBucketGrowth<JemallocSizeClasses>>();
+    sav_test_growth_policy_with<AllocatorBucketGrowth<GlibcSizeClasses, OneAndAHalfGrowth>>();
+    sav_test_growth_policy_with<LinearChunkGrowth<16>>();
+}
+
+void sav_test_malloc_allocator() {
+    /* Grow past `MallocAllocator::mmap_threshold`, so that the buffer is resized with `realloc`,
+    then copied into a mapping, and then resized with `mremap` */
+    StackAssistedVector<int, 4, MallocAllocator<int>> sav;
+    for (int i = 0; i < (1 << 20); ++i) {
+        sav.push_back(i);
+    }
+    for (int i = 0; i < (1 << 20); ++i) {
+        expect_equal(sav[i], i);
+    }
+
+    /* Non-trivially-copyable (but trivially relocatable) elements must survive `realloc` too */
+    using RNDCC = RelocatableNonDefaultConstructibleClass;
+    StackAssistedVector<RNDCC, 4, MallocAllocator<RNDCC>> sav2;
+    std::vector<RNDCC> vec;
+    for (int i = 0; i < 1000; ++i) {
+        sav2.push_back(i);
+        vec.push_back(i);
+    }
+    sav2.insert(sav2.begin() + 500, 100, -1);
+    vec.insert(vec.begin() + 500, 100, -1);
+    expect_equal(vectors_equal(sav2, vec), true);
+
+    /* `realloc` may move the elements, so appending one of them must copy it first */
+    using RLC = RelocatableLiveCounted;
+    sav_test_growth_with_aliasing<StackAssistedVector<RLC, 4, MallocAllocator<RLC>>>();
+    vector_test_insert_erase_lifetimes<StackAssistedVector<RLC, 4, MallocAllocator<RLC>>>();
+}
+
+void sav_test_compact_layout() {
+    /* With a stateless allocator, the compact layout needs just the union of the pointer and the
+    stack storage, plus 32-bit size and capacity fields */
+    static_assert(sizeof(CompactStackAssistedVector<int, 2>) == 16);
+    static_assert(sizeof(CompactStackAssistedVector<int, 2>) < sizeof(StackAssistedVector<int, 2>));
+
+    using Compact = CompactStackAssistedVector<NonDefaultConstructibleClass, 3>;
+    Compact sav;
+    std::vector<NonDefaultConstructibleClass> vec;
+    for (int i = 0; i < 100; ++i) {
+        sav.push_back(i);
+        vec.push_back(i);
     }
+    sav.insert(sav.begin() + 1, 5, -1);
+    vec.insert(vec.begin() + 1, 5, -1);
+    sav.erase(sav.begin() + 10, sav.begin() + 95);
+    vec.erase(vec.begin() + 10, vec.begin() + 95);
+    expect_equal(vectors_equal(sav, vec), true);
+
+    /* Moving the elements back to the stack overwrites the pointer to the dynamic array */
+    sav.erase(sav.begin() + 3, sav.end());
+    vec.erase(vec.begin() + 3, vec.end());
+    sav.shrink_to_fit();
+    expect_equal(sav.capacity(), size_t{3});
+    expect_equal(vectors_equal(sav, vec), true);
+
+    /* ...and going back to the heap must work afterwards too */
+    sav.push_back(7);
+    vec.push_back(7);
+    Compact moved(std::move(sav));
+    expect_equal(vectors_equal(moved, vec), true);
+    expect_equal(sav.size(), size_t{0});
+
+    /* The capacity field has 31 bits, so sizes and capacities beyond that are rejected rather than
+    truncated */
+    using CompactInts = CompactStackAssistedVector<uint32_t, 2>;
+    auto too_large = size_t{1} << 31;
+    CompactInts ints(2, 7u);
+    expect_equal(ints.max_size() < too_large, true);
+    auto throws_length_error = [](auto operation) {
+        try {
+            operation();
+        } catch (const std::length_error &) {
+            return true;
+        }
+        return false;
+    };
+    expect_equal(throws_length_error([&] { ints.reserve(too_large + 5); }), true);
+    expect_equal(throws_length_error([&] { ints.resize(too_large + 5); }), true);
+    expect_equal(throws_length_error([&] { ints.resize(too_large + 5, 1u); }), true);
+    expect_equal(throws_length_error([&] { ints.resize_for_overwrite(too_large + 5); }), true);
+    expect_equal(throws_length_error([&] { ints.resize_default_init(too_large + 5); }), true);
+    expect_equal(throws_length_error([&] { CompactInts sized(too_large + 5); }), true);
+    expect_equal(throws_length_error([&] { CompactInts filled(too_large + 5, 1u); }), true);
+    expect_equal(ints.capacity(), size_t{2});
+    expect_equal(ints.size(), size_t{2});
+    expect_equal(ints[1], 7u);
+}
+
+void sav_test_bulk_operations() {
+    vector_test_bulk_operations<
+        StackAssistedVector<int, 4>, StackAssistedVector<NonDefaultConstructibleClass, 4>
+    >();
+    vector_test_resize_and_overwrite<
+        StackAssistedVector<int, 4>, StackAssistedVector<std::string, 4>
+    >();
+
+    /* Appending or inserting a range grows the capacity at most once */
+    AllocationCounters counters;
+    {
+        StackAssistedVector<int, 4, CountingAllocator<int>> sav(counters);
+        std::vector<int> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+        sav.append_range(values);
+        expect_equal(counters.allocations.load(), uint64_t{1});
+        sav.insert_range(sav.begin() + 10, std::views::iota(0, 5000));
+        expect_equal(counters.allocations.load(), uint64_t{2});
+        sav.append_n_uninitialized(sav.capacity() - sav.size());
+        expect_equal(counters.allocations.load(), uint64_t{2});
+        expect_equal(sav.size(), sav.capacity());
+        expect_equal(std::ranges::equal(std::span(sav.begin(), 10), std::views::iota(0, 10)), true);
+        expect_equal(std::ranges::equal(std::span(sav.begin() + 10, 5000), std::views::iota(0, 5000)), true);
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+/* Assignment reuses the existing capacity, and moving or swapping vectors on the heap hands their
+dynamic arrays over rather than moving their elements */
+void sav_test_assignment_and_swap() {
+    vector_test_assignment_and_swap<StackAssistedVector<LiveCounted, 4>>({0, 2, 4, 7, 20});
+    vector_test_assignment_and_swap<StackAssistedVector<RelocatableLiveCounted, 4>>({0, 3, 4, 9});
+    vector_test_assignment_and_swap<CompactStackAssistedVector<LiveCounted, 2>>({0, 1, 2, 5});
+
+    using SAV = StackAssistedVector<int, 4, CountingAllocator<int>>;
+    AllocationCounters counters;
+    {
+        SAV big(counters);
+        for (int i = 0; i < 100; ++i) {
+            big.push_back(i);
+        }
+        SAV small(counters);
+        small = {1, 2, 3};
+
+        /* Copying a smaller vector reuses the dynamic array */
+        auto allocations = counters.allocations.load();
+        auto capacity = big.capacity();
+        big = small;
+        expect_equal(counters.allocations.load(), allocations);
+        expect_equal(big.capacity(), capacity);
+        expect_equal(std::ranges::equal(big, std::vector{1, 2, 3}), true);
+
+        /* Moving a vector whose elements are on the heap takes over its dynamic array */
+        SAV other(counters);
+        for (int i = 0; i < 50; ++i) {
+            other.push_back(i);
+        }
+        auto other_data = other.data();
+        allocations = counters.allocations.load();
+        big = std::move(other);
+        expect_equal(big.data() == other_data, true);
+        expect_equal(other.empty() && other.is_inline(), true);
+        expect_equal(counters.allocations.load(), allocations);
+
+        /* Swapping two vectors on the heap exchanges their dynamic arrays... */
+        auto &sav_counters = container_counters<SAV>();
+        auto moves = sav_counters.element_moves.load();
+        SAV heap(counters);
+        heap.insert(heap.end(), 20, 7);
+        auto heap_data = heap.data();
+        big.swap(heap);
+        expect_equal(big.data() == heap_data && heap.data() == other_data, true);
+        expect_equal(sav_counters.element_moves.load(), moves);
+
+        /* ...and swapping with an inline vector hands the dynamic array over, moving only the
+        inline elements */
+        swap(small, big);
+        expect_equal(small.data() == heap_data && big.is_inline(), true);
+        expect_equal(std::ranges::equal(big, std::vector{1, 2, 3}), true);
+        expect_equal(sav_counters.element_moves.load(), moves + 3);
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
 }
 
 void test_sav() {
     std::cout << "Testing SAV... " << std::flush;
     sav_test_insert();
     sav_test_erase();
+    sav_test_growth_policies();
+    sav_test_malloc_allocator();
+    sav_test_compact_layout();
+    sav_test_bulk_operations();
+    sav_test_assignment_and_swap();
     sav_test_move_constructor();
     sav_test_initializer_list_constructor();
     sav_test_iterator_constructor();
@@ -410,6 +1190,14 @@ void fcv_test_insert() {
     fcv_test_insert_with_capacity<10>();
     fcv_test_insert_with_capacity<50>();
     fcv_test_insert_with_capacity<100>();
+
+    /* Inserting and erasing neither leaks elements nor constructs over live ones */
+    vector_test_insert_erase_lifetimes<FixedCapacityVector<LiveCounted, 40>>();
+    vector_test_insert_erase_lifetimes<FixedCapacityVector<RelocatableLiveCounted, 40>>();
+
+    /* An insertion whose copy throws leaves the vector as it was */
+    vector_test_insert_exception_safety<FixedCapacityVector<LiveCounted, 16>>();
+    vector_test_insert_exception_safety<FixedCapacityVector<RelocatableLiveCounted, 16>>();
 }
 
 template <size_t Capacity>
@@ -457,10 +1245,2070 @@ void fcv_test_erase() {
     fcv_test_erase_with_capacity<100>();
 }
 
+/* Compares the search functions of `FixedCapacityVector<T, 80>` (and, on x86-64, the SSE2 kernels,
+which the runtime dispatch skips on CPUs with AVX2) against the standard algorithms, for every size
+up to the capacity, so that every combination of full vectors and tail is covered. */
+template <typename T>
+void fcv_test_search_with_type() {
+    constexpr size_t Capacity = 80;
+    for (size_t n = 0; n <= Capacity; ++n) {
+        FixedCapacityVector<T, Capacity> fcv;
+        std::vector<T> vec;
+        for (size_t i = 0; i < n; ++i) {
+            /* Values repeat, and exceed 127 (so that they are negative for `int8_t`) */
+            fcv.push_back(static_cast<T>((i * 37 + 11) % 61 * 4));
+            vec.push_back(fcv.back());
+        }
+
+        auto vec_min = std::min_element(vec.begin(), vec.end()) - vec.begin();
+        auto vec_max = std::max_element(vec.begin(), vec.end()) - vec.begin();
+        expect_equal(fcv.min_element() - fcv.begin(), vec_min);
+        expect_equal(fcv.max_element() - fcv.begin(), vec_max);
+
+        for (size_t i = 0; i <= n; ++i) {
+            /* Search for every element, and for a value that is never present */
+            auto value = (i < n ? vec[i] : static_cast<T>(3));
+            auto vec_index = std::find(vec.begin(), vec.end(), value) - vec.begin();
+            auto vec_count = static_cast<size_t>(std::count(vec.begin(), vec.end(), value));
+
+            expect_equal(fcv.find(value) - fcv.begin(), vec_index);
+            expect_equal(fcv.count(value), vec_count);
+            expect_equal(fcv.contains(value), vec_index != static_cast<ptrdiff_t>(n));
+            expect_equal(fcv.index_of(value).value_or(n), static_cast<size_t>(vec_index));
+#if defined(SIMD_SEARCH_X86)
+            expect_equal(simd_search_detail::sse2::find(vec.data(), n, value), size_t(vec_index));
+            expect_equal(simd_search_detail::sse2::count(vec.data(), n, value), vec_count);
+#endif
+        }
+    }
+}
+
+void fcv_test_search() {
+    fcv_test_search_with_type<int8_t>();
+    fcv_test_search_with_type<uint8_t>();
+    fcv_test_search_with_type<int16_t>();
+    fcv_test_search_with_type<uint16_t>();
+    fcv_test_search_with_type<int32_t>();
+    fcv_test_search_with_type<uint32_t>();
+    fcv_test_search_with_type<int64_t>();
+    fcv_test_search_with_type<uint64_t>();
+    fcv_test_search_with_type<float>();
+    fcv_test_search_with_type<double>();
+
+    /* Floating-point equality follows `operator==` */
+    FixedCapacityVector<double, 16> doubles{1.0, std::nan(""), -0.0, 2.0, 0.0};
+    expect_equal(doubles.index_of(0.0).value_or(doubles.size()), size_t{2});
+    expect_equal(doubles.count(0.0), size_t{2});
+    expect_equal(doubles.contains(std::nan("")), false);
+
+    /* The search functions are usable during constant evaluation */
+    static_assert([] {
+        FixedCapacityVector<int, 8> v{3, 1, 4, 1, 5};
+        return v.count(1) == 2 && v.index_of(4) == 2 && !v.contains(9) &&
+            *v.min_element() == 1 && *v.max_element() == 5;
+    }());
+}
+
+void fcv_test_bulk_operations() {
+    vector_test_bulk_operations<
+        FixedCapacityVector<int, 60>, FixedCapacityVector<NonDefaultConstructibleClass, 60>
+    >();
+    vector_test_resize_and_overwrite<
+        FixedCapacityVector<int, 20>, FixedCapacityVector<std::string, 20>
+    >();
+}
+
+consteval auto test_fcv_bulk_constant_evaluation() {
+    FixedCapacityVector<int, 100> v;
+    v.append_range(std::views::iota(50, 100));
+    int front[] = {0, 1, 2};
+    v.insert_range(v.begin(), front);
+    auto middle = std::views::iota(3, 50);
+    v.insert(v.begin() + 3, middle.begin(), middle.end());
+    v.resize_for_overwrite(90);
+
+    int sum = 0;
+    for (auto i : v) {
+        sum += i;
+    }
+    return sum;
+}
+
+/* Assigns and swaps `FixedCapacityVector`s of `std::string`s at compile time, and returns the total
+length of the strings left */
+consteval auto test_fcv_assignment_constant_evaluation() {
+    FixedCapacityVector<std::string, 10> a = {"a", "bb", "ccc"};
+    FixedCapacityVector<std::string, 10> b = {"dddd"};
+    a.swap(b);
+    b = a;
+    a = {"eeeee", "ffffff"};
+    swap(a, b);
+    b = std::move(a);
+
+    size_t length = 0;
+    for (const auto &s : b) {
+        length += s.size();
+    }
+    return length;
+}
+
+/* Shifts `std::string`s (which are not trivially relocatable) in both directions at compile time,
+and returns the total length of the strings left */
+consteval auto test_fcv_insert_erase_constant_evaluation() {
+    FixedCapacityVector<std::string, 20> v;
+    for (int i = 0; i < 6; ++i) {
+        v.push_back(std::string(static_cast<size_t>(i), 'x'));
+    }
+    v.insert(v.begin() + 1, v[5]);
+    v.insert(v.begin() + 2, 3, std::string(10, 'y'));
+    v.erase(v.begin(), v.begin() + 2);
+    v.erase(v.end() - 1);
+
+    size_t length = 0;
+    for (const auto &s : v) {
+        length += s.size();
+    }
+    return length;
+}
+
 void test_fcv() {
     std::cout << "Testing FCV... " << std::flush;
     fcv_test_insert();
     fcv_test_erase();
+    fcv_test_search();
+    fcv_test_bulk_operations();
+    vector_test_assignment_and_swap<FixedCapacityVector<LiveCounted, 20>>({0, 1, 5, 20});
+    vector_test_assignment_and_swap<FixedCapacityVector<RelocatableLiveCounted, 20>>({0, 3, 8});
+    std::cout << "Success" << std::endl;
+}
+
+/* Fills each of the three containers, built with a copy of `allocator`, and checks that they (and
+their copies) hold the expected elements */
+template <template <typename> typename Alloc>
+void allocator_test_containers(const Alloc<NonDefaultConstructibleClass> &allocator) {
+    using NDCC = NonDefaultConstructibleClass;
+    StackAssistedVector<NDCC, 4, Alloc<NDCC>> sav(allocator);
+    FixedCapacityVector<NDCC, 64, Alloc<NDCC>> fcv(allocator);
+    BoundsCheckedVector<NDCC, Alloc<NDCC>> bcv(allocator);
+    std::vector<NDCC> vec;
+    for (int i = 0; i < 64; ++i) {
+        sav.push_back(i);
+        fcv.push_back(i);
+        bcv.push_back(i);
+        vec.push_back(i);
+    }
+    sav.erase(sav.begin() + 10, sav.begin() + 20);
+    fcv.erase(fcv.begin() + 10, fcv.begin() + 20);
+    bcv.erase(bcv.begin() + 10, bcv.begin() + 20);
+    vec.erase(vec.begin() + 10, vec.begin() + 20);
+
+    auto sav_copy(sav);
+    auto fcv_copy(fcv);
+    auto bcv_copy(bcv);
+    expect_equal(vectors_equal(sav_copy, vec), true);
+    expect_equal(vectors_equal(fcv_copy, vec), true);
+    expect_equal(vectors_equal(bcv_copy, vec), true);
+
+    /* `std::pmr::polymorphic_allocator` deliberately reverts to the default resource on copies */
+    if constexpr (!std::is_same_v<Alloc<NDCC>, std::pmr::polymorphic_allocator<NDCC>>) {
+        expect_equal(bcv_copy.get_allocator() == allocator, true);
+    }
+}
+
+void allocator_test_monotonic_arena() {
+    MonotonicArena arena(1024);
+    auto first = arena.allocate(100);
+    auto second = arena.allocate(1, 64);
+    expect_equal(reinterpret_cast<uintptr_t>(second) % 64, uintptr_t{0});
+
+    /* Only the most recent allocation can be expanded, or given back */
+    expect_equal(arena.expand(first, 100, 200), false);
+    expect_equal(arena.expand(second, 1, 500), true);
+    arena.deallocate(second, 500);
+    expect_equal(arena.allocate(1, 64), second);
+
+    /* Allocations that do not fit the current chunk go to new chunks, which are kept (and reused
+    in the same order) after a reset */
+    auto large = arena.allocate(5000);
+    auto reserved = arena.bytes_reserved();
+    arena.reset();
+    expect_equal(arena.allocate(100), first);
+    expect_equal(arena.allocate(5000), large);
+    expect_equal(arena.bytes_reserved(), reserved);
+
+    /* An arena over a caller-provided buffer allocates from it first */
+    alignas(std::max_align_t) std::byte buffer[4096];
+    MonotonicArena buffer_arena(buffer, sizeof(buffer));
+    auto p = static_cast<std::byte*>(buffer_arena.allocate(1000));
+    expect_equal(p >= buffer && p + 1000 <= buffer + sizeof(buffer), true);
+    buffer_arena.allocate(10000);
+    buffer_arena.release();
+    expect_equal(buffer_arena.bytes_reserved() <= sizeof(buffer), true);
+}
+
+void allocator_test_arena_allocator() {
+    MonotonicArena arena;
+    allocator_test_containers<ArenaAllocator>(ArenaAllocator<NonDefaultConstructibleClass>(arena));
+
+    /* A `StackAssistedVector` that is the last to allocate from its arena grows in place, through
+    the `expand` hook */
+    arena.reset();
+    StackAssistedVector<int, 4, ArenaAllocator<int>> sav(arena);
+    for (int i = 0; i < 5; ++i) {
+        sav.push_back(i);
+    }
+    auto heap_array = sav.data();
+    for (int i = 5; i < 1000; ++i) {
+        sav.push_back(i);
+    }
+    expect_equal(sav.data() == heap_array, true);
+    for (int i = 0; i < 1000; ++i) {
+        expect_equal(sav[i], i);
+    }
+
+    /* The thread-local arena needs no arena to be passed around */
+    {
+        StackAssistedVector<int, 4, ThreadLocalArenaAllocator<int>> tl_sav;
+        BoundsCheckedVector<int, ThreadLocalArenaAllocator<int>> tl_bcv;
+        for (int i = 0; i < 100; ++i) {
+            tl_sav.push_back(i);
+            tl_bcv.push_back(i);
+        }
+        expect_equal(std::equal(tl_sav.begin(), tl_sav.end(), tl_bcv.begin(), tl_bcv.end()), true);
+        expect_equal(MonotonicArena::thread_local_arena().bytes_reserved() > 0, true);
+    }
+    MonotonicArena::thread_local_arena().reset();
+}
+
+void allocator_test_pool_allocator() {
+    FixedSizePool pool(64, 4);
+    allocator_test_containers<PoolAllocator>(PoolAllocator<NonDefaultConstructibleClass>(pool));
+
+    /* Freed blocks are reused first, while allocations larger than a block bypass the pool */
+    auto a = pool.allocate(64), b = pool.allocate(8);
+    pool.deallocate(a, 64);
+    expect_equal(pool.allocate(32), a);
+    auto large = pool.allocate(1000);
+    pool.deallocate(large, 1000);
+    pool.deallocate(a, 32);
+    pool.deallocate(b, 8);
+}
+
+void allocator_test_memory_resource_adapter() {
+    MonotonicArena arena;
+    MemoryResourceAdapter<MonotonicArena> arena_resource(arena);
+    allocator_test_containers<std::pmr::polymorphic_allocator>(&arena_resource);
+
+    FixedSizePool pool(256);
+    MemoryResourceAdapter<FixedSizePool> pool_resource(pool), pool_resource2(pool);
+    expect_equal(pool_resource.is_equal(pool_resource2), true);
+    expect_equal(pool_resource.is_equal(arena_resource), false);
+    allocator_test_containers<std::pmr::polymorphic_allocator>(&pool_resource);
+}
+
+/* An allocator which fills every buffer it hands out with the byte 0xAB, so that tests can see
+whether a container wrote to the buffer */
+template <typename T>
+struct PatternAllocator {
+    using value_type = T;
+
+    PatternAllocator() = default;
+    template <typename U>
+    PatternAllocator(const PatternAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        auto p = std::allocator<T>{}.allocate(n);
+        std::memset(static_cast<void*>(p), 0xAB, n * sizeof(T));
+        return p;
+    }
+    void deallocate(T *p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+
+    friend bool operator== (const PatternAllocator&, const PatternAllocator&) { return true; }
+};
+
+/* Returns true iff every byte of `p[0..n)` is 0xAB */
+template <typename T>
+bool holds_pattern(const T *p, size_t n) {
+    std::vector<unsigned char> bytes(n * sizeof(T));
+    std::memcpy(bytes.data(), static_cast<const void*>(p), bytes.size());
+    return std::ranges::all_of(bytes, [](unsigned char byte) { return byte == 0xAB; });
+}
+
+void allocator_test_default_init_allocator() {
+    /* Copies and moves are left to the upstream allocator, so the bulk paths remain enabled */
+    static_assert(uses_trivial_relocation_v<int, DefaultInitAllocator<int>>);
+    static_assert(uses_bulk_copy_v<int, DefaultInitAllocator<int>, const int*>);
+
+    /* `resize` value-initializes (zeroes) trivial elements, unless the allocator is wrapped */
+    std::vector<int, PatternAllocator<int>> zeroed;
+    zeroed.resize(100);
+    expect_equal(std::ranges::count(zeroed, 0), std::ptrdiff_t{100});
+    std::vector<int, DefaultInitAllocator<int, PatternAllocator<int>>> untouched;
+    untouched.resize(100);
+    expect_equal(holds_pattern(untouched.data(), 100), true);
+
+    using SAV = StackAssistedVector<int, 4, DefaultInitAllocator<int, PatternAllocator<int>>>;
+    SAV sav = {1, 2, 3};
+    sav.resize(1000);
+    expect_equal(sav[0] == 1 && sav[1] == 2 && sav[2] == 3, true);
+    expect_equal(holds_pattern(sav.data() + 3, 997), true);
+
+    /* Non-trivial elements are still constructed, by their default constructors */
+    StackAssistedVector<std::string, 2, DefaultInitAllocator<std::string>> strings;
+    strings.push_back(std::string(50, 's'));
+    strings.resize(10);
+    expect_equal(strings[0], std::string(50, 's'));
+    expect_equal(std::ranges::all_of(strings | std::views::drop(1), &std::string::empty), true);
+
+    /* Allocations go through the upstream allocator */
+    AllocationCounters counters;
+    {
+        using Counting = CountingAllocator<int>;
+        StackAssistedVector<int, 4, DefaultInitAllocator<int, Counting>> counted(Counting{counters});
+        counted.resize(100);
+        expect_equal(counters.allocations.load(), uint64_t{1});
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+void test_allocators() {
+    std::cout << "Testing allocators... " << std::flush;
+    allocator_test_monotonic_arena();
+    allocator_test_arena_allocator();
+    allocator_test_pool_allocator();
+    allocator_test_memory_resource_adapter();
+    allocator_test_default_init_allocator();
+    std::cout << "Success" << std::endl;
+}
+
+void instrumentation_test_zero_allocations() {
+    using SAV = StackAssistedVector<int, 8, CountingAllocator<int>>;
+    AllocationCounters counters;
+    auto &sav_counters = container_counters<SAV>();
+    sav_counters.reset();
+    {
+        /* No allocations may happen until the stack capacity is exceeded... */
+        SAV sav(counters);
+        for (int i = 0; i < 8; ++i) {
+            sav.push_back(i);
+        }
+        expect_equal(counters.allocations.load(), uint64_t{0});
+        expect_equal(sav_counters.spills.load(), uint64_t{0});
+
+        /* ...after which the elements spill to the heap exactly once */
+        sav.push_back(8);
+        expect_equal(counters.allocations.load(), uint64_t{1});
+        expect_equal(sav_counters.spills.load(), uint64_t{1});
+        expect_equal(sav_counters.element_moves.load(), uint64_t{8});
+
+        for (int i = 9; i < 100; ++i) {
+            sav.push_back(i);
+        }
+        expect_equal(sav_counters.spills.load(), uint64_t{1});
+        expect_equal(sav_counters.reallocations.load(), counters.allocations.load() - 1);
+
+        auto moves = sav_counters.element_moves.load();
+        sav.insert(sav.begin() + 90, -1);
+        sav.erase(sav.begin());
+        expect_equal(sav_counters.element_moves.load(), moves + 10 + 100);
+
+        /* Inserting when the capacity is exhausted moves each element once, straight to its place
+        in the new dynamic array */
+        while (sav.size() < sav.capacity()) {
+            sav.push_back(0);
+        }
+        moves = sav_counters.element_moves.load();
+        auto size = sav.size();
+        sav.insert(sav.begin() + 10, -1);
+        expect_equal(sav_counters.element_moves.load(), moves + size);
+        expect_equal(sav[10], -1);
+    }
+
+    /* Both sets of counters see the same allocations, all of which were freed */
+    expect_equal(counters.deallocations.load(), counters.allocations.load());
+    expect_equal(counters.live_bytes(), uint64_t{0});
+    expect_equal(sav_counters.allocations.load(), counters.allocations.load());
+    expect_equal(sav_counters.bytes_allocated.load(), counters.bytes_allocated.load());
+}
+
+void instrumentation_test_counting_allocator() {
+    /* Wrapping an allocator keeps its hooks, and keeps trivial relocation */
+    static_assert(allocator_has_reallocate<CountingAllocator<int, MallocAllocator<int>>>);
+    static_assert(!allocator_has_reallocate<CountingAllocator<int>>);
+    static_assert(allocator_has_expand<CountingAllocator<int, ArenaAllocator<int>>>);
+    static_assert(uses_trivial_relocation_v<int, CountingAllocator<int>>);
+
+    AllocationCounters counters;
+    {
+        StackAssistedVector<int, 4, CountingAllocator<int, MallocAllocator<int>>> sav(counters);
+        for (int i = 0; i < 10000; ++i) {
+            sav.push_back(i);
+        }
+        expect_equal(counters.allocations.load(), uint64_t{1});
+        expect_equal(counters.reallocations.load() > 0, true);
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+
+    /* The tracer sees every call, including those made by `std::vector` */
+    static size_t traced_events;
+    traced_events = 0;
+    counters.reset();
+    counters.tracer = [](const AllocationEvent&) { ++traced_events; };
+    {
+        BoundsCheckedVector<int, CountingAllocator<int>> bcv(counters);
+        for (int i = 0; i < 100; ++i) {
+            bcv.push_back(i);
+        }
+    }
+    expect_equal(traced_events, counters.allocations + counters.deallocations);
+    expect_equal(counters.live_bytes(), uint64_t{0});
+
+    /* `FixedCapacityVector` never allocates, but does move elements */
+    using FCV = FixedCapacityVector<int, 16>;
+    container_counters<FCV>().reset();
+    FCV fcv{1, 2, 3, 4, 5};
+    fcv.insert(fcv.begin(), 0);
+    fcv.erase(fcv.begin() + 5);
+    expect_equal(container_counters<FCV>().element_moves.load(), uint64_t{5});
+
+    /* Every container type that recorded events shows up in the report */
+    std::ostringstream report;
+    write_container_counters_report(report);
+    expect_equal(report.str().find("\"FixedCapacityVector<int, 16") != std::string::npos, true);
+    expect_equal(report.str().find("\"StackAssistedVector<int, 8") != std::string::npos, true);
+}
+
+void instrumentation_test_capacity_profile() {
+    /* Sizes below 256 have their own bucket, larger ones share a power-of-two bucket */
+    expect_equal(CapacityProfile::bucket_of(255), size_t{255});
+    expect_equal(CapacityProfile::bucket_lower_bound(CapacityProfile::bucket_of(300)), size_t{256});
+    expect_equal(CapacityProfile::bucket_upper_bound(CapacityProfile::bucket_of(300)), size_t{511});
+    expect_equal(CapacityProfile::bucket_of(SIZE_MAX), CapacityProfile::bucket_count - 1);
+
+    /* This test drives the tracker directly, rather than through a `StackAssistedVector`, as
+    enabling `CPP_CONTAINERS_CAPACITY_PROFILING` here would change the layout of every SAV */
+    using SAV = StackAssistedVector<int, 4>;
+    auto &profile = capacity_profile<SAV>(4, sizeof(int));
+    expect_equal(profile.recommended_capacity(), size_t{1});
+
+    /* 95 objects peak at sizes 1 to 5, and 5 outliers (which spill) peak at 1000 */
+    for (size_t i = 0; i < 100; ++i) {
+        capacity_profile_detail::ActivePeakSizeTracker tracker;
+        size_t peak = (i < 95 ? i % 5 + 1 : 1000);
+        tracker.note(peak);
+        if (peak > 4) {
+            tracker.spill<SAV>(4, sizeof(int));
+        }
+        tracker.finish<SAV>(0, 4, sizeof(int));
+    }
+    expect_equal(profile.objects.load(), uint64_t{100});
+    expect_equal(profile.spills.load(), uint64_t{24});
+    expect_equal(profile.peak_size_at(0.5), size_t{3});
+    expect_equal(profile.recommended_capacity(0.95), size_t{5});
+    expect_equal(profile.recommended_capacity(0.99), size_t{1023});
+
+    /* A target which is not a whole number of objects is rounded up: 9 of these 10 objects are
+    only 90%, so covering 95% of them takes all 10 */
+    using SmallSAV = StackAssistedVector<int, 2>;
+    auto &small_profile = capacity_profile<SmallSAV>(2, sizeof(int));
+    for (size_t i = 0; i < 10; ++i) {
+        capacity_profile_detail::ActivePeakSizeTracker tracker;
+        tracker.note(i < 9 ? 1 : 50);
+        tracker.finish<SmallSAV>(0, 2, sizeof(int));
+    }
+    expect_equal(small_profile.peak_size_at(0.9), size_t{1});
+    expect_equal(small_profile.peak_size_at(0.95), size_t{50});
+    expect_equal(small_profile.recommended_capacity(0.95), size_t{50});
+
+    std::ostringstream json, csv;
+    write_capacity_profiles_json(json, 0.95);
+    write_capacity_profiles_csv(csv, 0.95);
+    expect_equal(json.str().find("\"recommended_capacity\": 5") != std::string::npos, true);
+    expect_equal(json.str().find("[512, 1023, 5]") != std::string::npos, true);
+    expect_equal(csv.str().find(",100,24,5,512,1023,5\n") != std::string::npos, true);
+
+    /* When profiling is off, the tracker takes up no space in a `StackAssistedVector` */
+    static_assert(std::is_empty_v<PeakSizeTracker> == !CPP_CONTAINERS_CAPACITY_PROFILING);
+}
+
+void test_instrumentation() {
+    std::cout << "Testing instrumentation... " << std::flush;
+    instrumentation_test_zero_allocations();
+    instrumentation_test_counting_allocator();
+    instrumentation_test_capacity_profile();
+    std::cout << "Success" << std::endl;
+}
+
+/* Fills a structure-of-arrays vector of type `SoA` (with columns `int`, `std::string`, and
+`double`) with 40 rows, and checks every operation against a `std::vector` of tuples */
+template <typename SoA>
+void soa_test_operations() {
+    SoA soa;
+    std::vector<std::tuple<int, std::string, double>> vec;
+    for (int i = 0; i < 40; ++i) {
+        soa.emplace_back(i, std::to_string(i), i * 0.5);
+        vec.emplace_back(i, std::to_string(i), i * 0.5);
+    }
+    auto expect_same_rows = [&]() {
+        expect_equal(soa.size(), vec.size());
+        for (size_t i = 0; i < vec.size(); ++i) {
+            expect_equal(soa[i] == vec[i], true);
+        }
+    };
+    expect_same_rows();
+
+    /* Each column is contiguous */
+    auto ids = soa.template column<0>();
+    expect_equal(ids.size(), size_t{40});
+    expect_equal(std::accumulate(ids.begin(), ids.end(), 0), 780);
+    expect_equal(soa.template data<2>() + 39 == &std::get<2>(soa.back()), true);
+
+    /* Proxy references write through to the columns */
+    for (auto [id, name, weight] : soa) {
+        weight += id;
+    }
+    soa[1] = std::tuple(-1, "minus one", -1.0);
+    for (auto &[id, name, weight] : vec) {
+        weight += id;
+    }
+    vec[1] = std::tuple(-1, "minus one", -1.0);
+    expect_same_rows();
+
+    /* Erasing, popping, and resizing */
+    soa.erase(soa.begin() + 5);
+    vec.erase(vec.begin() + 5);
+    soa.erase(soa.begin() + 10, soa.begin() + 20);
+    vec.erase(vec.begin() + 10, vec.begin() + 20);
+    soa.pop_back();
+    vec.pop_back();
+    soa.resize(32);
+    vec.resize(32);
+    expect_same_rows();
+    expect_equal(std::get<1>(soa[31]), std::string());
+
+    /* Copying and moving */
+    SoA copy(soa);
+    expect_equal(copy.size(), soa.size());
+    for (size_t i = 0; i < soa.size(); ++i) {
+        expect_equal(copy[i] == soa[i], true);
+    }
+    SoA moved(std::move(copy));
+    expect_equal(copy.empty(), true);
+    for (size_t i = 0; i < soa.size(); ++i) {
+        expect_equal(moved[i] == soa[i], true);
+    }
+}
+
+void soa_test_growth() {
+    /* `StackAssistedSoAVector` only allocates once its stack capacity is exceeded */
+    AllocationCounters counters;
+    using Allocator = CountingAllocator<std::byte>;
+    BasicSoAVector<4, true, Allocator, char, double> soa(counters);
+    for (int i = 0; i < 4; ++i) {
+        soa.emplace_back('a' + i, i);
+    }
+    expect_equal(counters.allocations.load(), uint64_t{0});
+
+    /* Appending a row of the vector itself when it is full must not read the moved-from row */
+    soa.emplace_back(std::get<0>(soa[0]), std::get<1>(soa[3]));
+    expect_equal(counters.allocations.load(), uint64_t{1});
+    expect_equal(soa.back() == std::tuple('a', 3.0), true);
+
+    /* Every column of the heap buffer starts on its own cache line */
+    expect_equal(reinterpret_cast<uintptr_t>(soa.data<0>()) % 64, uintptr_t{0});
+    expect_equal(reinterpret_cast<uintptr_t>(soa.data<1>()) % 64, uintptr_t{0});
+    expect_equal(soa.data<0>() + 64 <= reinterpret_cast<char*>(soa.data<1>()), true);
+
+    /* Moving a heap-allocated `StackAssistedSoAVector` takes over its buffer */
+    auto data = soa.data<1>();
+    decltype(soa) moved(std::move(soa));
+    expect_equal(moved.data<1>() == data, true);
+    expect_equal(moved.size(), size_t{5});
+
+    /* `FixedCapacitySoAVector` never allocates, and holds its columns inline */
+    FixedCapacitySoAVector<8, int, float> fixed{{1, 1.0f}, {2, 2.0f}};
+    static_assert(sizeof(fixed) >= 8 * (sizeof(int) + sizeof(float)));
+    expect_equal(fixed.capacity(), size_t{8});
+    expect_equal(fixed.at(1) == std::tuple(2, 2.0f), true);
+}
+
+/* A field which counts its live instances, and whose construction (other than by moving) can be
+made to throw after `constructions_until_throw` more constructions */
+struct ThrowingField {
+    static inline int64_t live = 0;
+    static inline int64_t constructions_until_throw = -1;
+    int value;
+
+    ThrowingField(int value_ = 0) : value{value_} { count_construction(); }
+    ThrowingField(const ThrowingField &other) : value{other.value} { count_construction(); }
+    ThrowingField(ThrowingField &&other) noexcept : value{other.value} { ++live; }
+    ThrowingField& operator= (const ThrowingField&) = default;
+    ~ThrowingField() { --live; }
+
+    void count_construction() {
+        if (constructions_until_throw >= 0 && constructions_until_throw-- == 0) {
+            throw std::runtime_error("ThrowingField: construction failed");
+        }
+        ++live;
+    }
+};
+
+/* When constructing a field throws, neither the fields of the row built so far nor a new heap
+buffer are leaked, whether appending in place or while growing, resizing, or constructing */
+void soa_test_exception_safety() {
+    AllocationCounters counters;
+    using Allocator = CountingAllocator<std::byte>;
+    using SoA = BasicSoAVector<2, true, Allocator, std::string, ThrowingField, ThrowingField>;
+    auto throws = [](int64_t constructions, auto operation) {
+        ThrowingField::constructions_until_throw = constructions;
+        bool threw = false;
+        try {
+            operation();
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        ThrowingField::constructions_until_throw = -1;
+        return threw;
+    };
+    auto long_string = std::string(40, 's');
+    {
+        SoA soa(counters);
+        for (int64_t k = 0; k < 2; ++k) {
+            /* The `k`th `ThrowingField` of the row throws: in place, and then while growing */
+            expect_equal(throws(k, [&] { soa.emplace_back(long_string, 1, 2); }), true);
+            expect_equal(soa.size(), size_t{0});
+            soa.emplace_back(long_string, 1, 2);
+            soa.emplace_back(long_string, 3, 4);
+            expect_equal(throws(k, [&] { soa.emplace_back(long_string, 5, 6); }), true);
+            expect_equal(soa.size(), size_t{2});
+            expect_equal(counters.live_bytes(), uint64_t{0});
+            expect_equal(ThrowingField::live, int64_t{4});
+            soa.clear();
+        }
+
+        soa.resize(2);
+        expect_equal(throws(5, [&] { soa.resize(10); }), true);
+        expect_equal(soa.size(), size_t{2});
+        expect_equal(ThrowingField::live, int64_t{4});
+
+        expect_equal(throws(3, [&] { SoA copy(soa); }), true);
+        expect_equal(throws(5, [&] { SoA sized(10, counters); }), true);
+        expect_equal(ThrowingField::live, int64_t{4});
+    }
+    expect_equal(ThrowingField::live, int64_t{0});
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+void test_soa() {
+    std::cout << "Testing SoA vectors... " << std::flush;
+    soa_test_operations<SoAVector<int, std::string, double>>();
+    soa_test_operations<StackAssistedSoAVector<8, int, std::string, double>>();
+    soa_test_operations<FixedCapacitySoAVector<64, int, std::string, double>>();
+    soa_test_growth();
+    soa_test_exception_safety();
+    std::cout << "Success" << std::endl;
+}
+
+/* Performs the same random sequence of pushes and pops at both ends on a ring buffer of type
+`Ring` and on a `std::deque`, and checks that they always hold the same elements */
+template <typename Ring>
+void ring_test_against_deque() {
+    Ring ring;
+    std::deque<NonDefaultConstructibleClass> deque;
+    auto same_field = [](const auto &a, const auto &b) { return *a.field == *b.field; };
+    uint32_t state = 12345;
+    for (int step = 0; step < 300; ++step) {
+        state = state * 1664525 + 1013904223;
+        auto op = (state >> 16) % 4;
+        if ((op == 0 || op == 1) && ring.full()) {
+            op += 2;
+        }
+        if ((op == 2 || op == 3) && ring.empty()) {
+            op -= 2;
+        }
+        switch (op) {
+            case 0: ring.push_back(step); deque.push_back(step); break;
+            case 1: ring.emplace_front(step); deque.emplace_front(step); break;
+            case 2: ring.pop_back(); deque.pop_back(); break;
+            case 3: ring.pop_front(); deque.pop_front(); break;
+        }
+        expect_equal(ring.size(), deque.size());
+        expect_equal(std::equal(
+            ring.begin(), ring.end(), deque.begin(), deque.end(), same_field
+        ), true);
+    }
+    expect_equal(std::equal(
+        ring.rbegin(), ring.rend(), deque.rbegin(), deque.rend(), same_field
+    ), true);
+
+    Ring copy(ring);
+    expect_equal(std::equal(
+        copy.begin(), copy.end(), deque.begin(), deque.end(), same_field
+    ), true);
+    Ring moved(std::move(copy));
+    expect_equal(copy.empty(), true);
+    expect_equal(std::equal(
+        moved.begin(), moved.end(), deque.begin(), deque.end(), same_field
+    ), true);
+}
+
+void ring_test_bulk() {
+    /* A sliding window over a stream of samples, where every push and pop wraps around */
+    FixedCapacityRingBuffer<int, 6> window;
+    int samples[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int popped[10] = {};
+    expect_equal(window.push_n(samples, 4), size_t{4});
+    expect_equal(window.pop_n(popped, 3), size_t{3});
+    expect_equal(window.push_n(samples + 4, 10), size_t{5});  /* wraps around, and only 5 fit */
+    expect_equal(window.full(), true);
+    expect_equal(std::format("{}", window), "{3, 4, 5, 6, 7, 8}"s);
+    expect_equal(window.pop_n(popped + 3, 10), size_t{6});  /* wraps around */
+    expect_equal(window.empty(), true);
+    expect_equal(std::equal(popped, popped + 9, samples), true);
+
+    /* Non-trivial elements are copied and moved one at a time */
+    FixedCapacityRingBuffer<std::string, 4> names{"a", "b", "c"};
+    names.pop_front();
+    names.pop_front();
+    std::string more[] = {"d", "e", "f"};
+    expect_equal(names.push_n(more, 3), size_t{3});
+    std::string out[4];
+    expect_equal(names.pop_n(out, 4), size_t{4});
+    expect_equal(out[0] + out[1] + out[2] + out[3], "cdef"s);
+    expect_equal(names.empty(), true);
+}
+
+consteval auto test_ring_constant_evaluation() {
+    FixedCapacityRingBuffer<int, 5> ring;
+    int sum = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (ring.full()) {
+            sum += ring.front();
+            ring.pop_front();
+        }
+        ring.push_back(i);
+    }
+    int rest[5] = {};
+    ring.pop_n(rest, 5);
+    for (int i : rest) {
+        sum += i;
+    }
+    return sum;
+}
+
+void test_ring_buffer() {
+    std::cout << "Testing ring buffer... " << std::flush;
+    ring_test_against_deque<FixedCapacityRingBuffer<NonDefaultConstructibleClass, 8>>();
+    ring_test_against_deque<FixedCapacityRingBuffer<NonDefaultConstructibleClass, 7>>();
+    ring_test_bulk();
+    static_assert(test_ring_constant_evaluation() == 4950);
+    std::cout << "Success" << std::endl;
+}
+
+void spsc_test_single_thread() {
+    FixedCapacitySPSCQueue<std::string, 4> queue;
+    expect_equal(queue.empty(), true);
+    for (int i = 0; i < 4; ++i) {
+        expect_equal(queue.try_push(std::to_string(i)), true);
+    }
+    expect_equal(queue.try_push("full"), false);
+    expect_equal(queue.size(), size_t{4});
+
+    std::string out;
+    expect_equal(queue.try_pop(out), true);
+    expect_equal(out, "0"s);
+    expect_equal(queue.try_emplace(3, 'x'), true);  /* wraps around */
+    expect_equal(*queue.try_pop(), "1"s);
+
+    /* Batches wrap around too */
+    std::string batch[4];
+    expect_equal(queue.try_pop_n(batch, 4), size_t{3});
+    expect_equal(batch[0] + batch[1] + batch[2], "23xxx"s);
+    expect_equal(queue.try_pop().has_value(), false);
+    expect_equal(queue.try_push_n(batch, 4), size_t{4});
+    expect_equal(queue.try_push_n(batch, 1), size_t{0});
+
+    /* The elements left over are destroyed along with the queue (which ASan would notice) */
+}
+
+/* Streams `count` integers from a producer thread to this thread, in batches of varying sizes on
+both sides if `Batch` is true, and checks that they arrive complete and in order. Both threads
+yield whenever the queue is full (or empty), so that the test also finishes quickly when they
+share a core. */
+/* If a copy throws during `try_push_n`, the copies already made are destroyed and nothing is
+pushed, whichever segment the copy is in */
+void spsc_test_push_n_exception_safety() {
+    auto baseline = LiveCounted::live;
+    {
+        FixedCapacitySPSCQueue<LiveCounted, 4> queue;
+        LiveCounted batch[3] = {0, 1, 2};
+        for (int i = 0; i < 3; ++i) {
+            queue.try_emplace(i);
+            queue.try_pop();
+        }
+        /* The batch now wraps around: one element goes at the end, and two at the start */
+        for (int64_t copies : {0, 1, 2}) {
+            LiveCounted::copies_until_throw = copies;
+            bool threw = false;
+            try {
+                queue.try_push_n(batch, 3);
+            } catch (const std::runtime_error &) {
+                threw = true;
+            }
+            LiveCounted::copies_until_throw = -1;
+            expect_equal(threw, true);
+            expect_equal(queue.empty(), true);
+            expect_equal(LiveCounted::live, baseline + 3);
+        }
+        expect_equal(queue.try_push_n(batch, 3), size_t{3});
+        expect_equal(queue.try_pop()->value, 0);
+    }
+    expect_equal(LiveCounted::live, baseline);
+}
+
+template <size_t Capacity, bool Batch>
+void spsc_test_two_threads(uint64_t count) {
+    FixedCapacitySPSCQueue<uint64_t, Capacity> queue;
+    std::thread producer([&queue, count] {
+        uint64_t batch[7];
+        for (uint64_t next = 0; next < count;) {
+            if constexpr (Batch) {
+                auto n = std::min<uint64_t>(next % 7 + 1, count - next);
+                for (uint64_t i = 0; i < n; ++i) {
+                    batch[i] = next + i;
+                }
+                if (auto pushed = queue.try_push_n(batch, n)) {
+                    next += pushed;  /* retries whatever did not fit */
+                    continue;
+                }
+            } else if (queue.try_push(next)) {
+                ++next;
+                continue;
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    uint64_t expected = 0;
+    bool in_order = true;
+    uint64_t batch[5];
+    while (expected < count) {
+        if constexpr (Batch) {
+            auto n = queue.try_pop_n(batch, expected % 5 + 1);
+            for (uint64_t i = 0; i < n; ++i) {
+                in_order &= (batch[i] == expected++);
+            }
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+        } else if (auto value = queue.try_pop()) {
+            in_order &= (*value == expected++);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    expect_equal(in_order, true);
+    expect_equal(queue.empty(), true);
+}
+
+void test_spsc_queue() {
+    std::cout << "Testing SPSC queue... " << std::flush;
+    spsc_test_single_thread();
+    spsc_test_push_n_exception_safety();
+    spsc_test_two_threads<64, false>(200000);
+    spsc_test_two_threads<64, true>(200000);
+    spsc_test_two_threads<10, false>(200000);
+    spsc_test_two_threads<10, true>(200000);
+    std::cout << "Success" << std::endl;
+}
+
+template <size_t Capacity>
+void mpmc_test_single_thread() {
+    FixedCapacityMPMCQueue<std::string, Capacity> queue;
+    expect_equal(queue.empty(), true);
+    for (size_t i = 0; i < Capacity; ++i) {
+        expect_equal(queue.try_push(std::to_string(i)), true);
+    }
+    expect_equal(queue.try_push("full"), false);
+    expect_equal(queue.size(), Capacity);
+
+    std::string out;
+    expect_equal(queue.try_pop(out), true);
+    expect_equal(out, "0"s);
+    queue.emplace(3, 'x');  /* wraps around, without blocking */
+    expect_equal(queue.pop(), "1"s);
+
+    /* Batches stop at the first slot that is not ready, and wrap around too */
+    std::string batch[Capacity + 1];
+    expect_equal(queue.try_pop_n(batch, Capacity + 1), Capacity - 1);
+    expect_equal(batch[Capacity - 2], "xxx"s);
+    expect_equal(queue.try_pop().has_value(), false);
+    expect_equal(queue.try_pop_n(batch, 1), size_t{0});
+    expect_equal(queue.try_push_n(batch, Capacity + 1), Capacity);
+    expect_equal(queue.try_push_n(batch, 1), size_t{0});
+    expect_equal(*queue.try_pop(), "2"s);
+
+    /* The elements left over are destroyed along with the queue (which ASan would notice) */
+}
+
+enum class MPMCMode { Try, Blocking, Bulk };
+
+/* Runs `Producers` threads which each push `count` integers tagged with the producer's index, and
+`Consumers` threads which pop them, and checks that every integer is popped exactly once, and that
+every consumer sees the integers of each producer in order. With `MPMCMode::Try` and
+`MPMCMode::Bulk`, threads yield whenever the queue is full (or empty), so that the test also
+finishes quickly when they share a core; with `MPMCMode::Blocking`, they sleep in `push` and
+`pop` instead. */
+template <size_t Capacity, size_t Producers, size_t Consumers, MPMCMode Mode>
+void mpmc_test_threads(uint64_t count) {
+    static_assert((Producers * Consumers) != 0);
+    FixedCapacityMPMCQueue<uint64_t, Capacity> queue;
+    auto total = Producers * count;
+    std::vector<std::thread> threads;
+    for (uint64_t producer = 0; producer < Producers; ++producer) {
+        threads.emplace_back([&queue, producer, count] {
+            uint64_t batch[7];
+            for (uint64_t next = 0; next < count;) {
+                auto value = producer * count + next;
+                if constexpr (Mode == MPMCMode::Blocking) {
+                    queue.push(value);
+                    ++next;
+                    continue;
+                } else if constexpr (Mode == MPMCMode::Bulk) {
+                    auto n = std::min<uint64_t>(next % 7 + 1, count - next);
+                    for (uint64_t i = 0; i < n; ++i) {
+                        batch[i] = value + i;
+                    }
+                    if (auto pushed = queue.try_push_n(batch, n)) {
+                        next += pushed;
+                        continue;
+                    }
+                } else if (queue.try_push(value)) {
+                    ++next;
+                    continue;
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    /* Every consumer pops its share of the integers, so that blocking consumers all return */
+    std::vector<std::vector<uint64_t>> popped(Consumers);
+    for (size_t consumer = 0; consumer < Consumers; ++consumer) {
+        auto share = total / Consumers + (consumer < total % Consumers ? 1 : 0);
+        threads.emplace_back([&queue, &values = popped[consumer], share] {
+            uint64_t batch[5];
+            while (values.size() < share) {
+                if constexpr (Mode == MPMCMode::Blocking) {
+                    values.push_back(queue.pop());
+                    continue;
+                } else if constexpr (Mode == MPMCMode::Bulk) {
+                    auto wanted = std::min<size_t>(values.size() % 5 + 1, share - values.size());
+                    if (auto n = queue.try_pop_n(batch, wanted)) {
+                        values.insert(values.end(), batch, batch + n);
+                        continue;
+                    }
+                } else if (auto value = queue.try_pop()) {
+                    values.push_back(*value);
+                    continue;
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<uint64_t> times_popped(total, 0);
+    bool in_order = true;
+    for (const auto &values : popped) {
+        std::vector<uint64_t> last_of_producer(Producers, 0);
+        std::vector<bool> seen_producer(Producers, false);
+        for (auto value : values) {
+            ++times_popped[value];
+            auto producer = value / count;
+            in_order &= (!seen_producer[producer] || last_of_producer[producer] < value);
+            seen_producer[producer] = true;
+            last_of_producer[producer] = value;
+        }
+    }
+    expect_equal(in_order, true);
+    expect_equal(std::ranges::count(times_popped, uint64_t{1}), static_cast<ptrdiff_t>(total));
+    expect_equal(queue.empty(), true);
+}
+
+void test_mpmc_queue() {
+    std::cout << "Testing MPMC queue... " << std::flush;
+    mpmc_test_single_thread<4>();
+    mpmc_test_single_thread<3>();
+    mpmc_test_threads<64, 4, 4, MPMCMode::Try>(50000);
+    mpmc_test_threads<64, 4, 4, MPMCMode::Bulk>(50000);
+    mpmc_test_threads<64, 4, 4, MPMCMode::Blocking>(50000);
+    mpmc_test_threads<10, 3, 2, MPMCMode::Try>(50000);
+    mpmc_test_threads<10, 2, 3, MPMCMode::Bulk>(50000);
+    mpmc_test_threads<2, 3, 3, MPMCMode::Blocking>(50000);
+    std::cout << "Success" << std::endl;
+}
+
+/* Performs the same random sequence of insertions, lookups and erasures on a set of type `Set`
+and on a `std::set`, and checks that they always hold the same keys. Keys go up to 150, so that
+the sets outgrow both their stack capacity and the linear search threshold. */
+template <typename Set>
+void flat_test_set_against_std_set() {
+    Set set;
+    std::set<typename Set::key_type> expected;
+    auto key_from = [](uint32_t k) {
+        if constexpr (std::is_same_v<typename Set::key_type, std::string>) {
+            return std::to_string(k);
+        } else {
+            return static_cast<typename Set::key_type>(k);
+        }
+    };
+    uint32_t state = 54321;
+    for (int step = 0; step < 2000; ++step) {
+        state = state * 1664525 + 1013904223;
+        auto key = key_from((state >> 8) % 150);
+        switch ((state >> 20) % 4) {
+            case 0:
+            case 1:
+                expect_equal(set.insert(key).second, expected.insert(key).second);
+                break;
+            case 2:
+                expect_equal(set.erase(key), expected.erase(key));
+                break;
+            case 3:
+                if (auto it = set.find(key); it != set.end()) {
+                    expect_equal(*it, key);
+                    set.erase(it);
+                    expected.erase(key);
+                }
+                break;
+        }
+        expect_equal(set.contains(key), expected.contains(key));
+        expect_equal(set.size(), expected.size());
+    }
+    expect_equal(std::ranges::equal(set, expected), true);
+    expect_equal(Set(expected.rbegin(), expected.rend()) == set, true);
+}
+
+/* Performs the same random sequence of operations on a `SmallFlatMap` and on a `std::map` */
+void flat_test_map_against_std_map() {
+    SmallFlatMap<int, std::string, 8> map;
+    std::map<int, std::string> expected;
+    uint32_t state = 98765;
+    for (int step = 0; step < 2000; ++step) {
+        state = state * 1664525 + 1013904223;
+        auto key = static_cast<int>((state >> 8) % 150);
+        auto value = std::to_string(step);
+        switch ((state >> 20) % 5) {
+            case 0:
+                map[key] += value;
+                expected[key] += value;
+                break;
+            case 1:
+                expect_equal(
+                    map.try_emplace(key, value).second, expected.try_emplace(key, value).second
+                );
+                break;
+            case 2:
+                expect_equal(
+                    map.insert_or_assign(key, value).second,
+                    expected.insert_or_assign(key, value).second
+                );
+                break;
+            case 3:
+                expect_equal(map.erase(key), expected.erase(key));
+                break;
+            case 4:
+                if (auto it = map.find(key); it != map.end()) {
+                    expect_equal(it->second, expected.at(key));
+                    it = map.erase(it);
+                    auto next = expected.erase(expected.find(key));
+                    expect_equal(it == map.end(), next == expected.end());
+                }
+                break;
+        }
+        expect_equal(map.size(), expected.size());
+    }
+    expect_equal(std::ranges::equal(map.keys(), expected | std::views::keys), true);
+    expect_equal(std::ranges::equal(map.values(), expected | std::views::values), true);
+    for (auto [key, value] : map) {
+        expect_equal(value, expected.at(key));
+    }
+    expect_equal(map == SmallFlatMap<int, std::string, 8>(expected.begin(), expected.end()), true);
+}
+
+void flat_test_construction_and_lookup() {
+    /* Bulk construction sorts, and keeps the first of any duplicate keys */
+    SmallFlatMap<int, std::string, 4> map{{3, "a"}, {1, "b"}, {3, "c"}, {2, "d"}, {1, "e"}};
+    expect_equal(std::format("{}", map), "{1: b, 2: d, 3: a}"s);
+    expect_equal(map.at(2), "d"s);
+    expect_equal(map.count(4), size_t{0});
+    expect_equal(map.lower_bound(0)->first, 1);
+    bool threw = false;
+    try {
+        map.at(4);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    expect_equal(threw, true);
+
+    SmallFlatSet<int, 4> set{5, 3, 5, 1, 3};
+    expect_equal(std::format("{}", set), "{1, 3, 5}"s);
+    SmallFlatSet<int, 4, std::greater<int>> descending{5, 3, 5, 1, 3};
+    expect_equal(std::format("{}", descending), "{5, 3, 1}"s);
+
+    /* With a transparent comparator, lookups take any comparable type without converting it */
+    SmallFlatMap<std::string, int, 4, std::less<>> by_name{{"one", 1}, {"two", 2}, {"three", 3}};
+    expect_equal(by_name.contains("two"sv), true);
+    expect_equal(by_name.find("four"sv) == by_name.end(), true);
+    expect_equal(by_name.at("three"), 3);
+    expect_equal(by_name.erase("one"sv), size_t{1});
+    SmallFlatSet<std::string, 4, std::less<>> names{"b", "a"};
+    expect_equal(names.contains("a"sv), true);
+
+    /* Values need not be default-constructible, unless `operator[]` is used */
+    SmallFlatMap<int, NonDefaultConstructibleClass, 2> ndcc_map;
+    for (int i = 9; i >= 0; --i) {
+        expect_equal(ndcc_map.try_emplace(i, i * i).second, true);
+    }
+    expect_equal(ndcc_map.try_emplace(3, 0).second, false);
+    expect_equal(*ndcc_map.at(7).field, 49);
+    ndcc_map.erase(5);
+    expect_equal(*ndcc_map.begin()[5].second.field, 36);
+}
+
+/* The maps make no allocations until they exceed their stack capacity, including when built from
+a range (which sorts on the stack too) */
+void flat_test_allocations() {
+    AllocationCounters counters;
+    using Map = SmallFlatMap<
+        int, int, 8, std::less<int>, CountingAllocator<std::pair<const int, int>>
+    >;
+    {
+        std::vector<std::pair<int, int>> entries;
+        for (int i = 0; i < 8; ++i) {
+            entries.emplace_back(7 - i, i);
+        }
+        Map map(entries.begin(), entries.end(), {}, counters);
+        expect_equal(map.size(), size_t{8});
+        for (int i = 0; i < 8; ++i) {
+            map[i] += 1;
+        }
+        expect_equal(counters.allocations.load(), uint64_t{0});
+
+        /* One allocation for the keys and one for the values */
+        map[8] = 0;
+        expect_equal(counters.allocations.load(), uint64_t{2});
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+
+    counters.reset();
+    {
+        SmallFlatSet<int, 8, std::less<int>, CountingAllocator<int>> set(counters);
+        set.reserve(100);
+        for (int i = 0; i < 100; ++i) {
+            set.insert(i);
+        }
+        expect_equal(counters.allocations.load(), uint64_t{1});
+    }
+}
+
+void test_flat_maps() {
+    std::cout << "Testing flat maps... " << std::flush;
+    flat_test_set_against_std_set<SmallFlatSet<int, 8>>();
+    flat_test_set_against_std_set<SmallFlatSet<uint8_t, 8>>();
+    flat_test_set_against_std_set<SmallFlatSet<std::string, 4>>();
+    flat_test_map_against_std_map();
+    flat_test_construction_and_lookup();
+    flat_test_allocations();
+    std::cout << "Success" << std::endl;
+}
+
+/* Performs the same random sequence of operations on a `SmallSwissMap` and on a
+`std::unordered_map`. Keys go up to 300, so that the map outgrows its inline table, and is rebuilt
+both to grow and to clear out deleted slots. */
+void swiss_test_against_std_unordered_map() {
+    SmallSwissMap<int, std::string, 8> map;
+    std::unordered_map<int, std::string> expected;
+    uint32_t state = 13579;
+    for (int step = 0; step < 5000; ++step) {
+        state = state * 1664525 + 1013904223;
+        auto key = static_cast<int>((state >> 8) % 300);
+        auto value = std::to_string(step);
+        switch ((state >> 20) % 6) {
+            case 0:
+                map[key] += value;
+                expected[key] += value;
+                break;
+            case 1:
+                expect_equal(
+                    map.try_emplace(key, value).second, expected.try_emplace(key, value).second
+                );
+                break;
+            case 2:
+                expect_equal(
+                    map.insert_or_assign(key, value).second,
+                    expected.insert_or_assign(key, value).second
+                );
+                break;
+            case 3:
+            case 4:
+                expect_equal(map.erase(key), expected.erase(key));
+                break;
+            case 5:
+                if (auto it = map.find(key); it != map.end()) {
+                    expect_equal(it->second, expected.at(key));
+                    map.erase(it);
+                    expected.erase(key);
+                }
+                break;
+        }
+        expect_equal(map.contains(key), expected.contains(key));
+        expect_equal(map.size(), expected.size());
+    }
+    size_t visited = 0;
+    for (auto [key, value] : map) {
+        expect_equal(value, expected.at(key));
+        ++visited;
+    }
+    expect_equal(visited, expected.size());
+
+    /* Erasing while iterating visits every entry once, as erasing moves no other entry */
+    auto copy = map;
+    expect_equal(copy == map, true);
+    for (auto it = copy.begin(); it != copy.end();) {
+        it = (it->first % 2 == 0 ? copy.erase(it) : std::next(it));
+    }
+    expect_equal(copy.size(), size_t(std::ranges::count_if(expected, [](const auto &entry) {
+        return entry.first % 2 != 0;
+    })));
+    expect_equal(copy == map, false);
+
+    /* Shrinking the table back to the inline one keeps the entries */
+    auto moved = std::move(map);
+    expect_equal(map.empty() && map.is_inline(), true);
+    for (auto it = moved.begin(); it != moved.end();) {
+        it = (it->first >= 5 ? moved.erase(it) : std::next(it));
+    }
+    moved.rehash(0);
+    expect_equal(moved.is_inline(), true);
+    for (auto [key, value] : moved) {
+        expect_equal(value, expected.at(key));
+    }
+    map = moved;
+    expect_equal(map == moved, true);
+}
+
+/* A transparent hash for strings, so that lookups take a `std::string_view` or a `const char*`
+without constructing a `std::string` */
+struct TransparentStringHash {
+    using is_transparent = void;
+    size_t operator() (std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+void swiss_test_construction_and_lookup() {
+    /* Construction keeps the first of any duplicate keys */
+    SmallSwissMap<int, std::string, 4> map{{3, "a"}, {1, "b"}, {3, "c"}, {2, "d"}, {1, "e"}};
+    expect_equal(map.size(), size_t{3});
+    expect_equal(map.at(1), "b"s);
+    expect_equal(map.at(3), "a"s);
+    expect_equal(map.count(4), size_t{0});
+    bool threw = false;
+    try {
+        map.at(4);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    expect_equal(threw, true);
+    expect_equal(std::format("{}", SmallSwissMap<int, int, 1>{{7, 49}}), "{7: 49}"s);
+
+    /* With a transparent hash and key equality, lookups take any comparable type */
+    SmallSwissMap<std::string, int, 4, TransparentStringHash, std::equal_to<>> by_name{
+        {"one", 1}, {"two", 2}, {"three", 3}
+    };
+    expect_equal(by_name.contains("two"sv), true);
+    expect_equal(by_name.find("four"sv) == by_name.end(), true);
+    expect_equal(by_name.at("three"), 3);
+    expect_equal(by_name.erase("one"sv), size_t{1});
+    expect_equal(by_name.size(), size_t{2});
+
+    /* Values need not be default-constructible, unless `operator[]` is used */
+    SmallSwissMap<int, NonDefaultConstructibleClass, 2> ndcc_map;
+    for (int i = 0; i < 100; ++i) {
+        expect_equal(ndcc_map.try_emplace(i, i * i).second, true);
+    }
+    expect_equal(ndcc_map.try_emplace(3, 0).second, false);
+    expect_equal(*ndcc_map.at(7).field, 49);
+    expect_equal(*ndcc_map.find(99)->second.field, 9801);
+}
+
+/* The map makes no allocations until it exceeds `N` entries, and `reserve` sizes the table up
+front */
+void swiss_test_allocations() {
+    AllocationCounters counters;
+    using Map = SmallSwissMap<
+        int, int, 20, std::hash<int>, std::equal_to<int>,
+        CountingAllocator<std::pair<const int, int>>
+    >;
+    {
+        Map map(counters);
+        for (int i = 0; i < 20; ++i) {
+            map[i] = i;
+        }
+        /* Erasing and inserting leaves deleted slots, which are cleared out in place */
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 0; i < 20; ++i) {
+                map.erase(i + round * 20);
+                map[i + round * 20 + 20] = i;
+            }
+        }
+        expect_equal(map.is_inline(), true);
+        expect_equal(counters.allocations.load(), uint64_t{0});
+
+        /* One allocation for the control bytes and one for the slots */
+        for (int i = 0; i < 20; ++i) {
+            map[i] = i;
+        }
+        expect_equal(counters.allocations.load(), uint64_t{2});
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+
+    counters.reset();
+    {
+        Map map(counters);
+        map.reserve(1000);
+        auto capacity = map.capacity();
+        for (int i = 0; i < 1000; ++i) {
+            map[i] = i;
+        }
+        expect_equal(map.capacity(), capacity);
+        expect_equal(counters.allocations.load(), uint64_t{2});
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+/* An allocator which throws `std::bad_alloc` once `allocations_until_failure` (shared by every
+element type, if non-negative) more allocations have succeeded */
+struct AllocationFailures {
+    static inline int64_t allocations_until_failure = -1;
+};
+
+template <typename T>
+struct FailingAllocator {
+    using value_type = T;
+
+    FailingAllocator() = default;
+    template <typename U>
+    FailingAllocator(const FailingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        auto &until_failure = AllocationFailures::allocations_until_failure;
+        if (until_failure >= 0 && until_failure-- == 0) {
+            throw std::bad_alloc();
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T *p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+
+    friend bool operator== (const FailingAllocator&, const FailingAllocator&) { return true; }
+};
+
+/* If allocating a new table fails halfway (after the control bytes, but before the slots), the map
+keeps its current table, and nothing is leaked. Neither is anything leaked when copying an entry
+fails. */
+void swiss_test_failed_allocation() {
+    AllocationCounters counters;
+    using Entry = std::pair<const int, int>;
+    using Map = SmallSwissMap<
+        int, int, 4, std::hash<int>, std::equal_to<int>,
+        CountingAllocator<Entry, FailingAllocator<Entry>>
+    >;
+    {
+        Map map(counters);
+        for (int i = 0; i < 50; ++i) {
+            map[i] = i * i;
+        }
+        auto capacity = map.capacity();
+        auto allocations = counters.allocations.load();
+        auto live_bytes = counters.live_bytes();
+
+        AllocationFailures::allocations_until_failure = 1;
+        bool threw = false;
+        try {
+            map.reserve(1000);
+        } catch (const std::bad_alloc &) {
+            threw = true;
+        }
+        AllocationFailures::allocations_until_failure = -1;
+        expect_equal(threw, true);
+        expect_equal(counters.allocations.load(), allocations + 1);
+        expect_equal(counters.live_bytes(), live_bytes);
+
+        expect_equal(map.capacity(), capacity);
+        expect_equal(map.size(), size_t{50});
+        for (int i = 0; i < 50; ++i) {
+            expect_equal(map.at(i), i * i);
+        }
+        for (int i = 50; i < 200; ++i) {
+            map[i] = i * i;
+        }
+        expect_equal(map.at(199), 199 * 199);
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+
+    /* If copying an entry fails, the copy releases the entries copied so far and its table */
+    using CountedMap = SmallSwissMap<
+        int, LiveCounted, 4, std::hash<int>, std::equal_to<int>,
+        CountingAllocator<std::pair<const int, LiveCounted>>
+    >;
+    auto baseline = LiveCounted::live;
+    {
+        CountedMap map(counters);
+        for (int i = 0; i < 50; ++i) {
+            map.try_emplace(i, i);
+        }
+        auto live_bytes = counters.live_bytes();
+        LiveCounted::copies_until_throw = 20;
+        bool threw = false;
+        try {
+            CountedMap copy(map);
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        LiveCounted::copies_until_throw = -1;
+        expect_equal(threw, true);
+        expect_equal(LiveCounted::live, baseline + 50);
+        expect_equal(counters.live_bytes(), live_bytes);
+    }
+    expect_equal(LiveCounted::live, baseline);
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+/* A memory resource which tracks the blocks it has handed out, and counts deallocations of blocks
+it never handed out */
+struct TrackingResource : std::pmr::memory_resource {
+    std::set<void*> blocks;
+    size_t foreign_deallocations = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        auto p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        blocks.insert(p);
+        return p;
+    }
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        foreign_deallocations += (blocks.erase(p) == 0);
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/* With `std::pmr::polymorphic_allocator`, which does not propagate on assignment, assigning a map
+keeps its own resource: a move between maps of different resources moves the entries into this
+map's resource, rather than taking over (and later freeing) the other resource's table */
+void swiss_test_polymorphic_allocator() {
+    using Map = SmallSwissMap<
+        int, std::pmr::string, 4, std::hash<int>, std::equal_to<int>,
+        std::pmr::polymorphic_allocator<std::pair<const int, std::pmr::string>>
+    >;
+    TrackingResource a, b;
+    auto value = [](int i) { return std::string(32, static_cast<char>('a' + i % 26)); };
+    auto matches = [&](const Map &map, int count) {
+        if (map.size() != static_cast<size_t>(count)) {
+            return false;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (std::string_view(map.at(i)) != value(i)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    {
+        Map from_a(&a), to_b(&b);
+        for (int i = 0; i < 20; ++i) {
+            from_a.try_emplace(i, value(i));
+        }
+        to_b.try_emplace(100, value(100));
+
+        /* Copying allocates from `b` only */
+        auto a_blocks = a.blocks.size();
+        to_b = from_a;
+        expect_equal(matches(to_b, 20), true);
+        expect_equal(a.blocks.size(), a_blocks);
+
+        /* Moving between different resources moves the entries into `b` */
+        to_b = std::move(from_a);
+        expect_equal(matches(to_b, 20), true);
+        expect_equal(from_a.empty(), true);
+        expect_equal(a.blocks.size(), size_t{0});
+
+        /* Moving between maps of the same resource takes over the table */
+        Map also_b(&b);
+        auto b_blocks = b.blocks.size();
+        also_b = std::move(to_b);
+        expect_equal(matches(also_b, 20), true);
+        expect_equal(b.blocks.size(), b_blocks);
+    }
+    expect_equal(a.blocks.size() + b.blocks.size(), size_t{0});
+    expect_equal(a.foreign_deallocations + b.foreign_deallocations, size_t{0});
+}
+
+void test_swiss_map() {
+    std::cout << "Testing Swiss map... " << std::flush;
+    swiss_test_against_std_unordered_map();
+    swiss_test_construction_and_lookup();
+    swiss_test_allocations();
+    swiss_test_failed_allocation();
+    swiss_test_polymorphic_allocator();
+    std::cout << "Success" << std::endl;
+}
+
+/* Pushes 1000 elements into a `SegmentedVector`, and checks that elements never move, and that
+indexing, iterators and segments all agree */
+template <typename Vector>
+void segmented_test_push_back_and_indexing() {
+    Vector v;
+    std::vector<const int*> addresses;
+    for (int i = 0; i < 1000; ++i) {
+        auto &element = v.emplace_back(i);
+        expect_equal(&element == &v[i], true);
+        addresses.push_back(&element);
+    }
+    expect_equal(v.size(), size_t{1000});
+    for (int i = 0; i < 1000; ++i) {
+        expect_equal(v[i], i);
+        expect_equal(addresses[i] == &v[i], true);
+    }
+    expect_equal(std::ranges::equal(v, std::views::iota(0, 1000)), true);
+    expect_equal(std::ranges::equal(v | std::views::reverse, std::views::iota(0, 1000)
+                                                           | std::views::reverse), true);
+    auto it = v.begin() + 500;
+    expect_equal(*it, 500);
+    expect_equal(it[-100], 400);
+    expect_equal(v.end() - it, std::ptrdiff_t{500});
+    expect_equal(*(it - 250), 250);
+
+    /* The segments are contiguous, and hold every element once, in order */
+    int next = 0;
+    for (auto segment : v.segments()) {
+        for (auto element : segment) {
+            expect_equal(element, next++);
+        }
+    }
+    expect_equal(next, 1000);
+    long long sum = 0;
+    v.for_each_segment([&](std::span<const int> segment) {
+        sum += std::accumulate(segment.begin(), segment.end(), 0ll);
+    });
+    expect_equal(sum, 999ll * 1000 / 2);
+
+    /* `emplace_back` may take a reference to an element, even when it allocates a segment */
+    while (v.size() < v.capacity()) {
+        v.push_back(0);
+    }
+    v.push_back(v[7]);
+    expect_equal(v.back(), 7);
+
+    v.resize(10);
+    v.shrink_to_fit();
+    /* Only the segments holding the 10 remaining elements are kept */
+    expect_equal(v.capacity() >= 10 && v.capacity() < 32, true);
+    expect_equal(std::format("{}", v), "{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}"s);
+    bool threw = false;
+    try {
+        v.at(10);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    expect_equal(threw, true);
+}
+
+void segmented_test_copy_and_move() {
+    SegmentedVector<std::string, 4> v;
+    for (int i = 0; i < 50; ++i) {
+        v.push_back(std::to_string(i));
+    }
+    const auto *heap_element = &v[40];
+    auto copy = v;
+    expect_equal(copy == v, true);
+
+    /* Moving steals the heap segments, so only references to the inline elements change */
+    auto moved = std::move(v);
+    expect_equal(v.empty(), true);
+    expect_equal(moved == copy, true);
+    expect_equal(&moved[40] == heap_element, true);
+    v.push_back("reused");
+    expect_equal(v.size(), size_t{1});
+
+    /* Elements need be neither movable nor default-constructible */
+    SegmentedVector<std::atomic<int>, 2, FixedSegments> atomics;
+    for (int i = 0; i < 20; ++i) {
+        atomics.emplace_back(i);
+    }
+    expect_equal(atomics[19].load(), 19);
+    expect_equal(atomics.segment_count(), size_t{10});
+    SegmentedVector<NonDefaultConstructibleClass, 2> ndcc;
+    for (int i = 0; i < 20; ++i) {
+        ndcc.emplace_back(i);
+    }
+    expect_equal(*ndcc[13].field, 13);
+    ndcc.pop_back();
+    expect_equal(*ndcc.back().field, 18);
+}
+
+/* The first `ChunkSize` elements make no allocations, and every further segment makes exactly one;
+leaks would show up as live bytes */
+void segmented_test_allocations() {
+    AllocationCounters counters;
+    {
+        SegmentedVector<int, 16, GeometricSegments, CountingAllocator<int>> v(counters);
+        for (int i = 0; i < 16; ++i) {
+            v.push_back(i);
+        }
+        expect_equal(counters.allocations.load(), uint64_t{0});
+        /* 16 + 32 + 64 + 128 >= 200 */
+        v.resize(200);
+        expect_equal(counters.allocations.load(), uint64_t{3});
+        expect_equal(v.capacity(), size_t{240});
+        v.reserve(1000);
+        expect_equal(v.capacity(), size_t{1008});
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+
+    /* If the segment table fails to grow (here, when it first spills out of its 16 inline
+    entries), the newly allocated segment is released, and the vector is left unchanged */
+    {
+        SegmentedVector<
+            int, 1, FixedSegments, CountingAllocator<int, FailingAllocator<int>>
+        > v(counters);
+        for (int i = 0; i < 16; ++i) {
+            v.push_back(i);
+        }
+        auto live_bytes = counters.live_bytes();
+        AllocationFailures::allocations_until_failure = 1;
+        bool threw = false;
+        try {
+            v.push_back(16);
+        } catch (const std::bad_alloc &) {
+            threw = true;
+        }
+        AllocationFailures::allocations_until_failure = -1;
+        expect_equal(threw, true);
+        expect_equal(counters.live_bytes(), live_bytes);
+        expect_equal(v.size(), size_t{16});
+        expect_equal(v.capacity(), size_t{16});
+        v.push_back(16);
+        expect_equal(v.back(), 16);
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+void test_segmented_vector() {
+    std::cout << "Testing segmented vector... " << std::flush;
+    segmented_test_push_back_and_indexing<SegmentedVector<int, 8>>();
+    segmented_test_push_back_and_indexing<SegmentedVector<int, 1>>();
+    segmented_test_push_back_and_indexing<SegmentedVector<int, 16, FixedSegments>>();
+    segmented_test_copy_and_move();
+    segmented_test_allocations();
+    std::cout << "Success" << std::endl;
+}
+
+void concurrent_segmented_test_single_thread() {
+    ConcurrentSegmentedVector<std::string, 4> v;
+    expect_equal(v.is_published(0), false);
+    for (int i = 0; i < 100; ++i) {
+        expect_equal(v.push_back(std::to_string(i)), size_t(i));
+    }
+    const auto *first = &v[0];
+    auto &emplaced = v.emplace_back(3, 'x');
+    expect_equal(emplaced, "xxx"s);
+    expect_equal(v.grow_by(10, "g"), size_t{101});
+    expect_equal(v.grow_by(5), size_t{111});
+    expect_equal(v.size(), size_t{116});
+    expect_equal(&v[0] == first, true);
+    expect_equal(v.at(42), "42"s);
+    expect_equal(v[110], "g"s);
+    expect_equal(v[115], ""s);
+    expect_equal(std::ranges::count(v, "g"s), std::ptrdiff_t{10});
+    expect_equal(v.is_published(115), true);
+    expect_equal(v.is_published(116), false);
+    bool threw = false;
+    try {
+        v.at(116);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    expect_equal(threw, true);
+
+    ConcurrentSegmentedVector<NonDefaultConstructibleClass, 2> ndcc;
+    ndcc.reserve(30);
+    expect_equal(ndcc.capacity() >= 30, true);
+    const auto *first_ndcc = &ndcc.emplace_back(0);
+    for (int i = 1; i < 30; ++i) {
+        ndcc.emplace_back(i);
+    }
+    expect_equal(*ndcc[29].field, 29);
+    expect_equal(&ndcc[0] == first_ndcc, true);
+}
+
+/* Several threads append concurrently, one element at a time and in batches, while another thread
+reads every element as soon as it is published. Afterwards, every appended value must appear
+exactly once. */
+void concurrent_segmented_test_threads() {
+    constexpr int num_writers = 4;
+    constexpr int per_writer = 20000;
+    ConcurrentSegmentedVector<uint64_t, 8> v;
+    std::atomic<int> writers_done{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_writers; ++t) {
+        threads.emplace_back([&v, &writers_done, t] {
+            for (int i = 0; i < per_writer; i += 20) {
+                /* Values encode their writer, so that the reader can check them; a batch holds
+                10 copies of the same value, marked by bit 31 */
+                for (int j = 0; j < 10; ++j) {
+                    v.push_back(uint64_t(t) << 32 | uint64_t(i + j));
+                }
+                v.grow_by(10, uint64_t(t) << 32 | uint64_t{1} << 31 | uint64_t(i));
+                if (i % 1000 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            writers_done.fetch_add(1);
+        });
+    }
+
+    /* The reader scans published elements in order, checking that each holds a plausible value */
+    size_t read = 0;
+    bool all_plausible = true;
+    while (read < size_t{num_writers * per_writer}) {
+        if (v.is_published(read)) {
+            all_plausible &= (v[read] >> 32) < num_writers;
+            ++read;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    expect_equal(all_plausible, true);
+    expect_equal(writers_done.load(), num_writers);
+    expect_equal(v.size(), size_t{num_writers * per_writer});
+
+    std::vector<uint64_t> values(v.begin(), v.end());
+    std::ranges::sort(values);
+    std::vector<uint64_t> expected;
+    for (int t = 0; t < num_writers; ++t) {
+        for (int i = 0; i < per_writer; i += 20) {
+            for (int j = 0; j < 10; ++j) {
+                expected.push_back(uint64_t(t) << 32 | uint64_t(i + j));
+                expected.push_back(uint64_t(t) << 32 | uint64_t{1} << 31 | uint64_t(i));
+            }
+        }
+    }
+    std::ranges::sort(expected);
+    expect_equal(values == expected, true);
+}
+
+/* Segments are allocated once each (losing racers free theirs), and freed by the destructor */
+void concurrent_segmented_test_allocations() {
+    AllocationCounters counters;
+    {
+        ConcurrentSegmentedVector<int, 16, CountingAllocator<int>> v(counters);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&v] {
+                for (int i = 0; i < 5000; ++i) {
+                    v.push_back(i);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        expect_equal(v.size(), size_t{20000});
+        /* The segments holding the elements, plus at most the one allocated ahead */
+        expect_equal(v.capacity() >= 20000 && v.capacity() < 4 * 20000, true);
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+void test_concurrent_segmented_vector() {
+    std::cout << "Testing concurrent segmented vector... " << std::flush;
+    concurrent_segmented_test_single_thread();
+    concurrent_segmented_test_threads();
+    concurrent_segmented_test_allocations();
+    std::cout << "Success" << std::endl;
+}
+
+/* Applies random operations to a `SmallString<Capacity>` and a `std::string`, and checks that they
+agree, including on searches and comparisons, with lengths that cross the inline capacity and the
+16-byte blocks of the SIMD paths */
+template <size_t Capacity>
+void small_string_test_against_std_string() {
+    SmallString<Capacity> s;
+    std::string expected;
+    uint32_t state = 24680;
+    auto next = [&] {
+        state = state * 1664525 + 1013904223;
+        return state >> 8;
+    };
+    auto random_string = [&](size_t length) {
+        std::string result;
+        for (size_t i = 0; i < length; ++i) {
+            result.push_back(static_cast<char>('a' + next() % 3));
+        }
+        return result;
+    };
+    for (int step = 0; step < 3000; ++step) {
+        switch (next() % 10) {
+            case 0:
+            case 1: {
+                auto c = static_cast<char>('a' + next() % 3);
+                s.push_back(c);
+                expected.push_back(c);
+                break;
+            }
+            case 2: {
+                auto appended = random_string(next() % 40);
+                s += appended;
+                expected += appended;
+                break;
+            }
+            case 3: {
+                /* Appending part of the string itself, which may move as the string grows */
+                auto position = next() % (expected.size() + 1);
+                auto count = next() % (expected.size() - position + 1);
+                s.append(s.view().substr(position, count));
+                expected.append(expected.substr(position, count));
+                break;
+            }
+            case 4: {
+                auto count = next() % 20;
+                s.append(count, 'c');
+                expected.append(count, 'c');
+                break;
+            }
+            case 5:
+                if (!expected.empty()) {
+                    s.pop_back();
+                    expected.pop_back();
+                }
+                break;
+            case 6: {
+                auto position = next() % (expected.size() + 1);
+                auto count = next() % 10;
+                s.erase(position, count);
+                expected.erase(position, count);
+                break;
+            }
+            case 7: {
+                auto new_size = next() % 100;
+                s.resize(new_size, 'b');
+                expected.resize(new_size, 'b');
+                break;
+            }
+            case 8:
+                if (expected.size() > 200) {
+                    s.assign(s.view().substr(10, 20));
+                    expected = expected.substr(10, 20);
+                }
+                break;
+            case 9:
+                if (next() % 8 == 0) {
+                    s.clear();
+                    expected.clear();
+                    s.shrink_to_fit();
+                    expect_equal(s.is_inline(), true);
+                }
+                break;
+        }
+        expect_equal(s.view(), std::string_view(expected));
+        expect_equal(std::strlen(s.c_str()), expected.size());
+        expect_equal(s.capacity() >= s.size(), true);
+
+        auto needle = random_string(next() % 6);
+        auto position = next() % (expected.size() + 2);
+        expect_equal(s.find(needle, position), expected.find(needle, position));
+        if (!needle.empty()) {
+            expect_equal(s.find(needle[0], position), expected.find(needle[0], position));
+        }
+        auto other = random_string(next() % 60);
+        expect_equal(s.compare(other) < 0, expected.compare(other) < 0);
+        expect_equal(s.compare(other) == 0, expected.compare(other) == 0);
+        expect_equal(s == expected, true);
+        expect_equal(s.starts_with(needle), expected.starts_with(needle));
+        expect_equal(s.ends_with(needle), expected.ends_with(needle));
+    }
+    s.shrink_to_fit();
+    expect_equal(s.capacity(), std::max(s.size(), Capacity));
+    expect_equal(s.view(), std::string_view(expected));
+}
+
+/* Checks searching and comparing where the match or the mismatch is at every position of strings
+long enough for all of the SIMD paths, and with characters whose signs differ */
+void small_string_test_find_and_compare() {
+    std::string base(100, 'x');
+    for (size_t length = 0; length <= base.size(); length += 7) {
+        SmallString<16> s(std::string_view(base).substr(0, length));
+        for (size_t i = 0; i < length; ++i) {
+            s[i] = 'y';
+            expect_equal(s.find('y'), i);
+            expect_equal(s.find("yx"), (i + 1 < length ? i : SmallString<16>::npos));
+            expect_equal(s.find("xxy"), (i >= 2 ? i - 2 : SmallString<16>::npos));
+            expect_equal(s.compare(std::string_view(base).substr(0, length)) > 0, true);
+            s[i] = '\xF0';
+            expect_equal(s.compare(std::string_view(base).substr(0, length)) > 0, true);
+            expect_equal(s.view() < std::string_view(base).substr(0, length), false);
+            s[i] = 'x';
+        }
+        expect_equal(s.find('y'), SmallString<16>::npos);
+        expect_equal(s.compare(std::string_view(base).substr(0, length)), 0);
+        expect_equal((s <=> base) == 0, length == base.size());
+    }
+}
+
+void small_string_test_construction_and_hashing() {
+    static_assert(sizeof(SmallString<23>) == 32);
+    static_assert(sizeof(SmallString<23, true>) == 40);
+
+    SmallString<8> from_c_string = "hello, world";
+    SmallString<8> from_count(3, 'z');
+    std::string source = "iterators";
+    SmallString<8> from_iterators(source.begin(), source.end());
+    expect_equal(from_c_string.view(), "hello, world"sv);
+    expect_equal(from_count.view(), "zzz"sv);
+    expect_equal(std::string_view(from_iterators), "iterators"sv);
+    expect_equal(std::format("[{:>6}]", from_count), "[   zzz]"s);
+    expect_equal(from_c_string.at(7), 'w');
+    bool threw = false;
+    try {
+        from_c_string.at(12);
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    expect_equal(threw, true);
+
+    /* Copies and moves, both between inline and heap strings */
+    auto copy = from_c_string;
+    copy = from_count;
+    expect_equal(copy.view(), "zzz"sv);
+    copy = from_c_string;
+    auto moved = std::move(copy);
+    expect_equal(moved.view(), "hello, world"sv);
+    expect_equal(copy.empty(), true);
+    copy = std::move(moved);
+    expect_equal(copy.view(), "hello, world"sv);
+    copy = copy.view().substr(7);
+    expect_equal(copy.view(), "world"sv);
+
+    /* A copy of a heap string keeps room for the null terminator */
+    SmallString<7> heap_string("0123456789abcdef0xyz");
+    SmallString<7> heap_copy(heap_string);
+    expect_equal(heap_copy.is_inline(), false);
+    expect_equal(heap_copy.capacity() >= heap_copy.size(), true);
+    expect_equal(std::strlen(heap_copy.c_str()), size_t{20});
+    expect_equal(heap_copy.view(), heap_string.view());
+
+    /* Equal strings hash equally, whether or not the hash is cached, and for every length up to
+    past the word-at-a-time path */
+    std::set<size_t> hashes;
+    for (size_t length = 0; length < 40; ++length) {
+        std::string characters(length, 'k');
+        SmallString<16> uncached(characters);
+        SmallString<16, true> cached(characters);
+        expect_equal(cached.hash(), uncached.hash());
+        expect_equal(std::hash<SmallString<16, true>>{}(cached), uncached.hash());
+        hashes.insert(uncached.hash());
+    }
+    expect_equal(hashes.size(), size_t{40});
+
+    /* The cached hash is recomputed after every kind of modification */
+    SmallString<16, true> cached = "cached";
+    auto reference_hash = [](std::string_view s) { return SmallString<16>(s).hash(); };
+    expect_equal(cached.hash(), reference_hash("cached"));
+    cached += "!";
+    expect_equal(cached.hash(), reference_hash("cached!"));
+    cached[0] = 'C';
+    expect_equal(cached.hash(), reference_hash("Cached!"));
+    *cached.begin() = 'k';
+    expect_equal(cached.hash(), reference_hash("kached!"));
+    cached.erase(0, 1);
+    expect_equal(cached.hash(), reference_hash("ached!"));
+    auto cached_copy = cached;
+    expect_equal(cached_copy.hash(), reference_hash("ached!"));
+    cached_copy = SmallString<16, true>("other");
+    expect_equal(cached_copy.hash(), reference_hash("other"));
+
+    std::unordered_map<SmallString<16, true>, int> counts;
+    for (auto word : {"one", "two", "one", "three", "one", "a rather long word", "two"}) {
+        ++counts[SmallString<16, true>(word)];
+    }
+    expect_equal(counts.size(), size_t{4});
+    expect_equal(counts.at("one"), 3);
+    expect_equal(counts.at("a rather long word"), 1);
+}
+
+void small_string_test_allocations() {
+    AllocationCounters counters;
+    using String = SmallString<24, false, CountingAllocator<char>>;
+    {
+        /* Up to 24 characters (and their null terminator) fit inline */
+        String s(counters);
+        s.append("0123456789abcdefghijklmn");
+        expect_equal(s.c_str() == s.data(), true);
+        expect_equal(s.is_inline(), true);
+        expect_equal(counters.allocations.load(), uint64_t{0});
+
+        /* Appending grows once, to the final size rather than once for the characters and again
+        for the null terminator */
+        s.append(std::string(100, 'x'));
+        expect_equal(counters.allocations.load(), uint64_t{1});
+        expect_equal(s.capacity() >= s.size(), true);
+        expect_equal(std::strlen(s.c_str()), size_t{124});
+        expect_equal(counters.allocations.load(), uint64_t{1});
+
+        /* Appending one character at a time grows geometrically */
+        for (int i = 0; i < 1000; ++i) {
+            s.push_back('y');
+        }
+        expect_equal(counters.allocations.load() <= uint64_t{5}, true);
+
+        s.resize(30);
+        s.shrink_to_fit();
+        expect_equal(s.capacity(), size_t{30});
+        s.resize(24);
+        s.shrink_to_fit();
+        expect_equal(s.is_inline(), true);
+        expect_equal(s.view(), "0123456789abcdefghijklmn"sv);
+
+        /* A short read into the string keeps only what was read */
+        auto allocations = counters.allocations.load();
+        s.resize_and_overwrite(200, [](char *data, size_t count) {
+            expect_equal(count, size_t{200});
+            std::memset(data + 24, 'r', 6);
+            return 30;
+        });
+        expect_equal(counters.allocations.load(), allocations + 1);
+        expect_equal(s.view(), "0123456789abcdefghijklmnrrrrrr"sv);
+        expect_equal(std::strlen(s.c_str()), size_t{30});
+    }
+    expect_equal(counters.live_bytes(), uint64_t{0});
+}
+
+void test_small_string() {
+    std::cout << "Testing small string... " << std::flush;
+    small_string_test_against_std_string<8>();
+    small_string_test_against_std_string<24>();
+    small_string_test_find_and_compare();
+    small_string_test_construction_and_hashing();
+    small_string_test_allocations();
     std::cout << "Success" << std::endl;
 }
 
@@ -468,7 +3316,21 @@ int main()
 {
     test_fcv();
     test_sav();
+    test_allocators();
+    test_instrumentation();
+    test_soa();
+    test_ring_buffer();
+    test_spsc_queue();
+    test_mpmc_queue();
+    test_flat_maps();
+    test_swiss_map();
+    test_segmented_vector();
+    test_concurrent_segmented_vector();
+    test_small_string();
     expect_equal(test_fcv_constant_evaluation(), 4950);
+    expect_equal(test_fcv_bulk_constant_evaluation(), 4005);
+    expect_equal(test_fcv_insert_erase_constant_evaluation(), size_t{40});
+    expect_equal(test_fcv_assignment_constant_evaluation(), size_t{4});
     test_bcv();  /* Will terminate the program if all goes well */
 
     return 0;